@@ -25,27 +25,27 @@
 #include "SessionsManager.h"
 #include "../ui/ContentBlockingProfileDialog.h"
 
-#include <QtConcurrent/QtConcurrentRun>
 #include <QtCore/QBuffer>
 #include <QtCore/QCoreApplication>
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QFileInfo>
+#include <QtCore/QPointer>
 #include <QtCore/QSaveFile>
 #include <QtCore/QTextStream>
+#include <QtCore/QThreadPool>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QMessageBox>
 
 namespace Otter
 {
 
-QHash<QString, AdblockContentFiltersProfile::RuleOption> AdblockContentFiltersProfile::m_options({{QLatin1String("third-party"), ThirdPartyOption}, {QLatin1String("stylesheet"), StyleSheetOption}, {QLatin1String("image"), ImageOption}, {QLatin1String("script"), ScriptOption}, {QLatin1String("object"), ObjectOption}, {QLatin1String("object-subrequest"), ObjectSubRequestOption}, {QLatin1String("object_subrequest"), ObjectSubRequestOption}, {QLatin1String("subdocument"), SubDocumentOption}, {QLatin1String("xmlhttprequest"), XmlHttpRequestOption}, {QLatin1String("websocket"), WebSocketOption}, {QLatin1String("popup"), PopupOption}, {QLatin1String("elemhide"), ElementHideOption}, {QLatin1String("generichide"), GenericHideOption}});
-QHash<NetworkManager::ResourceType, AdblockContentFiltersProfile::RuleOption> AdblockContentFiltersProfile::m_resourceTypes({{NetworkManager::ImageType, ImageOption}, {NetworkManager::ScriptType, ScriptOption}, {NetworkManager::StyleSheetType, StyleSheetOption}, {NetworkManager::ObjectType, ObjectOption}, {NetworkManager::XmlHttpRequestType, XmlHttpRequestOption}, {NetworkManager::SubFrameType, SubDocumentOption},{NetworkManager::PopupType, PopupOption}, {NetworkManager::ObjectSubrequestType, ObjectSubRequestOption}, {NetworkManager::WebSocketType, WebSocketOption}});
-
 AdblockContentFiltersProfile::AdblockContentFiltersProfile(const ContentFiltersProfile::ProfileSummary &profileSummary, const QStringList &languages, ContentFiltersProfile::ProfileFlags flags, QObject *parent) : ContentFiltersProfile(parent),
-	m_root(nullptr),
 	m_dataFetchJob(nullptr),
 	m_profileSummary(profileSummary),
 	m_error(NoError),
 	m_flags(flags),
+	m_ruleSetGeneration(0),
+	m_isLoadingRuleSet(false),
 	m_wasLoaded(false)
 {
 	if (!languages.isEmpty())
@@ -73,21 +73,62 @@ AdblockContentFiltersProfile::AdblockContentFiltersProfile(const ContentFiltersP
 
 void AdblockContentFiltersProfile::clear()
 {
+	++m_ruleSetGeneration;
+
+	m_isLoadingRuleSet = false;
+
 	if (!m_wasLoaded)
 	{
 		return;
 	}
 
-	if (m_root)
+	m_ruleSet.reset();
+	m_cosmeticFiltersRules.clear();
+
+	m_wasLoaded = false;
+}
+
+void AdblockContentFiltersProfile::loadRuleSet()
+{
+	if (m_wasLoaded || m_isLoadingRuleSet)
 	{
-		QtConcurrent::run(this, &AdblockContentFiltersProfile::deleteNode, m_root);
+		return;
 	}
 
-	m_cosmeticFiltersRules.clear();
-	m_cosmeticFiltersDomainExceptions.clear();
-	m_cosmeticFiltersDomainRules.clear();
+	const QString path(getPath());
 
-	m_wasLoaded = false;
+	if (!QFile::exists(path))
+	{
+		loadRules();
+
+		return;
+	}
+
+	const ProfileSummary profileSummary(m_profileSummary);
+	const QString compiledPath(getCompiledPath());
+	const quint32 parameters(getRulesParameters());
+	const quint64 generation(m_ruleSetGeneration);
+	const QPointer<AdblockContentFiltersProfile> profile(this);
+
+	m_isLoadingRuleSet = true;
+
+	QThreadPool::globalInstance()->start([=]()
+	{
+		QSharedPointer<AdblockContentFiltersRuleSet> ruleSet(AdblockContentFiltersRuleSet::load(compiledPath, path, parameters));
+
+		if (!ruleSet)
+		{
+			ruleSet = compileRules(profileSummary, path, compiledPath, parameters);
+		}
+
+		QMetaObject::invokeMethod(QCoreApplication::instance(), [=]()
+		{
+			if (profile)
+			{
+				profile->handleRuleSetLoaded(ruleSet, generation);
+			}
+		}, Qt::QueuedConnection);
+	});
 }
 
 void AdblockContentFiltersProfile::loadHeader()
@@ -130,7 +171,7 @@ void AdblockContentFiltersProfile::loadHeader()
 	}
 }
 
-void AdblockContentFiltersProfile::parseRuleLine(const QString &rule)
+void AdblockContentFiltersProfile::parseRuleLine(const QString &rule, const ProfileSummary &profileSummary, AdblockContentFiltersRuleSet::Builder *builder)
 {
 	if (rule.isEmpty() || rule.startsWith(QLatin1Char('!')))
 	{
@@ -139,9 +180,9 @@ void AdblockContentFiltersProfile::parseRuleLine(const QString &rule)
 
 	if (rule.startsWith(QLatin1String("##")))
 	{
-		if (m_profileSummary.cosmeticFiltersMode == ContentFiltersManager::AllFilters)
+		if (profileSummary.cosmeticFiltersMode == ContentFiltersManager::AllFilters)
 		{
-			m_cosmeticFiltersRules.append(rule.mid(2));
+			builder->addCosmeticFilter(rule.mid(2));
 		}
 
 		return;
@@ -149,9 +190,9 @@ void AdblockContentFiltersProfile::parseRuleLine(const QString &rule)
 
 	if (rule.contains(QLatin1String("##")))
 	{
-		if (m_profileSummary.cosmeticFiltersMode != ContentFiltersManager::NoFilters)
+		if (profileSummary.cosmeticFiltersMode != ContentFiltersManager::NoFilters)
 		{
-			parseStyleSheetRule(rule.split(QLatin1String("##")), m_cosmeticFiltersDomainRules);
+			parseStyleSheetRule(rule.split(QLatin1String("##")), builder, false);
 		}
 
 		return;
@@ -159,423 +200,32 @@ void AdblockContentFiltersProfile::parseRuleLine(const QString &rule)
 
 	if (rule.contains(QLatin1String("#@#")))
 	{
-		if (m_profileSummary.cosmeticFiltersMode != ContentFiltersManager::NoFilters)
+		if (profileSummary.cosmeticFiltersMode != ContentFiltersManager::NoFilters)
 		{
-			parseStyleSheetRule(rule.split(QLatin1String("#@#")), m_cosmeticFiltersDomainExceptions);
+			parseStyleSheetRule(rule.split(QLatin1String("#@#")), builder, true);
 		}
 
 		return;
 	}
 
-	const int optionsSeparator(rule.indexOf(QLatin1Char('$')));
-	const QStringList options((optionsSeparator >= 0) ? rule.mid(optionsSeparator + 1).split(QLatin1Char(','), Qt::SkipEmptyParts) : QStringList());
-	QString line(rule);
-
-	if (optionsSeparator >= 0)
-	{
-		line = line.left(optionsSeparator);
-	}
-
-	if (line.endsWith(QLatin1Char('*')))
-	{
-		line = line.left(line.length() - 1);
-	}
-
-	if (line.startsWith(QLatin1Char('*')))
-	{
-		line = line.mid(1);
-	}
-
-	if (!m_profileSummary.areWildcardsEnabled && line.contains(QLatin1Char('*')))
-	{
-		return;
-	}
-
-	Node::Rule *definition(new Node::Rule());
-	definition->rule = rule;
-	definition->isException = line.startsWith(QLatin1String("@@"));
-
-	if (definition->isException)
-	{
-		line = line.mid(2);
-	}
-
-	definition->needsDomainCheck = line.startsWith(QLatin1String("||"));
-
-	if (definition->needsDomainCheck)
-	{
-		line = line.mid(2);
-	}
-
-	if (line.startsWith(QLatin1Char('|')))
-	{
-		definition->ruleMatch = StartMatch;
-
-		line = line.mid(1);
-	}
+	AdblockContentFiltersRuleSet::RuleDefinition definition;
 
-	if (line.endsWith(QLatin1Char('|')))
+	if (AdblockContentFiltersRuleSet::parseRule(rule, profileSummary.areWildcardsEnabled, &definition))
 	{
-		definition->ruleMatch = ((definition->ruleMatch == StartMatch) ? ExactMatch : EndMatch);
-
-		line = line.left(line.length() - 1);
+		builder->addRule(definition);
 	}
-
-	for (int i = 0; i < options.count(); ++i)
-	{
-		const QString option(options.at(i));
-		const bool isOptionException(option.startsWith(QLatin1Char('~')));
-		const QString optionName(isOptionException ? option.mid(1) : option);
-
-		if (m_options.contains(optionName))
-		{
-			const RuleOption ruleOption(m_options.value(optionName));
-
-			if ((!definition->isException || isOptionException) && (ruleOption == ElementHideOption || ruleOption == GenericHideOption))
-			{
-				continue;
-			}
-
-			if (!isOptionException)
-			{
-				definition->ruleOptions |= ruleOption;
-			}
-			else if (ruleOption != WebSocketOption && ruleOption != PopupOption)
-			{
-				definition->ruleExceptions |= ruleOption;
-			}
-		}
-		else if (optionName.startsWith(QLatin1String("domain")))
-		{
-			const QStringList parsedDomains(option.mid(option.indexOf(QLatin1Char('=')) + 1).split(QLatin1Char('|'), Qt::SkipEmptyParts));
-
-			for (int j = 0; j < parsedDomains.count(); ++j)
-			{
-				const QString parsedDomain(parsedDomains.at(j));
-
-				if (parsedDomain.startsWith(QLatin1Char('~')))
-				{
-					definition->allowedDomains.append(parsedDomain.mid(1));
-				}
-				else
-				{
-					definition->blockedDomains.append(parsedDomain);
-				}
-			}
-		}
-		else
-		{
-			return;
-		}
-	}
-
-	Node *node(m_root);
-
-	for (int i = 0; i < line.length(); ++i)
-	{
-		const QChar value(line.at(i));
-		bool hasChildren(false);
-
-		for (int j = 0; j < node->children.count(); ++j)
-		{
-			Node *nextNode(node->children.at(j));
-
-			if (nextNode->value == value)
-			{
-				node = nextNode;
-
-				hasChildren = true;
-
-				break;
-			}
-		}
-
-		if (!hasChildren)
-		{
-			Node *newNode(new Node());
-			newNode->value = value;
-
-			if (value == QLatin1Char('^'))
-			{
-				node->children.insert(0, newNode);
-			}
-			else
-			{
-				node->children.append(newNode);
-			}
-
-			node = newNode;
-		}
-	}
-
-	node->rules.append(definition);
 }
 
-void AdblockContentFiltersProfile::parseStyleSheetRule(const QStringList &line, QMultiHash<QString, QString> &list)
+void AdblockContentFiltersProfile::parseStyleSheetRule(const QStringList &line, AdblockContentFiltersRuleSet::Builder *builder, bool isException)
 {
 	const QStringList domains(line.at(0).split(QLatin1Char(',')));
 
 	for (int i = 0; i < domains.count(); ++i)
 	{
-		list.insert(domains.at(i), line.at(1));
+		builder->addCosmeticDomainFilter(domains.at(i), line.at(1), isException);
 	}
 }
 
-void AdblockContentFiltersProfile::deleteNode(Node *node) const
-{
-	for (int i = 0; i < node->children.count(); ++i)
-	{
-		deleteNode(node->children.at(i));
-	}
-
-	for (int i = 0; i < node->rules.count(); ++i)
-	{
-		delete node->rules.at(i);
-	}
-
-	delete node;
-}
-
-ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkUrlSubstring(const Node *node, const QString &subString, QString currentRule, const Request &request) const
-{
-	ContentFiltersManager::CheckResult result;
-	ContentFiltersManager::CheckResult currentResult;
-
-	for (int i = 0; i < subString.length(); ++i)
-	{
-		const QChar treeChar(subString.at(i));
-		bool childrenExists(false);
-
-		currentResult = evaluateNodeRules(node, currentRule, request);
-
-		if (currentResult.isBlocked)
-		{
-			result = currentResult;
-		}
-		else if (currentResult.isException)
-		{
-			return currentResult;
-		}
-
-		for (int j = 0; j < node->children.count(); ++j)
-		{
-			const Node *nextNode(node->children.at(j));
-
-			if (nextNode->value == QLatin1Char('*'))
-			{
-				const QString wildcardSubString(subString.mid(i));
-
-				for (int k = 0; k < wildcardSubString.length(); ++k)
-				{
-					currentResult = checkUrlSubstring(nextNode, wildcardSubString.right(wildcardSubString.length() - k), (currentRule + wildcardSubString.left(k)), request);
-
-					if (currentResult.isBlocked)
-					{
-						result = currentResult;
-					}
-					else if (currentResult.isException)
-					{
-						return currentResult;
-					}
-				}
-			}
-
-			if (nextNode->value == QLatin1Char('^') && !treeChar.isDigit() && !treeChar.isLetter() && treeChar != QLatin1Char('_') && treeChar != QLatin1Char('-') && treeChar != QLatin1Char('.') && treeChar != QLatin1Char('%'))
-			{
-				currentResult = checkUrlSubstring(nextNode, subString.mid(i), currentRule, request);
-
-				if (currentResult.isBlocked)
-				{
-					result = currentResult;
-				}
-				else if (currentResult.isException)
-				{
-					return currentResult;
-				}
-			}
-
-			if (nextNode->value == treeChar)
-			{
-				node = nextNode;
-
-				childrenExists = true;
-
-				break;
-			}
-		}
-
-		if (!childrenExists)
-		{
-			return result;
-		}
-
-		currentRule += treeChar;
-	}
-
-	currentResult = evaluateNodeRules(node, currentRule, request);
-
-	if (currentResult.isBlocked)
-	{
-		result = currentResult;
-	}
-	else if (currentResult.isException)
-	{
-		return currentResult;
-	}
-
-	for (int i = 0; i < node->children.count(); ++i)
-	{
-		if (node->children.at(i)->value != QLatin1Char('^'))
-		{
-			continue;
-		}
-
-		currentResult = evaluateNodeRules(node, currentRule, request);
-
-		if (currentResult.isBlocked)
-		{
-			result = currentResult;
-		}
-		else if (currentResult.isException)
-		{
-			return currentResult;
-		}
-	}
-
-	return result;
-}
-
-ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkRuleMatch(const Node::Rule *rule, const QString &currentRule, const Request &request) const
-{
-	switch (rule->ruleMatch)
-	{
-		case StartMatch:
-			if (!request.requestUrl.startsWith(currentRule))
-			{
-				return {};
-			}
-
-			break;
-		case EndMatch:
-			if (!request.requestUrl.endsWith(currentRule))
-			{
-				return {};
-			}
-
-			break;
-		case ExactMatch:
-			if (request.requestUrl != currentRule)
-			{
-				return {};
-			}
-
-			break;
-		default:
-			if (!request.requestUrl.contains(currentRule))
-			{
-				return {};
-			}
-
-			break;
-	}
-
-	const QStringList requestSubdomainList(ContentFiltersManager::createSubdomainList(request.requestHost));
-
-	if (rule->needsDomainCheck && !requestSubdomainList.contains(currentRule.left(currentRule.indexOf(m_domainExpression))))
-	{
-		return {};
-	}
-
-	const bool hasBlockedDomains(!rule->blockedDomains.isEmpty());
-	const bool hasAllowedDomains(!rule->allowedDomains.isEmpty());
-	bool isBlocked(true);
-
-	if (hasBlockedDomains)
-	{
-		isBlocked = resolveDomainExceptions(request.baseHost, rule->blockedDomains);
-
-		if (!isBlocked)
-		{
-			return {};
-		}
-	}
-
-	isBlocked = (hasAllowedDomains ? !resolveDomainExceptions(request.baseHost, rule->allowedDomains) : isBlocked);
-
-	if (rule->ruleOptions.testFlag(ThirdPartyOption) || rule->ruleExceptions.testFlag(ThirdPartyOption))
-	{
-		if (request.baseHost.isEmpty() || requestSubdomainList.contains(request.baseHost))
-		{
-			isBlocked = rule->ruleExceptions.testFlag(ThirdPartyOption);
-		}
-		else if (!hasBlockedDomains && !hasAllowedDomains)
-		{
-			isBlocked = rule->ruleOptions.testFlag(ThirdPartyOption);
-		}
-	}
-
-	if (rule->ruleOptions != NoOption || rule->ruleExceptions != NoOption)
-	{
-		QHash<NetworkManager::ResourceType, RuleOption>::const_iterator iterator;
-
-		for (iterator = m_resourceTypes.constBegin(); iterator != m_resourceTypes.constEnd(); ++iterator)
-		{
-			const bool supportsException(iterator.value() != WebSocketOption && iterator.value() != PopupOption);
-
-			if (!rule->ruleOptions.testFlag(iterator.value()) && !(supportsException && rule->ruleExceptions.testFlag(iterator.value())))
-			{
-				continue;
-			}
-
-			if (request.resourceType == iterator.key())
-			{
-				isBlocked = (isBlocked ? rule->ruleOptions.testFlag(iterator.value()) : isBlocked);
-			}
-			else if (supportsException)
-			{
-				isBlocked = (isBlocked ? rule->ruleExceptions.testFlag(iterator.value()) : isBlocked);
-			}
-			else
-			{
-				isBlocked = false;
-			}
-		}
-	}
-	else if (request.resourceType == NetworkManager::PopupType)
-	{
-		isBlocked = false;
-	}
-
-	if (!isBlocked)
-	{
-		return {};
-	}
-
-	ContentFiltersManager::CheckResult result;
-	result.rule = rule->rule;
-
-	if (rule->isException)
-	{
-		result.isBlocked = false;
-		result.isException = true;
-
-		if (rule->ruleOptions.testFlag(ElementHideOption))
-		{
-			result.comesticFiltersMode = ContentFiltersManager::NoFilters;
-		}
-		else if (rule->ruleOptions.testFlag(GenericHideOption))
-		{
-			result.comesticFiltersMode = ContentFiltersManager::DomainOnlyFilters;
-		}
-
-		return result;
-	}
-
-	result.isBlocked = true;
-
-	return result;
-}
-
 void AdblockContentFiltersProfile::raiseError(const QString &message, ProfileError error)
 {
 	m_error = error;
@@ -650,6 +300,26 @@ void AdblockContentFiltersProfile::handleJobFinished(bool isSuccess)
 	emit profileModified();
 }
 
+void AdblockContentFiltersProfile::handleRuleSetLoaded(const QSharedPointer<AdblockContentFiltersRuleSet> &ruleSet, quint64 generation)
+{
+	if (generation != m_ruleSetGeneration || !m_isLoadingRuleSet)
+	{
+		return;
+	}
+
+	m_isLoadingRuleSet = false;
+
+	if (m_wasLoaded)
+	{
+		return;
+	}
+
+	m_ruleSet = ruleSet;
+	m_wasLoaded = true;
+
+	emit ruleSetLoaded();
+}
+
 void AdblockContentFiltersProfile::setProfileSummary(const ContentFiltersProfile::ProfileSummary &profileSummary)
 {
 	const bool needsReload(profileSummary.cosmeticFiltersMode != m_profileSummary.cosmeticFiltersMode || profileSummary.areWildcardsEnabled != m_profileSummary.areWildcardsEnabled);
@@ -688,6 +358,11 @@ QString AdblockContentFiltersProfile::getPath() const
 	return SessionsManager::getWritableDataPath(QLatin1String("contentBlocking/%1.txt")).arg(m_profileSummary.name);
 }
 
+QString AdblockContentFiltersProfile::getCompiledPath() const
+{
+	return SessionsManager::getWritableDataPath(QLatin1String("contentBlocking/%1.dat")).arg(m_profileSummary.name);
+}
+
 QDateTime AdblockContentFiltersProfile::getLastUpdate() const
 {
 	return m_profileSummary.lastUpdate;
@@ -710,17 +385,27 @@ ContentFiltersManager::CosmeticFiltersResult AdblockContentFiltersProfile::getCo
 		loadRules();
 	}
 
+	if (!m_ruleSet)
+	{
+		return {};
+	}
+
 	ContentFiltersManager::CosmeticFiltersResult result;
 
 	if (!isDomainOnly)
 	{
+		if (m_cosmeticFiltersRules.isEmpty())
+		{
+			m_cosmeticFiltersRules = m_ruleSet->getCosmeticFilters();
+		}
+
 		result.rules = m_cosmeticFiltersRules;
 	}
 
 	for (int i = 0; i < domains.count(); ++i)
 	{
-		result.rules.append(m_cosmeticFiltersDomainRules.values(domains.at(i)));
-		result.exceptions.append(m_cosmeticFiltersDomainExceptions.values(domains.at(i)));
+		result.rules.append(m_ruleSet->getDomainCosmeticFilters(domains.at(i), false));
+		result.exceptions.append(m_ruleSet->getDomainCosmeticFilters(domains.at(i), true));
 	}
 
 	return result;
@@ -728,58 +413,17 @@ ContentFiltersManager::CosmeticFiltersResult AdblockContentFiltersProfile::getCo
 
 ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkUrl(const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType)
 {
-	ContentFiltersManager::CheckResult result;
-
-	if (!m_wasLoaded && !loadRules())
+	if ((!m_wasLoaded && !loadRules()) || !m_ruleSet)
 	{
-		return result;
-	}
-
-	const Request request(baseUrl, requestUrl, resourceType);
-
-	for (int i = 0; i < request.requestUrl.length(); ++i)
-	{
-		const ContentFiltersManager::CheckResult currentResult(checkUrlSubstring(m_root, request.requestUrl.right(request.requestUrl.length() - i), {}, request));
-
-		if (currentResult.isBlocked)
-		{
-			result = currentResult;
-		}
-		else if (currentResult.isException)
-		{
-			return currentResult;
-		}
+		return {};
 	}
 
-	return result;
+	return m_ruleSet->checkUrl(AdblockContentFiltersRuleSet::Request(baseUrl, requestUrl, resourceType));
 }
 
-ContentFiltersManager::CheckResult AdblockContentFiltersProfile::evaluateNodeRules(const Node *node, const QString &currentRule, const Request &request) const
+QSharedPointer<ContentFiltersRuleSet> AdblockContentFiltersProfile::getRuleSet()
 {
-	ContentFiltersManager::CheckResult result;
-
-	for (int i = 0; i < node->rules.count(); ++i)
-	{
-		Node::Rule *rule(node->rules.at(i));
-
-		if (!rule)
-		{
-			continue;
-		}
-
-		ContentFiltersManager::CheckResult currentResult(checkRuleMatch(rule, currentRule, request));
-
-		if (currentResult.isBlocked)
-		{
-			result = currentResult;
-		}
-		else if (currentResult.isException)
-		{
-			return currentResult;
-		}
-	}
-
-	return result;
+	return m_ruleSet;
 }
 
 AdblockContentFiltersProfile::HeaderInformation AdblockContentFiltersProfile::loadHeader(QIODevice *rulesDevice)
@@ -919,6 +563,11 @@ ContentFiltersProfile::ProfileFlags AdblockContentFiltersProfile::getFlags() con
 	return m_flags;
 }
 
+quint32 AdblockContentFiltersProfile::getRulesParameters() const
+{
+	return (static_cast<quint32>(m_profileSummary.cosmeticFiltersMode) | (m_profileSummary.areWildcardsEnabled ? 4 : 0));
+}
+
 int AdblockContentFiltersProfile::getUpdateInterval() const
 {
 	return m_profileSummary.updateInterval;
@@ -1041,29 +690,76 @@ bool AdblockContentFiltersProfile::loadRules()
 
 	m_wasLoaded = true;
 
-	if (m_domainExpression.pattern().isEmpty())
+	if (!QFile::exists(path))
+	{
+		return true;
+	}
+
+	const QString compiledPath(getCompiledPath());
+	const quint32 parameters(getRulesParameters());
+
+	m_ruleSet = AdblockContentFiltersRuleSet::load(compiledPath, path, parameters);
+
+	if (!m_ruleSet)
 	{
-		m_domainExpression = QRegularExpression(QLatin1String("[:\?&/=]"));
-		m_domainExpression.optimize();
+		m_ruleSet = compileRules(m_profileSummary, path, compiledPath, parameters);
 	}
 
+	emit ruleSetLoaded();
+
+	return true;
+}
+
+QSharedPointer<AdblockContentFiltersRuleSet> AdblockContentFiltersProfile::compileRules(const ProfileSummary &profileSummary, const QString &path, const QString &compiledPath, quint32 parameters)
+{
 	QFile file(path);
-	file.open(QIODevice::ReadOnly | QIODevice::Text);
 
-	QTextStream stream(&file);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		Console::addMessage(QCoreApplication::translate("main", "Failed to open content blocking profile file: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, path);
+
+		return {};
+	}
+
+	const QByteArray rulesData(file.readAll());
+
+	file.close();
+
+	AdblockContentFiltersRuleSet::SourceInformation source(AdblockContentFiltersRuleSet::getSourceInformation(path, parameters));
+	source.checksum = QCryptographicHash::hash(rulesData, QCryptographicHash::Md5);
+
+	AdblockContentFiltersRuleSet::Builder builder(source);
+	QTextStream stream(rulesData);
 	stream.setCodec("UTF-8");
 	stream.readLine(); // skip header
 
-	m_root = new Node();
-
 	while (!stream.atEnd())
 	{
-		parseRuleLine(stream.readLine());
+		parseRuleLine(stream.readLine(), profileSummary, &builder);
 	}
 
-	file.close();
+	const QByteArray compiledData(builder.build());
 
-	return true;
+	if (!SessionsManager::isReadOnly())
+	{
+		QSaveFile compiledFile(compiledPath);
+
+		if (compiledFile.open(QIODevice::WriteOnly) && compiledFile.write(compiledData) == compiledData.size() && compiledFile.commit())
+		{
+			const QSharedPointer<AdblockContentFiltersRuleSet> ruleSet(AdblockContentFiltersRuleSet::load(compiledPath, path, parameters));
+
+			if (ruleSet)
+			{
+				return ruleSet;
+			}
+		}
+		else
+		{
+			Console::addMessage(QCoreApplication::translate("main", "Failed to save compiled content blocking profile: %1").arg(compiledFile.errorString()), Console::OtherCategory, Console::WarningLevel, compiledPath);
+		}
+	}
+
+	return AdblockContentFiltersRuleSet::fromData(compiledData);
 }
 
 bool AdblockContentFiltersProfile::update(const QUrl &url)
@@ -1112,25 +808,19 @@ bool AdblockContentFiltersProfile::remove()
 		m_dataFetchJob = nullptr;
 	}
 
-	if (QFile::exists(path))
+	const QString compiledPath(getCompiledPath());
+
+	if (QFile::exists(compiledPath))
 	{
-		return QFile::remove(path);
+		QFile::remove(compiledPath);
 	}
 
-	return true;
-}
-
-bool AdblockContentFiltersProfile::resolveDomainExceptions(const QString &url, const QStringList &ruleList) const
-{
-	for (int i = 0; i < ruleList.count(); ++i)
+	if (QFile::exists(path))
 	{
-		if (url.contains(ruleList.at(i)))
-		{
-			return true;
-		}
+		return QFile::remove(path);
 	}
 
-	return false;
+	return true;
 }
 
 bool AdblockContentFiltersProfile::areWildcardsEnabled() const
@@ -1145,6 +835,11 @@ bool AdblockContentFiltersProfile::isFraud(const QUrl &url)
 	return false;
 }
 
+bool AdblockContentFiltersProfile::isLoadingRuleSet() const
+{
+	return m_isLoadingRuleSet;
+}
+
 bool AdblockContentFiltersProfile::isUpdating() const
 {
 	return (m_dataFetchJob != nullptr);
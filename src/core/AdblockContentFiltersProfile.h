@@ -22,9 +22,7 @@
 #ifndef OTTER_ADBLOCKCONTENTFILTERSPROFILE_H
 #define OTTER_ADBLOCKCONTENTFILTERSPROFILE_H
 
-#include "ContentFiltersManager.h"
-
-#include <QtCore/QRegularExpression>
+#include "AdblockContentFiltersRuleSet.h"
 
 namespace Otter
 {
@@ -60,6 +58,7 @@ public:
 	explicit AdblockContentFiltersProfile(const ProfileSummary &profileSummary, const QStringList &languages, ProfileFlags flags, QObject *parent = nullptr);
 
 	void clear() override;
+	void loadRuleSet() override;
 	void setProfileSummary(const ProfileSummary &profileSummary) override;
 	QString getName() const override;
 	QString getTitle() const override;
@@ -69,6 +68,7 @@ public:
 	ProfileSummary getProfileSummary() const override;
 	ContentFiltersManager::CosmeticFiltersResult getCosmeticFilters(const QStringList &domains, bool isDomainOnly) override;
 	ContentFiltersManager::CheckResult checkUrl(const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType) override;
+	QSharedPointer<ContentFiltersRuleSet> getRuleSet() override;
 	static HeaderInformation loadHeader(QIODevice *rulesDevice);
 	static QHash<RuleType, quint32> loadRulesInformation(const ProfileSummary &profileSummary, QIODevice *rulesDevice);
 	QVector<QLocale::Language> getLanguages() const override;
@@ -84,100 +84,34 @@ public:
 	bool remove() override;
 	bool areWildcardsEnabled() const override;
 	bool isFraud(const QUrl &url) override;
+	bool isLoadingRuleSet() const override;
 	bool isUpdating() const override;
 
 protected:
-	enum RuleOption : quint16
-	{
-		NoOption = 0,
-		ThirdPartyOption = 1,
-		StyleSheetOption = 2,
-		ScriptOption = 4,
-		ImageOption = 8,
-		ObjectOption = 16,
-		ObjectSubRequestOption = 32,
-		SubDocumentOption = 64,
-		XmlHttpRequestOption = 128,
-		WebSocketOption = 256,
-		PopupOption = 512,
-		ElementHideOption = 1024,
-		GenericHideOption = 2048
-	};
-
-	Q_DECLARE_FLAGS(RuleOptions, RuleOption)
-
-	enum RuleMatch
-	{
-		ContainsMatch = 0,
-		StartMatch,
-		EndMatch,
-		ExactMatch
-	};
-
-	struct Node final
-	{
-		struct Rule final
-		{
-			QString rule;
-			QStringList blockedDomains;
-			QStringList allowedDomains;
-			RuleOptions ruleOptions = NoOption;
-			RuleOptions ruleExceptions = NoOption;
-			RuleMatch ruleMatch = ContainsMatch;
-			bool isException = false;
-			bool needsDomainCheck = false;
-		};
-
-		QChar value = 0;
-		QVarLengthArray<Node*, 1> children;
-		QVarLengthArray<Rule*, 1> rules;
-	};
-
-	struct Request final
-	{
-		QString baseHost;
-		QString requestHost;
-		QString requestUrl;
-		NetworkManager::ResourceType resourceType = NetworkManager::OtherType;
-
-		explicit Request(const QUrl &baseUrlValue, const QUrl &requestUrlValue, NetworkManager::ResourceType resourceTypeValue) : baseHost(baseUrlValue.host()), requestHost(requestUrlValue.host()), requestUrl(requestUrlValue.toString()), resourceType(resourceTypeValue)
-		{
-			if (requestUrl.startsWith(QLatin1String("//")))
-			{
-				requestUrl = requestUrl.mid(2);
-			}
-		}
-	};
-
 	void loadHeader();
-	void parseRuleLine(const QString &rule);
-	void parseStyleSheetRule(const QStringList &line, QMultiHash<QString, QString> &list);
-	void deleteNode(Node *node) const;
-	ContentFiltersManager::CheckResult checkUrlSubstring(const Node *node, const QString &subString, QString currentRule, const Request &request) const;
-	ContentFiltersManager::CheckResult checkRuleMatch(const Node::Rule *rule, const QString &currentRule, const Request &request) const;
-	ContentFiltersManager::CheckResult evaluateNodeRules(const Node *node, const QString &currentRule, const Request &request) const;
+	static void parseRuleLine(const QString &rule, const ProfileSummary &profileSummary, AdblockContentFiltersRuleSet::Builder *builder);
+	static void parseStyleSheetRule(const QStringList &line, AdblockContentFiltersRuleSet::Builder *builder, bool isException);
+	QString getCompiledPath() const;
+	static QSharedPointer<AdblockContentFiltersRuleSet> compileRules(const ProfileSummary &profileSummary, const QString &path, const QString &compiledPath, quint32 parameters);
+	quint32 getRulesParameters() const;
 	bool loadRules();
-	bool resolveDomainExceptions(const QString &url, const QStringList &ruleList) const;
 
 protected slots:
 	void raiseError(const QString &message, ProfileError error);
 	void handleJobFinished(bool isSuccess);
+	void handleRuleSetLoaded(const QSharedPointer<AdblockContentFiltersRuleSet> &ruleSet, quint64 generation);
 
 private:
-	Node *m_root;
 	DataFetchJob *m_dataFetchJob;
+	QSharedPointer<AdblockContentFiltersRuleSet> m_ruleSet;
 	ProfileSummary m_profileSummary;
-	QRegularExpression m_domainExpression;
 	QStringList m_cosmeticFiltersRules;
 	QVector<QLocale::Language> m_languages;
-	QMultiHash<QString, QString> m_cosmeticFiltersDomainRules;
-	QMultiHash<QString, QString> m_cosmeticFiltersDomainExceptions;
 	ProfileError m_error;
 	ProfileFlags m_flags;
+	quint64 m_ruleSetGeneration;
+	bool m_isLoadingRuleSet;
 	bool m_wasLoaded;
-
-	static QHash<QString, RuleOption> m_options;
-	static QHash<NetworkManager::ResourceType, RuleOption> m_resourceTypes;
 };
 
 }
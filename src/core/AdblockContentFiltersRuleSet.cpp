@@ -0,0 +1,1232 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2010 - 2014 David Rosca <nowrep@gmail.com>
+* Copyright (C) 2014 - 2017 Jan Bajer aka bajasoft <jbajer@gmail.com>
+* Copyright (C) 2015 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "AdblockContentFiltersRuleSet.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QFileInfo>
+#include <QtCore/QVarLengthArray>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Otter
+{
+
+const quint32 AdblockContentFiltersRuleSet::m_magic(0x4f414252);
+const quint32 AdblockContentFiltersRuleSet::m_version(3);
+const quint32 AdblockContentFiltersRuleSet::m_unanchoredOffset(0xffffffff);
+const int AdblockContentFiltersRuleSet::m_fragmentLength(4);
+QHash<QString, AdblockContentFiltersRuleSet::RuleOption> AdblockContentFiltersRuleSet::m_options({{QLatin1String("third-party"), ThirdPartyOption}, {QLatin1String("stylesheet"), StyleSheetOption}, {QLatin1String("image"), ImageOption}, {QLatin1String("script"), ScriptOption}, {QLatin1String("object"), ObjectOption}, {QLatin1String("object-subrequest"), ObjectSubRequestOption}, {QLatin1String("object_subrequest"), ObjectSubRequestOption}, {QLatin1String("subdocument"), SubDocumentOption}, {QLatin1String("xmlhttprequest"), XmlHttpRequestOption}, {QLatin1String("websocket"), WebSocketOption}, {QLatin1String("popup"), PopupOption}, {QLatin1String("elemhide"), ElementHideOption}, {QLatin1String("generichide"), GenericHideOption}});
+QHash<NetworkManager::ResourceType, AdblockContentFiltersRuleSet::RuleOption> AdblockContentFiltersRuleSet::m_resourceTypes({{NetworkManager::ImageType, ImageOption}, {NetworkManager::ScriptType, ScriptOption}, {NetworkManager::StyleSheetType, StyleSheetOption}, {NetworkManager::ObjectType, ObjectOption}, {NetworkManager::XmlHttpRequestType, XmlHttpRequestOption}, {NetworkManager::SubFrameType, SubDocumentOption},{NetworkManager::PopupType, PopupOption}, {NetworkManager::ObjectSubrequestType, ObjectSubRequestOption}, {NetworkManager::WebSocketType, WebSocketOption}});
+
+AdblockContentFiltersRuleSet::Builder::Builder(const SourceInformation &source) :
+	m_source(source),
+	m_stringsLength(0)
+{
+	addString({});
+
+	m_domainLists.append({0, 0});
+}
+
+void AdblockContentFiltersRuleSet::Builder::addRule(const RuleDefinition &definition)
+{
+	RuleEntry entry;
+	entry.rule = addString(definition.rule);
+	entry.pattern = addString(definition.pattern);
+	entry.blockedDomains = addDomainList(definition.blockedDomains);
+	entry.allowedDomains = addDomainList(definition.allowedDomains);
+	entry.ruleOptions = static_cast<quint16>(definition.ruleOptions);
+	entry.ruleExceptions = static_cast<quint16>(definition.ruleExceptions);
+	entry.ruleMatch = static_cast<quint8>(definition.ruleMatch);
+	entry.flags = NoFlags;
+	entry.reserved = 0;
+
+	if (definition.isException)
+	{
+		entry.flags |= IsExceptionFlag;
+	}
+
+	if (definition.needsDomainCheck)
+	{
+		entry.flags |= NeedsDomainCheckFlag;
+	}
+
+	m_rules.append(entry);
+}
+
+void AdblockContentFiltersRuleSet::Builder::addCosmeticFilter(const QString &rule)
+{
+	m_cosmeticFilters.append(addString(rule));
+}
+
+void AdblockContentFiltersRuleSet::Builder::addCosmeticDomainFilter(const QString &domain, const QString &rule, bool isException)
+{
+	CosmeticFilterEntry entry;
+	entry.domain = addString(domain);
+	entry.rule = addString(rule);
+
+	if (isException)
+	{
+		m_cosmeticDomainExceptions.append(entry);
+	}
+	else
+	{
+		m_cosmeticDomainFilters.append(entry);
+	}
+}
+
+QByteArray AdblockContentFiltersRuleSet::Builder::build()
+{
+	QVector<QVector<QPair<quint32, quint32> > > rulesFragments(m_rules.count());
+	QHash<quint32, int> fragmentsUsage;
+
+	for (int i = 0; i < m_rules.count(); ++i)
+	{
+		const QString pattern(m_strings.at(static_cast<int>(m_rules.at(i).pattern)));
+		QVector<QPair<quint32, quint32> > &ruleFragments(rulesFragments[i]);
+		QVector<quint32> ruleHashes;
+		quint32 offset(0);
+
+		for (int j = 0; (j + m_fragmentLength) <= pattern.length(); ++j)
+		{
+			if (j > 0 && offset != m_unanchoredOffset)
+			{
+				const QChar previousCharacter(pattern.at(j - 1));
+
+				if (previousCharacter == QLatin1Char('*'))
+				{
+					offset = m_unanchoredOffset;
+				}
+				else if (previousCharacter != QLatin1Char('^'))
+				{
+					++offset;
+				}
+			}
+
+			bool isLiteral(true);
+
+			for (int k = 0; k < m_fragmentLength; ++k)
+			{
+				const QChar character(pattern.at(j + k));
+
+				if (character == QLatin1Char('*') || character == QLatin1Char('^'))
+				{
+					isLiteral = false;
+
+					break;
+				}
+			}
+
+			if (!isLiteral)
+			{
+				continue;
+			}
+
+			const quint32 hash(hashFragment(pattern.constData() + j));
+
+			if (!ruleHashes.contains(hash))
+			{
+				ruleHashes.append(hash);
+				ruleFragments.append({hash, offset});
+
+				++fragmentsUsage[hash];
+			}
+		}
+	}
+
+	QHash<quint32, QVector<FragmentRuleEntry> > fragmentsRules;
+	QVector<quint32> fallbackRules;
+
+	for (int i = 0; i < rulesFragments.count(); ++i)
+	{
+		const QVector<QPair<quint32, quint32> > ruleFragments(rulesFragments.at(i));
+
+		if (ruleFragments.isEmpty())
+		{
+			fallbackRules.append(static_cast<quint32>(i));
+
+			continue;
+		}
+
+		QPair<quint32, quint32> bestFragment(ruleFragments.at(0));
+
+		for (int j = 1; j < ruleFragments.count(); ++j)
+		{
+			const QPair<quint32, quint32> fragment(ruleFragments.at(j));
+			const bool isAnchored(fragment.second != m_unanchoredOffset);
+			const bool isBestAnchored(bestFragment.second != m_unanchoredOffset);
+
+			if ((isAnchored && !isBestAnchored) || (isAnchored == isBestAnchored && fragmentsUsage.value(fragment.first) < fragmentsUsage.value(bestFragment.first)))
+			{
+				bestFragment = fragment;
+			}
+		}
+
+		fragmentsRules[bestFragment.first].append({static_cast<quint32>(i), bestFragment.second});
+	}
+
+	int fragmentsTableSize(0);
+
+	if (!fragmentsRules.isEmpty())
+	{
+		fragmentsTableSize = 1;
+
+		while (fragmentsTableSize < (fragmentsRules.count() * 2))
+		{
+			fragmentsTableSize *= 2;
+		}
+	}
+
+	QVector<FragmentEntry> fragments(fragmentsTableSize, {0, 0, 0});
+	QVector<FragmentRuleEntry> fragmentRules;
+	fragmentRules.reserve(m_rules.count() - fallbackRules.count());
+
+	QHash<quint32, QVector<FragmentRuleEntry> >::const_iterator iterator;
+
+	for (iterator = fragmentsRules.constBegin(); iterator != fragmentsRules.constEnd(); ++iterator)
+	{
+		const quint32 mask(static_cast<quint32>(fragmentsTableSize - 1));
+		quint32 slot(iterator.key() & mask);
+
+		while (fragments.at(static_cast<int>(slot)).rulesAmount > 0)
+		{
+			slot = ((slot + 1) & mask);
+		}
+
+		fragments[static_cast<int>(slot)] = {iterator.key(), static_cast<quint32>(fragmentRules.count()), static_cast<quint32>(iterator.value().count())};
+
+		fragmentRules.append(iterator.value());
+	}
+
+	QVector<StringEntry> strings;
+	strings.reserve(m_strings.count());
+
+	QString stringData;
+	stringData.reserve(m_stringsLength);
+
+	for (int i = 0; i < m_strings.count(); ++i)
+	{
+		const QString string(m_strings.at(i));
+
+		strings.append({static_cast<quint32>(stringData.length()), static_cast<quint32>(string.length())});
+
+		stringData.append(string);
+	}
+
+	const auto compareEntries([&](const CosmeticFilterEntry &first, const CosmeticFilterEntry &second)
+	{
+		return (m_strings.at(static_cast<int>(first.domain)) < m_strings.at(static_cast<int>(second.domain)));
+	});
+
+	std::stable_sort(m_cosmeticDomainFilters.begin(), m_cosmeticDomainFilters.end(), compareEntries);
+	std::stable_sort(m_cosmeticDomainExceptions.begin(), m_cosmeticDomainExceptions.end(), compareEntries);
+
+	FileHeader header;
+	header.magic = m_magic;
+	header.version = m_version;
+	header.parameters = m_source.parameters;
+	header.sourceSize = m_source.size;
+	header.sourceModificationTime = m_source.modificationTime;
+
+	std::memset(header.sourceChecksum, 0, sizeof(header.sourceChecksum));
+	std::memcpy(header.sourceChecksum, m_source.checksum.constData(), qMin(static_cast<size_t>(m_source.checksum.size()), sizeof(header.sourceChecksum)));
+
+	QByteArray data(sizeof(FileHeader), 0);
+	const auto appendSection([&](SectionIdentifier section, const void *sectionData, int count)
+	{
+		if (data.size() % 8 != 0)
+		{
+			data.append((8 - (data.size() % 8)), 0);
+		}
+
+		header.sections[section].offset = static_cast<quint32>(data.size());
+		header.sections[section].count = static_cast<quint32>(count);
+
+		data.append(static_cast<const char*>(sectionData), static_cast<int>(count * getElementSize(section)));
+	});
+
+	appendSection(RulesSection, m_rules.constData(), m_rules.count());
+	appendSection(FragmentsSection, fragments.constData(), fragments.count());
+	appendSection(FragmentRulesSection, fragmentRules.constData(), fragmentRules.count());
+	appendSection(FallbackRulesSection, fallbackRules.constData(), fallbackRules.count());
+	appendSection(DomainListsSection, m_domainLists.constData(), m_domainLists.count());
+	appendSection(DomainListItemsSection, m_domainListItems.constData(), m_domainListItems.count());
+	appendSection(StringsSection, strings.constData(), strings.count());
+	appendSection(CosmeticFiltersSection, m_cosmeticFilters.constData(), m_cosmeticFilters.count());
+	appendSection(CosmeticDomainFiltersSection, m_cosmeticDomainFilters.constData(), m_cosmeticDomainFilters.count());
+	appendSection(CosmeticDomainExceptionsSection, m_cosmeticDomainExceptions.constData(), m_cosmeticDomainExceptions.count());
+	appendSection(StringDataSection, stringData.constData(), stringData.length());
+
+	std::memcpy(data.data(), &header, sizeof(FileHeader));
+
+	return data;
+}
+
+quint32 AdblockContentFiltersRuleSet::Builder::addString(const QString &string)
+{
+	if (m_stringIdentifiers.contains(string))
+	{
+		return m_stringIdentifiers.value(string);
+	}
+
+	const quint32 identifier(static_cast<quint32>(m_strings.count()));
+
+	m_strings.append(string);
+	m_stringIdentifiers.insert(string, identifier);
+
+	m_stringsLength += string.length();
+
+	return identifier;
+}
+
+quint32 AdblockContentFiltersRuleSet::Builder::addDomainList(const QStringList &domains)
+{
+	if (domains.isEmpty())
+	{
+		return 0;
+	}
+
+	m_domainLists.append({static_cast<quint32>(m_domainListItems.count()), static_cast<quint32>(domains.count())});
+
+	for (int i = 0; i < domains.count(); ++i)
+	{
+		m_domainListItems.append(addString(domains.at(i)));
+	}
+
+	return static_cast<quint32>(m_domainLists.count() - 1);
+}
+
+AdblockContentFiltersRuleSet::AdblockContentFiltersRuleSet() :
+	m_rawData(nullptr),
+	m_header(nullptr)
+{
+}
+
+ContentFiltersManager::CheckResult AdblockContentFiltersRuleSet::checkRuleMatch(const RuleEntry &rule, QStringView currentRule, const Request &request) const
+{
+	switch (static_cast<RuleMatch>(rule.ruleMatch))
+	{
+		case StartMatch:
+			if (!request.requestUrl.startsWith(currentRule))
+			{
+				return {};
+			}
+
+			break;
+		case EndMatch:
+			if (!request.requestUrl.endsWith(currentRule))
+			{
+				return {};
+			}
+
+			break;
+		case ExactMatch:
+			if (currentRule.size() != request.requestUrl.size())
+			{
+				return {};
+			}
+
+			break;
+		default:
+			break;
+	}
+
+	if (rule.flags & NeedsDomainCheckFlag)
+	{
+		int domainLength(-1);
+
+		for (int i = 0; i < currentRule.length(); ++i)
+		{
+			const QChar character(currentRule.at(i));
+
+			if (character == QLatin1Char(':') || character == QLatin1Char('?') || character == QLatin1Char('&') || character == QLatin1Char('/') || character == QLatin1Char('='))
+			{
+				domainLength = i;
+
+				break;
+			}
+		}
+
+		if (!request.requestSubdomainList.contains(currentRule.left(domainLength).toString()))
+		{
+			return {};
+		}
+	}
+
+	const RuleOptions ruleOptions(QFlag(rule.ruleOptions));
+	const RuleOptions ruleExceptions(QFlag(rule.ruleExceptions));
+	const bool hasBlockedDomains(rule.blockedDomains != 0);
+	const bool hasAllowedDomains(rule.allowedDomains != 0);
+	bool isBlocked(true);
+
+	if (hasBlockedDomains)
+	{
+		isBlocked = resolveDomainExceptions(request.baseHost, rule.blockedDomains);
+
+		if (!isBlocked)
+		{
+			return {};
+		}
+	}
+
+	isBlocked = (hasAllowedDomains ? !resolveDomainExceptions(request.baseHost, rule.allowedDomains) : isBlocked);
+
+	if (ruleOptions.testFlag(ThirdPartyOption) || ruleExceptions.testFlag(ThirdPartyOption))
+	{
+		if (request.baseHost.isEmpty() || request.requestSubdomainList.contains(request.baseHost))
+		{
+			isBlocked = ruleExceptions.testFlag(ThirdPartyOption);
+		}
+		else if (!hasBlockedDomains && !hasAllowedDomains)
+		{
+			isBlocked = ruleOptions.testFlag(ThirdPartyOption);
+		}
+	}
+
+	if (ruleOptions != NoOption || ruleExceptions != NoOption)
+	{
+		QHash<NetworkManager::ResourceType, RuleOption>::const_iterator iterator;
+
+		for (iterator = m_resourceTypes.constBegin(); iterator != m_resourceTypes.constEnd(); ++iterator)
+		{
+			const bool supportsException(iterator.value() != WebSocketOption && iterator.value() != PopupOption);
+
+			if (!ruleOptions.testFlag(iterator.value()) && !(supportsException && ruleExceptions.testFlag(iterator.value())))
+			{
+				continue;
+			}
+
+			if (request.resourceType == iterator.key())
+			{
+				isBlocked = (isBlocked ? ruleOptions.testFlag(iterator.value()) : isBlocked);
+			}
+			else if (supportsException)
+			{
+				isBlocked = (isBlocked ? ruleExceptions.testFlag(iterator.value()) : isBlocked);
+			}
+			else
+			{
+				isBlocked = false;
+			}
+		}
+	}
+	else if (request.resourceType == NetworkManager::PopupType)
+	{
+		isBlocked = false;
+	}
+
+	if (!isBlocked)
+	{
+		return {};
+	}
+
+	ContentFiltersManager::CheckResult result;
+	result.rule = getString(rule.rule).toString();
+
+	if (rule.flags & IsExceptionFlag)
+	{
+		result.isBlocked = false;
+		result.isException = true;
+
+		if (ruleOptions.testFlag(ElementHideOption))
+		{
+			result.comesticFiltersMode = ContentFiltersManager::NoFilters;
+		}
+		else if (ruleOptions.testFlag(GenericHideOption))
+		{
+			result.comesticFiltersMode = ContentFiltersManager::DomainOnlyFilters;
+		}
+
+		return result;
+	}
+
+	result.isBlocked = true;
+
+	return result;
+}
+
+ContentFiltersManager::CheckResult AdblockContentFiltersRuleSet::checkUrl(const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType) const
+{
+	return checkUrl(Request(baseUrl, requestUrl, resourceType));
+}
+
+ContentFiltersManager::CheckResult AdblockContentFiltersRuleSet::checkUrl(const Request &request) const
+{
+	const QString &url(request.requestUrl);
+	const quint32 fragmentsTableSize(m_header->sections[FragmentsSection].count);
+	QVarLengthArray<QPair<quint32, int>, 64> candidates;
+
+	if (fragmentsTableSize > 0)
+	{
+		const FragmentEntry *fragments(reinterpret_cast<const FragmentEntry*>(getSection(FragmentsSection)));
+		const FragmentRuleEntry *fragmentRules(reinterpret_cast<const FragmentRuleEntry*>(getSection(FragmentRulesSection)));
+		const quint32 mask(fragmentsTableSize - 1);
+
+		for (int i = 0; (i + m_fragmentLength) <= url.length(); ++i)
+		{
+			const quint32 hash(hashFragment(url.constData() + i));
+			quint32 slot(hash & mask);
+
+			while (fragments[slot].rulesAmount > 0)
+			{
+				const FragmentEntry &fragment(fragments[slot]);
+
+				if (fragment.hash == hash)
+				{
+					for (quint32 j = 0; j < fragment.rulesAmount; ++j)
+					{
+						const FragmentRuleEntry &fragmentRule(fragmentRules[fragment.firstRule + j]);
+
+						if (fragmentRule.offset == m_unanchoredOffset)
+						{
+							candidates.append({fragmentRule.rule, -1});
+						}
+						else if (fragmentRule.offset <= static_cast<quint32>(i))
+						{
+							candidates.append({fragmentRule.rule, (i - static_cast<int>(fragmentRule.offset))});
+						}
+					}
+
+					break;
+				}
+
+				slot = ((slot + 1) & mask);
+			}
+		}
+	}
+
+	const quint32 *fallbackRules(reinterpret_cast<const quint32*>(getSection(FallbackRulesSection)));
+
+	for (quint32 i = 0; i < m_header->sections[FallbackRulesSection].count; ++i)
+	{
+		candidates.append({fallbackRules[i], -1});
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+
+	candidates.resize(static_cast<int>(std::unique(candidates.begin(), candidates.end()) - candidates.begin()));
+
+	const RuleEntry *rules(reinterpret_cast<const RuleEntry*>(getSection(RulesSection)));
+	ContentFiltersManager::CheckResult result;
+	QBitArray failedStates;
+
+	for (int i = 0; i < candidates.count(); ++i)
+	{
+		const RuleEntry &rule(rules[candidates.at(i).first]);
+		const QStringView pattern(getString(rule.pattern));
+		const int start(candidates.at(i).second);
+		ContentFiltersManager::CheckResult currentResult;
+
+		if (static_cast<RuleMatch>(rule.ruleMatch) == ContainsMatch && !(rule.flags & NeedsDomainCheckFlag))
+		{
+			if (findPattern(pattern, url, start))
+			{
+				currentResult = checkRuleMatch(rule, {}, request);
+			}
+		}
+		else
+		{
+			const bool hasWildcard(pattern.contains(QLatin1Char('*')));
+
+			if (hasWildcard)
+			{
+				failedStates.resize((pattern.size() + 1) * (url.length() + 1));
+			}
+
+			for (int j = qMax(start, 0); j < url.length(); ++j)
+			{
+				if (!canStartMatch(rule, j, request))
+				{
+					if (start >= 0)
+					{
+						break;
+					}
+
+					continue;
+				}
+
+				if (hasWildcard)
+				{
+					failedStates.fill(false);
+				}
+
+				if (matchPattern(rule, pattern, 0, j, j, request, (hasWildcard ? &failedStates : nullptr), &currentResult) || start >= 0)
+				{
+					break;
+				}
+			}
+		}
+
+		if (currentResult.isBlocked)
+		{
+			result = currentResult;
+		}
+		else if (currentResult.isException)
+		{
+			return currentResult;
+		}
+	}
+
+	return result;
+}
+
+QStringList AdblockContentFiltersRuleSet::createSubdomainList(const QString &domain)
+{
+	QStringList subdomainList;
+	int dotPosition(domain.lastIndexOf(QLatin1Char('.')));
+	dotPosition = domain.lastIndexOf(QLatin1Char('.'), (dotPosition - 1));
+
+	while (dotPosition != -1)
+	{
+		subdomainList.append(domain.mid(dotPosition + 1));
+
+		dotPosition = domain.lastIndexOf(QLatin1Char('.'), (dotPosition - 1));
+	}
+
+	subdomainList.append(domain);
+
+	return subdomainList;
+}
+
+AdblockContentFiltersRuleSet::SourceInformation AdblockContentFiltersRuleSet::getSourceInformation(const QString &path, quint32 parameters, bool needsChecksum)
+{
+	const QFileInfo fileInformation(path);
+	SourceInformation information;
+	information.parameters = parameters;
+
+	if (!fileInformation.exists())
+	{
+		return information;
+	}
+
+	information.size = fileInformation.size();
+	information.modificationTime = fileInformation.lastModified().toMSecsSinceEpoch();
+
+	if (needsChecksum)
+	{
+		QFile file(path);
+
+		if (file.open(QIODevice::ReadOnly))
+		{
+			QCryptographicHash hash(QCryptographicHash::Md5);
+			hash.addData(&file);
+
+			information.checksum = hash.result();
+
+			file.close();
+		}
+	}
+
+	return information;
+}
+
+QSharedPointer<AdblockContentFiltersRuleSet> AdblockContentFiltersRuleSet::load(const QString &path, const QString &sourcePath, quint32 parameters)
+{
+	if (!QFile::exists(path))
+	{
+		return {};
+	}
+
+	QSharedPointer<AdblockContentFiltersRuleSet> ruleSet(new AdblockContentFiltersRuleSet());
+	ruleSet->m_file.setFileName(path);
+
+	if (!ruleSet->m_file.open(QIODevice::ReadOnly))
+	{
+		return {};
+	}
+
+	const qint64 size(ruleSet->m_file.size());
+	const uchar *data(ruleSet->m_file.map(0, size));
+
+	if (!data || !ruleSet->setData(reinterpret_cast<const char*>(data), size))
+	{
+		return {};
+	}
+
+	const FileHeader *header(ruleSet->m_header);
+	const SourceInformation source(getSourceInformation(sourcePath, parameters));
+
+	if (header->parameters != source.parameters || header->sourceSize != source.size)
+	{
+		return {};
+	}
+
+	if (header->sourceModificationTime != source.modificationTime && getSourceInformation(sourcePath, parameters, true).checksum != QByteArray(header->sourceChecksum, sizeof(header->sourceChecksum)))
+	{
+		return {};
+	}
+
+	return ruleSet;
+}
+
+QSharedPointer<AdblockContentFiltersRuleSet> AdblockContentFiltersRuleSet::fromData(const QByteArray &data)
+{
+	QSharedPointer<AdblockContentFiltersRuleSet> ruleSet(new AdblockContentFiltersRuleSet());
+	ruleSet->m_data = data;
+
+	if (!ruleSet->setData(ruleSet->m_data.constData(), ruleSet->m_data.size()))
+	{
+		return {};
+	}
+
+	return ruleSet;
+}
+
+bool AdblockContentFiltersRuleSet::parseRule(const QString &rule, bool areWildcardsEnabled, RuleDefinition *definition)
+{
+	if (rule.isEmpty() || rule.startsWith(QLatin1Char('!')) || rule.contains(QLatin1String("##")) || rule.contains(QLatin1String("#@#")))
+	{
+		return false;
+	}
+
+	const int optionsSeparator(rule.indexOf(QLatin1Char('$')));
+	const QStringList ruleOptions((optionsSeparator >= 0) ? rule.mid(optionsSeparator + 1).split(QLatin1Char(','), Qt::SkipEmptyParts) : QStringList());
+	QString line(rule);
+
+	if (optionsSeparator >= 0)
+	{
+		line = line.left(optionsSeparator);
+	}
+
+	if (line.endsWith(QLatin1Char('*')))
+	{
+		line = line.left(line.length() - 1);
+	}
+
+	if (line.startsWith(QLatin1Char('*')))
+	{
+		line = line.mid(1);
+	}
+
+	if (!areWildcardsEnabled && line.contains(QLatin1Char('*')))
+	{
+		return false;
+	}
+
+	definition->rule = rule;
+	definition->isException = line.startsWith(QLatin1String("@@"));
+
+	if (definition->isException)
+	{
+		line = line.mid(2);
+	}
+
+	definition->needsDomainCheck = line.startsWith(QLatin1String("||"));
+
+	if (definition->needsDomainCheck)
+	{
+		line = line.mid(2);
+	}
+
+	if (line.startsWith(QLatin1Char('|')))
+	{
+		definition->ruleMatch = StartMatch;
+
+		line = line.mid(1);
+	}
+
+	if (line.endsWith(QLatin1Char('|')))
+	{
+		definition->ruleMatch = ((definition->ruleMatch == StartMatch) ? ExactMatch : EndMatch);
+
+		line = line.left(line.length() - 1);
+	}
+
+	for (int i = 0; i < ruleOptions.count(); ++i)
+	{
+		const QString option(ruleOptions.at(i));
+		const bool isOptionException(option.startsWith(QLatin1Char('~')));
+		const QString optionName(isOptionException ? option.mid(1) : option);
+
+		if (m_options.contains(optionName))
+		{
+			const RuleOption ruleOption(m_options.value(optionName));
+
+			if ((!definition->isException || isOptionException) && (ruleOption == ElementHideOption || ruleOption == GenericHideOption))
+			{
+				continue;
+			}
+
+			if (!isOptionException)
+			{
+				definition->ruleOptions |= ruleOption;
+			}
+			else if (ruleOption != WebSocketOption && ruleOption != PopupOption)
+			{
+				definition->ruleExceptions |= ruleOption;
+			}
+		}
+		else if (optionName.startsWith(QLatin1String("domain")))
+		{
+			const QStringList parsedDomains(option.mid(option.indexOf(QLatin1Char('=')) + 1).split(QLatin1Char('|'), Qt::SkipEmptyParts));
+
+			for (int j = 0; j < parsedDomains.count(); ++j)
+			{
+				const QString parsedDomain(parsedDomains.at(j));
+
+				if (parsedDomain.startsWith(QLatin1Char('~')))
+				{
+					definition->allowedDomains.append(parsedDomain.mid(1));
+				}
+				else
+				{
+					definition->blockedDomains.append(parsedDomain);
+				}
+			}
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	definition->pattern = line;
+
+	return true;
+}
+
+QStringView AdblockContentFiltersRuleSet::getString(quint32 identifier) const
+{
+	const StringEntry &entry(reinterpret_cast<const StringEntry*>(getSection(StringsSection))[identifier]);
+
+	return QStringView(reinterpret_cast<const QChar*>(getSection(StringDataSection)) + entry.offset, static_cast<qsizetype>(entry.length));
+}
+
+QStringList AdblockContentFiltersRuleSet::getCosmeticFilters() const
+{
+	const quint32 *filters(reinterpret_cast<const quint32*>(getSection(CosmeticFiltersSection)));
+	const quint32 amount(m_header->sections[CosmeticFiltersSection].count);
+	QStringList rules;
+	rules.reserve(static_cast<int>(amount));
+
+	for (quint32 i = 0; i < amount; ++i)
+	{
+		rules.append(getString(filters[i]).toString());
+	}
+
+	return rules;
+}
+
+QStringList AdblockContentFiltersRuleSet::getDomainCosmeticFilters(const QString &domain, bool isException) const
+{
+	const SectionIdentifier section(isException ? CosmeticDomainExceptionsSection : CosmeticDomainFiltersSection);
+	const CosmeticFilterEntry *begin(reinterpret_cast<const CosmeticFilterEntry*>(getSection(section)));
+	const CosmeticFilterEntry *end(begin + m_header->sections[section].count);
+	const CosmeticFilterEntry *iterator(std::lower_bound(begin, end, domain, [&](const CosmeticFilterEntry &entry, const QString &value)
+	{
+		return (getString(entry.domain).compare(value) < 0);
+	}));
+	QStringList rules;
+
+	while (iterator != end && getString(iterator->domain).compare(domain) == 0)
+	{
+		rules.append(getString(iterator->rule).toString());
+
+		++iterator;
+	}
+
+	return rules;
+}
+
+const char* AdblockContentFiltersRuleSet::getSection(SectionIdentifier section) const
+{
+	return (m_rawData + m_header->sections[section].offset);
+}
+
+quint32 AdblockContentFiltersRuleSet::hashFragment(const QChar *data)
+{
+	quint32 hash(2166136261u);
+
+	for (int i = 0; i < m_fragmentLength; ++i)
+	{
+		hash ^= data[i].unicode();
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+quint32 AdblockContentFiltersRuleSet::getElementSize(SectionIdentifier section)
+{
+	switch (section)
+	{
+		case RulesSection:
+			return sizeof(RuleEntry);
+		case FragmentsSection:
+			return sizeof(FragmentEntry);
+		case FragmentRulesSection:
+			return sizeof(FragmentRuleEntry);
+		case DomainListsSection:
+			return sizeof(ListEntry);
+		case StringsSection:
+			return sizeof(StringEntry);
+		case StringDataSection:
+			return sizeof(QChar);
+		case CosmeticDomainFiltersSection:
+		case CosmeticDomainExceptionsSection:
+			return sizeof(CosmeticFilterEntry);
+		default:
+			break;
+	}
+
+	return sizeof(quint32);
+}
+
+bool AdblockContentFiltersRuleSet::setData(const char *data, qint64 size)
+{
+	if (size < static_cast<qint64>(sizeof(FileHeader)))
+	{
+		return false;
+	}
+
+	const FileHeader *header(reinterpret_cast<const FileHeader*>(data));
+
+	if (header->magic != m_magic || header->version != m_version)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < SectionsCount; ++i)
+	{
+		const Section &section(header->sections[i]);
+
+		if (section.offset % 8 != 0 || (static_cast<qint64>(section.offset) + (static_cast<qint64>(section.count) * getElementSize(static_cast<SectionIdentifier>(i)))) > size)
+		{
+			return false;
+		}
+	}
+
+	m_rawData = data;
+	m_header = header;
+
+	if (!validateData())
+	{
+		m_rawData = nullptr;
+		m_header = nullptr;
+
+		return false;
+	}
+
+	return true;
+}
+
+bool AdblockContentFiltersRuleSet::validateData() const
+{
+	const quint32 rulesAmount(m_header->sections[RulesSection].count);
+	const quint32 stringsAmount(m_header->sections[StringsSection].count);
+	const quint32 domainListsAmount(m_header->sections[DomainListsSection].count);
+	const quint32 domainListItemsAmount(m_header->sections[DomainListItemsSection].count);
+	const quint32 fragmentRulesAmount(m_header->sections[FragmentRulesSection].count);
+	const quint32 fragmentsTableSize(m_header->sections[FragmentsSection].count);
+	const StringEntry *strings(reinterpret_cast<const StringEntry*>(getSection(StringsSection)));
+
+	for (quint32 i = 0; i < stringsAmount; ++i)
+	{
+		if ((static_cast<quint64>(strings[i].offset) + strings[i].length) > m_header->sections[StringDataSection].count)
+		{
+			return false;
+		}
+	}
+
+	const RuleEntry *rules(reinterpret_cast<const RuleEntry*>(getSection(RulesSection)));
+
+	for (quint32 i = 0; i < rulesAmount; ++i)
+	{
+		const RuleEntry &rule(rules[i]);
+
+		if (rule.rule >= stringsAmount || rule.pattern >= stringsAmount || rule.blockedDomains >= qMax(domainListsAmount, 1u) || rule.allowedDomains >= qMax(domainListsAmount, 1u) || rule.ruleMatch > ExactMatch)
+		{
+			return false;
+		}
+	}
+
+	const ListEntry *domainLists(reinterpret_cast<const ListEntry*>(getSection(DomainListsSection)));
+
+	for (quint32 i = 0; i < domainListsAmount; ++i)
+	{
+		if ((static_cast<quint64>(domainLists[i].first) + domainLists[i].amount) > domainListItemsAmount)
+		{
+			return false;
+		}
+	}
+
+	const auto validateIdentifiers([&](SectionIdentifier section, quint32 limit)
+	{
+		const quint32 *identifiers(reinterpret_cast<const quint32*>(getSection(section)));
+
+		for (quint32 i = 0; i < m_header->sections[section].count; ++i)
+		{
+			if (identifiers[i] >= limit)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	});
+
+	if (!validateIdentifiers(DomainListItemsSection, stringsAmount) || !validateIdentifiers(FallbackRulesSection, rulesAmount) || !validateIdentifiers(CosmeticFiltersSection, stringsAmount))
+	{
+		return false;
+	}
+
+	const FragmentRuleEntry *fragmentRules(reinterpret_cast<const FragmentRuleEntry*>(getSection(FragmentRulesSection)));
+
+	for (quint32 i = 0; i < fragmentRulesAmount; ++i)
+	{
+		if (fragmentRules[i].rule >= rulesAmount)
+		{
+			return false;
+		}
+	}
+
+	if ((fragmentsTableSize & (fragmentsTableSize - 1)) != 0)
+	{
+		return false;
+	}
+
+	const FragmentEntry *fragments(reinterpret_cast<const FragmentEntry*>(getSection(FragmentsSection)));
+	bool hasEmptySlot(fragmentsTableSize == 0);
+
+	for (quint32 i = 0; i < fragmentsTableSize; ++i)
+	{
+		if (fragments[i].rulesAmount == 0)
+		{
+			hasEmptySlot = true;
+		}
+		else if ((static_cast<quint64>(fragments[i].firstRule) + fragments[i].rulesAmount) > fragmentRulesAmount)
+		{
+			return false;
+		}
+	}
+
+	if (!hasEmptySlot)
+	{
+		return false;
+	}
+
+	const auto validateCosmeticFilters([&](SectionIdentifier section)
+	{
+		const CosmeticFilterEntry *entries(reinterpret_cast<const CosmeticFilterEntry*>(getSection(section)));
+
+		for (quint32 i = 0; i < m_header->sections[section].count; ++i)
+		{
+			if (entries[i].domain >= stringsAmount || entries[i].rule >= stringsAmount)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	});
+
+	return (validateCosmeticFilters(CosmeticDomainFiltersSection) && validateCosmeticFilters(CosmeticDomainExceptionsSection));
+}
+
+bool AdblockContentFiltersRuleSet::matchPattern(const RuleEntry &rule, QStringView pattern, int patternPosition, int start, int position, const Request &request, QBitArray *failedStates, ContentFiltersManager::CheckResult *result) const
+{
+	const QString &url(request.requestUrl);
+
+	if (patternPosition == pattern.size())
+	{
+		*result = checkRuleMatch(rule, QStringView(url).mid(start, (position - start)), request);
+
+		return (result->isBlocked || result->isException);
+	}
+
+	if (position >= url.length())
+	{
+		return false;
+	}
+
+	const int state(failedStates ? ((patternPosition * (url.length() + 1)) + position) : -1);
+
+	if (state >= 0 && failedStates->testBit(state))
+	{
+		return false;
+	}
+
+	const QChar patternCharacter(pattern.at(patternPosition));
+	const QChar urlCharacter(url.at(position));
+	bool isMatch(false);
+
+	if (patternCharacter == QLatin1Char('*'))
+	{
+		for (int i = position; i < url.length(); ++i)
+		{
+			if (matchPattern(rule, pattern, (patternPosition + 1), start, i, request, failedStates, result))
+			{
+				isMatch = true;
+
+				break;
+			}
+		}
+	}
+	else if (patternCharacter == QLatin1Char('^') && isSeparator(urlCharacter))
+	{
+		isMatch = matchPattern(rule, pattern, (patternPosition + 1), start, position, request, failedStates, result);
+	}
+
+	if (!isMatch)
+	{
+		isMatch = (urlCharacter == patternCharacter && matchPattern(rule, pattern, (patternPosition + 1), start, (position + 1), request, failedStates, result));
+	}
+
+	if (!isMatch && state >= 0)
+	{
+		failedStates->setBit(state);
+	}
+
+	return isMatch;
+}
+
+bool AdblockContentFiltersRuleSet::canStartMatch(const RuleEntry &rule, int start, const Request &request)
+{
+	if (static_cast<RuleMatch>(rule.ruleMatch) == ExactMatch && start > 0)
+	{
+		return false;
+	}
+
+	if (rule.flags & NeedsDomainCheckFlag)
+	{
+		const QStringView remainingUrl(QStringView(request.requestUrl).mid(start));
+
+		for (int i = 0; i < request.requestSubdomainList.count(); ++i)
+		{
+			if (remainingUrl.startsWith(request.requestSubdomainList.at(i)))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	return true;
+}
+
+bool AdblockContentFiltersRuleSet::findPattern(QStringView pattern, const QString &url, int start)
+{
+	int position(qMax(start, 0));
+	int segmentStart(0);
+	bool isAnchored(start >= 0);
+
+	while (position < url.length())
+	{
+		const int wildcardPosition(pattern.indexOf(QLatin1Char('*'), segmentStart));
+		const QStringView segment((wildcardPosition < 0) ? pattern.mid(segmentStart) : pattern.mid(segmentStart, (wildcardPosition - segmentStart)));
+		int segmentEnd(-1);
+
+		for (int i = position; i < url.length(); ++i)
+		{
+			if (segmentEnd >= 0 && i >= segmentEnd)
+			{
+				break;
+			}
+
+			const int end(matchSegment(segment, url, i));
+
+			if (end >= 0 && (segmentEnd < 0 || end < segmentEnd))
+			{
+				segmentEnd = end;
+			}
+
+			if (isAnchored)
+			{
+				break;
+			}
+		}
+
+		if (segmentEnd < 0)
+		{
+			return false;
+		}
+
+		if (wildcardPosition < 0)
+		{
+			return true;
+		}
+
+		position = segmentEnd;
+		segmentStart = (wildcardPosition + 1);
+		isAnchored = false;
+	}
+
+	return false;
+}
+
+bool AdblockContentFiltersRuleSet::resolveDomainExceptions(const QString &url, quint32 list) const
+{
+	const ListEntry &entry(reinterpret_cast<const ListEntry*>(getSection(DomainListsSection))[list]);
+	const quint32 *items(reinterpret_cast<const quint32*>(getSection(DomainListItemsSection)));
+
+	for (quint32 i = 0; i < entry.amount; ++i)
+	{
+		if (url.contains(getString(items[entry.first + i])))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int AdblockContentFiltersRuleSet::matchSegment(QStringView segment, const QString &url, int position)
+{
+	if (segment.isEmpty())
+	{
+		return position;
+	}
+
+	if (position >= url.length())
+	{
+		return -1;
+	}
+
+	const QChar patternCharacter(segment.at(0));
+	const QChar urlCharacter(url.at(position));
+	int end(-1);
+
+	if (patternCharacter == QLatin1Char('^') && isSeparator(urlCharacter))
+	{
+		end = matchSegment(segment.mid(1), url, position);
+	}
+
+	if (urlCharacter == patternCharacter)
+	{
+		const int literalEnd(matchSegment(segment.mid(1), url, (position + 1)));
+
+		if (literalEnd >= 0 && (end < 0 || literalEnd < end))
+		{
+			end = literalEnd;
+		}
+	}
+
+	return end;
+}
+
+bool AdblockContentFiltersRuleSet::isSeparator(const QChar &character)
+{
+	return (!character.isDigit() && !character.isLetter() && character != QLatin1Char('_') && character != QLatin1Char('-') && character != QLatin1Char('.') && character != QLatin1Char('%'));
+}
+
+}
@@ -0,0 +1,261 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2010 - 2014 David Rosca <nowrep@gmail.com>
+* Copyright (C) 2014 - 2017 Jan Bajer aka bajasoft <jbajer@gmail.com>
+* Copyright (C) 2015 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_ADBLOCKCONTENTFILTERSRULESET_H
+#define OTTER_ADBLOCKCONTENTFILTERSRULESET_H
+
+#include "ContentFiltersManager.h"
+
+#include <QtCore/QBitArray>
+#include <QtCore/QFile>
+#include <QtCore/QSharedPointer>
+
+namespace Otter
+{
+
+class AdblockContentFiltersRuleSet final : public ContentFiltersRuleSet
+{
+public:
+	enum RuleOption : quint16
+	{
+		NoOption = 0,
+		ThirdPartyOption = 1,
+		StyleSheetOption = 2,
+		ScriptOption = 4,
+		ImageOption = 8,
+		ObjectOption = 16,
+		ObjectSubRequestOption = 32,
+		SubDocumentOption = 64,
+		XmlHttpRequestOption = 128,
+		WebSocketOption = 256,
+		PopupOption = 512,
+		ElementHideOption = 1024,
+		GenericHideOption = 2048
+	};
+
+	Q_DECLARE_FLAGS(RuleOptions, RuleOption)
+
+	enum RuleMatch
+	{
+		ContainsMatch = 0,
+		StartMatch,
+		EndMatch,
+		ExactMatch
+	};
+
+	struct RuleDefinition final
+	{
+		QString rule;
+		QString pattern;
+		QStringList blockedDomains;
+		QStringList allowedDomains;
+		RuleOptions ruleOptions = NoOption;
+		RuleOptions ruleExceptions = NoOption;
+		RuleMatch ruleMatch = ContainsMatch;
+		bool isException = false;
+		bool needsDomainCheck = false;
+	};
+
+	struct SourceInformation final
+	{
+		QByteArray checksum;
+		qint64 size = -1;
+		qint64 modificationTime = -1;
+		quint32 parameters = 0;
+	};
+
+	struct Request final
+	{
+		QString baseHost;
+		QString requestHost;
+		QString requestUrl;
+		QStringList requestSubdomainList;
+		NetworkManager::ResourceType resourceType = NetworkManager::OtherType;
+
+		explicit Request(const QUrl &baseUrlValue, const QUrl &requestUrlValue, NetworkManager::ResourceType resourceTypeValue) : baseHost(baseUrlValue.host()), requestHost(requestUrlValue.host()), requestUrl(requestUrlValue.toString()), requestSubdomainList(createSubdomainList(requestHost)), resourceType(resourceTypeValue)
+		{
+			if (requestUrl.startsWith(QLatin1String("//")))
+			{
+				requestUrl = requestUrl.mid(2);
+			}
+		}
+	};
+
+	class Builder;
+
+	ContentFiltersManager::CheckResult checkUrl(const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType) const override;
+	ContentFiltersManager::CheckResult checkUrl(const Request &request) const;
+	QStringList getCosmeticFilters() const;
+	QStringList getDomainCosmeticFilters(const QString &domain, bool isException) const;
+	static SourceInformation getSourceInformation(const QString &path, quint32 parameters, bool needsChecksum = false);
+	static QSharedPointer<AdblockContentFiltersRuleSet> load(const QString &path, const QString &sourcePath, quint32 parameters);
+	static QSharedPointer<AdblockContentFiltersRuleSet> fromData(const QByteArray &data);
+	static QStringList createSubdomainList(const QString &domain);
+	static bool parseRule(const QString &rule, bool areWildcardsEnabled, RuleDefinition *definition);
+
+protected:
+	enum SectionIdentifier
+	{
+		RulesSection = 0,
+		FragmentsSection,
+		FragmentRulesSection,
+		FallbackRulesSection,
+		DomainListsSection,
+		DomainListItemsSection,
+		StringsSection,
+		StringDataSection,
+		CosmeticFiltersSection,
+		CosmeticDomainFiltersSection,
+		CosmeticDomainExceptionsSection,
+		SectionsCount
+	};
+
+	enum RuleFlag : quint8
+	{
+		NoFlags = 0,
+		IsExceptionFlag = 1,
+		NeedsDomainCheckFlag = 2
+	};
+
+	struct Section final
+	{
+		quint32 offset = 0;
+		quint32 count = 0;
+	};
+
+	struct FileHeader final
+	{
+		quint32 magic = 0;
+		quint32 version = 0;
+		quint32 parameters = 0;
+		quint32 reserved = 0;
+		qint64 sourceSize = -1;
+		qint64 sourceModificationTime = -1;
+		char sourceChecksum[16];
+		Section sections[SectionsCount];
+	};
+
+	struct RuleEntry final
+	{
+		quint32 rule;
+		quint32 pattern;
+		quint32 blockedDomains;
+		quint32 allowedDomains;
+		quint16 ruleOptions;
+		quint16 ruleExceptions;
+		quint8 ruleMatch;
+		quint8 flags;
+		quint16 reserved;
+	};
+
+	struct FragmentEntry final
+	{
+		quint32 hash;
+		quint32 firstRule;
+		quint32 rulesAmount;
+	};
+
+	struct FragmentRuleEntry final
+	{
+		quint32 rule;
+		quint32 offset;
+	};
+
+	struct ListEntry final
+	{
+		quint32 first;
+		quint32 amount;
+	};
+
+	struct StringEntry final
+	{
+		quint32 offset;
+		quint32 length;
+	};
+
+	struct CosmeticFilterEntry final
+	{
+		quint32 domain;
+		quint32 rule;
+	};
+
+	AdblockContentFiltersRuleSet();
+
+	ContentFiltersManager::CheckResult checkRuleMatch(const RuleEntry &rule, QStringView currentRule, const Request &request) const;
+	QStringView getString(quint32 identifier) const;
+	const char* getSection(SectionIdentifier section) const;
+	bool setData(const char *data, qint64 size);
+	bool validateData() const;
+	bool matchPattern(const RuleEntry &rule, QStringView pattern, int patternPosition, int start, int position, const Request &request, QBitArray *failedStates, ContentFiltersManager::CheckResult *result) const;
+	bool resolveDomainExceptions(const QString &url, quint32 list) const;
+	static quint32 getElementSize(SectionIdentifier section);
+	static quint32 hashFragment(const QChar *data);
+	static int matchSegment(QStringView segment, const QString &url, int position);
+	static bool canStartMatch(const RuleEntry &rule, int start, const Request &request);
+	static bool findPattern(QStringView pattern, const QString &url, int start);
+	static bool isSeparator(const QChar &character);
+
+private:
+	QFile m_file;
+	QByteArray m_data;
+	const char *m_rawData;
+	const FileHeader *m_header;
+
+	static const quint32 m_magic;
+	static const quint32 m_version;
+	static const quint32 m_unanchoredOffset;
+	static const int m_fragmentLength;
+	static QHash<QString, RuleOption> m_options;
+	static QHash<NetworkManager::ResourceType, RuleOption> m_resourceTypes;
+};
+
+class AdblockContentFiltersRuleSet::Builder final
+{
+public:
+	explicit Builder(const SourceInformation &source);
+
+	void addRule(const RuleDefinition &definition);
+	void addCosmeticFilter(const QString &rule);
+	void addCosmeticDomainFilter(const QString &domain, const QString &rule, bool isException);
+	QByteArray build();
+
+protected:
+	quint32 addString(const QString &string);
+	quint32 addDomainList(const QStringList &domains);
+
+private:
+	SourceInformation m_source;
+	QVector<RuleEntry> m_rules;
+	QVector<quint32> m_cosmeticFilters;
+	QVector<CosmeticFilterEntry> m_cosmeticDomainFilters;
+	QVector<CosmeticFilterEntry> m_cosmeticDomainExceptions;
+	QVector<ListEntry> m_domainLists;
+	QVector<quint32> m_domainListItems;
+	QStringList m_strings;
+	QHash<QString, quint32> m_stringIdentifiers;
+	int m_stringsLength;
+};
+
+}
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(Otter::AdblockContentFiltersRuleSet::RuleOptions)
+
+#endif
@@ -22,12 +22,14 @@
 #include "AddonsManager.h"
 #include "BookmarksManager.h"
 #include "Console.h"
+#include "ContentFiltersManager.h"
 #include "FeedsManager.h"
 #include "GesturesManager.h"
 #include "HandlersManager.h"
 #include "HistoryManager.h"
 #include "LongTermTimer.h"
 #include "Migrator.h"
+#include "NetworkCache.h"
 #include "NetworkManagerFactory.h"
 #include "NotesManager.h"
 #include "NotificationsManager.h"
@@ -39,6 +41,7 @@
 #include "TasksManager.h"
 #include "ToolBarsManager.h"
 #include "ThemesManager.h"
+#include "ThumbnailsManager.h"
 #include "TransfersManager.h"
 #include "Utils.h"
 #include "Updater.h"
@@ -261,6 +264,16 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 			{
 				reportOptions |= SettingsReport;
 			}
+
+			if (rawReportOptions.contains(QLatin1String("contentBlocking")))
+			{
+				reportOptions |= ContentBlockingReport;
+			}
+
+			if (rawReportOptions.contains(QLatin1String("cache")))
+			{
+				reportOptions |= CacheReport;
+			}
 		}
 
 		if (rawReportOptions.contains(QLatin1String("dialog")))
@@ -413,6 +426,8 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 
 	ThemesManager::createInstance();
 
+	ThumbnailsManager::createInstance();
+
 	ActionsManager::createInstance();
 
 	AddonsManager::createInstance();
@@ -1420,7 +1435,7 @@ QString Application::createReport(ReportOptions options)
 		pathsReport.entries.append({QLatin1String("Session"), SessionsManager::getSessionPath(SessionsManager::getCurrentSession())});
 		pathsReport.entries.append({QLatin1String("Bookmarks"), SessionsManager::getWritableDataPath(QLatin1String("bookmarks.xbel"))});
 		pathsReport.entries.append({QLatin1String("Notes"), SessionsManager::getWritableDataPath(QLatin1String("notes.xbel"))});
-		pathsReport.entries.append({QLatin1String("History"), SessionsManager::getWritableDataPath(QLatin1String("browsingHistory.json"))});
+		pathsReport.entries.append({QLatin1String("History"), SessionsManager::getWritableDataPath(QLatin1String("browsingHistory.dat"))});
 		pathsReport.entries.append({QLatin1String("Cache"), SessionsManager::getCachePath()});
 
 		report.sections.append(pathsReport);
@@ -1436,6 +1451,16 @@ QString Application::createReport(ReportOptions options)
 		report.sections.append(ActionsManager::createReport());
 	}
 
+	if (options.testFlag(ContentBlockingReport))
+	{
+		report.sections.append(ContentFiltersManager::createReport());
+	}
+
+	if (options.testFlag(CacheReport))
+	{
+		report.sections.append(NetworkManagerFactory::hasCache() ? NetworkManagerFactory::getCache()->createReport() : NetworkCache::createReport(SessionsManager::getCachePath()));
+	}
+
 	QString reportString;
 	QTextStream stream(&reportString);
 	stream.setFieldAlignment(QTextStream::AlignLeft);
@@ -51,8 +51,10 @@ public:
 		KeyboardShortcutsReport = 2,
 		PathsReport = 4,
 		SettingsReport = 8,
-		StandardReport = (EnvironmentReport | PathsReport | SettingsReport),
-		FullReport = (EnvironmentReport | KeyboardShortcutsReport | PathsReport | SettingsReport)
+		ContentBlockingReport = 16,
+		CacheReport = 32,
+		StandardReport = (EnvironmentReport | PathsReport | SettingsReport | ContentBlockingReport | CacheReport),
+		FullReport = (EnvironmentReport | KeyboardShortcutsReport | PathsReport | SettingsReport | ContentBlockingReport | CacheReport)
 	};
 
 	Q_DECLARE_FLAGS(ReportOptions, ReportOption)
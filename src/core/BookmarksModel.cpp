@@ -30,11 +30,14 @@
 #include <QtCore/QFile>
 #include <QtCore/QMimeData>
 #include <QtCore/QSaveFile>
+#include <QtCore/QSet>
 #include <QtWidgets/QMessageBox>
 
 namespace Otter
 {
 
+const int BookmarksModel::m_completionMatchesLimit(250);
+
 BookmarksModel::Bookmark::Bookmark() = default;
 
 void BookmarksModel::Bookmark::remove()
@@ -565,6 +568,7 @@ void BookmarksModel::removeBookmark(Bookmark *bookmark)
 	if (!bookmark->data(KeywordRole).toString().isEmpty() && m_keywords.contains(bookmark->data(KeywordRole).toString()))
 	{
 		m_keywords.remove(bookmark->data(KeywordRole).toString());
+		m_completionIndex.removeKeyword(bookmark->data(KeywordRole).toString());
 	}
 
 	emit bookmarkRemoved(bookmark, bookmark->getParent());
@@ -896,6 +900,7 @@ void BookmarksModel::removeBookmarkUrl(Bookmark *bookmark)
 					if (m_urls[url].isEmpty())
 					{
 						m_urls.remove(url);
+						m_completionIndex.removeUrl(url);
 					}
 				}
 			}
@@ -932,6 +937,8 @@ void BookmarksModel::readdBookmarkUrl(Bookmark *bookmark)
 					if (!m_urls.contains(url))
 					{
 						m_urls[url] = {};
+
+						m_completionIndex.addUrl(url);
 					}
 
 					m_urls[url].append(bookmark);
@@ -1041,10 +1048,16 @@ void BookmarksModel::handleKeywordChanged(Bookmark *bookmark, const QString &new
 	if (!oldKeyword.isEmpty() && m_keywords.contains(oldKeyword))
 	{
 		m_keywords.remove(oldKeyword);
+		m_completionIndex.removeKeyword(oldKeyword);
 	}
 
 	if (!newKeyword.isEmpty())
 	{
+		if (!m_keywords.contains(newKeyword))
+		{
+			m_completionIndex.addKeyword(newKeyword);
+		}
+
 		m_keywords[newKeyword] = bookmark;
 	}
 }
@@ -1058,6 +1071,7 @@ void BookmarksModel::handleUrlChanged(Bookmark *bookmark, const QUrl &newUrl, co
 		if (m_urls[oldUrl].isEmpty())
 		{
 			m_urls.remove(oldUrl);
+			m_completionIndex.removeUrl(oldUrl);
 		}
 	}
 
@@ -1066,6 +1080,8 @@ void BookmarksModel::handleUrlChanged(Bookmark *bookmark, const QUrl &newUrl, co
 		if (!m_urls.contains(newUrl))
 		{
 			m_urls[newUrl] = {};
+
+			m_completionIndex.addUrl(newUrl);
 		}
 
 		m_urls[newUrl].append(bookmark);
@@ -1301,26 +1317,28 @@ QStringList BookmarksModel::getKeywords() const
 
 QVector<BookmarksModel::BookmarkMatch> BookmarksModel::findBookmarks(const QString &prefix) const
 {
-	QVector<Bookmark*> matchedBookmarks;
+	const QStringList keywords(m_completionIndex.findKeywords(prefix, m_completionMatchesLimit));
+	QSet<Bookmark*> matchedBookmarks;
 	QVector<BookmarkMatch> allMatches;
 	QVector<BookmarkMatch> currentMatches;
 	QMultiMap<QDateTime, BookmarkMatch> matchesMap;
-	QHash<QString, Bookmark*>::const_iterator keywordsIterator;
 
-	for (keywordsIterator = m_keywords.constBegin(); keywordsIterator != m_keywords.constEnd(); ++keywordsIterator)
+	for (int i = 0; i < keywords.count(); ++i)
 	{
-		if (!keywordsIterator.key().startsWith(prefix, Qt::CaseInsensitive))
+		Bookmark *bookmark(m_keywords.value(keywords.at(i)));
+
+		if (!bookmark)
 		{
 			continue;
 		}
 
 		BookmarkMatch match;
-		match.bookmark = keywordsIterator.value();
-		match.match = keywordsIterator.key();
+		match.bookmark = bookmark;
+		match.match = keywords.at(i);
 
 		matchesMap.insert(match.bookmark->getTimeVisited(), match);
 
-		matchedBookmarks.append(match.bookmark);
+		matchedBookmarks.insert(match.bookmark);
 	}
 
 	currentMatches = matchesMap.values().toVector();
@@ -1334,27 +1352,30 @@ QVector<BookmarksModel::BookmarkMatch> BookmarksModel::findBookmarks(const QStri
 		allMatches.append(currentMatches.at(i));
 	}
 
-	QHash<QUrl, QVector<Bookmark*> >::const_iterator urlsIterator;
+	const QVector<CompletionIndex::UrlMatch> urlMatches(m_completionIndex.findUrls(prefix, m_completionMatchesLimit, [&](const QUrl &url)
+	{
+		const QVector<Bookmark*> bookmarks(m_urls.value(url));
+		const QDateTime timeVisited(bookmarks.isEmpty() ? QDateTime() : bookmarks.at(0)->getTimeVisited());
+
+		return (timeVisited.isValid() ? timeVisited.toMSecsSinceEpoch() : -1);
+	}));
 
-	for (urlsIterator = m_urls.constBegin(); urlsIterator != m_urls.constEnd(); ++urlsIterator)
+	for (int i = 0; i < urlMatches.count(); ++i)
 	{
-		if (urlsIterator.value().isEmpty() || matchedBookmarks.contains(urlsIterator.value().value(0)))
+		const QVector<Bookmark*> bookmarks(m_urls.value(urlMatches.at(i).url));
+
+		if (bookmarks.isEmpty() || matchedBookmarks.contains(bookmarks.at(0)))
 		{
 			continue;
 		}
 
-		const QString result(Utils::matchUrl(urlsIterator.key(), prefix));
-
-		if (!result.isEmpty())
-		{
-			BookmarkMatch match;
-			match.bookmark = urlsIterator.value().value(0);
-			match.match = result;
+		BookmarkMatch match;
+		match.bookmark = bookmarks.at(0);
+		match.match = urlMatches.at(i).match;
 
-			matchesMap.insert(match.bookmark->getTimeVisited(), match);
+		matchesMap.insert(match.bookmark->getTimeVisited(), match);
 
-			matchedBookmarks.append(match.bookmark);
-		}
+		matchedBookmarks.insert(match.bookmark);
 	}
 
 	currentMatches = matchesMap.values().toVector();
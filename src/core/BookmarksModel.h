@@ -21,6 +21,8 @@
 #ifndef OTTER_BOOKMARKSMODEL_H
 #define OTTER_BOOKMARKSMODEL_H
 
+#include "CompletionIndex.h"
+
 #include <QtCore/QUrl>
 #include <QtCore/QXmlStreamReader>
 #include <QtCore/QXmlStreamWriter>
@@ -168,6 +170,7 @@ private:
 	Bookmark *m_rootItem;
 	Bookmark *m_trashItem;
 	Bookmark *m_importTargetItem;
+	CompletionIndex m_completionIndex;
 	QHash<Bookmark*, BookmarkLocation> m_trash;
 	QHash<QUrl, QVector<Bookmark*> > m_feeds;
 	QHash<QUrl, QVector<Bookmark*> > m_urls;
@@ -175,6 +178,8 @@ private:
 	QMap<quint64, Bookmark*> m_identifiers;
 	FormatMode m_mode;
 
+	static const int m_completionMatchesLimit;
+
 signals:
 	void bookmarkAdded(Bookmark *bookmark);
 	void bookmarkModified(Bookmark *bookmark);
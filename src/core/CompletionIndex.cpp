@@ -0,0 +1,219 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "CompletionIndex.h"
+
+#include <QtCore/QHash>
+
+#include <algorithm>
+
+namespace Otter
+{
+
+void CompletionIndex::addUrl(const QUrl &url)
+{
+	if (url.isEmpty())
+	{
+		return;
+	}
+
+	const QVector<UrlForm> forms(createForms(url));
+
+	for (int i = 0; i < forms.count(); ++i)
+	{
+		m_urls.insert(forms.at(i).text.toCaseFolded(), forms.at(i));
+	}
+}
+
+void CompletionIndex::removeUrl(const QUrl &url)
+{
+	if (url.isEmpty())
+	{
+		return;
+	}
+
+	const QVector<UrlForm> forms(createForms(url));
+
+	for (int i = 0; i < forms.count(); ++i)
+	{
+		const QString key(forms.at(i).text.toCaseFolded());
+		QMultiMap<QString, UrlForm>::iterator iterator(m_urls.find(key));
+
+		while (iterator != m_urls.end() && iterator.key() == key)
+		{
+			if (iterator.value().url == url && iterator.value().type == forms.at(i).type)
+			{
+				iterator = m_urls.erase(iterator);
+
+				break;
+			}
+
+			++iterator;
+		}
+	}
+}
+
+void CompletionIndex::addKeyword(const QString &keyword)
+{
+	if (!keyword.isEmpty())
+	{
+		m_keywords.insert(keyword.toCaseFolded(), keyword);
+	}
+}
+
+void CompletionIndex::removeKeyword(const QString &keyword)
+{
+	if (!keyword.isEmpty())
+	{
+		m_keywords.remove(keyword.toCaseFolded(), keyword);
+	}
+}
+
+void CompletionIndex::clear()
+{
+	m_urls.clear();
+	m_keywords.clear();
+}
+
+QVector<CompletionIndex::UrlForm> CompletionIndex::createForms(const QUrl &url)
+{
+	QVector<UrlForm> forms;
+	forms.reserve(3);
+
+	UrlForm fullForm;
+	fullForm.url = url;
+	fullForm.text = url.toString();
+	fullForm.type = FullMatch;
+
+	forms.append(fullForm);
+
+	UrlForm noSchemeForm;
+	noSchemeForm.url = url;
+	noSchemeForm.text = url.toString(QUrl::RemoveScheme).mid(2);
+	noSchemeForm.type = NoSchemeMatch;
+
+	forms.append(noSchemeForm);
+
+	if (noSchemeForm.text.startsWith(QLatin1String("www.")) && url.host().count(QLatin1Char('.')) > 1)
+	{
+		UrlForm noWwwForm;
+		noWwwForm.url = url;
+		noWwwForm.text = noSchemeForm.text.mid(4);
+		noWwwForm.type = NoWwwMatch;
+
+		forms.append(noWwwForm);
+	}
+
+	return forms;
+}
+
+QVector<CompletionIndex::UrlMatch> CompletionIndex::findUrls(const QString &prefix, int limit, const std::function<qint64(const QUrl &url)> &getRank) const
+{
+	const QString foldedPrefix(prefix.toCaseFolded());
+	QHash<QUrl, int> positions;
+	QVector<UrlForm> forms;
+	QMultiMap<QString, UrlForm>::const_iterator iterator(m_urls.lowerBound(foldedPrefix));
+
+	while (iterator != m_urls.constEnd() && iterator.key().startsWith(foldedPrefix))
+	{
+		const UrlForm &form(iterator.value());
+		const int position(positions.value(form.url, -1));
+
+		if (position < 0)
+		{
+			if (!getRank && limit >= 0 && forms.count() >= limit)
+			{
+				break;
+			}
+
+			positions[form.url] = forms.count();
+
+			forms.append(form);
+		}
+		else if (form.type < forms.at(position).type)
+		{
+			forms[position] = form;
+		}
+
+		++iterator;
+	}
+
+	if (getRank && limit >= 0 && forms.count() > limit)
+	{
+		QVector<QPair<qint64, int> > ranks;
+		ranks.reserve(forms.count());
+
+		for (int i = 0; i < forms.count(); ++i)
+		{
+			ranks.append({getRank(forms.at(i).url), i});
+		}
+
+		std::partial_sort(ranks.begin(), (ranks.begin() + limit), ranks.end(), [&](const QPair<qint64, int> &first, const QPair<qint64, int> &second)
+		{
+			if (first.first != second.first)
+			{
+				return (first.first > second.first);
+			}
+
+			return (first.second < second.second);
+		});
+
+		QVector<UrlForm> rankedForms;
+		rankedForms.reserve(limit);
+
+		for (int i = 0; i < limit; ++i)
+		{
+			rankedForms.append(forms.at(ranks.at(i).second));
+		}
+
+		forms = rankedForms;
+	}
+
+	QVector<UrlMatch> matches;
+	matches.reserve(forms.count());
+
+	for (int i = 0; i < forms.count(); ++i)
+	{
+		UrlMatch match;
+		match.url = forms.at(i).url;
+		match.match = forms.at(i).text;
+
+		matches.append(match);
+	}
+
+	return matches;
+}
+
+QStringList CompletionIndex::findKeywords(const QString &prefix, int limit) const
+{
+	const QString foldedPrefix(prefix.toCaseFolded());
+	QStringList keywords;
+	QMultiMap<QString, QString>::const_iterator iterator(m_keywords.lowerBound(foldedPrefix));
+
+	while (iterator != m_keywords.constEnd() && iterator.key().startsWith(foldedPrefix) && (limit < 0 || keywords.count() < limit))
+	{
+		keywords.append(iterator.value());
+
+		++iterator;
+	}
+
+	return keywords;
+}
+
+}
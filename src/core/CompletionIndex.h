@@ -0,0 +1,74 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_COMPLETIONINDEX_H
+#define OTTER_COMPLETIONINDEX_H
+
+#include <QtCore/QMap>
+#include <QtCore/QStringList>
+#include <QtCore/QUrl>
+#include <QtCore/QVector>
+
+#include <functional>
+
+namespace Otter
+{
+
+class CompletionIndex final
+{
+public:
+	struct UrlMatch final
+	{
+		QUrl url;
+		QString match;
+	};
+
+	void addUrl(const QUrl &url);
+	void removeUrl(const QUrl &url);
+	void addKeyword(const QString &keyword);
+	void removeKeyword(const QString &keyword);
+	void clear();
+	QVector<UrlMatch> findUrls(const QString &prefix, int limit = -1, const std::function<qint64(const QUrl &url)> &getRank = nullptr) const;
+	QStringList findKeywords(const QString &prefix, int limit = -1) const;
+
+protected:
+	enum MatchType
+	{
+		FullMatch = 0,
+		NoSchemeMatch,
+		NoWwwMatch
+	};
+
+	struct UrlForm final
+	{
+		QUrl url;
+		QString text;
+		MatchType type = FullMatch;
+	};
+
+	static QVector<UrlForm> createForms(const QUrl &url);
+
+private:
+	QMultiMap<QString, UrlForm> m_urls;
+	QMultiMap<QString, QString> m_keywords;
+};
+
+}
+
+#endif
@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2013 - 2018 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2013 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -20,14 +20,24 @@
 #include "Console.h"
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QThread>
+#include <QtCore/QTimerEvent>
 
 namespace Otter
 {
 
 Console* Console::m_instance(nullptr);
-QVector<Console::Message> Console::m_messages;
+Console::MessageSlot* Console::m_slots(nullptr);
+Console::RateLimit Console::m_rateLimits[JavaScriptCategory + 1];
+QElapsedTimer Console::m_elapsedTimer;
+QAtomicInteger<quint64> Console::m_writeSequence(0);
+QAtomicInt Console::m_hasPendingMessages(0);
+const int Console::m_capacity(1000);
+const int Console::m_rateLimit(100);
 
-Console::Console(QObject *parent) : QObject(parent)
+Console::Console(QObject *parent) : QObject(parent),
+	m_deliveredSequence(0),
+	m_deliveryTimer(0)
 {
 }
 
@@ -35,12 +45,93 @@ void Console::createInstance()
 {
 	if (!m_instance)
 	{
+		m_slots = new MessageSlot[m_capacity];
 		m_instance = new Console(QCoreApplication::instance());
+
+		m_elapsedTimer.start();
+	}
+}
+
+void Console::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() != m_deliveryTimer)
+	{
+		return;
+	}
+
+	killTimer(m_deliveryTimer);
+
+	m_deliveryTimer = 0;
+
+	m_hasPendingMessages.storeRelease(0);
+
+	for (int i = 0; i <= JavaScriptCategory; ++i)
+	{
+		const int droppedAmount(m_rateLimits[i].droppedAmount.fetchAndStoreRelaxed(0));
+
+		if (droppedAmount > 0)
+		{
+			Message message;
+			message.rawNote = QT_TRANSLATE_NOOP("main", "%1 messages were suppressed");
+			message.arguments = QStringList({QString::number(droppedAmount)});
+			message.category = static_cast<MessageCategory>(i);
+			message.level = WarningLevel;
+
+			appendMessage(message);
+		}
+	}
+
+	const quint64 writeSequence(m_writeSequence.loadAcquire());
+	QVector<Message> messages;
+	quint64 sequence((writeSequence > static_cast<quint64>(m_capacity)) ? qMax(m_deliveredSequence, (writeSequence - m_capacity)) : m_deliveredSequence);
+
+	messages.reserve(static_cast<int>(writeSequence - sequence));
+
+	for (; sequence < writeSequence; ++sequence)
+	{
+		const MessageSlot &slot(m_slots[sequence % m_capacity]);
+
+		if (slot.state.loadAcquire() != ReadySlot || slot.sequence.loadRelaxed() < sequence)
+		{
+			break;
+		}
+
+		Message message;
+
+		if (readMessage(sequence, &message))
+		{
+			messages.append(message);
+		}
+	}
+
+	m_deliveredSequence = sequence;
+
+	if (sequence < writeSequence)
+	{
+		scheduleDelivery();
+	}
+
+	if (!messages.isEmpty())
+	{
+		emit messagesAdded(messages);
+	}
+}
+
+void Console::scheduleDelivery()
+{
+	if (m_deliveryTimer == 0)
+	{
+		m_deliveryTimer = startTimer(100);
 	}
 }
 
 void Console::addMessage(const QString &note, MessageCategory category, MessageLevel level, const QString &source, int line, quint64 window)
 {
+	if (isRateLimited(category, level))
+	{
+		return;
+	}
+
 	Message message;
 	message.note = note;
 	message.source = source;
@@ -49,14 +140,63 @@ void Console::addMessage(const QString &note, MessageCategory category, MessageL
 	message.line = line;
 	message.window = window;
 
-	m_messages.append(message);
+	appendMessage(message);
+}
+
+void Console::addMessage(const char *note, const QStringList &arguments, MessageCategory category, MessageLevel level, const QString &source, int line, quint64 window)
+{
+	if (isRateLimited(category, level))
+	{
+		return;
+	}
+
+	Message message;
+	message.source = source;
+	message.arguments = arguments;
+	message.rawNote = note;
+	message.category = category;
+	message.level = level;
+	message.line = line;
+	message.window = window;
+
+	appendMessage(message);
+}
+
+void Console::appendMessage(const Message &message)
+{
+	if (!m_instance)
+	{
+		return;
+	}
+
+	const quint64 sequence(m_writeSequence.fetchAndAddOrdered(1));
+	MessageSlot &slot(m_slots[sequence % m_capacity]);
+	int state(slot.state.loadAcquire());
 
-	if (m_messages.count() > 1000)
+	while ((state != EmptySlot && state != ReadySlot) || !slot.state.testAndSetAcquire(state, WritingSlot))
 	{
-		m_messages.removeFirst();
+		QThread::yieldCurrentThread();
+
+		state = slot.state.loadAcquire();
+	}
+
+	if (state == ReadySlot && slot.sequence.loadRelaxed() > sequence)
+	{
+		slot.state.storeRelease(ReadySlot);
+
+		m_rateLimits[message.category].droppedAmount.fetchAndAddRelaxed(1);
+
+		return;
 	}
 
-	emit m_instance->messageAdded(message);
+	slot.message = message;
+	slot.sequence.storeRelaxed(sequence);
+	slot.state.storeRelease(ReadySlot);
+
+	if (m_hasPendingMessages.testAndSetOrdered(0, 1))
+	{
+		QMetaObject::invokeMethod(m_instance, &Console::scheduleDelivery, Qt::QueuedConnection);
+	}
 }
 
 Console* Console::getInstance()
@@ -66,7 +206,101 @@ Console* Console::getInstance()
 
 QVector<Console::Message> Console::getMessages()
 {
-	return m_messages;
+	if (!m_instance)
+	{
+		return {};
+	}
+
+	const quint64 deliveredSequence(m_instance->m_deliveredSequence);
+	QVector<Message> messages;
+	messages.reserve(m_capacity);
+
+	for (quint64 sequence((deliveredSequence > static_cast<quint64>(m_capacity)) ? (deliveredSequence - m_capacity) : 0); sequence < deliveredSequence; ++sequence)
+	{
+		Message message;
+
+		if (readMessage(sequence, &message))
+		{
+			messages.append(message);
+		}
+	}
+
+	return messages;
+}
+
+bool Console::readMessage(quint64 sequence, Message *message)
+{
+	MessageSlot &slot(m_slots[sequence % m_capacity]);
+
+	if (!slot.state.testAndSetAcquire(ReadySlot, ReadingSlot))
+	{
+		return false;
+	}
+
+	const bool isValid(slot.sequence.loadRelaxed() == sequence);
+
+	if (isValid)
+	{
+		*message = slot.message;
+	}
+
+	slot.state.storeRelease(ReadySlot);
+
+	return isValid;
+}
+
+bool Console::isRateLimited(MessageCategory category, MessageLevel level)
+{
+	if (level == ErrorLevel || !m_instance)
+	{
+		return false;
+	}
+
+	RateLimit &rateLimit(m_rateLimits[category]);
+	const int period(static_cast<int>(m_elapsedTimer.elapsed() / 1000) + 1);
+	const int currentPeriod(rateLimit.period.loadRelaxed());
+
+	if (currentPeriod != period && rateLimit.period.testAndSetRelaxed(currentPeriod, period))
+	{
+		rateLimit.amount.storeRelaxed(0);
+	}
+
+	if (rateLimit.amount.fetchAndAddRelaxed(1) < m_rateLimit)
+	{
+		return false;
+	}
+
+	rateLimit.droppedAmount.fetchAndAddRelaxed(1);
+
+	return true;
+}
+
+QString Console::Message::getNote() const
+{
+	const QString text(rawNote ? QCoreApplication::translate("main", rawNote) : note);
+
+	switch (arguments.count())
+	{
+		case 0:
+			return text;
+		case 1:
+			return text.arg(arguments.at(0));
+		case 2:
+			return text.arg(arguments.at(0), arguments.at(1));
+		case 3:
+			return text.arg(arguments.at(0), arguments.at(1), arguments.at(2));
+		default:
+			break;
+	}
+
+	QString result(text);
+
+	for (int i = 0; i < arguments.count(); ++i)
+	{
+		result = result.arg(arguments.at(i));
+	}
+
+	return result;
 }
 
 }
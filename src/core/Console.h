@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2013 - 2018 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2013 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -20,8 +20,11 @@
 #ifndef OTTER_CONSOLE_H
 #define OTTER_CONSOLE_H
 
+#include <QtCore/QAtomicInteger>
 #include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QObject>
+#include <QtCore/QStringList>
 #include <QtCore/QVector>
 
 namespace Otter
@@ -56,26 +59,68 @@ public:
 		QDateTime time = QDateTime::currentDateTimeUtc();
 		QString note;
 		QString source;
+		QStringList arguments;
+		const char *rawNote = nullptr;
 		MessageCategory category = OtherCategory;
 		MessageLevel level = UnknownLevel;
 		quint64 window = 0;
 		int line = -1;
+
+		QString getNote() const;
 	};
 
 	static void createInstance();
 	static void addMessage(const QString &note, MessageCategory category, MessageLevel level, const QString &source = {}, int line = -1, quint64 window = 0);
+	static void addMessage(const char *note, const QStringList &arguments, MessageCategory category, MessageLevel level, const QString &source = {}, int line = -1, quint64 window = 0);
 	static Console* getInstance();
 	static QVector<Console::Message> getMessages();
 
 protected:
+	enum SlotState
+	{
+		EmptySlot = 0,
+		WritingSlot,
+		ReadySlot,
+		ReadingSlot
+	};
+
+	struct MessageSlot final
+	{
+		Message message;
+		QAtomicInteger<quint64> sequence;
+		QAtomicInt state;
+	};
+
+	struct RateLimit final
+	{
+		QAtomicInt period;
+		QAtomicInt amount;
+		QAtomicInt droppedAmount;
+	};
+
 	explicit Console(QObject *parent = nullptr);
 
+	void timerEvent(QTimerEvent *event) override;
+	void scheduleDelivery();
+	static void appendMessage(const Message &message);
+	static bool readMessage(quint64 sequence, Message *message);
+	static bool isRateLimited(MessageCategory category, MessageLevel level);
+
 private:
+	quint64 m_deliveredSequence;
+	int m_deliveryTimer;
+
 	static Console *m_instance;
-	static QVector<Message> m_messages;
+	static MessageSlot *m_slots;
+	static RateLimit m_rateLimits[JavaScriptCategory + 1];
+	static QElapsedTimer m_elapsedTimer;
+	static QAtomicInteger<quint64> m_writeSequence;
+	static QAtomicInt m_hasPendingMessages;
+	static const int m_capacity;
+	static const int m_rateLimit;
 
 signals:
-	void messageAdded(const Console::Message &message);
+	void messagesAdded(const QVector<Console::Message> &messages);
 };
 
 }
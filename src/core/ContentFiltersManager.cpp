@@ -26,9 +26,13 @@
 #include "SettingsManager.h"
 #include "SessionsManager.h"
 
+#include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonObject>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
 #include <QtCore/QTimer>
 
 namespace Otter
@@ -37,6 +41,18 @@ namespace Otter
 ContentFiltersManager* ContentFiltersManager::m_instance(nullptr);
 QVector<ContentFiltersProfile*> ContentFiltersManager::m_contentBlockingProfiles;
 QVector<ContentFiltersProfile*> ContentFiltersManager::m_fraudCheckingProfiles;
+QVector<ContentFiltersProfile*> ContentFiltersManager::m_preloadedProfiles;
+QHash<QObject*, QVector<int> > ContentFiltersManager::m_profilesUsers;
+QSharedPointer<ContentFiltersManager::RulesSnapshot> ContentFiltersManager::m_rulesSnapshot(new ContentFiltersManager::RulesSnapshot());
+QThreadStorage<ContentFiltersManager::LocalRulesSnapshot> ContentFiltersManager::m_localRulesSnapshots;
+QHash<ContentFiltersProfile*, QSharedPointer<ContentFiltersRuleSet> > ContentFiltersManager::m_publishedRuleSets;
+QMutex ContentFiltersManager::m_rulesSnapshotMutex;
+QWaitCondition ContentFiltersManager::m_rulesSnapshotCondition;
+QAtomicInteger<quint64> ContentFiltersManager::m_rulesSnapshotGeneration(1);
+QAtomicInteger<quint64> ContentFiltersManager::m_checkCacheHits(0);
+QAtomicInteger<quint64> ContentFiltersManager::m_checkCacheMisses(0);
+const int ContentFiltersManager::m_checkCacheSize(5000);
+const int ContentFiltersManager::m_ruleSetLoadTimeout(30000);
 
 ContentFiltersManager::ContentFiltersManager(QObject *parent) : QObject(parent),
 	m_saveTimer(0)
@@ -175,11 +191,27 @@ void ContentFiltersManager::initialize()
 		{
 			m_instance->scheduleSave();
 
+			if (m_preloadedProfiles.contains(profile))
+			{
+				profile->loadRuleSet();
+
+				updateRulesSnapshot();
+			}
+
 			emit m_instance->profileModified(profile->getName());
 		});
+		connect(profile, &ContentFiltersProfile::ruleSetLoaded, profile, [=]()
+		{
+			if (m_preloadedProfiles.contains(profile))
+			{
+				updateRulesSnapshot();
+			}
+		});
 	}
 
 	m_contentBlockingProfiles.squeeze();
+
+	updateRulesSnapshot();
 }
 
 void ContentFiltersManager::timerEvent(QTimerEvent *event)
@@ -290,6 +322,115 @@ void ContentFiltersManager::save()
 	settings.save();
 }
 
+void ContentFiltersManager::updatePreloadedProfiles()
+{
+	QVector<ContentFiltersProfile*> preloadedProfiles;
+	QHash<QObject*, QVector<int> >::const_iterator iterator;
+
+	for (iterator = m_profilesUsers.constBegin(); iterator != m_profilesUsers.constEnd(); ++iterator)
+	{
+		const QVector<int> profiles(iterator.value());
+
+		for (int i = 0; i < profiles.count(); ++i)
+		{
+			ContentFiltersProfile *profile(m_contentBlockingProfiles.value(profiles.at(i), nullptr));
+
+			if (profile && !preloadedProfiles.contains(profile))
+			{
+				preloadedProfiles.append(profile);
+			}
+		}
+	}
+
+	bool needsUpdate(preloadedProfiles.count() != m_preloadedProfiles.count());
+
+	for (int i = 0; i < m_preloadedProfiles.count(); ++i)
+	{
+		ContentFiltersProfile *profile(m_preloadedProfiles.at(i));
+
+		if (!preloadedProfiles.contains(profile))
+		{
+			profile->clear();
+
+			needsUpdate = true;
+		}
+	}
+
+	m_preloadedProfiles = preloadedProfiles;
+
+	for (int i = 0; i < m_preloadedProfiles.count(); ++i)
+	{
+		m_preloadedProfiles.at(i)->loadRuleSet();
+	}
+
+	if (needsUpdate)
+	{
+		updateRulesSnapshot();
+	}
+}
+
+void ContentFiltersManager::updateRulesSnapshot()
+{
+	QSharedPointer<RulesSnapshot> snapshot(new RulesSnapshot());
+	snapshot->ruleSets.reserve(m_contentBlockingProfiles.count());
+	snapshot->pendingRuleSets.reserve(m_contentBlockingProfiles.count());
+
+	for (int i = 0; i < RulesSnapshot::checkCacheShardsAmount; ++i)
+	{
+		snapshot->checkCacheShards[i].checkCache.setMaxCost(m_checkCacheSize / RulesSnapshot::checkCacheShardsAmount);
+	}
+
+	QHash<ContentFiltersProfile*, QSharedPointer<ContentFiltersRuleSet> > publishedRuleSets;
+
+	for (int i = 0; i < m_contentBlockingProfiles.count(); ++i)
+	{
+		ContentFiltersProfile *profile(m_contentBlockingProfiles.at(i));
+		QSharedPointer<ContentFiltersRuleSet> ruleSet;
+		bool isPending(false);
+
+		if (m_preloadedProfiles.contains(profile))
+		{
+			ruleSet = profile->getRuleSet();
+
+			if (!ruleSet && profile->isLoadingRuleSet())
+			{
+				ruleSet = m_publishedRuleSets.value(profile);
+				isPending = !ruleSet;
+			}
+
+			if (ruleSet)
+			{
+				publishedRuleSets[profile] = ruleSet;
+			}
+		}
+
+		snapshot->ruleSets.append(ruleSet);
+		snapshot->pendingRuleSets.append(isPending);
+	}
+
+	m_publishedRuleSets = publishedRuleSets;
+
+	QMutexLocker locker(&m_rulesSnapshotMutex);
+
+	m_rulesSnapshot.swap(snapshot);
+	m_rulesSnapshotGeneration.fetchAndAddRelease(1);
+	m_rulesSnapshotCondition.wakeAll();
+}
+
+QSharedPointer<ContentFiltersManager::RulesSnapshot> ContentFiltersManager::waitForRulesSnapshot(const QVector<int> &profiles)
+{
+	QMutexLocker locker(&m_rulesSnapshotMutex);
+	QElapsedTimer timer;
+	timer.start();
+
+	while (m_rulesSnapshot->isPending(profiles) && timer.elapsed() < m_ruleSetLoadTimeout)
+	{
+		m_rulesSnapshotCondition.wait(&m_rulesSnapshotMutex, static_cast<unsigned long>(m_ruleSetLoadTimeout - timer.elapsed()));
+	}
+
+	return m_rulesSnapshot;
+}
+
 void ContentFiltersManager::addProfile(ContentFiltersProfile *profile)
 {
 	if (!profile)
@@ -305,6 +446,7 @@ void ContentFiltersManager::addProfile(ContentFiltersProfile *profile)
 		{
 			isReplacing = true;
 
+			m_preloadedProfiles.removeAll(m_contentBlockingProfiles.at(i));
 			m_contentBlockingProfiles.at(i)->deleteLater();
 			m_contentBlockingProfiles.replace(i, profile);
 
@@ -319,9 +461,28 @@ void ContentFiltersManager::addProfile(ContentFiltersProfile *profile)
 
 	m_instance->scheduleSave();
 
+	updatePreloadedProfiles();
+	updateRulesSnapshot();
+
 	emit m_instance->profileAdded(profile->getName());
 
 	connect(profile, &ContentFiltersProfile::profileModified, m_instance, &ContentFiltersManager::scheduleSave);
+	connect(profile, &ContentFiltersProfile::profileModified, profile, [=]()
+	{
+		if (m_preloadedProfiles.contains(profile))
+		{
+			profile->loadRuleSet();
+
+			updateRulesSnapshot();
+		}
+	});
+	connect(profile, &ContentFiltersProfile::ruleSetLoaded, profile, [=]()
+	{
+		if (m_preloadedProfiles.contains(profile))
+		{
+			updateRulesSnapshot();
+		}
+	});
 }
 
 void ContentFiltersManager::removeProfile(ContentFiltersProfile *profile, bool removeFile)
@@ -354,12 +515,54 @@ void ContentFiltersManager::removeProfile(ContentFiltersProfile *profile, bool r
 	localSettings.save();
 
 	m_contentBlockingProfiles.removeAll(profile);
+	m_preloadedProfiles.removeAll(profile);
+
+	updatePreloadedProfiles();
+	updateRulesSnapshot();
 
 	profile->deleteLater();
 
 	emit m_instance->profileRemoved(name);
 }
 
+void ContentFiltersManager::preloadProfiles(const QVector<int> &profiles, QObject *user)
+{
+	if (!user)
+	{
+		return;
+	}
+
+	if (profiles.isEmpty())
+	{
+		if (m_profilesUsers.remove(user) > 0)
+		{
+			disconnect(user, &QObject::destroyed, m_instance, nullptr);
+
+			updatePreloadedProfiles();
+		}
+
+		return;
+	}
+
+	if (!m_profilesUsers.contains(user))
+	{
+		connect(user, &QObject::destroyed, m_instance, [=]()
+		{
+			m_profilesUsers.remove(user);
+
+			updatePreloadedProfiles();
+		});
+	}
+	else if (m_profilesUsers.value(user) == profiles)
+	{
+		return;
+	}
+
+	m_profilesUsers[user] = profiles;
+
+	updatePreloadedProfiles();
+}
+
 ContentFiltersManager* ContentFiltersManager::getInstance()
 {
 	return m_instance;
@@ -419,33 +622,101 @@ ContentFiltersManager::CheckResult ContentFiltersManager::checkUrl(const QVector
 		return {};
 	}
 
-	CheckResult result;
-	result.isFraud = ((resourceType == NetworkManager::MainFrameType || resourceType == NetworkManager::SubFrameType) ? isFraud(requestUrl) : false);
+	const QSharedPointer<RulesSnapshot> snapshot(getRulesSnapshot());
+	bool isSnapshotComplete(true);
 
 	for (int i = 0; i < profiles.count(); ++i)
 	{
-		const int profile(profiles.at(i));
-
-		if (profile < 0 || profile >= m_contentBlockingProfiles.count())
+		if (!snapshot->ruleSets.value(profiles.at(i)))
 		{
-			continue;
+			isSnapshotComplete = false;
+
+			break;
 		}
+	}
 
-		CheckResult currentResult(m_contentBlockingProfiles.at(profile)->checkUrl(baseUrl, requestUrl, resourceType));
-		currentResult.profile = profile;
-		currentResult.isFraud = result.isFraud;
+	CheckResult result;
 
-		if (currentResult.isBlocked)
+	if (isSnapshotComplete)
+	{
+		result = snapshot->checkUrl(profiles, baseUrl, requestUrl, resourceType);
+	}
+	else
+	{
+		for (int i = 0; i < profiles.count(); ++i)
 		{
-			result = currentResult;
+			ContentFiltersProfile *profile(m_contentBlockingProfiles.value(profiles.at(i), nullptr));
+
+			if (!profile)
+			{
+				continue;
+			}
+
+			CheckResult currentResult(profile->checkUrl(baseUrl, requestUrl, resourceType));
+			currentResult.profile = profiles.at(i);
+
+			if (currentResult.isBlocked)
+			{
+				result = currentResult;
+			}
+			else if (currentResult.isException)
+			{
+				result = currentResult;
+
+				break;
+			}
 		}
-		else if (currentResult.isException)
+	}
+
+	result.isFraud = ((resourceType == NetworkManager::MainFrameType || resourceType == NetworkManager::SubFrameType) ? isFraud(requestUrl) : false);
+
+	return result;
+}
+
+DiagnosticReport::Section ContentFiltersManager::createReport()
+{
+	const QSharedPointer<RulesSnapshot> snapshot(getRulesSnapshot());
+	const quint64 hits(m_checkCacheHits.loadAcquire());
+	const quint64 misses(m_checkCacheMisses.loadAcquire());
+	int loadedProfilesAmount(0);
+
+	for (int i = 0; i < snapshot->ruleSets.count(); ++i)
+	{
+		if (snapshot->ruleSets.at(i))
 		{
-			return currentResult;
+			++loadedProfilesAmount;
 		}
 	}
 
-	return result;
+	int cachedResultsAmount(0);
+
+	for (int i = 0; i < RulesSnapshot::checkCacheShardsAmount; ++i)
+	{
+		CheckCacheShard &shard(snapshot->checkCacheShards[i]);
+		shard.checkCacheMutex.lock();
+
+		cachedResultsAmount += shard.checkCache.count();
+
+		shard.checkCacheMutex.unlock();
+	}
+
+	DiagnosticReport::Section report;
+	report.title = QLatin1String("Content Blocking");
+	report.fieldWidths = {30, 0};
+	report.entries.reserve(5);
+	report.entries.append({QLatin1String("Loaded Profiles"), QString::number(loadedProfilesAmount)});
+
+	if ((hits + misses) == 0)
+	{
+		return report;
+	}
+
+	report.entries.append({QLatin1String("Decision Cache Entries"), QStringLiteral("%1 / %2").arg(cachedResultsAmount).arg(m_checkCacheSize)});
+	report.entries.append({QLatin1String("Decision Cache Hits"), QString::number(hits)});
+	report.entries.append({QLatin1String("Decision Cache Misses"), QString::number(misses)});
+	report.entries.append({QLatin1String("Decision Cache Hit Ratio"), QStringLiteral("%1%").arg(((hits * 100.0) / (hits + misses)), 0, 'f', 1)});
+
+	return report;
 }
 
 ContentFiltersManager::CosmeticFiltersResult ContentFiltersManager::getCosmeticFilters(const QVector<int> &profiles, const QUrl &requestUrl)
@@ -483,20 +754,7 @@ ContentFiltersManager::CosmeticFiltersResult ContentFiltersManager::getCosmeticF
 
 QStringList ContentFiltersManager::createSubdomainList(const QString &domain)
 {
-	QStringList subdomainList;
-	int dotPosition(domain.lastIndexOf(QLatin1Char('.')));
-	dotPosition = domain.lastIndexOf(QLatin1Char('.'), (dotPosition - 1));
-
-	while (dotPosition != -1)
-	{
-		subdomainList.append(domain.mid(dotPosition + 1));
-
-		dotPosition = domain.lastIndexOf(QLatin1Char('.'), (dotPosition - 1));
-	}
-
-	subdomainList.append(domain);
-
-	return subdomainList;
+	return AdblockContentFiltersRuleSet::createSubdomainList(domain);
 }
 
 QStringList ContentFiltersManager::getProfileNames()
@@ -514,6 +772,21 @@ QStringList ContentFiltersManager::getProfileNames()
 	return names;
 }
 
+QSharedPointer<ContentFiltersManager::RulesSnapshot> ContentFiltersManager::getRulesSnapshot()
+{
+	LocalRulesSnapshot &localSnapshot(m_localRulesSnapshots.localData());
+
+	if (localSnapshot.generation != m_rulesSnapshotGeneration.loadAcquire())
+	{
+		QMutexLocker locker(&m_rulesSnapshotMutex);
+
+		localSnapshot.snapshot = m_rulesSnapshot;
+		localSnapshot.generation = m_rulesSnapshotGeneration.loadAcquire();
+	}
+
+	return localSnapshot.snapshot;
+}
+
 QVector<ContentFiltersProfile*> ContentFiltersManager::getContentBlockingProfiles()
 {
 	initialize();
@@ -564,6 +837,106 @@ bool ContentFiltersManager::isFraud(const QUrl &url)
 	return false;
 }
 
+ContentFiltersManager::CheckResult ContentFiltersManager::RulesSnapshot::checkUrl(const QVector<int> &profiles, const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType)
+{
+	if (profiles.isEmpty())
+	{
+		return {};
+	}
+
+	const QString scheme(requestUrl.scheme());
+
+	if (scheme != QLatin1String("http") && scheme != QLatin1String("https"))
+	{
+		return {};
+	}
+
+	QStringList profilesKey;
+	profilesKey.reserve(profiles.count());
+
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		profilesKey.append(QString::number(profiles.at(i)));
+	}
+
+	if (isPending(profiles) && QThread::currentThread() != QCoreApplication::instance()->thread())
+	{
+		const QSharedPointer<RulesSnapshot> snapshot(waitForRulesSnapshot(profiles));
+
+		if (snapshot.data() != this && !snapshot->isPending(profiles))
+		{
+			return snapshot->checkUrl(profiles, baseUrl, requestUrl, resourceType);
+		}
+	}
+
+	const QString cacheKey(QStringLiteral("%1 %2 %3 %4").arg(profilesKey.join(QLatin1Char(','))).arg(static_cast<int>(resourceType)).arg(baseUrl.host(), requestUrl.toString()));
+	CheckCacheShard &shard(checkCacheShards[qHash(cacheKey) % checkCacheShardsAmount]);
+
+	shard.checkCacheMutex.lock();
+
+	const CheckResult *cachedResult(shard.checkCache.object(cacheKey));
+
+	if (cachedResult)
+	{
+		const CheckResult result(*cachedResult);
+
+		shard.checkCacheMutex.unlock();
+
+		m_checkCacheHits.fetchAndAddRelaxed(1);
+
+		return result;
+	}
+
+	shard.checkCacheMutex.unlock();
+
+	m_checkCacheMisses.fetchAndAddRelaxed(1);
+
+	CheckResult result;
+
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		const int profile(profiles.at(i));
+
+		if (profile < 0 || profile >= ruleSets.count() || !ruleSets.at(profile))
+		{
+			continue;
+		}
+
+		CheckResult currentResult(ruleSets.at(profile)->checkUrl(baseUrl, requestUrl, resourceType));
+		currentResult.profile = profile;
+
+		if (currentResult.isBlocked)
+		{
+			result = currentResult;
+		}
+		else if (currentResult.isException)
+		{
+			result = currentResult;
+
+			break;
+		}
+	}
+
+	shard.checkCacheMutex.lock();
+	shard.checkCache.insert(cacheKey, new CheckResult(result));
+	shard.checkCacheMutex.unlock();
+
+	return result;
+}
+
+bool ContentFiltersManager::RulesSnapshot::isPending(const QVector<int> &profiles) const
+{
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		if (pendingRuleSets.value(profiles.at(i), false))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 ContentFiltersProfile::ContentFiltersProfile(QObject *parent) : QObject(parent)
 {
 }
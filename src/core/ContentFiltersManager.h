@@ -22,13 +22,21 @@
 #define OTTER_CONTENTFILTERSMANAGER_H
 
 #include "NetworkManager.h"
+#include "Utils.h"
 
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QCache>
+#include <QtCore/QMutex>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QThreadStorage>
 #include <QtCore/QUrl>
+#include <QtCore/QWaitCondition>
 
 namespace Otter
 {
 
 class ContentFiltersProfile;
+class ContentFiltersRuleSet;
 
 class ContentFiltersManager final : public QObject
 {
@@ -58,28 +66,58 @@ public:
 		QStringList exceptions;
 	};
 
+	struct CheckCacheShard final
+	{
+		QCache<QString, CheckResult> checkCache;
+		QMutex checkCacheMutex;
+	};
+
+	struct RulesSnapshot final
+	{
+		static const int checkCacheShardsAmount = 16;
+
+		QVector<QSharedPointer<ContentFiltersRuleSet> > ruleSets;
+		QVector<bool> pendingRuleSets;
+		CheckCacheShard checkCacheShards[checkCacheShardsAmount];
+
+		CheckResult checkUrl(const QVector<int> &profiles, const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType);
+		bool isPending(const QVector<int> &profiles) const;
+	};
+
 	static void createInstance();
 	static void initialize();
 	static void addProfile(ContentFiltersProfile *profile);
 	static void removeProfile(ContentFiltersProfile *profile, bool removeFile = false);
+	static void preloadProfiles(const QVector<int> &profiles, QObject *user);
 	static ContentFiltersManager* getInstance();
 	static ContentFiltersProfile* getProfile(const QString &name);
 	static ContentFiltersProfile* getProfile(const QUrl &url);
 	static ContentFiltersProfile* getProfile(int identifier);
 	static CheckResult checkUrl(const QVector<int> &profiles, const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType);
+	static DiagnosticReport::Section createReport();
 	static CosmeticFiltersResult getCosmeticFilters(const QVector<int> &profiles, const QUrl &requestUrl);
 	static QStringList createSubdomainList(const QString &domain);
 	static QStringList getProfileNames();
+	static QSharedPointer<RulesSnapshot> getRulesSnapshot();
 	static QVector<ContentFiltersProfile*> getContentBlockingProfiles();
 	static QVector<ContentFiltersProfile*> getFraudCheckingProfiles();
 	static QVector<int> getProfileIdentifiers(const QStringList &names);
 	static bool isFraud(const QUrl &url);
 
 protected:
+	struct LocalRulesSnapshot final
+	{
+		QSharedPointer<RulesSnapshot> snapshot;
+		quint64 generation = 0;
+	};
+
 	explicit ContentFiltersManager(QObject *parent);
 
 	void timerEvent(QTimerEvent *event) override;
 	void save();
+	static void updatePreloadedProfiles();
+	static void updateRulesSnapshot();
+	static QSharedPointer<RulesSnapshot> waitForRulesSnapshot(const QVector<int> &profiles);
 
 protected slots:
 	void scheduleSave();
@@ -90,6 +128,18 @@ private:
 	static ContentFiltersManager *m_instance;
 	static QVector<ContentFiltersProfile*> m_contentBlockingProfiles;
 	static QVector<ContentFiltersProfile*> m_fraudCheckingProfiles;
+	static QVector<ContentFiltersProfile*> m_preloadedProfiles;
+	static QHash<QObject*, QVector<int> > m_profilesUsers;
+	static QSharedPointer<RulesSnapshot> m_rulesSnapshot;
+	static QThreadStorage<LocalRulesSnapshot> m_localRulesSnapshots;
+	static QHash<ContentFiltersProfile*, QSharedPointer<ContentFiltersRuleSet> > m_publishedRuleSets;
+	static QMutex m_rulesSnapshotMutex;
+	static QWaitCondition m_rulesSnapshotCondition;
+	static QAtomicInteger<quint64> m_rulesSnapshotGeneration;
+	static QAtomicInteger<quint64> m_checkCacheHits;
+	static QAtomicInteger<quint64> m_checkCacheMisses;
+	static const int m_checkCacheSize;
+	static const int m_ruleSetLoadTimeout;
 
 signals:
 	void profileAdded(const QString &profile);
@@ -143,6 +193,7 @@ public:
 	explicit ContentFiltersProfile(QObject *parent = nullptr);
 
 	virtual void clear() = 0;
+	virtual void loadRuleSet() = 0;
 	virtual void setProfileSummary(const ProfileSummary &profileSummary) = 0;
 	virtual QString getName() const = 0;
 	virtual QString getTitle() const = 0;
@@ -152,6 +203,7 @@ public:
 	virtual ProfileSummary getProfileSummary() const = 0;
 	virtual ContentFiltersManager::CheckResult checkUrl(const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType) = 0;
 	virtual ContentFiltersManager::CosmeticFiltersResult getCosmeticFilters(const QStringList &domains, bool isDomainOnly) = 0;
+	virtual QSharedPointer<ContentFiltersRuleSet> getRuleSet() = 0;
 	virtual QVector<QLocale::Language> getLanguages() const = 0;
 	virtual ProfileCategory getCategory() const = 0;
 	virtual ContentFiltersManager::CosmeticFiltersMode getCosmeticFiltersMode() const = 0;
@@ -164,12 +216,22 @@ public:
 	virtual bool areWildcardsEnabled() const = 0;
 	virtual bool isUpdating() const = 0;
 	virtual bool isFraud(const QUrl &url) = 0;
+	virtual bool isLoadingRuleSet() const = 0;
 
 signals:
 	void profileModified();
+	void ruleSetLoaded();
 	void updateProgressChanged(int progress);
 };
 
+class ContentFiltersRuleSet
+{
+public:
+	virtual ~ContentFiltersRuleSet() = default;
+
+	virtual ContentFiltersManager::CheckResult checkUrl(const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType) const = 0;
+};
+
 }
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Otter::ContentFiltersProfile::ProfileFlags)
@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2013 - 2023 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2013 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -23,8 +23,9 @@
 #include "SettingsManager.h"
 
 #include <QtCore/QDataStream>
+#include <QtCore/QDir>
 #include <QtCore/QFile>
-#include <QtCore/QSaveFile>
+#include <QtCore/QFileInfo>
 #include <QtCore/QTimerEvent>
 
 namespace Otter
@@ -32,16 +33,32 @@ namespace Otter
 
 CookieJar::CookieJar(const QString &path, QObject *parent) : QNetworkCookieJar(parent),
 	m_path(path),
+	m_journal(nullptr),
 	m_generalCookiesPolicy(AcceptAllCookies),
 	m_thirdPartyCookiesPolicy(AcceptAllCookies),
 	m_keepMode(KeepUntilExpiresMode),
-	m_saveTimer(0)
+	m_expirationTimer(0),
+	m_saveTimer(0),
+	m_isLoading(true)
 {
 	if (!path.isEmpty())
 	{
-		loadCookies(path);
+		m_journal = new JournalFile(path, this);
+
+		if (m_journal->exists())
+		{
+			loadJournal();
+		}
+		else
+		{
+			loadLegacyCookies(QFileInfo(path).dir().filePath(QLatin1String("cookies.dat")));
+		}
+
+		scheduleExpirationCheck();
 	}
 
+	m_isLoading = false;
+
 	handleOptionChanged(SettingsManager::Network_CookiesPolicyOption, SettingsManager::getOption(SettingsManager::Network_CookiesPolicyOption));
 
 	connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, &CookieJar::handleOptionChanged);
@@ -49,19 +66,61 @@ CookieJar::CookieJar(const QString &path, QObject *parent) : QNetworkCookieJar(p
 
 void CookieJar::timerEvent(QTimerEvent *event)
 {
-	if (event->timerId() != m_saveTimer)
+	if (event->timerId() == m_expirationTimer)
 	{
-		return;
+		killTimer(m_expirationTimer);
+
+		m_expirationTimer = 0;
+		m_nextExpiration = {};
+
+		removeExpiredCookies();
+		scheduleExpirationCheck();
 	}
+	else if (event->timerId() == m_saveTimer)
+	{
+		killTimer(m_saveTimer);
 
-	killTimer(m_saveTimer);
+		m_saveTimer = 0;
 
-	m_saveTimer = 0;
+		save();
+	}
+}
 
-	save();
+void CookieJar::loadJournal()
+{
+	const QVector<JournalFile::Record> records(m_journal->load());
+
+	for (int i = 0; i < records.count(); ++i)
+	{
+		const JournalFile::Record record(records.at(i));
+		const QList<QNetworkCookie> cookies(QNetworkCookie::parseCookies(record.data));
+
+		for (int j = 0; j < cookies.count(); ++j)
+		{
+			switch (record.type)
+			{
+				case InsertRecord:
+				case UpdateRecord:
+					addCookie(cookies.at(j));
+
+					break;
+				case RemoveRecord:
+					removeCookie(cookies.at(j));
+
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	if (m_journal->needsCompaction(m_expirations.count()) && !SessionsManager::isReadOnly())
+	{
+		compactJournal();
+	}
 }
 
-void CookieJar::loadCookies(const QString &path)
+void CookieJar::loadLegacyCookies(const QString &path)
 {
 	QFile file(path);
 
@@ -75,8 +134,7 @@ void CookieJar::loadCookies(const QString &path)
 
 	stream >> amount;
 
-	QList<QNetworkCookie> allCookies;
-	allCookies.reserve(static_cast<int>(amount));
+	const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
 
 	for (quint32 i = 0; i < amount; ++i)
 	{
@@ -88,7 +146,10 @@ void CookieJar::loadCookies(const QString &path)
 
 		for (int j = 0; j < cookies.count(); ++j)
 		{
-			allCookies.append(cookies.at(j));
+			if (cookies.at(j).isSessionCookie() || cookies.at(j).expirationDate() >= currentDateTime)
+			{
+				addCookie(cookies.at(j));
+			}
 		}
 
 		if (stream.atEnd())
@@ -97,16 +158,146 @@ void CookieJar::loadCookies(const QString &path)
 		}
 	}
 
-	setAllCookies(allCookies);
+	file.close();
+
+	if (SessionsManager::isReadOnly())
+	{
+		return;
+	}
+
+	connect(m_journal, &JournalFile::compacted, this, [=](bool isSuccess)
+	{
+		if (isSuccess)
+		{
+			QFile::remove(path);
+		}
+	});
+
+	compactJournal();
+}
+
+void CookieJar::compactJournal()
+{
+	QVector<JournalFile::Record> records;
+	records.reserve(m_expirations.count());
+
+	QHash<QString, QVector<QNetworkCookie> >::const_iterator iterator;
+
+	for (iterator = m_cookies.constBegin(); iterator != m_cookies.constEnd(); ++iterator)
+	{
+		const QVector<QNetworkCookie> &cookies(iterator.value());
+
+		for (int i = 0; i < cookies.count(); ++i)
+		{
+			if (!cookies.at(i).isSessionCookie())
+			{
+				JournalFile::Record record;
+				record.type = InsertRecord;
+				record.data = cookies.at(i).toRawForm();
+
+				records.append(record);
+			}
+		}
+	}
+
+	m_journal->compact(records);
+}
+
+void CookieJar::writeRecord(RecordType type, const QNetworkCookie &cookie)
+{
+	if (m_journal && !m_isLoading && !SessionsManager::isReadOnly())
+	{
+		m_journal->addRecord(type, cookie.toRawForm());
+	}
+}
+
+void CookieJar::removeExpiredCookies()
+{
+	const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
+	QVector<QNetworkCookie> expiredCookies;
+
+	while (!m_expirations.isEmpty() && m_expirations.firstKey() < currentDateTime)
+	{
+		const QMultiMap<QDateTime, QString>::iterator iterator(m_expirations.begin());
+		const QVector<QNetworkCookie> cookies(m_cookies.value(iterator.value()));
+		bool hasRemovedCookies(false);
+
+		for (int i = 0; i < cookies.count(); ++i)
+		{
+			const QNetworkCookie cookie(cookies.at(i));
+
+			if (!cookie.isSessionCookie() && cookie.expirationDate() < currentDateTime && removeCookie(cookie, false))
+			{
+				expiredCookies.append(cookie);
+
+				hasRemovedCookies = true;
+			}
+		}
+
+		if (!hasRemovedCookies)
+		{
+			m_expirations.erase(iterator);
+		}
+	}
+
+	for (int i = 0; i < expiredCookies.count(); ++i)
+	{
+		emit cookieRemoved(expiredCookies.at(i));
+	}
+
+	if (!expiredCookies.isEmpty())
+	{
+		scheduleSave();
+	}
+}
+
+void CookieJar::scheduleExpirationCheck()
+{
+	if (m_expirations.isEmpty())
+	{
+		if (m_expirationTimer != 0)
+		{
+			killTimer(m_expirationTimer);
+
+			m_expirationTimer = 0;
+		}
+
+		m_nextExpiration = {};
+
+		return;
+	}
+
+	const QDateTime nextExpiration(m_expirations.firstKey());
+
+	if (m_expirationTimer != 0 && nextExpiration == m_nextExpiration)
+	{
+		return;
+	}
+
+	if (m_expirationTimer != 0)
+	{
+		killTimer(m_expirationTimer);
+	}
+
+	m_nextExpiration = nextExpiration;
+	m_expirationTimer = startTimer(static_cast<int>(qBound(static_cast<qint64>(1000), QDateTime::currentDateTimeUtc().msecsTo(nextExpiration), static_cast<qint64>(3600000))));
 }
 
 void CookieJar::clearCookies(int period)
 {
 	Q_UNUSED(period)
 
-	const QList<QNetworkCookie> cookies(allCookies());
+	const QVector<QNetworkCookie> cookies(getCookies());
+
+	m_cookies.clear();
+	m_expirations.clear();
 
-	setAllCookies({});
+	if (m_journal && !SessionsManager::isReadOnly())
+	{
+		m_journal->clear();
+	}
+
+	scheduleExpirationCheck();
 
 	for (int i = 0; i < cookies.count(); ++i)
 	{
@@ -177,33 +368,19 @@ void CookieJar::handleOptionChanged(int identifier, const QVariant &value)
 
 void CookieJar::save()
 {
-	if (m_path.isEmpty() || SessionsManager::isReadOnly())
+	if (!m_journal || SessionsManager::isReadOnly())
 	{
 		return;
 	}
 
-	QSaveFile file(m_path);
-
-	if (!file.open(QIODevice::WriteOnly))
+	if (m_journal->needsCompaction(m_expirations.count()))
 	{
-		return;
+		compactJournal();
 	}
-
-	const QList<QNetworkCookie> cookies(allCookies());
-	QDataStream stream(&file);
-	stream << static_cast<quint32>(cookies.count());
-
-	for (int i = 0; i < cookies.count(); ++i)
+	else
 	{
-		const QNetworkCookie cookie(cookies.at(i));
-
-		if (!cookie.isSessionCookie())
-		{
-			stream << cookie.toRawForm();
-		}
+		m_journal->flush();
 	}
-
-	file.commit();
 }
 
 QString CookieJar::getPath() const
@@ -218,22 +395,54 @@ QList<QNetworkCookie> CookieJar::cookiesForUrl(const QUrl &url) const
 		return {};
 	}
 
-	return QNetworkCookieJar::cookiesForUrl(url);
+	return getCookiesForUrl(url);
 }
 
 QList<QNetworkCookie> CookieJar::getCookiesForUrl(const QUrl &url) const
 {
-	return QNetworkCookieJar::cookiesForUrl(url);
+	const QString host(url.host());
+	const QHash<QString, QVector<QNetworkCookie> >::const_iterator bucket(m_cookies.constFind(getRegistrableDomain(host)));
+
+	if (bucket == m_cookies.constEnd())
+	{
+		return {};
+	}
+
+	const QVector<QNetworkCookie> &domainCookies(bucket.value());
+	const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
+	const QString path(url.path());
+	const bool isEncrypted(url.scheme() == QLatin1String("https"));
+	QList<QNetworkCookie> cookies;
+
+	for (int i = 0; i < domainCookies.count(); ++i)
+	{
+		const QNetworkCookie &cookie(domainCookies.at(i));
+
+		if (isParentDomain(host, cookie.domain()) && isParentPath(path, cookie.path()) && (cookie.isSessionCookie() || cookie.expirationDate() >= currentDateTime) && (!cookie.isSecure() || isEncrypted))
+		{
+			cookies.append(cookie);
+		}
+	}
+
+	return cookies;
 }
 
 QVector<QNetworkCookie> CookieJar::getCookies(const QString &domain) const
 {
 	if (domain.isEmpty())
 	{
-		return allCookies().toVector();
+		QVector<QNetworkCookie> cookies;
+		QHash<QString, QVector<QNetworkCookie> >::const_iterator iterator;
+
+		for (iterator = m_cookies.constBegin(); iterator != m_cookies.constEnd(); ++iterator)
+		{
+			cookies.append(iterator.value());
+		}
+
+		return cookies;
 	}
 
-	const QList<QNetworkCookie> cookies(allCookies());
+	const QVector<QNetworkCookie> cookies(m_cookies.value(getRegistrableDomain(domain)));
 	QVector<QNetworkCookie> domainCookies;
 
 	for (int i = 0; i < cookies.count(); ++i)
@@ -256,7 +465,14 @@ bool CookieJar::insertCookie(const QNetworkCookie &cookie)
 		return false;
 	}
 
-	const bool result(QNetworkCookieJar::insertCookie(cookie));
+	if (!cookie.isSessionCookie() && cookie.expirationDate() < QDateTime::currentDateTimeUtc())
+	{
+		deleteCookie(cookie);
+
+		return false;
+	}
+
+	const bool result(addCookie(cookie));
 
 	if (result)
 	{
@@ -275,7 +491,7 @@ bool CookieJar::updateCookie(const QNetworkCookie &cookie)
 		return false;
 	}
 
-	const bool result(QNetworkCookieJar::updateCookie(cookie));
+	const bool result(replaceCookie(cookie));
 
 	if (result)
 	{
@@ -294,7 +510,7 @@ bool CookieJar::deleteCookie(const QNetworkCookie &cookie)
 		return false;
 	}
 
-	const bool result(QNetworkCookieJar::deleteCookie(cookie));
+	const bool result(removeCookie(cookie));
 
 	if (result)
 	{
@@ -308,7 +524,14 @@ bool CookieJar::deleteCookie(const QNetworkCookie &cookie)
 
 bool CookieJar::forceInsertCookie(const QNetworkCookie &cookie)
 {
-	const bool result(QNetworkCookieJar::insertCookie(cookie));
+	if (!cookie.isSessionCookie() && cookie.expirationDate() < QDateTime::currentDateTimeUtc())
+	{
+		forceDeleteCookie(cookie);
+
+		return false;
+	}
+
+	const bool result(addCookie(cookie));
 
 	if (result)
 	{
@@ -322,7 +545,7 @@ bool CookieJar::forceInsertCookie(const QNetworkCookie &cookie)
 
 bool CookieJar::forceUpdateCookie(const QNetworkCookie &cookie)
 {
-	const bool result(QNetworkCookieJar::updateCookie(cookie));
+	const bool result(replaceCookie(cookie));
 
 	if (result)
 	{
@@ -336,7 +559,7 @@ bool CookieJar::forceUpdateCookie(const QNetworkCookie &cookie)
 
 bool CookieJar::forceDeleteCookie(const QNetworkCookie &cookie)
 {
-	const bool result(QNetworkCookieJar::deleteCookie(cookie));
+	const bool result(removeCookie(cookie));
 
 	if (result)
 	{
@@ -348,14 +571,102 @@ bool CookieJar::forceDeleteCookie(const QNetworkCookie &cookie)
 	return result;
 }
 
-bool CookieJar::hasCookie(const QNetworkCookie &cookie) const
+bool CookieJar::addCookie(const QNetworkCookie &cookie)
 {
-	QUrl url;
-	url.setScheme(cookie.isSecure() ? QLatin1String("https") : QLatin1String("http"));
-	url.setHost(cookie.domain().startsWith(QLatin1Char('.')) ? cookie.domain().mid(1) : cookie.domain());
-	url.setPath(cookie.path());
+	const bool isDeletion(!cookie.isSessionCookie() && cookie.expirationDate() < QDateTime::currentDateTimeUtc());
+	const bool hasRemovedCookie(removeCookie(cookie, (isDeletion || cookie.isSessionCookie())));
+
+	if (isDeletion)
+	{
+		return false;
+	}
+
+	const QString domain(getRegistrableDomain(cookie.domain()));
+	QVector<QNetworkCookie> &cookies(m_cookies[domain]);
+	int index(0);
+
+	while (index < cookies.count() && cookies.at(index).path().length() >= cookie.path().length())
+	{
+		++index;
+	}
+
+	cookies.insert(index, cookie);
+
+	if (!cookie.isSessionCookie())
+	{
+		m_expirations.insert(cookie.expirationDate(), domain);
+
+		writeRecord((hasRemovedCookie ? UpdateRecord : InsertRecord), cookie);
+
+		if (!m_isLoading)
+		{
+			scheduleExpirationCheck();
+		}
+	}
+
+	return true;
+}
+
+bool CookieJar::removeCookie(const QNetworkCookie &cookie, bool isJournaled)
+{
+	const QString domain(getRegistrableDomain(cookie.domain()));
+	QHash<QString, QVector<QNetworkCookie> >::iterator bucket(m_cookies.find(domain));
+
+	if (bucket == m_cookies.end())
+	{
+		return false;
+	}
+
+	QVector<QNetworkCookie> &cookies(bucket.value());
+
+	for (int i = 0; i < cookies.count(); ++i)
+	{
+		if (!cookie.hasSameIdentifier(cookies.at(i)))
+		{
+			continue;
+		}
+
+		if (!cookies.at(i).isSessionCookie())
+		{
+			const QMultiMap<QDateTime, QString>::iterator expiration(m_expirations.find(cookies.at(i).expirationDate(), domain));
+
+			if (expiration != m_expirations.end())
+			{
+				m_expirations.erase(expiration);
+			}
 
-	const QList<QNetworkCookie> cookies(getCookiesForUrl(url));
+			if (isJournaled)
+			{
+				writeRecord(RemoveRecord, cookies.at(i));
+			}
+		}
+
+		cookies.removeAt(i);
+
+		if (cookies.isEmpty())
+		{
+			m_cookies.erase(bucket);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+bool CookieJar::replaceCookie(const QNetworkCookie &cookie)
+{
+	if (removeCookie(cookie))
+	{
+		return addCookie(cookie);
+	}
+
+	return false;
+}
+
+bool CookieJar::hasCookie(const QNetworkCookie &cookie) const
+{
+	const QVector<QNetworkCookie> cookies(m_cookies.value(getRegistrableDomain(cookie.domain())));
 
 	for (int i = 0; i < cookies.count(); ++i)
 	{
@@ -368,6 +679,50 @@ bool CookieJar::hasCookie(const QNetworkCookie &cookie) const
 	return false;
 }
 
+QString CookieJar::getRegistrableDomain(const QString &host)
+{
+	const QString domain((host.startsWith(QLatin1Char('.')) ? host.mid(1) : host).toLower());
+	QUrl url;
+	url.setScheme(QLatin1String("http"));
+	url.setHost(domain);
+
+	const QString topLevelDomain(url.topLevelDomain());
+
+	if (topLevelDomain.isEmpty() || topLevelDomain.length() >= (domain.length() + 1))
+	{
+		return domain;
+	}
+
+	const QString label(domain.left(domain.length() - topLevelDomain.length()).section(QLatin1Char('.'), -1));
+
+	return (label.isEmpty() ? domain : (label + topLevelDomain));
+}
+
+bool CookieJar::isParentDomain(const QString &domain, const QString &reference)
+{
+	if (!reference.startsWith(QLatin1Char('.')))
+	{
+		return (domain == reference);
+	}
+
+	return (domain.endsWith(reference) || domain == reference.midRef(1));
+}
+
+bool CookieJar::isParentPath(const QString &path, const QString &reference)
+{
+	if ((path.isEmpty() && reference == QLatin1String("/")) || path.startsWith(reference))
+	{
+		if (path.length() == reference.length() || reference.endsWith(QLatin1Char('/')))
+		{
+			return true;
+		}
+
+		return (path.length() > reference.length() && path.at(reference.length()) == QLatin1Char('/'));
+	}
+
+	return false;
+}
+
 bool CookieJar::isDomainTheSame(const QUrl &first, const QUrl &second)
 {
 	const QString firstTld(first.topLevelDomain());
@@ -20,6 +20,11 @@
 #ifndef OTTER_COOKIEJAR_H
 #define OTTER_COOKIEJAR_H
 
+#include "JournalFile.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
 #include <QtNetwork/QNetworkCookie>
 #include <QtNetwork/QNetworkCookieJar>
 
@@ -67,23 +72,47 @@ public:
 	bool forceUpdateCookie(const QNetworkCookie &cookie);
 	bool forceDeleteCookie(const QNetworkCookie &cookie);
 	bool hasCookie(const QNetworkCookie &cookie) const;
+	static QString getRegistrableDomain(const QString &host);
 	static bool isDomainTheSame(const QUrl &first, const QUrl &second);
 
 protected:
+	enum RecordType : quint8
+	{
+		InsertRecord = 1,
+		UpdateRecord,
+		RemoveRecord
+	};
+
 	void timerEvent(QTimerEvent *event) override;
-	void loadCookies(const QString &path);
+	void loadJournal();
+	void loadLegacyCookies(const QString &path);
+	void compactJournal();
+	void writeRecord(RecordType type, const QNetworkCookie &cookie);
+	void removeExpiredCookies();
+	void scheduleExpirationCheck();
 	void scheduleSave();
 	void save();
+	bool addCookie(const QNetworkCookie &cookie);
+	bool removeCookie(const QNetworkCookie &cookie, bool isJournaled = true);
+	bool replaceCookie(const QNetworkCookie &cookie);
+	static bool isParentDomain(const QString &domain, const QString &reference);
+	static bool isParentPath(const QString &path, const QString &reference);
 
 protected slots:
 	void handleOptionChanged(int identifier, const QVariant &value);
 
 private:
 	QString m_path;
+	JournalFile *m_journal;
+	QHash<QString, QVector<QNetworkCookie> > m_cookies;
+	QMultiMap<QDateTime, QString> m_expirations;
+	QDateTime m_nextExpiration;
 	CookiesPolicy m_generalCookiesPolicy;
 	CookiesPolicy m_thirdPartyCookiesPolicy;
 	KeepMode m_keepMode;
+	int m_expirationTimer;
 	int m_saveTimer;
+	bool m_isLoading;
 
 signals:
 	void cookieAdded(const QNetworkCookie &cookie);
@@ -0,0 +1,518 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "FaviconsDatabase.h"
+#include "Console.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QSaveFile>
+#include <QtGui/QPainter>
+
+#include <cstring>
+
+namespace Otter
+{
+
+const quint32 FaviconsDatabase::m_magic(0x4f544649);
+const quint32 FaviconsDatabase::m_version(2);
+const int FaviconsDatabase::m_hashSize(16);
+const int FaviconsDatabase::m_cacheSize(256);
+const QVector<int> FaviconsDatabase::m_iconSizes({16, 32, 48});
+
+FaviconsDatabase::FaviconsDatabase(const QString &path, bool isReadOnly) : m_file(path),
+	m_cache(m_cacheSize),
+	m_data(nullptr),
+	m_size(0),
+	m_recordsAmount(0)
+{
+	load(isReadOnly);
+
+	if (!isReadOnly && needsCompaction())
+	{
+		compact();
+	}
+}
+
+FaviconsDatabase::~FaviconsDatabase()
+{
+	unmap();
+
+	m_file.close();
+}
+
+void FaviconsDatabase::load(bool isReadOnly)
+{
+	if (!m_file.open(isReadOnly ? QIODevice::ReadOnly : QIODevice::ReadWrite))
+	{
+		if (!isReadOnly || m_file.exists())
+		{
+			Console::addMessage(QCoreApplication::translate("main", "Failed to open favicons database: %1").arg(m_file.errorString()), Console::OtherCategory, Console::ErrorLevel, m_file.fileName());
+		}
+
+		return;
+	}
+
+	if (m_file.size() == 0 && (!m_file.isWritable() || !writeHeader()))
+	{
+		return;
+	}
+
+	if (!map())
+	{
+		return;
+	}
+
+	FileHeader header;
+
+	if (m_size >= static_cast<qint64>(sizeof(FileHeader)))
+	{
+		std::memcpy(&header, m_data, sizeof(FileHeader));
+	}
+
+	if (header.magic != m_magic || header.version != m_version)
+	{
+		Console::addMessage(QCoreApplication::translate("main", "Failed to load favicons database: invalid header"), Console::OtherCategory, Console::ErrorLevel, m_file.fileName());
+
+		unmap();
+
+		if (m_file.isWritable() && m_file.resize(0) && writeHeader())
+		{
+			map();
+		}
+
+		return;
+	}
+
+	qint64 position(sizeof(FileHeader));
+
+	while ((position + static_cast<qint64>(sizeof(RecordHeader))) <= m_size)
+	{
+		RecordHeader recordHeader;
+
+		std::memcpy(&recordHeader, (m_data + position), sizeof(RecordHeader));
+
+		const qint64 dataPosition(position + static_cast<qint64>(sizeof(RecordHeader)));
+
+		if (recordHeader.size < static_cast<quint32>(m_hashSize) || (dataPosition + recordHeader.size) > m_size)
+		{
+			break;
+		}
+
+		const QByteArray hash(reinterpret_cast<const char*>(m_data + dataPosition), m_hashSize);
+
+		if (recordHeader.type == IconRecord && recordHeader.size == (m_hashSize + getIconDataSize()))
+		{
+			m_icons[hash] = (dataPosition + m_hashSize);
+		}
+		else if (recordHeader.type == KeyRecord)
+		{
+			const QString key(QString::fromUtf8(reinterpret_cast<const char*>(m_data + dataPosition + m_hashSize), static_cast<int>(recordHeader.size - m_hashSize)));
+
+			if (hash.count('\0') == m_hashSize)
+			{
+				m_keys.remove(key);
+			}
+			else
+			{
+				m_keys[key] = hash;
+			}
+		}
+		else
+		{
+			break;
+		}
+
+		++m_recordsAmount;
+
+		position = (dataPosition + getAlignedSize(recordHeader.size));
+	}
+
+	if (position < m_size)
+	{
+		Console::addMessage(QCoreApplication::translate("main", "Favicons database is truncated, discarding incomplete records"), Console::OtherCategory, Console::WarningLevel, m_file.fileName());
+
+		if (m_file.isWritable())
+		{
+			unmap();
+
+			m_file.resize(position);
+
+			map();
+		}
+	}
+}
+
+void FaviconsDatabase::unmap()
+{
+	if (m_data)
+	{
+		m_file.unmap(m_data);
+
+		m_data = nullptr;
+		m_size = 0;
+	}
+}
+
+void FaviconsDatabase::setIcon(const QUrl &url, const QIcon &icon)
+{
+	if (icon.isNull() || url.host().isEmpty() || !m_file.isWritable())
+	{
+		return;
+	}
+
+	const QByteArray data(createIconData(icon));
+
+	if (data.isEmpty())
+	{
+		return;
+	}
+
+	const QByteArray hash(QCryptographicHash::hash(data, QCryptographicHash::Md5));
+
+	if (!m_icons.contains(hash))
+	{
+		const qint64 position(m_file.size() + static_cast<qint64>(sizeof(RecordHeader)) + m_hashSize);
+
+		if (!addRecord(IconRecord, (hash + data)))
+		{
+			return;
+		}
+
+		m_icons[hash] = position;
+	}
+
+	setKey(createHostKey(url.host()), hash);
+}
+
+void FaviconsDatabase::clear()
+{
+	m_cache.clear();
+	m_icons.clear();
+	m_keys.clear();
+
+	m_recordsAmount = 0;
+
+	if (m_file.isWritable())
+	{
+		unmap();
+
+		if (m_file.resize(0) && writeHeader())
+		{
+			map();
+		}
+	}
+}
+
+void FaviconsDatabase::retainHosts(const QSet<QString> &hosts)
+{
+	if (!m_file.isWritable())
+	{
+		return;
+	}
+
+	const QByteArray removedHash(m_hashSize, 0);
+	const QStringList keys(m_keys.keys());
+
+	for (int i = 0; i < keys.count(); ++i)
+	{
+		if (!hosts.contains(keys.at(i)) && setKey(keys.at(i), removedHash))
+		{
+			m_keys.remove(keys.at(i));
+		}
+	}
+
+	if (needsCompaction())
+	{
+		compact();
+	}
+}
+
+void FaviconsDatabase::compact()
+{
+	m_file.flush();
+
+	if (!map())
+	{
+		return;
+	}
+
+	QByteArray data;
+	FileHeader header;
+	header.magic = m_magic;
+	header.version = m_version;
+
+	data.append(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+
+	QSet<QByteArray> hashes;
+	QHash<QString, QByteArray>::const_iterator iterator;
+
+	for (iterator = m_keys.constBegin(); iterator != m_keys.constEnd(); ++iterator)
+	{
+		if (!m_icons.contains(iterator.value()))
+		{
+			continue;
+		}
+
+		if (!hashes.contains(iterator.value()))
+		{
+			hashes.insert(iterator.value());
+
+			data.append(createRecord(IconRecord, (iterator.value() + QByteArray(reinterpret_cast<const char*>(m_data + m_icons[iterator.value()]), static_cast<int>(getIconDataSize())))));
+		}
+
+		data.append(createRecord(KeyRecord, (iterator.value() + iterator.key().toUtf8())));
+	}
+
+	unmap();
+
+	m_file.close();
+
+	m_cache.clear();
+	m_icons.clear();
+	m_keys.clear();
+
+	m_recordsAmount = 0;
+
+	QSaveFile file(m_file.fileName());
+
+	if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+	{
+		Console::addMessage(QCoreApplication::translate("main", "Failed to compact favicons database: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, m_file.fileName());
+	}
+
+	load(false);
+}
+
+QString FaviconsDatabase::createHostKey(const QString &host)
+{
+	return host.toLower();
+}
+
+QIcon FaviconsDatabase::getIcon(const QUrl &url)
+{
+	return getIcon(url.host());
+}
+
+QIcon FaviconsDatabase::getIcon(const QString &host)
+{
+	return (host.isEmpty() ? QIcon() : getIconByKey(createHostKey(host)));
+}
+
+QIcon FaviconsDatabase::getIconByKey(const QString &key)
+{
+	const QByteArray hash(m_keys.value(key));
+
+	if (hash.isEmpty())
+	{
+		return {};
+	}
+
+	const QIcon *cachedIcon(m_cache.object(hash));
+
+	if (cachedIcon)
+	{
+		return *cachedIcon;
+	}
+
+	if (!m_icons.contains(hash))
+	{
+		return {};
+	}
+
+	if ((m_icons[hash] + getIconDataSize()) > m_size)
+	{
+		m_file.flush();
+
+		map();
+	}
+
+	if (!m_data)
+	{
+		return {};
+	}
+
+	const uchar *data(m_data + m_icons[hash]);
+	QIcon icon;
+
+	for (int i = 0; i < m_iconSizes.count(); ++i)
+	{
+		const int size(m_iconSizes.at(i));
+
+		icon.addPixmap(QPixmap::fromImage(QImage(data, size, size, QImage::Format_ARGB32_Premultiplied).copy()));
+
+		data += (size * size * 4);
+	}
+
+	m_cache.insert(hash, new QIcon(icon));
+
+	return icon;
+}
+
+QByteArray FaviconsDatabase::createIconData(const QIcon &icon)
+{
+	QByteArray data;
+	data.reserve(static_cast<int>(getIconDataSize()));
+
+	for (int i = 0; i < m_iconSizes.count(); ++i)
+	{
+		const int size(m_iconSizes.at(i));
+		const QPixmap pixmap(icon.pixmap(size, size));
+
+		if (pixmap.isNull())
+		{
+			return {};
+		}
+
+		QImage scaledImage(pixmap.toImage().scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+		scaledImage.setDevicePixelRatio(1);
+
+		QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+		image.fill(Qt::transparent);
+
+		QPainter painter(&image);
+		painter.drawImage(((size - scaledImage.width()) / 2), ((size - scaledImage.height()) / 2), scaledImage);
+		painter.end();
+
+		data.append(reinterpret_cast<const char*>(image.constBits()), (size * size * 4));
+	}
+
+	return data;
+}
+
+qint64 FaviconsDatabase::getIconDataSize()
+{
+	qint64 size(0);
+
+	for (int i = 0; i < m_iconSizes.count(); ++i)
+	{
+		size += (m_iconSizes.at(i) * m_iconSizes.at(i) * 4);
+	}
+
+	return size;
+}
+
+QByteArray FaviconsDatabase::createRecord(RecordType type, const QByteArray &data)
+{
+	RecordHeader header;
+	header.type = type;
+	header.size = static_cast<quint32>(data.size());
+
+	QByteArray record(static_cast<int>(sizeof(RecordHeader) + getAlignedSize(data.size())), 0);
+
+	std::memcpy(record.data(), &header, sizeof(RecordHeader));
+	std::memcpy((record.data() + sizeof(RecordHeader)), data.constData(), static_cast<size_t>(data.size()));
+
+	return record;
+}
+
+qint64 FaviconsDatabase::getAlignedSize(qint64 size)
+{
+	return ((size + 3) & ~static_cast<qint64>(3));
+}
+
+bool FaviconsDatabase::map()
+{
+	unmap();
+
+	m_size = m_file.size();
+
+	if (m_size <= 0)
+	{
+		m_size = 0;
+
+		return false;
+	}
+
+	m_data = m_file.map(0, m_size);
+
+	if (!m_data)
+	{
+		Console::addMessage(QCoreApplication::translate("main", "Failed to map favicons database: %1").arg(m_file.errorString()), Console::OtherCategory, Console::ErrorLevel, m_file.fileName());
+
+		m_size = 0;
+
+		return false;
+	}
+
+	return true;
+}
+
+bool FaviconsDatabase::addRecord(RecordType type, const QByteArray &data)
+{
+	const QByteArray record(createRecord(type, data));
+	const qint64 position(m_file.size());
+
+	if (!m_file.seek(position) || m_file.write(record) != record.size())
+	{
+		Console::addMessage(QCoreApplication::translate("main", "Failed to write favicons database: %1").arg(m_file.errorString()), Console::OtherCategory, Console::ErrorLevel, m_file.fileName());
+
+		unmap();
+
+		m_file.resize(position);
+
+		map();
+
+		return false;
+	}
+
+	++m_recordsAmount;
+
+	return true;
+}
+
+bool FaviconsDatabase::setKey(const QString &key, const QByteArray &hash)
+{
+	if (m_keys.value(key) == hash)
+	{
+		return true;
+	}
+
+	if (!addRecord(KeyRecord, (hash + key.toUtf8())))
+	{
+		return false;
+	}
+
+	m_keys[key] = hash;
+
+	return true;
+}
+
+bool FaviconsDatabase::writeHeader()
+{
+	FileHeader header;
+	header.magic = m_magic;
+	header.version = m_version;
+
+	return (m_file.seek(0) && m_file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader)) == static_cast<qint64>(sizeof(FileHeader)) && m_file.flush());
+}
+
+bool FaviconsDatabase::needsCompaction() const
+{
+	const int liveRecordsAmount(m_keys.count() * 2);
+
+	return (m_recordsAmount > 100 && m_recordsAmount > (liveRecordsAmount * 2));
+}
+
+bool FaviconsDatabase::hasIcon(const QUrl &url) const
+{
+	return (!url.host().isEmpty() && m_keys.contains(createHostKey(url.host())));
+}
+
+}
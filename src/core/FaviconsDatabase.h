@@ -0,0 +1,98 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_FAVICONSDATABASE_H
+#define OTTER_FAVICONSDATABASE_H
+
+#include <QtCore/QCache>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QUrl>
+#include <QtGui/QIcon>
+
+namespace Otter
+{
+
+class FaviconsDatabase final
+{
+public:
+	explicit FaviconsDatabase(const QString &path, bool isReadOnly = false);
+	~FaviconsDatabase();
+
+	void setIcon(const QUrl &url, const QIcon &icon);
+	void clear();
+	void retainHosts(const QSet<QString> &hosts);
+	QIcon getIcon(const QUrl &url);
+	QIcon getIcon(const QString &host);
+	bool hasIcon(const QUrl &url) const;
+
+protected:
+	enum RecordType : quint32
+	{
+		IconRecord = 1,
+		KeyRecord
+	};
+
+	struct FileHeader final
+	{
+		quint32 magic = 0;
+		quint32 version = 0;
+	};
+
+	struct RecordHeader final
+	{
+		quint32 type = 0;
+		quint32 size = 0;
+	};
+
+	void load(bool isReadOnly);
+	void unmap();
+	void compact();
+	QIcon getIconByKey(const QString &key);
+	static QString createHostKey(const QString &host);
+	static QByteArray createIconData(const QIcon &icon);
+	static QByteArray createRecord(RecordType type, const QByteArray &data);
+	static qint64 getIconDataSize();
+	static qint64 getAlignedSize(qint64 size);
+	bool map();
+	bool addRecord(RecordType type, const QByteArray &data);
+	bool setKey(const QString &key, const QByteArray &hash);
+	bool writeHeader();
+	bool needsCompaction() const;
+
+private:
+	QFile m_file;
+	QCache<QByteArray, QIcon> m_cache;
+	QHash<QByteArray, qint64> m_icons;
+	QHash<QString, QByteArray> m_keys;
+	uchar *m_data;
+	qint64 m_size;
+	int m_recordsAmount;
+
+	static const quint32 m_magic;
+	static const quint32 m_version;
+	static const int m_hashSize;
+	static const int m_cacheSize;
+	static const QVector<int> m_iconSizes;
+};
+
+}
+
+#endif
@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2018 - 2019 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2018 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -98,9 +98,9 @@ AtomFeedParser::AtomFeedParser() : FeedParser()
 	m_information.mimeType = QMimeDatabase().mimeTypeForName(QLatin1String("application/atom+xml"));
 }
 
-void AtomFeedParser::parse(DataFetchJob *data)
+bool AtomFeedParser::parse(const QByteArray &data, const QUrl &url)
 {
-	QXmlStreamReader reader(data->getData());
+	QXmlStreamReader reader(data);
 	bool isSuccess(true);
 
 	m_information.entries.reserve(10);
@@ -219,7 +219,7 @@ void AtomFeedParser::parse(DataFetchJob *data)
 
 			if (reader.hasError())
 			{
-				Console::addMessage(tr("Failed to parse feed file: %1").arg(reader.errorString()), Console::OtherCategory, Console::ErrorLevel, data->getUrl().toDisplayString());
+				Console::addMessage(tr("Failed to parse feed file: %1").arg(reader.errorString()), Console::OtherCategory, Console::ErrorLevel, url.toDisplayString());
 
 				isSuccess = false;
 			}
@@ -230,12 +230,12 @@ void AtomFeedParser::parse(DataFetchJob *data)
 
 	if (m_information.entries.isEmpty())
 	{
-		Console::addMessage(tr("Failed to parse feed: no valid entries found"), Console::NetworkCategory, Console::ErrorLevel, data->getUrl().toDisplayString());
+		Console::addMessage(tr("Failed to parse feed: no valid entries found"), Console::NetworkCategory, Console::ErrorLevel, url.toDisplayString());
 
 		isSuccess = false;
 	}
 
-	emit parsingFinished(isSuccess);
+	return isSuccess;
 }
 
 FeedParser::FeedInformation AtomFeedParser::getInformation() const
@@ -256,9 +256,9 @@ RssFeedParser::RssFeedParser() : FeedParser()
 	m_information.mimeType = QMimeDatabase().mimeTypeForName(QLatin1String("application/rss+xml"));
 }
 
-void RssFeedParser::parse(DataFetchJob *data)
+bool RssFeedParser::parse(const QByteArray &data, const QUrl &url)
 {
-	QXmlStreamReader reader(data->getData());
+	QXmlStreamReader reader(data);
 	bool isSuccess(true);
 	QRegularExpression emailExpression(QLatin1String(R"(^[a-zA-Z0-9\._\-]+@[a-zA-Z0-9\._\-]+\.[a-zA-Z0-9]+$)"));
 	emailExpression.optimize();
@@ -382,7 +382,7 @@ void RssFeedParser::parse(DataFetchJob *data)
 
 			if (reader.hasError())
 			{
-				Console::addMessage(tr("Failed to parse feed file: %1").arg(reader.errorString()), Console::OtherCategory, Console::ErrorLevel, data->getUrl().toDisplayString(), static_cast<int>(reader.lineNumber()));
+				Console::addMessage(tr("Failed to parse feed file: %1").arg(reader.errorString()), Console::OtherCategory, Console::ErrorLevel, url.toDisplayString(), static_cast<int>(reader.lineNumber()));
 
 				isSuccess = false;
 			}
@@ -393,12 +393,12 @@ void RssFeedParser::parse(DataFetchJob *data)
 
 	if (m_information.entries.isEmpty())
 	{
-		Console::addMessage(tr("Failed to parse feed: no valid entries found"), Console::NetworkCategory, Console::ErrorLevel, data->getUrl().toDisplayString());
+		Console::addMessage(tr("Failed to parse feed: no valid entries found"), Console::NetworkCategory, Console::ErrorLevel, url.toDisplayString());
 
 		isSuccess = false;
 	}
 
-	emit parsingFinished(isSuccess);
+	return isSuccess;
 }
 
 FeedParser::FeedInformation RssFeedParser::getInformation() const
@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2018 - 2019 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2018 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -55,15 +55,12 @@ public:
 
 	explicit FeedParser();
 
-	virtual void parse(DataFetchJob *data) = 0;
+	virtual bool parse(const QByteArray &data, const QUrl &url) = 0;
 	virtual FeedInformation getInformation() const = 0;
 	static FeedParser* createParser(Feed *feed, DataFetchJob *data);
 
 protected:
 	static QString createIdentifier(const Feed::Entry &entry);
-
-signals:
-	void parsingFinished(bool isSuccess);
 };
 
 class AtomFeedParser final : public FeedParser
@@ -71,7 +68,7 @@ class AtomFeedParser final : public FeedParser
 public:
 	explicit AtomFeedParser();
 
-	void parse(DataFetchJob *data) override;
+	bool parse(const QByteArray &data, const QUrl &url) override;
 	FeedInformation getInformation() const override;
 
 protected:
@@ -86,7 +83,7 @@ class RssFeedParser final : public FeedParser
 public:
 	explicit RssFeedParser();
 
-	void parse(DataFetchJob *data) override;
+	bool parse(const QByteArray &data, const QUrl &url) override;
 	FeedInformation getInformation() const override;
 
 protected:
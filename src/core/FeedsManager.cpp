@@ -33,6 +33,9 @@
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
 #include <QtCore/QSaveFile>
+#include <QtCore/QSet>
+
+#include <algorithm>
 
 namespace Otter
 {
@@ -167,6 +170,12 @@ void Feed::setEntries(const QVector<Feed::Entry> &entries)
 	m_entries = entries;
 }
 
+void Feed::setValidators(const QString &entityTag, const QString &lastModified)
+{
+	m_entityTag = entityTag;
+	m_lastModified = lastModified;
+}
+
 void Feed::setUpdateInterval(int interval)
 {
 	if (interval == m_updateInterval)
@@ -187,7 +196,10 @@ void Feed::setUpdateInterval(int interval)
 		{
 			m_updateTimer = new LongTermTimer(this);
 
-			connect(m_updateTimer, &LongTermTimer::timeout, this, &Feed::update);
+			connect(m_updateTimer, &LongTermTimer::timeout, this, [&]()
+			{
+				FeedsManager::scheduleUpdate(this);
+			});
 		}
 
 		m_updateTimer->start(static_cast<quint64>(interval) * 60000);
@@ -198,7 +210,7 @@ void Feed::setUpdateInterval(int interval)
 
 void Feed::update()
 {
-	if (m_parser)
+	if (m_isUpdating)
 	{
 		return;
 	}
@@ -210,6 +222,19 @@ void Feed::update()
 
 	DataFetchJob *dataJob(new DataFetchJob(m_url, this));
 
+	if (!m_entries.isEmpty())
+	{
+		if (!m_entityTag.isEmpty())
+		{
+			dataJob->setHeader(QByteArrayLiteral("If-None-Match"), m_entityTag.toLatin1());
+		}
+
+		if (!m_lastModified.isEmpty())
+		{
+			dataJob->setHeader(QByteArrayLiteral("If-Modified-Since"), m_lastModified.toLatin1());
+		}
+	}
+
 	connect(dataJob, &DataFetchJob::progressChanged, this, [&](int progress)
 	{
 		m_updateProgress = progress;
@@ -230,10 +255,26 @@ void Feed::update()
 			return;
 		}
 
+		m_updateProgress = -1;
+
+		emit updateProgressChanged(-1);
+
+		if (dataJob->getStatusCode() == 304)
+		{
+			m_lastSynchronizationTime = QDateTime::currentDateTimeUtc();
+			m_isUpdating = false;
+
+			emit feedModified(this);
+
+			return;
+		}
+
 		m_parser = FeedParser::createParser(this, dataJob);
 
 		if (!m_parser)
 		{
+			m_entityTag.clear();
+			m_lastModified.clear();
 			m_error = ParseError;
 			m_isUpdating = false;
 
@@ -244,148 +285,183 @@ void Feed::update()
 			return;
 		}
 
-		m_parser->moveToThread(&m_parserThread);
+		FeedParser *parser(m_parser);
+		const QByteArray data(dataJob->getData()->readAll());
+		const QUrl url(dataJob->getUrl());
+		const QString entityTag(QString::fromLatin1(dataJob->getHeader(QByteArrayLiteral("ETag"))));
+		const QString lastModified(QString::fromLatin1(dataJob->getHeader(QByteArrayLiteral("Last-Modified"))));
 
-		connect(m_parser, &FeedParser::parsingFinished, m_parser, [&](bool isParsingSuccess)
+		FeedsManager::getThreadPool()->start([=]()
 		{
-			const FeedParser::FeedInformation information(m_parser->getInformation());
+			const bool isSuccess(parser->parse(data, url));
 
-			if (!isParsingSuccess)
+			QMetaObject::invokeMethod(this, [=]()
 			{
-				m_error = ParseError;
-			}
-
-			if (m_icon.isNull() && information.icon.isValid())
-			{
-				IconFetchJob *iconJob(new IconFetchJob(information.icon, this));
-
-				connect(iconJob, &IconFetchJob::jobFinished, this, [=](bool isIconFetchSuccess)
+				if (m_parser == parser)
 				{
-					if (isIconFetchSuccess)
-					{
-						setIcon(iconJob->getIcon());
-					}
-				});
+					m_entityTag = (isSuccess ? entityTag : QString());
+					m_lastModified = (isSuccess ? lastModified : QString());
+				}
 
-				iconJob->start();
-			}
+				handleParsingFinished(isSuccess);
+			}, Qt::QueuedConnection);
+		});
+	});
 
-			if (m_title.isEmpty())
-			{
-				m_title = information.title;
-			}
+	dataJob->start();
+}
 
-			if (m_description.isEmpty())
-			{
-				m_description = information.description;
-			}
+void Feed::handleParsingFinished(bool isSuccess)
+{
+	if (!m_parser)
+	{
+		return;
+	}
 
-			if (!information.entries.isEmpty())
-			{
-				QStringList existingRemovedEntries;
-				int amount(0);
+	const FeedParser::FeedInformation information(m_parser->getInformation());
 
-				for (int i = (information.entries.count() - 1); i >= 0; --i)
-				{
-					Feed::Entry entry(information.entries.at(i));
+	if (!isSuccess)
+	{
+		m_error = ParseError;
+	}
 
-					if (m_removedEntries.contains(entry.identifier))
-					{
-						existingRemovedEntries.append(entry.identifier);
+	if (m_icon.isNull() && information.icon.isValid())
+	{
+		IconFetchJob *iconJob(new IconFetchJob(information.icon, this));
 
-						continue;
-					}
+		connect(iconJob, &IconFetchJob::jobFinished, this, [=](bool isIconFetchSuccess)
+		{
+			if (isIconFetchSuccess)
+			{
+				setIcon(iconJob->getIcon());
+			}
+		});
 
-					bool hasEntry(false);
+		iconJob->start();
+	}
 
-					for (int j = 0; j < m_entries.count(); ++j)
-					{
-						const Feed::Entry existingEntry(m_entries.at(j));
+	if (m_title.isEmpty())
+	{
+		m_title = information.title;
+	}
 
-						if (existingEntry.identifier != entry.identifier)
-						{
-							continue;
-						}
+	if (m_description.isEmpty())
+	{
+		m_description = information.description;
+	}
 
-						if ((entry.publicationTime.isValid() && existingEntry.publicationTime != entry.publicationTime) || (entry.updateTime.isValid() && existingEntry.updateTime != entry.updateTime))
-						{
-							++amount;
-						}
+	if (!information.entries.isEmpty())
+	{
+		const QSet<QString> removedEntries(m_removedEntries.begin(), m_removedEntries.end());
+		QHash<QString, int> existingEntries;
+		QHash<QString, int> addedEntries;
+		QVector<Feed::Entry> entries;
+		QStringList existingRemovedEntries;
+		int amount(0);
 
-						entry.lastReadTime = existingEntry.lastReadTime;
-						entry.publicationTime = normalizeDateTime(entry.publicationTime);
+		existingEntries.reserve(m_entries.count());
 
-						if (entry.updateTime.isValid())
-						{
-							entry.updateTime = normalizeDateTime(entry.updateTime);
-						}
+		for (int i = 0; i < m_entries.count(); ++i)
+		{
+			if (!existingEntries.contains(m_entries.at(i).identifier))
+			{
+				existingEntries[m_entries.at(i).identifier] = i;
+			}
+		}
 
-						m_entries[j] = entry;
+		for (int i = (information.entries.count() - 1); i >= 0; --i)
+		{
+			Feed::Entry entry(information.entries.at(i));
 
-						hasEntry = true;
+			if (removedEntries.contains(entry.identifier))
+			{
+				existingRemovedEntries.append(entry.identifier);
 
-						break;
-					}
+				continue;
+			}
 
-					if (!hasEntry)
-					{
-						++amount;
+			Feed::Entry *existingEntry(nullptr);
 
-						entry.publicationTime = normalizeDateTime(entry.publicationTime);
-						entry.updateTime = normalizeDateTime(entry.updateTime);
+			if (existingEntries.contains(entry.identifier))
+			{
+				existingEntry = &m_entries[existingEntries.value(entry.identifier)];
+			}
+			else if (addedEntries.contains(entry.identifier))
+			{
+				existingEntry = &entries[addedEntries.value(entry.identifier)];
+			}
 
-						m_entries.prepend(entry);
-					}
+			if (existingEntry)
+			{
+				if ((entry.publicationTime.isValid() && existingEntry->publicationTime != entry.publicationTime) || (entry.updateTime.isValid() && existingEntry->updateTime != entry.updateTime))
+				{
+					++amount;
 				}
 
-				m_removedEntries = existingRemovedEntries;
+				entry.lastReadTime = existingEntry->lastReadTime;
+				entry.publicationTime = normalizeDateTime(entry.publicationTime);
 
-				if (amount > 0)
+				if (entry.updateTime.isValid())
 				{
-					Notification::Message message;
-					message.message = getTitle() + QLatin1Char('\n') + tr("%n new message(s)", nullptr, amount);
-					message.icon = getIcon();
-					message.event = NotificationsManager::FeedUpdatedEvent;
-
-					if (message.icon.isNull())
-					{
-						message.icon = ThemesManager::createIcon(QLatin1String("application-rss+xml"));
-					}
-
-					connect(NotificationsManager::createNotification(message, this), &Notification::clicked, this, [&]()
-					{
-						Application::getInstance()->triggerAction(ActionsManager::OpenUrlAction, {{QLatin1String("url"), FeedsManager::createFeedReaderUrl(getUrl())}});
-					});
+					entry.updateTime = normalizeDateTime(entry.updateTime);
 				}
 
-				emit entriesModified(this);
+				*existingEntry = entry;
+
+				continue;
 			}
 
-			m_mimeType = information.mimeType;
-			m_lastSynchronizationTime = QDateTime::currentDateTimeUtc();
-			m_lastUpdateTime = information.lastUpdateTime;
-			m_categories = information.categories;
+			++amount;
 
-			m_parserThread.exit();
+			entry.publicationTime = normalizeDateTime(entry.publicationTime);
+			entry.updateTime = normalizeDateTime(entry.updateTime);
 
-			m_parser->deleteLater();
-			m_parser = nullptr;
+			addedEntries[entry.identifier] = entries.count();
 
-			m_isUpdating = false;
+			entries.append(entry);
+		}
 
-			emit feedModified(this);
-		});
+		if (!entries.isEmpty())
+		{
+			std::reverse(entries.begin(), entries.end());
 
-		m_parserThread.start();
+			m_entries = (entries + m_entries);
+		}
 
-		m_parser->parse(dataJob);
+		m_removedEntries = existingRemovedEntries;
 
-		m_updateProgress = -1;
+		if (amount > 0)
+		{
+			Notification::Message message;
+			message.message = getTitle() + QLatin1Char('\n') + tr("%n new message(s)", nullptr, amount);
+			message.icon = getIcon();
+			message.event = NotificationsManager::FeedUpdatedEvent;
 
-		emit updateProgressChanged(-1);
-	});
+			if (message.icon.isNull())
+			{
+				message.icon = ThemesManager::createIcon(QLatin1String("application-rss+xml"));
+			}
 
-	dataJob->start();
+			connect(NotificationsManager::createNotification(message, this), &Notification::clicked, this, [&]()
+			{
+				Application::getInstance()->triggerAction(ActionsManager::OpenUrlAction, {{QLatin1String("url"), FeedsManager::createFeedReaderUrl(getUrl())}});
+			});
+		}
+
+		emit entriesModified(this);
+	}
+
+	m_mimeType = information.mimeType;
+	m_lastSynchronizationTime = QDateTime::currentDateTimeUtc();
+	m_lastUpdateTime = information.lastUpdateTime;
+	m_categories = information.categories;
+
+	m_parser->deleteLater();
+	m_parser = nullptr;
+
+	m_isUpdating = false;
+
+	emit feedModified(this);
 }
 
 QString Feed::getTitle() const
@@ -398,6 +474,16 @@ QString Feed::getDescription() const
 	return m_description;
 }
 
+QString Feed::getEntityTag() const
+{
+	return m_entityTag;
+}
+
+QString Feed::getLastModified() const
+{
+	return m_lastModified;
+}
+
 QUrl Feed::getUrl() const
 {
 	return m_url;
@@ -511,11 +597,17 @@ bool Feed::isUpdating() const
 FeedsManager* FeedsManager::m_instance(nullptr);
 FeedsModel* FeedsManager::m_model(nullptr);
 QVector<Feed*> FeedsManager::m_feeds;
+QQueue<QPointer<Feed> > FeedsManager::m_updatesQueue;
+const int FeedsManager::m_updatesInterval(250);
+const int FeedsManager::m_updatesLimit(4);
 bool FeedsManager::m_isInitialized(false);
 
 FeedsManager::FeedsManager(QObject *parent) : QObject(parent),
-	m_saveTimer(0)
+	m_threadPool(new QThreadPool(this)),
+	m_saveTimer(0),
+	m_updateTimer(0)
 {
+	m_threadPool->setMaxThreadCount(qBound(1, (QThread::idealThreadCount() / 2), 4));
 }
 
 void FeedsManager::timerEvent(QTimerEvent *event)
@@ -528,6 +620,37 @@ void FeedsManager::timerEvent(QTimerEvent *event)
 
 		save();
 	}
+	else if (event->timerId() == m_updateTimer)
+	{
+		int updatingFeedsAmount(0);
+
+		for (int i = 0; i < m_feeds.count(); ++i)
+		{
+			if (m_feeds.at(i)->isUpdating())
+			{
+				++updatingFeedsAmount;
+			}
+		}
+
+		while (updatingFeedsAmount < m_updatesLimit && !m_updatesQueue.isEmpty())
+		{
+			Feed *feed(m_updatesQueue.dequeue());
+
+			if (feed && !feed->isUpdating())
+			{
+				feed->update();
+
+				break;
+			}
+		}
+
+		if (m_updatesQueue.isEmpty())
+		{
+			killTimer(m_updateTimer);
+
+			m_updateTimer = 0;
+		}
+	}
 }
 
 void FeedsManager::createInstance()
@@ -563,6 +686,7 @@ void FeedsManager::ensureInitialized()
 			feed->setLastUpdateTime(QDateTime::fromString(feedObject.value(QLatin1String("lastUpdateTime")).toString(), Qt::ISODate));
 			feed->setLastSynchronizationTime(QDateTime::fromString(feedObject.value(QLatin1String("lastSynchronizationTime")).toString(), Qt::ISODate));
 			feed->setRemovedEntries(feedObject.value(QLatin1String("removedEntries")).toVariant().toStringList());
+			feed->setValidators(feedObject.value(QLatin1String("entityTag")).toString(), feedObject.value(QLatin1String("lastModified")).toString());
 
 			if (feedObject.contains(QLatin1String("categories")))
 			{
@@ -688,6 +812,16 @@ void FeedsManager::save()
 			feedObject.insert(QLatin1String("categories"), categoriesObject);
 		}
 
+		if (!feed->getEntityTag().isEmpty())
+		{
+			feedObject.insert(QLatin1String("entityTag"), feed->getEntityTag());
+		}
+
+		if (!feed->getLastModified().isEmpty())
+		{
+			feedObject.insert(QLatin1String("lastModified"), feed->getLastModified());
+		}
+
 		if (!feed->getRemovedEntries().isEmpty())
 		{
 			feedObject.insert(QLatin1String("removedEntries"), QJsonArray::fromStringList(feed->getRemovedEntries()));
@@ -822,6 +956,26 @@ QUrl FeedsManager::createFeedReaderUrl(const QUrl &url)
 	return QUrl(QLatin1String("feed:") + url.toDisplayString());
 }
 
+QThreadPool* FeedsManager::getThreadPool()
+{
+	return m_instance->m_threadPool;
+}
+
+void FeedsManager::scheduleUpdate(Feed *feed)
+{
+	if (!feed || feed->isUpdating() || m_updatesQueue.contains(feed))
+	{
+		return;
+	}
+
+	m_updatesQueue.enqueue(feed);
+
+	if (m_instance->m_updateTimer == 0)
+	{
+		m_instance->m_updateTimer = m_instance->startTimer(m_updatesInterval);
+	}
+}
+
 QVector<Feed*> FeedsManager::getFeeds()
 {
 	ensureInitialized();
@@ -24,7 +24,9 @@
 
 #include <QtCore/QDateTime>
 #include <QtCore/QMimeType>
-#include <QtCore/QThread>
+#include <QtCore/QPointer>
+#include <QtCore/QQueue>
+#include <QtCore/QThreadPool>
 
 namespace Otter
 {
@@ -95,14 +97,19 @@ protected:
 	void setCategories(const QMap<QString, QString> &categories);
 	void setRemovedEntries(const QStringList &removedEntries);
 	void setEntries(const QVector<Entry> &entries);
+	void setValidators(const QString &entityTag, const QString &lastModified);
+	void handleParsingFinished(bool isSuccess);
+	QString getEntityTag() const;
+	QString getLastModified() const;
 	static QDateTime normalizeDateTime(const QDateTime &time);
 
 private:
 	LongTermTimer *m_updateTimer;
 	FeedParser *m_parser;
-	QThread m_parserThread;
 	QString m_title;
 	QString m_description;
+	QString m_entityTag;
+	QString m_lastModified;
 	QUrl m_url;
 	QIcon m_icon;
 	QDateTime m_lastUpdateTime;
@@ -135,7 +142,9 @@ public:
 	static Feed* createFeed(const QUrl &url, const QString &title = {}, const QIcon &icon = {}, int updateInterval = -1);
 	static Feed* getFeed(const QUrl &url);
 	static QUrl createFeedReaderUrl(const QUrl &url);
+	static QThreadPool* getThreadPool();
 	static QVector<Feed*> getFeeds();
+	static void scheduleUpdate(Feed *feed);
 
 protected:
 	explicit FeedsManager(QObject *parent);
@@ -148,11 +157,16 @@ protected slots:
 	void scheduleSave();
 
 private:
+	QThreadPool *m_threadPool;
 	int m_saveTimer;
+	int m_updateTimer;
 
 	static FeedsManager *m_instance;
 	static FeedsModel *m_model;
 	static QVector<Feed*> m_feeds;
+	static QQueue<QPointer<Feed> > m_updatesQueue;
+	static const int m_updatesInterval;
+	static const int m_updatesLimit;
 	static bool m_isInitialized;
 
 signals:
@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2013 - 2021 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2013 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 * Copyright (C) 2017 Jan Bajer aka bajasoft <jbajer@gmail.com>
 *
 * This program is free software: you can redistribute it and/or modify
@@ -21,6 +21,7 @@
 #include "HistoryManager.h"
 #include "AddonsManager.h"
 #include "Application.h"
+#include "FaviconsDatabase.h"
 #include "SessionsManager.h"
 #include "SettingsManager.h"
 #include "ThemesManager.h"
@@ -31,12 +32,14 @@ namespace Otter
 {
 
 HistoryManager* HistoryManager::m_instance(nullptr);
+FaviconsDatabase* HistoryManager::m_faviconsDatabase(nullptr);
 HistoryModel* HistoryManager::m_browsingHistoryModel(nullptr);
 HistoryModel* HistoryManager::m_typedHistoryModel(nullptr);
 bool HistoryManager::m_isEnabled(false);
 bool HistoryManager::m_isStoringFavicons(true);
 
 HistoryManager::HistoryManager(QObject *parent) : QObject(parent),
+	m_faviconsTimer(0),
 	m_saveTimer(0)
 {
 	m_dayTimer = startTimer(QTime::currentTime().msecsTo(QTime(23, 59, 59, 999)));
@@ -47,6 +50,13 @@ HistoryManager::HistoryManager(QObject *parent) : QObject(parent),
 	connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, &HistoryManager::handleOptionChanged);
 }
 
+HistoryManager::~HistoryManager()
+{
+	delete m_faviconsDatabase;
+
+	m_faviconsDatabase = nullptr;
+}
+
 void HistoryManager::createInstance()
 {
 	if (!m_instance)
@@ -65,6 +75,14 @@ void HistoryManager::timerEvent(QTimerEvent *event)
 
 		save();
 	}
+	else if (event->timerId() == m_faviconsTimer)
+	{
+		killTimer(m_faviconsTimer);
+
+		m_faviconsTimer = 0;
+
+		pruneFavicons();
+	}
 	else if (event->timerId() == m_dayTimer)
 	{
 		killTimer(m_dayTimer);
@@ -111,16 +129,46 @@ void HistoryManager::scheduleSave()
 	}
 }
 
+void HistoryManager::scheduleFaviconsPruning()
+{
+	if (m_faviconsTimer == 0 && !Application::isAboutToQuit())
+	{
+		m_faviconsTimer = startTimer(5000);
+	}
+}
+
+void HistoryManager::pruneFavicons()
+{
+	if (!m_browsingHistoryModel)
+	{
+		getBrowsingHistoryModel();
+	}
+
+	QSet<QString> hosts;
+
+	for (int i = 0; i < m_browsingHistoryModel->rowCount(); ++i)
+	{
+		const QString host(m_browsingHistoryModel->index(i, 0).data(HistoryModel::UrlRole).toUrl().host());
+
+		if (!host.isEmpty())
+		{
+			hosts.insert(host.toLower());
+		}
+	}
+
+	getFaviconsDatabase()->retainHosts(hosts);
+}
+
 void HistoryManager::save()
 {
 	if (m_browsingHistoryModel)
 	{
-		m_browsingHistoryModel->save(SessionsManager::getWritableDataPath(QLatin1String("browsingHistory.json")));
+		m_browsingHistoryModel->save();
 	}
 
 	if (m_typedHistoryModel)
 	{
-		m_typedHistoryModel->save(SessionsManager::getWritableDataPath(QLatin1String("typedHistory.json")));
+		m_typedHistoryModel->save();
 	}
 }
 
@@ -138,6 +186,11 @@ void HistoryManager::clearHistory(uint period)
 
 	m_browsingHistoryModel->clearRecentEntries(period);
 	m_typedHistoryModel->clearRecentEntries(period);
+
+	if (period == 0)
+	{
+		getFaviconsDatabase()->clear();
+	}
 }
 
 void HistoryManager::removeEntry(quint64 identifier)
@@ -202,6 +255,16 @@ void HistoryManager::updateEntry(quint64 identifier, const QUrl &url, const QStr
 
 		m_instance->scheduleSave();
 	}
+
+	setIcon(url, icon);
+}
+
+void HistoryManager::setIcon(const QUrl &url, const QIcon &icon)
+{
+	if (m_isStoringFavicons && !icon.isNull() && !Utils::isUrlEmpty(url) && hasEntry(url))
+	{
+		getFaviconsDatabase()->setIcon(url, icon);
+	}
 }
 
 void HistoryManager::handleOptionChanged(int identifier)
@@ -211,6 +274,7 @@ void HistoryManager::handleOptionChanged(int identifier)
 		case SettingsManager::Browser_PrivateModeOption:
 		case SettingsManager::History_RememberBrowsingOption:
 			m_isEnabled = (SettingsManager::getOption(SettingsManager::History_RememberBrowsingOption).toBool() && !SettingsManager::getOption(SettingsManager::Browser_PrivateModeOption).toBool());
+			m_isStoringFavicons = (SettingsManager::getOption(SettingsManager::History_StoreFaviconsOption).toBool() && !SettingsManager::getOption(SettingsManager::Browser_PrivateModeOption).toBool());
 
 			break;
 		case SettingsManager::History_BrowsingLimitAmountGlobalOption:
@@ -244,7 +308,7 @@ void HistoryManager::handleOptionChanged(int identifier)
 
 			break;
 		case SettingsManager::History_StoreFaviconsOption:
-			m_isStoringFavicons = SettingsManager::getOption(identifier).toBool();
+			m_isStoringFavicons = (SettingsManager::getOption(identifier).toBool() && !SettingsManager::getOption(SettingsManager::Browser_PrivateModeOption).toBool());
 
 			break;
 		default:
@@ -261,9 +325,10 @@ HistoryModel* HistoryManager::getBrowsingHistoryModel()
 {
 	if (!m_browsingHistoryModel)
 	{
-		m_browsingHistoryModel = new HistoryModel(SessionsManager::getWritableDataPath(QLatin1String("browsingHistory.json")), HistoryModel::BrowsingHistory, m_instance);
+		m_browsingHistoryModel = new HistoryModel(SessionsManager::getWritableDataPath(QLatin1String("browsingHistory.dat")), HistoryModel::BrowsingHistory, m_instance);
 
 		connect(m_browsingHistoryModel, &HistoryModel::modelModified, m_instance, &HistoryManager::scheduleSave);
+		connect(m_browsingHistoryModel, &HistoryModel::entryRemoved, m_instance, &HistoryManager::scheduleFaviconsPruning);
 	}
 
 	return m_browsingHistoryModel;
@@ -273,7 +338,7 @@ HistoryModel* HistoryManager::getTypedHistoryModel()
 {
 	if (!m_typedHistoryModel && m_instance)
 	{
-		m_typedHistoryModel = new HistoryModel(SessionsManager::getWritableDataPath(QLatin1String("typedHistory.json")), HistoryModel::TypedHistory, m_instance);
+		m_typedHistoryModel = new HistoryModel(SessionsManager::getWritableDataPath(QLatin1String("typedHistory.dat")), HistoryModel::TypedHistory, m_instance);
 
 		connect(m_typedHistoryModel, &HistoryModel::modelModified, m_instance, &HistoryManager::scheduleSave);
 	}
@@ -281,6 +346,21 @@ HistoryModel* HistoryManager::getTypedHistoryModel()
 	return m_typedHistoryModel;
 }
 
+FaviconsDatabase* HistoryManager::getFaviconsDatabase()
+{
+	if (!m_faviconsDatabase)
+	{
+		m_faviconsDatabase = new FaviconsDatabase(SessionsManager::getWritableDataPath(QLatin1String("favicons.dat")), SessionsManager::isReadOnly());
+
+		if (m_instance && !SessionsManager::isReadOnly())
+		{
+			m_instance->scheduleFaviconsPruning();
+		}
+	}
+
+	return m_faviconsDatabase;
+}
+
 QDateTime HistoryManager::getLastVisitTime(const QUrl &url)
 {
 	if (!m_browsingHistoryModel)
@@ -293,11 +373,9 @@ QDateTime HistoryManager::getLastVisitTime(const QUrl &url)
 
 QIcon HistoryManager::getIcon(const QString &host)
 {
-	Q_UNUSED(host)
-
-///TODO
+	const QIcon icon(getFaviconsDatabase()->getIcon(host));
 
-	return ThemesManager::createIcon(QLatin1String("text-html"));
+	return (icon.isNull() ? ThemesManager::createIcon(QLatin1String("text-html")) : icon);
 }
 
 QIcon HistoryManager::getIcon(const QUrl &url)
@@ -322,9 +400,9 @@ QIcon HistoryManager::getIcon(const QUrl &url)
 		}
 	}
 
-///TODO
+	const QIcon icon(getFaviconsDatabase()->getIcon(url));
 
-	return ThemesManager::createIcon(QLatin1String("text-html"));
+	return (icon.isNull() ? ThemesManager::createIcon(QLatin1String("text-html")) : icon);
 }
 
 HistoryModel::Entry* HistoryManager::getEntry(quint64 identifier)
@@ -373,6 +451,8 @@ quint64 HistoryManager::addEntry(const QUrl &url, const QString &title, const QI
 
 	const quint64 identifier(m_browsingHistoryModel->addEntry(url, title, icon, QDateTime::currentDateTimeUtc())->getIdentifier());
 
+	setIcon(url, icon);
+
 	if (isTypedIn)
 	{
 		if (!m_typedHistoryModel)
@@ -411,4 +491,9 @@ bool HistoryManager::hasEntry(const QUrl &url)
 	return m_browsingHistoryModel->hasEntry(url);
 }
 
+bool HistoryManager::isEnabled()
+{
+	return m_isEnabled;
+}
+
 }
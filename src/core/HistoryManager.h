@@ -29,6 +29,8 @@
 namespace Otter
 {
 
+class FaviconsDatabase;
+
 class HistoryManager final : public QObject
 {
 	Q_OBJECT
@@ -39,6 +41,7 @@ public:
 	static void removeEntry(quint64 identifier);
 	static void removeEntries(const QVector<quint64> &identifiers);
 	static void updateEntry(quint64 identifier, const QUrl &url, const QString &title = {}, const QIcon &icon = {});
+	static void setIcon(const QUrl &url, const QIcon &icon);
 	static HistoryManager* getInstance();
 	static HistoryModel* getBrowsingHistoryModel();
 	static HistoryModel* getTypedHistoryModel();
@@ -49,22 +52,29 @@ public:
 	static QVector<HistoryModel::HistoryEntryMatch> findEntries(const QString &prefix, bool isTypedInOnly = false);
 	static quint64 addEntry(const QUrl &url, const QString &title = {}, const QIcon &icon = {}, bool isTypedIn = false);
 	static bool hasEntry(const QUrl &url);
+	static bool isEnabled();
 
 protected:
 	explicit HistoryManager(QObject *parent);
+	~HistoryManager();
 
 	void timerEvent(QTimerEvent *event) override;
 	void scheduleSave();
+	void scheduleFaviconsPruning();
+	void pruneFavicons();
 	void save();
+	static FaviconsDatabase* getFaviconsDatabase();
 
 protected slots:
 	void handleOptionChanged(int identifier);
 
 private:
 	int m_dayTimer;
+	int m_faviconsTimer;
 	int m_saveTimer;
 
 	static HistoryManager *m_instance;
+	static FaviconsDatabase *m_faviconsDatabase;
 	static HistoryModel *m_browsingHistoryModel;
 	static HistoryModel *m_typedHistoryModel;
 	static bool m_isEnabled;
@@ -25,13 +25,17 @@
 #include "ThemesManager.h"
 #include "Utils.h"
 
+#include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonObject>
 
 namespace Otter
 {
 
+const int HistoryModel::m_completionMatchesLimit(250);
+
 HistoryModel::Entry::Entry() = default;
 
 void HistoryModel::Entry::setData(const QVariant &value, int role)
@@ -84,10 +88,150 @@ bool HistoryModel::Entry::isValid() const
 }
 
 HistoryModel::HistoryModel(const QString &path, HistoryType type, QObject *parent) : QStandardItemModel(parent),
-	m_type(type)
+	m_journal(new JournalFile(path, this)),
+	m_identifierCounter(0),
+	m_type(type),
+	m_isLoading(true)
+{
+	if (m_journal->exists())
+	{
+		loadJournal();
+	}
+	else
+	{
+		const QFileInfo fileInformation(path);
+
+		loadLegacyHistory(fileInformation.dir().filePath(fileInformation.completeBaseName() + QLatin1String(".json")));
+	}
+
+	m_isLoading = false;
+
+	setSortRole(TimeVisitedRole);
+	sort(0, Qt::DescendingOrder);
+}
+
+void HistoryModel::loadJournal()
+{
+	const QVector<JournalFile::Record> records(m_journal->load());
+	QMap<quint64, QByteArray> entries;
+
+	for (int i = 0; i < records.count(); ++i)
+	{
+		const JournalFile::Record record(records.at(i));
+		QDataStream stream(record.data);
+		stream.setVersion(QDataStream::Qt_5_15);
+
+		quint64 identifier(0);
+
+		stream >> identifier;
+
+		if (identifier > m_identifierCounter)
+		{
+			m_identifierCounter = identifier;
+		}
+
+		switch (record.type)
+		{
+			case EntryRecord:
+				entries[identifier] = record.data;
+
+				break;
+			case RemoveRecord:
+				entries.remove(identifier);
+
+				break;
+			default:
+				break;
+		}
+	}
+
+	QList<QStandardItem*> items;
+	QMap<quint64, QByteArray>::const_iterator iterator;
+
+	m_urls.reserve(entries.count());
+
+	for (iterator = entries.constBegin(); iterator != entries.constEnd(); ++iterator)
+	{
+		QDataStream stream(iterator.value());
+		stream.setVersion(QDataStream::Qt_5_15);
+
+		quint64 identifier(0);
+		QString url;
+		QString title;
+		qint64 timeVisited(0);
+
+		stream >> identifier >> url >> title >> timeVisited;
+
+		if (stream.status() != QDataStream::Ok)
+		{
+			continue;
+		}
+
+		const QUrl entryUrl(url);
+		const QUrl normalizedUrl(Utils::normalizeUrl(entryUrl));
+
+		if (m_type == TypedHistory && m_urls.contains(normalizedUrl))
+		{
+			const QVector<Entry*> previousEntries(m_urls.take(normalizedUrl));
+
+			for (int i = 0; i < previousEntries.count(); ++i)
+			{
+				Entry *previousEntry(previousEntries.at(i));
+
+				m_identifiers.remove(previousEntry->getIdentifier());
+				m_removedEntries.insert(previousEntry->getIdentifier());
+
+				items.removeOne(previousEntry);
+
+				delete previousEntry;
+			}
+		}
+
+		if (identifier == 0)
+		{
+			identifier = (m_identifierCounter + 1);
+			m_identifierCounter = identifier;
+		}
+
+		Entry *entry(new Entry());
+		entry->setIcon({});
+		entry->setItemData(entryUrl, UrlRole);
+		entry->setItemData(title, TitleRole);
+		entry->setItemData(QDateTime::fromMSecsSinceEpoch(timeVisited, Qt::UTC), TimeVisitedRole);
+		entry->setItemData(identifier, IdentifierRole);
+
+		if (!normalizedUrl.isEmpty())
+		{
+			if (!m_urls.contains(normalizedUrl))
+			{
+				m_completionIndex.addUrl(normalizedUrl);
+			}
+
+			m_urls[normalizedUrl].append(entry);
+		}
+
+		m_identifiers[identifier] = entry;
+
+		items.prepend(entry);
+	}
+
+	invisibleRootItem()->appendRows(items);
+
+	if (m_journal->needsCompaction(m_identifiers.count()) && !SessionsManager::isReadOnly())
+	{
+		compactJournal();
+	}
+}
+
+void HistoryModel::loadLegacyHistory(const QString &path)
 {
 	QFile file(path);
 
+	if (!file.exists())
+	{
+		return;
+	}
+
 	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
 	{
 		Console::addMessage(tr("Failed to open history file: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, path);
@@ -108,8 +252,37 @@ HistoryModel::HistoryModel(const QString &path, HistoryType type, QObject *paren
 		addEntry(QUrl(entryObject.value(QLatin1String("url")).toString()), entryObject.value(QLatin1String("title")).toString(), {}, dateTime);
 	}
 
-	setSortRole(TimeVisitedRole);
-	sort(0, Qt::DescendingOrder);
+	if (!m_identifiers.isEmpty() && !SessionsManager::isReadOnly())
+	{
+		compactJournal();
+	}
+}
+
+void HistoryModel::compactJournal()
+{
+	QVector<JournalFile::Record> records;
+	records.reserve(m_identifiers.count());
+
+	QMap<quint64, Entry*>::const_iterator iterator;
+
+	for (iterator = m_identifiers.constBegin(); iterator != m_identifiers.constEnd(); ++iterator)
+	{
+		JournalFile::Record record;
+		record.type = EntryRecord;
+		record.data = serializeEntry(iterator.value());
+
+		records.append(record);
+	}
+
+	if (m_identifierCounter > 0 && (m_identifiers.isEmpty() || m_identifierCounter > m_identifiers.lastKey()))
+	{
+		records.append(createRemoveRecord(m_identifierCounter));
+	}
+
+	m_modifiedEntries.clear();
+	m_removedEntries.clear();
+
+	m_journal->compact(records);
 }
 
 void HistoryModel::clearExcessEntries(int limit)
@@ -129,8 +302,22 @@ void HistoryModel::clearRecentEntries(uint period)
 	{
 		clear();
 
+		m_completionIndex.clear();
 		m_urls.clear();
 		m_identifiers.clear();
+		m_modifiedEntries.clear();
+		m_removedEntries.clear();
+
+		if (!SessionsManager::isReadOnly())
+		{
+			m_journal->clear();
+
+			if (m_identifierCounter > 0)
+			{
+				m_journal->addRecord(RemoveRecord, createRemoveRecord(m_identifierCounter).data);
+				m_journal->flush();
+			}
+		}
 
 		emit cleared();
 
@@ -182,12 +369,15 @@ void HistoryModel::removeEntry(quint64 identifier)
 		if (m_urls[url].isEmpty())
 		{
 			m_urls.remove(url);
+			m_completionIndex.removeUrl(url);
 		}
 	}
 
 	if (identifier > 0 && m_identifiers.contains(identifier))
 	{
 		m_identifiers.remove(identifier);
+		m_modifiedEntries.remove(identifier);
+		m_removedEntries.insert(identifier);
 	}
 
 	emit entryRemoved(entry);
@@ -223,7 +413,12 @@ HistoryModel::Entry* HistoryModel::addEntry(const QUrl &url, const QString &titl
 
 	if (identifier == 0 || m_identifiers.contains(identifier))
 	{
-		identifier = (m_identifiers.isEmpty() ? 1 : (m_identifiers.lastKey() + 1));
+		identifier = (m_identifierCounter + 1);
+	}
+
+	if (identifier > m_identifierCounter)
+	{
+		m_identifierCounter = identifier;
 	}
 
 	setData(index, identifier, IdentifierRole);
@@ -275,80 +470,156 @@ QDateTime HistoryModel::getLastVisitTime(const QUrl &url) const
 
 QVector<HistoryModel::HistoryEntryMatch> HistoryModel::findEntries(const QString &prefix, bool markAsTypedIn) const
 {
-	QVector<Entry*> matchedEntries;
-	QVector<HistoryEntryMatch> allMatches;
-	QVector<HistoryEntryMatch> currentMatches;
-	QMultiMap<QDateTime, HistoryEntryMatch> matchesMap;
-	QHash<QUrl, QVector<Entry*> >::const_iterator urlsIterator;
-
-	for (urlsIterator = m_urls.constBegin(); urlsIterator != m_urls.constEnd(); ++urlsIterator)
+	const QVector<CompletionIndex::UrlMatch> urlMatches(m_completionIndex.findUrls(prefix, m_completionMatchesLimit, [&](const QUrl &url)
 	{
-		if (urlsIterator.value().isEmpty() || matchedEntries.contains(urlsIterator.value().value(0)))
+		return static_cast<qint64>(calculateFrecency(m_urls.value(url)));
+	}));
+	QVector<HistoryEntryMatch> matches;
+	QHash<Entry*, int> frecencies;
+	matches.reserve(urlMatches.count());
+	frecencies.reserve(urlMatches.count());
+
+	for (int i = 0; i < urlMatches.count(); ++i)
+	{
+		const QVector<Entry*> entries(m_urls.value(urlMatches.at(i).url));
+
+		if (entries.isEmpty())
 		{
 			continue;
 		}
 
-		const QString result(Utils::matchUrl(urlsIterator.key(), prefix));
+		HistoryEntryMatch match;
+		match.entry = entries.at(0);
+		match.match = urlMatches.at(i).match;
+		match.isTypedIn = markAsTypedIn;
 
-		if (!result.isEmpty())
-		{
-			HistoryEntryMatch match;
-			match.entry = urlsIterator.value().value(0);
-			match.match = result;
+		matches.append(match);
 
-			if (markAsTypedIn)
-			{
-				match.isTypedIn = true;
-			}
+		frecencies[match.entry] = calculateFrecency(entries);
+	}
 
-			matchesMap.insert(match.entry->data(TimeVisitedRole).toDateTime(), match);
+	std::sort(matches.begin(), matches.end(), [&](const HistoryEntryMatch &first, const HistoryEntryMatch &second)
+	{
+		const int firstFrecency(frecencies.value(first.entry));
+		const int secondFrecency(frecencies.value(second.entry));
 
-			matchedEntries.append(match.entry);
+		if (firstFrecency != secondFrecency)
+		{
+			return (firstFrecency > secondFrecency);
 		}
-	}
 
-	currentMatches = matchesMap.values().toVector();
+		return (first.entry->getTimeVisited() > second.entry->getTimeVisited());
+	});
+
+	return matches;
+}
+
+HistoryModel::HistoryType HistoryModel::getType() const
+{
+	return m_type;
+}
+
+int HistoryModel::getVisitsAmount(const QUrl &url) const
+{
+	return m_urls.value(Utils::normalizeUrl(url)).count();
+}
 
-	matchesMap.clear();
+int HistoryModel::getFrecency(const QUrl &url) const
+{
+	return calculateFrecency(m_urls.value(Utils::normalizeUrl(url)));
+}
 
-	allMatches.reserve(currentMatches.count());
+int HistoryModel::calculateFrecency(const QVector<Entry*> &entries)
+{
+	const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
+	int frecency(0);
 
-	for (int i = (currentMatches.count() - 1); i >= 0; --i)
+	for (int i = 0; i < entries.count(); ++i)
 	{
-		allMatches.append(currentMatches.at(i));
+		const qint64 age(entries.at(i)->getTimeVisited().daysTo(currentDateTime));
+
+		if (age < 4)
+		{
+			frecency += 100;
+		}
+		else if (age < 14)
+		{
+			frecency += 70;
+		}
+		else if (age < 31)
+		{
+			frecency += 50;
+		}
+		else if (age < 90)
+		{
+			frecency += 30;
+		}
+		else
+		{
+			frecency += 10;
+		}
 	}
 
-	return allMatches;
+	return frecency;
 }
 
-HistoryModel::HistoryType HistoryModel::getType() const
+QByteArray HistoryModel::serializeEntry(const Entry *entry)
 {
-	return m_type;
+	QByteArray data;
+	QDataStream stream(&data, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_5_15);
+	stream << entry->getIdentifier() << entry->getUrl().toString() << entry->data(TitleRole).toString() << entry->getTimeVisited().toMSecsSinceEpoch();
+
+	return data;
+}
+
+JournalFile::Record HistoryModel::createRemoveRecord(quint64 identifier)
+{
+	JournalFile::Record record;
+	record.type = RemoveRecord;
+
+	QDataStream stream(&record.data, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_5_15);
+	stream << identifier;
+
+	return record;
 }
 
-bool HistoryModel::save(const QString &path) const
+bool HistoryModel::save()
 {
 	if (SessionsManager::isReadOnly())
 	{
 		return false;
 	}
 
-	QJsonArray historyArray;
+	QSet<quint64>::const_iterator iterator;
 
-	for (int i = 0; i < rowCount(); ++i)
+	for (iterator = m_removedEntries.constBegin(); iterator != m_removedEntries.constEnd(); ++iterator)
 	{
-		const QModelIndex index(this->index(i, 0));
+		m_journal->addRecord(RemoveRecord, createRemoveRecord(*iterator).data);
+	}
 
-		if (index.isValid())
+	for (iterator = m_modifiedEntries.constBegin(); iterator != m_modifiedEntries.constEnd(); ++iterator)
+	{
+		const Entry *entry(getEntry(*iterator));
+
+		if (entry)
 		{
-			historyArray.prepend({{{QLatin1String("url"), index.data(UrlRole).toUrl().toString()}, {QLatin1String("title"), index.data(TitleRole).toString()}, {QLatin1String("time"), index.data(TimeVisitedRole).toDateTime().toString(Qt::ISODate)}}});
+			m_journal->addRecord(EntryRecord, serializeEntry(entry));
 		}
 	}
 
-	JsonSettings settings;
-	settings.setArray(historyArray);
+	m_removedEntries.clear();
+	m_modifiedEntries.clear();
+
+	if (m_journal->needsCompaction(m_identifiers.count()))
+	{
+		compactJournal();
+
+		return true;
+	}
 
-	return settings.save(path);
+	return m_journal->flush();
 }
 
 bool HistoryModel::setData(const QModelIndex &index, const QVariant &value, int role)
@@ -372,6 +643,7 @@ bool HistoryModel::setData(const QModelIndex &index, const QVariant &value, int
 			if (m_urls[oldUrl].isEmpty())
 			{
 				m_urls.remove(oldUrl);
+				m_completionIndex.removeUrl(oldUrl);
 			}
 		}
 
@@ -380,6 +652,8 @@ bool HistoryModel::setData(const QModelIndex &index, const QVariant &value, int
 			if (!m_urls.contains(newUrl))
 			{
 				m_urls[newUrl] = {};
+
+				m_completionIndex.addUrl(newUrl);
 			}
 
 			m_urls[newUrl].append(entry);
@@ -394,6 +668,11 @@ bool HistoryModel::setData(const QModelIndex &index, const QVariant &value, int
 		case UrlRole:
 		case IdentifierRole:
 		case TimeVisitedRole:
+			if (!m_isLoading && entry->isValid())
+			{
+				m_modifiedEntries.insert(entry->getIdentifier());
+			}
+
 			emit entryModified(entry);
 			emit modelModified();
 
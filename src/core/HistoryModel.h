@@ -21,7 +21,11 @@
 #ifndef OTTER_HISTORYMODEL_H
 #define OTTER_HISTORYMODEL_H
 
+#include "CompletionIndex.h"
+#include "JournalFile.h"
+
 #include <QtCore/QDateTime>
+#include <QtCore/QSet>
 #include <QtCore/QUrl>
 #include <QtGui/QStandardItemModel>
 
@@ -83,14 +87,38 @@ public:
 	QDateTime getLastVisitTime(const QUrl &url) const;
 	QVector<HistoryEntryMatch> findEntries(const QString &prefix, bool markAsTypedIn = false) const;
 	HistoryType getType() const;
+	int getVisitsAmount(const QUrl &url) const;
+	int getFrecency(const QUrl &url) const;
 	bool hasEntry(const QUrl &url) const;
-	bool save(const QString &path) const;
+	bool save();
 	bool setData(const QModelIndex &index, const QVariant &value, int role) override;
 
+protected:
+	enum RecordType : quint8
+	{
+		EntryRecord = 1,
+		RemoveRecord
+	};
+
+	void loadJournal();
+	void loadLegacyHistory(const QString &path);
+	void compactJournal();
+	static JournalFile::Record createRemoveRecord(quint64 identifier);
+	static QByteArray serializeEntry(const Entry *entry);
+	static int calculateFrecency(const QVector<Entry*> &entries);
+
 private:
+	JournalFile *m_journal;
+	CompletionIndex m_completionIndex;
 	QHash<QUrl, QVector<Entry*> > m_urls;
 	QMap<quint64, Entry*> m_identifiers;
+	QSet<quint64> m_modifiedEntries;
+	QSet<quint64> m_removedEntries;
+	quint64 m_identifierCounter;
 	HistoryType m_type;
+	bool m_isLoading;
+
+	static const int m_completionMatchesLimit;
 
 signals:
 	void cleared();
@@ -79,7 +79,26 @@ void FetchJob::start()
 		return;
 	}
 
-	m_reply = NetworkManagerFactory::createRequest(m_url, QNetworkAccessManager::GetOperation, m_isPrivate);
+	if (m_headers.isEmpty())
+	{
+		m_reply = NetworkManagerFactory::createRequest(m_url, QNetworkAccessManager::GetOperation, m_isPrivate);
+	}
+	else
+	{
+		QNetworkRequest request(m_url);
+		request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+		request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+		request.setHeader(QNetworkRequest::UserAgentHeader, NetworkManagerFactory::getUserAgent());
+
+		QMap<QByteArray, QByteArray>::const_iterator iterator;
+
+		for (iterator = m_headers.constBegin(); iterator != m_headers.constEnd(); ++iterator)
+		{
+			request.setRawHeader(iterator.key(), iterator.value());
+		}
+
+		m_reply = NetworkManagerFactory::getNetworkManager(m_isPrivate)->get(request);
+	}
 
 	connect(m_reply, &QNetworkReply::downloadProgress, this, [&](qint64 bytesReceived, qint64 bytesTotal)
 	{
@@ -151,6 +170,11 @@ void FetchJob::setPrivate(bool isPrivate)
 	m_isPrivate = isPrivate;
 }
 
+void FetchJob::setHeader(const QByteArray &header, const QByteArray &value)
+{
+	m_headers[header] = value;
+}
+
 QUrl FetchJob::getUrl() const
 {
 	return (m_reply ? m_reply->request().url() : m_url);
@@ -178,6 +202,11 @@ QIODevice* DataFetchJob::getData() const
 	return m_reply;
 }
 
+QByteArray DataFetchJob::getHeader(const QByteArray &header) const
+{
+	return (m_reply ? m_reply->rawHeader(header) : QByteArray());
+}
+
 QMap<QByteArray, QByteArray> DataFetchJob::getHeaders() const
 {
 	QMap<QByteArray, QByteArray> headers;
@@ -193,6 +222,11 @@ QMap<QByteArray, QByteArray> DataFetchJob::getHeaders() const
 	return headers;
 }
 
+int DataFetchJob::getStatusCode() const
+{
+	return (m_reply ? m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() : 0);
+}
+
 IconFetchJob::IconFetchJob(const QUrl &url, QObject *parent) : FetchJob(url, parent)
 {
 	setSizeLimit(20480);
@@ -62,6 +62,7 @@ public:
 	void setTimeout(int seconds);
 	void setSizeLimit(qint64 limit);
 	void setPrivate(bool isPrivate);
+	void setHeader(const QByteArray &header, const QByteArray &value);
 	QUrl getUrl() const;
 	bool isRunning() const override;
 
@@ -78,6 +79,7 @@ protected:
 private:
 	QNetworkReply *m_reply;
 	QUrl m_url;
+	QMap<QByteArray, QByteArray> m_headers;
 	qint64 m_sizeLimit;
 	int m_timeoutTimer;
 	bool m_isFinished;
@@ -93,7 +95,9 @@ public:
 	explicit DataFetchJob(const QUrl &url, QObject *parent = nullptr);
 
 	QIODevice* getData() const;
+	QByteArray getHeader(const QByteArray &header) const;
 	QMap<QByteArray, QByteArray> getHeaders() const;
+	int getStatusCode() const;
 
 protected:
 	void handleSuccessfulReply(QNetworkReply *reply) override;
@@ -0,0 +1,347 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "JournalFile.h"
+#include "Console.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+
+namespace Otter
+{
+
+const quint32 JournalFile::m_magic(0x4f544a4c);
+const quint32 JournalFile::m_version(1);
+const int JournalFile::m_compactionThreshold(1000);
+
+JournalFile::JournalFile(const QString &path, QObject *parent) : QObject(parent),
+	m_path(path),
+	m_compactionThread(nullptr),
+	m_validSize(-1),
+	m_recordsAmount(0),
+	m_previousRecordsAmount(0),
+	m_isCompactionSuccessful(false)
+{
+}
+
+JournalFile::~JournalFile()
+{
+	waitForCompaction();
+
+	flush();
+}
+
+void JournalFile::addRecord(quint8 type, const QByteArray &data)
+{
+	Record record;
+	record.type = type;
+	record.data = data;
+
+	m_pendingRecords.append(record);
+}
+
+void JournalFile::compact(const QVector<Record> &records)
+{
+	if (m_compactionThread)
+	{
+		return;
+	}
+
+	const QString path(m_path);
+
+	m_compactedRecords = m_pendingRecords;
+	m_pendingRecords.clear();
+	m_previousRecordsAmount = m_recordsAmount;
+	m_isCompactionSuccessful = false;
+	m_compactionThread = QThread::create([=]()
+	{
+		QSaveFile file(path);
+
+		if (!file.open(QIODevice::WriteOnly))
+		{
+			return;
+		}
+
+		QDataStream stream(&file);
+		stream.setVersion(QDataStream::Qt_5_15);
+
+		if (!writeHeader(stream))
+		{
+			file.cancelWriting();
+
+			return;
+		}
+
+		for (int i = 0; i < records.count(); ++i)
+		{
+			if (!writeRecord(stream, records.at(i)))
+			{
+				file.cancelWriting();
+
+				return;
+			}
+		}
+
+		m_isCompactionSuccessful = file.commit();
+	});
+
+	m_recordsAmount = records.count();
+
+	connect(m_compactionThread, &QThread::finished, this, &JournalFile::handleCompactionFinished);
+
+	m_compactionThread->start(QThread::LowPriority);
+}
+
+void JournalFile::handleCompactionFinished()
+{
+	if (!m_compactionThread)
+	{
+		return;
+	}
+
+	m_compactionThread->deleteLater();
+	m_compactionThread = nullptr;
+
+	if (m_isCompactionSuccessful)
+	{
+		m_validSize = -1;
+	}
+	else
+	{
+		Console::addMessage(tr("Failed to compact journal file"), Console::OtherCategory, Console::ErrorLevel, m_path);
+
+		m_pendingRecords = (m_compactedRecords + m_pendingRecords);
+		m_recordsAmount = m_previousRecordsAmount;
+	}
+
+	m_compactedRecords.clear();
+
+	flush();
+
+	emit compacted(m_isCompactionSuccessful);
+}
+
+void JournalFile::clear()
+{
+	waitForCompaction();
+
+	m_pendingRecords.clear();
+	m_recordsAmount = 0;
+	m_validSize = -1;
+
+	QSaveFile file(m_path);
+
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		Console::addMessage(tr("Failed to open journal file: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, m_path);
+
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_15);
+
+	if (!writeHeader(stream))
+	{
+		file.cancelWriting();
+
+		return;
+	}
+
+	if (!file.commit())
+	{
+		Console::addMessage(tr("Failed to write journal file: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, m_path);
+	}
+}
+
+void JournalFile::waitForCompaction()
+{
+	if (m_compactionThread)
+	{
+		m_compactionThread->wait();
+
+		handleCompactionFinished();
+	}
+}
+
+QString JournalFile::getPath() const
+{
+	return m_path;
+}
+
+QVector<JournalFile::Record> JournalFile::load()
+{
+	QFile file(m_path);
+
+	m_recordsAmount = 0;
+	m_validSize = -1;
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		return {};
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_15);
+
+	quint32 magic(0);
+	quint32 version(0);
+
+	stream >> magic >> version;
+
+	if (stream.status() != QDataStream::Ok || magic != m_magic || version != m_version)
+	{
+		Console::addMessage(tr("Failed to load journal file: invalid header"), Console::OtherCategory, Console::ErrorLevel, m_path);
+
+		m_validSize = 0;
+
+		return {};
+	}
+
+	QVector<Record> records;
+	qint64 validSize(file.pos());
+
+	while (!stream.atEnd())
+	{
+		Record record;
+		quint16 checksum(0);
+
+		stream >> record.type >> checksum >> record.data;
+
+		if (stream.status() != QDataStream::Ok || checksum != qChecksum(record.data.constData(), static_cast<uint>(record.data.size())))
+		{
+			Console::addMessage(tr("Journal file is truncated, discarding incomplete records"), Console::OtherCategory, Console::WarningLevel, m_path);
+
+			m_validSize = validSize;
+
+			break;
+		}
+
+		records.append(record);
+
+		validSize = file.pos();
+	}
+
+	m_recordsAmount = records.count();
+
+	return records;
+}
+
+int JournalFile::getRecordsAmount() const
+{
+	return (m_recordsAmount + m_pendingRecords.count());
+}
+
+bool JournalFile::writeHeader(QDataStream &stream)
+{
+	stream << m_magic << m_version;
+
+	return (stream.status() == QDataStream::Ok);
+}
+
+bool JournalFile::writeRecord(QDataStream &stream, const Record &record)
+{
+	stream << record.type << qChecksum(record.data.constData(), static_cast<uint>(record.data.size())) << record.data;
+
+	return (stream.status() == QDataStream::Ok);
+}
+
+bool JournalFile::flush()
+{
+	if (m_pendingRecords.isEmpty())
+	{
+		return true;
+	}
+
+	if (m_compactionThread)
+	{
+		return false;
+	}
+
+	QFile file(m_path);
+
+	if (!file.open(QIODevice::ReadWrite))
+	{
+		Console::addMessage(tr("Failed to open journal file: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, m_path);
+
+		return false;
+	}
+
+	if (m_validSize >= 0 && file.size() > m_validSize)
+	{
+		file.resize(m_validSize);
+	}
+
+	m_validSize = -1;
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_15);
+
+	if (file.size() == 0)
+	{
+		if (!writeHeader(stream))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		file.seek(file.size());
+	}
+
+	for (int i = 0; i < m_pendingRecords.count(); ++i)
+	{
+		const qint64 position(file.pos());
+
+		if (!writeRecord(stream, m_pendingRecords.at(i)))
+		{
+			Console::addMessage(tr("Failed to write journal file: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, m_path);
+
+			m_pendingRecords.remove(0, i);
+			m_recordsAmount += i;
+			m_validSize = position;
+
+			return false;
+		}
+	}
+
+	m_recordsAmount += m_pendingRecords.count();
+	m_pendingRecords.clear();
+
+	return file.flush();
+}
+
+bool JournalFile::exists() const
+{
+	return QFile::exists(m_path);
+}
+
+bool JournalFile::isCompacting() const
+{
+	return (m_compactionThread != nullptr);
+}
+
+bool JournalFile::needsCompaction(int liveRecordsAmount) const
+{
+	const int recordsAmount(getRecordsAmount());
+
+	return (!m_compactionThread && recordsAmount > m_compactionThreshold && recordsAmount > (liveRecordsAmount * 2));
+}
+
+}
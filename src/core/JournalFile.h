@@ -0,0 +1,81 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_JOURNALFILE_H
+#define OTTER_JOURNALFILE_H
+
+#include <QtCore/QDataStream>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+
+namespace Otter
+{
+
+class JournalFile final : public QObject
+{
+	Q_OBJECT
+
+public:
+	struct Record final
+	{
+		QByteArray data;
+		quint8 type = 0;
+	};
+
+	explicit JournalFile(const QString &path, QObject *parent = nullptr);
+	~JournalFile();
+
+	void addRecord(quint8 type, const QByteArray &data);
+	void compact(const QVector<Record> &records);
+	void clear();
+	void waitForCompaction();
+	QString getPath() const;
+	QVector<Record> load();
+	int getRecordsAmount() const;
+	bool flush();
+	bool exists() const;
+	bool isCompacting() const;
+	bool needsCompaction(int liveRecordsAmount) const;
+
+protected:
+	void handleCompactionFinished();
+	static bool writeHeader(QDataStream &stream);
+	static bool writeRecord(QDataStream &stream, const Record &record);
+
+private:
+	QString m_path;
+	QThread *m_compactionThread;
+	QVector<Record> m_pendingRecords;
+	QVector<Record> m_compactedRecords;
+	qint64 m_validSize;
+	int m_recordsAmount;
+	int m_previousRecordsAmount;
+	bool m_isCompactionSuccessful;
+
+	static const quint32 m_magic;
+	static const quint32 m_version;
+	static const int m_compactionThreshold;
+
+signals:
+	void compacted(bool isSuccess);
+};
+
+}
+
+#endif
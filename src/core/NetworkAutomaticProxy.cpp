@@ -24,9 +24,10 @@
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDate>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
+#include <QtCore/QMutexLocker>
 #include <QtCore/QRegularExpression>
-#include <QtNetwork/QHostInfo>
 #include <QtNetwork/QNetworkInterface>
 
 namespace Otter
@@ -34,6 +35,13 @@ namespace Otter
 
 QStringList PacUtils::m_months = {QLatin1String("jan"), QLatin1String("feb"), QLatin1String("mar"), QLatin1String("apr"), QLatin1String("may"), QLatin1String("jun"), QLatin1String("jul"), QLatin1String("aug"), QLatin1String("sep"), QLatin1String("oct"), QLatin1String("nov"), QLatin1String("dec")};
 QStringList PacUtils::m_days = {QLatin1String("mon"), QLatin1String("tue"), QLatin1String("wed"), QLatin1String("thu"), QLatin1String("fri"), QLatin1String("sat"), QLatin1String("sun")};
+QHash<QString, PacUtils::HostEntry> PacUtils::m_hosts;
+QMutex PacUtils::m_hostsMutex;
+const int PacUtils::m_hostsLimit(1000);
+const int PacUtils::m_hostsTimeToLive(60000);
+const int NetworkAutomaticProxy::m_cacheLimit(1000);
+const int NetworkAutomaticProxy::m_cacheTimeToLive(300000);
+const int NetworkAutomaticProxy::m_evaluationTimeout(5000);
 
 PacUtils::PacUtils(QObject *parent) : QObject(parent)
 {
@@ -46,10 +54,9 @@ void PacUtils::alert(const QString &message) const
 
 QString PacUtils::dnsResolve(const QString &host) const
 {
-	const QHostInfo hostInformation(QHostInfo::fromName(host));
-	const QList<QHostAddress> addresses(hostInformation.addresses());
+	const QList<QHostAddress> addresses(resolveHost(host));
 
-	if (hostInformation.error() == QHostInfo::NoError && !addresses.isEmpty())
+	if (!addresses.isEmpty())
 	{
 		return addresses.first().toString();
 	}
@@ -86,7 +93,23 @@ int PacUtils::dnsDomainLevels(const QString &host) const
 
 bool PacUtils::isInNet(const QString &host, const QString &pattern, const QString &mask) const
 {
-	const QHostAddress address(host);
+	QHostAddress address(host);
+
+	if (address.isNull())
+	{
+		const QList<QHostAddress> addresses(resolveHost(host));
+
+		for (int i = 0; i < addresses.count(); ++i)
+		{
+			if (addresses.at(i).protocol() == QAbstractSocket::IPv4Protocol)
+			{
+				address = addresses.at(i);
+
+				break;
+			}
+		}
+	}
+
 	const QHostAddress netaddress(pattern);
 	const QHostAddress netmask(mask);
 
@@ -100,7 +123,7 @@ bool PacUtils::isPlainHostName(const QString &host) const
 
 bool PacUtils::isResolvable(const QString &host) const
 {
-	return (QHostInfo::fromName(host).error() == QHostInfo::NoError);
+	return !resolveHost(host).isEmpty();
 }
 
 bool PacUtils::localHostOrDomainIs(const QString &host, QString domain) const
@@ -295,6 +318,76 @@ bool PacUtils::timeRange(const QVariant &arg1, const QVariant &arg2, const QVari
 	return false;
 }
 
+QList<QHostAddress> PacUtils::resolveHost(const QString &host) const
+{
+	const QString normalizedHost(host.toLower());
+
+	{
+		QMutexLocker locker(&m_hostsMutex);
+
+		if (m_hosts.contains(normalizedHost))
+		{
+			HostEntry &entry(m_hosts[normalizedHost]);
+
+			if (entry.expirationTime < QDateTime::currentMSecsSinceEpoch() && !entry.isUpdating)
+			{
+				entry.isUpdating = true;
+
+				QHostInfo::lookupHost(normalizedHost, this, [=](const QHostInfo &information)
+				{
+					updateHost(normalizedHost, information);
+				});
+			}
+
+			return entry.addresses;
+		}
+	}
+
+	const QHostInfo information(QHostInfo::fromName(normalizedHost));
+
+	updateHost(normalizedHost, information);
+
+	return ((information.error() == QHostInfo::NoError) ? information.addresses() : QList<QHostAddress>());
+}
+
+void PacUtils::updateHost(const QString &host, const QHostInfo &information)
+{
+	HostEntry entry;
+	entry.expirationTime = (QDateTime::currentMSecsSinceEpoch() + m_hostsTimeToLive);
+
+	if (information.error() == QHostInfo::NoError)
+	{
+		entry.addresses = information.addresses();
+	}
+
+	QMutexLocker locker(&m_hostsMutex);
+
+	if (m_hosts.count() >= m_hostsLimit && !m_hosts.contains(host))
+	{
+		const qint64 currentTime(QDateTime::currentMSecsSinceEpoch());
+		QHash<QString, HostEntry>::iterator iterator(m_hosts.begin());
+
+		while (iterator != m_hosts.end())
+		{
+			if (iterator.value().expirationTime < currentTime && !iterator.value().isUpdating)
+			{
+				iterator = m_hosts.erase(iterator);
+			}
+			else
+			{
+				++iterator;
+			}
+		}
+
+		if (m_hosts.count() >= m_hostsLimit)
+		{
+			m_hosts.clear();
+		}
+	}
+
+	m_hosts[host] = entry;
+}
+
 bool PacUtils::isDateInRange(const QDate &from, const QDate &to, const QDate &value) const
 {
 	return (value >= from && value <= to);
@@ -310,25 +403,77 @@ bool PacUtils::isNumberInRange(int from, int to, int value) const
 	return (value >= from && value <= to);
 }
 
-NetworkAutomaticProxy::NetworkAutomaticProxy(const QString &path, QObject *parent) : QObject(parent),
-	m_path(path),
-	m_isValid(false)
+PacEvaluator::PacEvaluator(QObject *parent) : QObject(parent),
+	m_engine(nullptr)
+{
+}
+
+QString PacEvaluator::evaluate(const QString &url, const QString &host)
 {
-	m_engine.globalObject().setProperty(QLatin1String("PacUtils"), m_engine.newQObject(new PacUtils(this)));
+	if (!m_engine || !m_findProxy.isCallable())
+	{
+		return QLatin1String("ERROR");
+	}
 
-	const QStringList functions({QLatin1String("alert"), QLatin1String("dnsResolve"), QLatin1String("myIpAddress"), QLatin1String("dnsDomainLevels"), QLatin1String("isInNet"), QLatin1String("isPlainHostName"), QLatin1String("isResolvable"), QLatin1String("localHostOrDomainIs"), QLatin1String("dnsDomainIs"), QLatin1String("shExpMatch"), QLatin1String("weekdayRange"), QLatin1String("dateRange"), QLatin1String("timeRange")});
+	const QJSValue result(m_findProxy.call(QJSValueList({m_engine->toScriptValue(url), m_engine->toScriptValue(host)})));
 
-	for (int i = 0; i < functions.count(); ++i)
+	if (result.isError())
 	{
-		m_engine.evaluate(QStringLiteral("function %1() { return PacUtils.%1.apply(null, arguments); }").arg(functions.at(i))).isError();
+		return QLatin1String("ERROR");
 	}
 
+	return result.toString().remove(QLatin1Char(' '));
+}
+
+bool PacEvaluator::setup(const QString &script)
+{
+	if (!m_engine)
+	{
+		m_engine = new QJSEngine(this);
+		m_engine->globalObject().setProperty(QLatin1String("PacUtils"), m_engine->newQObject(new PacUtils(this)));
+
+		const QStringList functions({QLatin1String("alert"), QLatin1String("dnsResolve"), QLatin1String("myIpAddress"), QLatin1String("dnsDomainLevels"), QLatin1String("isInNet"), QLatin1String("isPlainHostName"), QLatin1String("isResolvable"), QLatin1String("localHostOrDomainIs"), QLatin1String("dnsDomainIs"), QLatin1String("shExpMatch"), QLatin1String("weekdayRange"), QLatin1String("dateRange"), QLatin1String("timeRange")});
+
+		for (int i = 0; i < functions.count(); ++i)
+		{
+			m_engine->evaluate(QStringLiteral("function %1() { return PacUtils.%1.apply(null, arguments); }").arg(functions.at(i))).isError();
+		}
+	}
+
+	if (m_engine->evaluate(script).isError())
+	{
+		return false;
+	}
+
+	m_findProxy = m_engine->globalObject().property(QLatin1String("FindProxyForURL"));
+
+	return m_findProxy.isCallable();
+}
+
+NetworkAutomaticProxy::NetworkAutomaticProxy(const QString &path, QObject *parent) : QObject(parent),
+	m_thread(new QThread(this)),
+	m_evaluator(new PacEvaluator()),
+	m_path(path),
+	m_generation(0),
+	m_isValid(0)
+{
 	m_proxies.insert(QLatin1String("ERROR"), QVector<QNetworkProxy>({QNetworkProxy(QNetworkProxy::DefaultProxy)}));
 	m_proxies.insert(QLatin1String("DIRECT"), QVector<QNetworkProxy>({QNetworkProxy(QNetworkProxy::NoProxy)}));
 
+	m_evaluator->moveToThread(m_thread);
+	m_thread->start(QThread::LowPriority);
+
 	setPath(path);
 }
 
+NetworkAutomaticProxy::~NetworkAutomaticProxy()
+{
+	m_thread->quit();
+	m_thread->wait();
+
+	delete m_evaluator;
+}
+
 void NetworkAutomaticProxy::setPath(const QString &path)
 {
 	if (QFile::exists(path))
@@ -337,8 +482,6 @@ void NetworkAutomaticProxy::setPath(const QString &path)
 
 		if (file.open(QIODevice::ReadOnly | QIODevice::Text) && setup(QString::fromLatin1(file.readAll())))
 		{
-			m_isValid = true;
-
 			file.close();
 		}
 		else
@@ -358,11 +501,7 @@ void NetworkAutomaticProxy::setPath(const QString &path)
 			{
 				QIODevice *device(job->getData());
 
-				if (isSuccess && device && setup(QString::fromLatin1(device->readAll())))
-				{
-					m_isValid = true;
-				}
-				else
+				if (!isSuccess || !device || !setup(QString::fromLatin1(device->readAll())))
 				{
 					Console::addMessage(tr("Failed to load proxy auto-config (PAC): %1").arg(device ? device->errorString() : tr("Download failure")), Console::NetworkCategory, Console::ErrorLevel, url.url());
 				}
@@ -384,15 +523,81 @@ QString NetworkAutomaticProxy::getPath() const
 
 QVector<QNetworkProxy> NetworkAutomaticProxy::getProxy(const QString &url, const QString &host)
 {
-	const QJSValue result(m_findProxy.call(QJSValueList({m_engine.toScriptValue(url), m_engine.toScriptValue(host)})));
+	const QString key(url.left(url.indexOf(QLatin1Char(':')) + 1) + host.toLower());
+	QMutexLocker locker(&m_mutex);
 
-	if (result.isError())
+	if (m_cache.contains(key))
+	{
+		const CacheEntry entry(m_cache.value(key));
+
+		if (entry.expirationTime < QDateTime::currentMSecsSinceEpoch())
+		{
+			scheduleEvaluation(key, url, host);
+		}
+
+		return getProxies(entry.configuration);
+	}
+
+	scheduleEvaluation(key, url, host);
+
+	QElapsedTimer timer;
+	timer.start();
+
+	while (!m_cache.contains(key) && timer.elapsed() < m_evaluationTimeout)
+	{
+		m_evaluationCondition.wait(&m_mutex, static_cast<unsigned long>(m_evaluationTimeout - timer.elapsed()));
+
+		scheduleEvaluation(key, url, host);
+	}
+
+	if (!m_cache.contains(key))
 	{
 		return m_proxies[QLatin1String("ERROR")];
 	}
 
-	const QString configuration(result.toString().remove(QLatin1Char(' ')));
+	return getProxies(m_cache.value(key).configuration);
+}
+
+void NetworkAutomaticProxy::scheduleEvaluation(const QString &key, const QString &url, const QString &host)
+{
+	if (m_pendingEvaluations.contains(key))
+	{
+		return;
+	}
+
+	m_pendingEvaluations.insert(key);
+
+	const quint64 generation(m_generation);
+
+	QMetaObject::invokeMethod(m_evaluator, [=]()
+	{
+		CacheEntry entry;
+		entry.configuration = m_evaluator->evaluate(url, host);
+		entry.expirationTime = (QDateTime::currentMSecsSinceEpoch() + m_cacheTimeToLive);
+
+		QMutexLocker locker(&m_mutex);
+
+		if (generation != m_generation)
+		{
+			m_evaluationCondition.wakeAll();
 
+			return;
+		}
+
+		if (m_cache.count() >= m_cacheLimit && !m_cache.contains(key))
+		{
+			m_cache.clear();
+		}
+
+		m_cache[key] = entry;
+
+		m_pendingEvaluations.remove(key);
+		m_evaluationCondition.wakeAll();
+	}, Qt::QueuedConnection);
+}
+
+QVector<QNetworkProxy> NetworkAutomaticProxy::getProxies(const QString &configuration)
+{
 	if (!m_proxies.value(configuration).isEmpty())
 	{
 		return m_proxies[configuration];
@@ -441,19 +646,27 @@ QVector<QNetworkProxy> NetworkAutomaticProxy::getProxy(const QString &url, const
 
 bool NetworkAutomaticProxy::isValid() const
 {
-	return m_isValid;
+	return (m_isValid.loadAcquire() != 0);
 }
 
 bool NetworkAutomaticProxy::setup(const QString &script)
 {
-	if (m_engine.evaluate(script).isError())
+	bool isValid(false);
+
+	QMetaObject::invokeMethod(m_evaluator, [&]()
 	{
-		return false;
-	}
+		isValid = m_evaluator->setup(script);
+	}, Qt::BlockingQueuedConnection);
 
-	m_findProxy = m_engine.globalObject().property(QLatin1String("FindProxyForURL"));
+	QMutexLocker locker(&m_mutex);
 
-	return m_findProxy.isCallable();
+	++m_generation;
+
+	m_cache.clear();
+	m_pendingEvaluations.clear();
+	m_isValid.storeRelease(isValid ? 1 : 0);
+
+	return isValid;
 }
 
 }
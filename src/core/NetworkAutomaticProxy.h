@@ -21,6 +21,11 @@
 #ifndef OTTER_NETWORKAUTOMATICPROXY_H
 #define OTTER_NETWORKAUTOMATICPROXY_H
 
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+#include <QtNetwork/QHostInfo>
 #include <QtNetwork/QNetworkProxy>
 #include <QtQml/QJSEngine>
 
@@ -50,19 +55,46 @@ public slots:
 	bool timeRange(const QVariant &arg1, const QVariant &arg2, const QVariant &arg3, const QVariant &arg4, const QVariant &arg5, const QVariant &arg6, const QString &gmt = QLatin1String("gmt")) const;
 
 protected:
+	struct HostEntry final
+	{
+		QList<QHostAddress> addresses;
+		qint64 expirationTime = 0;
+		bool isUpdating = false;
+	};
+
+	QList<QHostAddress> resolveHost(const QString &host) const;
 	bool isDateInRange(const QDate &from, const QDate &to, const QDate &value) const;
 	bool isTimeInRange(const QTime &from, const QTime &to, const QTime &value) const;
 	bool isNumberInRange(int from, int to, int value) const;
+	static void updateHost(const QString &host, const QHostInfo &information);
 
 private:
 	static QStringList m_months;
 	static QStringList m_days;
+	static QHash<QString, HostEntry> m_hosts;
+	static QMutex m_hostsMutex;
+	static const int m_hostsLimit;
+	static const int m_hostsTimeToLive;
+};
+
+class PacEvaluator final : public QObject
+{
+public:
+	explicit PacEvaluator(QObject *parent = nullptr);
+
+	QString evaluate(const QString &url, const QString &host);
+	bool setup(const QString &script);
+
+private:
+	QJSEngine *m_engine;
+	QJSValue m_findProxy;
 };
 
 class NetworkAutomaticProxy final : public QObject
 {
 public:
 	explicit NetworkAutomaticProxy(const QString &path, QObject *parent = nullptr);
+	~NetworkAutomaticProxy();
 
 	void setPath(const QString &path);
 	QString getPath() const;
@@ -70,14 +102,31 @@ public:
 	bool isValid() const;
 
 protected:
+	struct CacheEntry final
+	{
+		QString configuration;
+		qint64 expirationTime = 0;
+	};
+
+	void scheduleEvaluation(const QString &key, const QString &url, const QString &host);
+	QVector<QNetworkProxy> getProxies(const QString &configuration);
 	bool setup(const QString &script);
 
 private:
-	QJSEngine m_engine;
-	QJSValue m_findProxy;
+	QThread *m_thread;
+	PacEvaluator *m_evaluator;
 	QString m_path;
+	QHash<QString, CacheEntry> m_cache;
 	QHash<QString, QVector<QNetworkProxy> > m_proxies;
-	bool m_isValid;
+	QSet<QString> m_pendingEvaluations;
+	QMutex m_mutex;
+	QWaitCondition m_evaluationCondition;
+	quint64 m_generation;
+	QAtomicInt m_isValid;
+
+	static const int m_cacheLimit;
+	static const int m_cacheTimeToLive;
+	static const int m_evaluationTimeout;
 };
 
 }
@@ -21,13 +21,29 @@
 #include "SessionsManager.h"
 #include "SettingsManager.h"
 
-#include <QtCore/QDateTime>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
 #include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QTimerEvent>
+
+#include <cstring>
 
 namespace Otter
 {
 
-NetworkCache::NetworkCache(const QString &path, QObject *parent) : QNetworkDiskCache(parent)
+const quint32 NetworkCache::m_indexVersion(2);
+
+NetworkCache::NetworkCache(const QString &path, QObject *parent) : QNetworkDiskCache(parent),
+	m_indexIterator(nullptr),
+	m_evictionPolicy(SegmentedLeastRecentlyUsedPolicy),
+	m_indexSize(0),
+	m_evictedBytes(0),
+	m_evictedEntries(0),
+	m_indexTimer(0),
+	m_needsPruning(false),
+	m_isUpdatingMetaData(false)
 {
 	if (path.isEmpty())
 	{
@@ -38,16 +54,238 @@ NetworkCache::NetworkCache(const QString &path, QObject *parent) : QNetworkDiskC
 
 	setCacheDirectory(path);
 	setMaximumCacheSize(SettingsManager::getOption(SettingsManager::Cache_DiskCacheLimitOption).toInt() * 1024);
+	setEvictionPolicy(SettingsManager::getOption(SettingsManager::Cache_EvictionPolicyOption).toString());
+	loadIndex();
 
 	connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, [&](int identifier, const QVariant &value)
 	{
-		if (identifier == SettingsManager::Cache_DiskCacheLimitOption)
+		switch (identifier)
 		{
-			setMaximumCacheSize(value.toInt() * 1024);
+			case SettingsManager::Cache_DiskCacheLimitOption:
+				setMaximumCacheSize(value.toInt() * 1024);
+
+				break;
+			case SettingsManager::Cache_EvictionPolicyOption:
+				setEvictionPolicy(value.toString());
+
+				break;
+			default:
+				break;
 		}
 	});
 }
 
+NetworkCache::~NetworkCache()
+{
+	if (m_indexIterator)
+	{
+		delete m_indexIterator;
+	}
+	else if (!cacheDirectory().isEmpty())
+	{
+		saveIndex();
+	}
+}
+
+void NetworkCache::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_indexTimer)
+	{
+		updateIndex(50);
+	}
+}
+
+void NetworkCache::loadIndex()
+{
+	QFile file(QDir(cacheDirectory()).filePath(QLatin1String("index.dat")));
+
+	if (file.open(QIODevice::ReadOnly))
+	{
+		QDataStream stream(&file);
+		stream.setVersion(QDataStream::Qt_5_15);
+
+		quint32 version(0);
+		quint32 amount(0);
+
+		stream >> version >> amount;
+
+		if (version == m_indexVersion)
+		{
+			m_index.reserve(static_cast<int>(amount));
+
+			for (quint32 i = 0; i < amount; ++i)
+			{
+				QUrl url;
+				EntryInformation information;
+
+				stream >> url >> information.path >> information.type >> information.lastModified >> information.expirationDate >> information.storageTime >> information.lastAccessTime >> information.size >> information.fileSize >> information.accessesAmount;
+
+				if (stream.status() != QDataStream::Ok)
+				{
+					break;
+				}
+
+				addIndexEntry(url, information);
+			}
+		}
+
+		const bool isValid(version == m_indexVersion && stream.status() == QDataStream::Ok && m_index.count() == static_cast<int>(amount));
+
+		file.close();
+
+		file.remove();
+
+		if (isValid)
+		{
+			return;
+		}
+
+		m_index.clear();
+		m_evictionQueue.clear();
+		m_indexSize = 0;
+	}
+
+	m_indexIterator = new QDirIterator(cacheDirectory(), {QLatin1String("*.d")}, QDir::Files, QDirIterator::Subdirectories);
+	m_indexTimer = startTimer(0);
+}
+
+void NetworkCache::saveIndex()
+{
+	QSaveFile file(QDir(cacheDirectory()).filePath(QLatin1String("index.dat")));
+
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_15);
+	stream << m_indexVersion << static_cast<quint32>(m_index.count());
+
+	QHash<QUrl, EntryInformation>::const_iterator iterator;
+
+	for (iterator = m_index.constBegin(); iterator != m_index.constEnd(); ++iterator)
+	{
+		const EntryInformation &information(iterator.value());
+
+		stream << iterator.key() << information.path << information.type << information.lastModified << information.expirationDate << information.storageTime << information.lastAccessTime << information.size << information.fileSize << information.accessesAmount;
+	}
+
+	file.commit();
+}
+
+void NetworkCache::ensureIndex()
+{
+	if (m_indexIterator)
+	{
+		updateIndex(-1);
+	}
+}
+
+void NetworkCache::updateIndex(int limit)
+{
+	if (!m_indexIterator)
+	{
+		return;
+	}
+
+	const QDir cacheMainDirectory(cacheDirectory());
+	int amount(0);
+
+	while (m_indexIterator->hasNext() && (limit < 0 || amount < limit))
+	{
+		const QString path(m_indexIterator->next());
+
+		++amount;
+
+		if (cacheMainDirectory.relativeFilePath(path).count(QLatin1Char('/')) != 2)
+		{
+			continue;
+		}
+
+		const QNetworkCacheMetaData metaData(fileMetaData(path));
+
+		if (!metaData.isValid() || m_index.contains(metaData.url()))
+		{
+			continue;
+		}
+
+		const QFileInfo fileInformation(m_indexIterator->fileInfo());
+		EntryInformation information(createEntryInformation(metaData));
+		information.path = path;
+		information.storageTime = fileInformation.lastModified().toUTC();
+		information.lastAccessTime = information.storageTime;
+		information.size = fileInformation.size();
+		information.fileSize = information.size;
+
+		addIndexEntry(metaData.url(), information);
+	}
+
+	if (!m_indexIterator->hasNext())
+	{
+		delete m_indexIterator;
+
+		m_indexIterator = nullptr;
+
+		killTimer(m_indexTimer);
+
+		m_indexTimer = 0;
+	}
+}
+
+void NetworkCache::pruneIndex()
+{
+	if (!m_needsPruning)
+	{
+		return;
+	}
+
+	m_needsPruning = false;
+
+	QHash<QUrl, EntryInformation>::iterator iterator(m_index.begin());
+
+	while (iterator != m_index.end())
+	{
+		if (iterator.value().path.isEmpty() ? QNetworkDiskCache::metaData(iterator.key()).isValid() : QFileInfo::exists(iterator.value().path))
+		{
+			++iterator;
+
+			continue;
+		}
+
+		const QUrl url(iterator.key());
+
+		m_indexSize -= iterator.value().fileSize;
+		m_evictionQueue.remove(getEvictionKey(iterator.value()), url);
+
+		iterator = m_index.erase(iterator);
+
+		emit entryRemoved(url);
+	}
+}
+
+void NetworkCache::addIndexEntry(const QUrl &url, const EntryInformation &information)
+{
+	removeIndexEntry(url);
+
+	m_index[url] = information;
+	m_indexSize += information.fileSize;
+	m_evictionQueue.insert(getEvictionKey(information), url);
+}
+
+void NetworkCache::removeIndexEntry(const QUrl &url)
+{
+	QHash<QUrl, EntryInformation>::iterator iterator(m_index.find(url));
+
+	if (iterator != m_index.end())
+	{
+		m_indexSize -= iterator.value().fileSize;
+		m_evictionQueue.remove(getEvictionKey(iterator.value()), url);
+
+		m_index.erase(iterator);
+	}
+}
+
 void NetworkCache::clearCache(int period)
 {
 	if (period <= 0)
@@ -59,136 +297,497 @@ void NetworkCache::clearCache(int period)
 		return;
 	}
 
+	ensureIndex();
+	pruneIndex();
+
 	const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
-	const QDir cacheMainDirectory(cacheDirectory());
-	const QStringList directories(cacheMainDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
+	QVector<QUrl> urls;
+	QHash<QUrl, EntryInformation>::const_iterator iterator;
 
-	for (int i = 0; i < directories.count(); ++i)
+	for (iterator = m_index.constBegin(); iterator != m_index.constEnd(); ++iterator)
 	{
-		const QDir cacheSubDirectory(cacheMainDirectory.absoluteFilePath(directories.at(i)));
-		const QStringList subDirectories(cacheSubDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
-
-		for (int j = 0; j < subDirectories.count(); ++j)
+		if (iterator.value().storageTime.secsTo(currentDateTime) < (period * 3600))
 		{
-			const QFileInfoList files(QDir(cacheSubDirectory.absoluteFilePath(subDirectories.at(j))).entryInfoList(QDir::Files));
+			urls.append(iterator.key());
+		}
+	}
 
-			for (int k = 0; k < files.count(); ++k)
-			{
-				const QFileInfo file(files.at(k));
+	for (int i = 0; i < urls.count(); ++i)
+	{
+		remove(urls.at(i));
+	}
+}
 
-				if (file.lastModified().toUTC().secsTo(currentDateTime) < (period * 3600))
-				{
-					const QNetworkCacheMetaData metaData(fileMetaData(file.absoluteFilePath()));
+void NetworkCache::clear()
+{
+	if (m_indexIterator)
+	{
+		delete m_indexIterator;
 
-					if (metaData.isValid())
-					{
-						remove(metaData.url());
-					}
-				}
-			}
-		}
+		m_indexIterator = nullptr;
+
+		killTimer(m_indexTimer);
+
+		m_indexTimer = 0;
 	}
+
+	m_index.clear();
+	m_evictionQueue.clear();
+	m_indexSize = 0;
+	m_needsPruning = false;
+
+	QNetworkDiskCache::clear();
 }
 
 void NetworkCache::insert(QIODevice *device)
 {
+	const qint64 size(device ? device->size() : -1);
+
 	QNetworkDiskCache::insert(device);
 
-	if (m_devices.contains(device))
+	if (!m_devices.contains(device))
 	{
-		emit entryAdded(m_devices[device]);
+		return;
+	}
+
+	const QNetworkCacheMetaData metaData(m_devices.take(device));
+	EntryInformation information(createEntryInformation(metaData));
+	information.storageTime = QDateTime::currentDateTimeUtc();
+	information.lastAccessTime = information.storageTime;
+	information.path = findPathForUrl(metaData.url());
+	information.size = size;
+	information.fileSize = (information.path.isEmpty() ? qMax(size, qint64(0)) : QFileInfo(information.path).size());
+
+	if (m_isUpdatingMetaData && m_index.contains(metaData.url()))
+	{
+		const EntryInformation previousInformation(m_index.value(metaData.url()));
+
+		information.storageTime = previousInformation.storageTime;
+		information.lastAccessTime = previousInformation.lastAccessTime;
+		information.accessesAmount = previousInformation.accessesAmount;
+
+		addIndexEntry(metaData.url(), information);
+
+		return;
+	}
 
-		m_devices.remove(device);
+	addIndexEntry(metaData.url(), information);
+
+	emit entryAdded(metaData.url());
+
+	if (!m_indexIterator && maximumCacheSize() > 0 && m_indexSize > maximumCacheSize())
+	{
+		evictEntries((maximumCacheSize() * 9) / 10);
 	}
 }
 
+void NetworkCache::updateMetaData(const QNetworkCacheMetaData &metaData)
+{
+	m_isUpdatingMetaData = true;
+
+	QNetworkDiskCache::updateMetaData(metaData);
+
+	m_isUpdatingMetaData = false;
+}
+
 QIODevice* NetworkCache::prepare(const QNetworkCacheMetaData &metaData)
 {
 	QIODevice *device(QNetworkDiskCache::prepare(metaData));
 
 	if (device)
 	{
-		m_devices[device] = metaData.url();
+		m_devices[device] = metaData;
 	}
 
 	return device;
 }
 
+NetworkCache::EntryInformation NetworkCache::createEntryInformation(const QNetworkCacheMetaData &metaData)
+{
+	const QList<QPair<QByteArray, QByteArray> > headers(metaData.rawHeaders());
+	EntryInformation information;
+	information.lastModified = metaData.lastModified();
+	information.expirationDate = metaData.expirationDate();
+
+	for (int i = 0; i < headers.count(); ++i)
+	{
+		if (headers.at(i).first == QByteArrayLiteral("Content-Type"))
+		{
+			information.type = QString::fromLatin1(headers.at(i).second);
+
+			break;
+		}
+	}
+
+	return information;
+}
+
 QString NetworkCache::getPathForUrl(const QUrl &url)
 {
-	if (!url.isValid() || !metaData(url).isValid())
+	if (!url.isValid())
 	{
 		return {};
 	}
 
-	const QDir cacheMainDirectory(cacheDirectory());
-	const QStringList directories(cacheMainDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
+	ensureIndex();
 
-	for (int i = 0; i < directories.count(); ++i)
+	QHash<QUrl, EntryInformation>::iterator iterator(m_index.find(url));
+
+	if (iterator == m_index.end())
 	{
-		const QDir cacheSubDirectory(cacheMainDirectory.absoluteFilePath(directories.at(i)));
-		const QStringList subDirectories(cacheSubDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
+		return {};
+	}
 
-		for (int j = 0; j < subDirectories.count(); ++j)
-		{
-			const QDir cacheFilesDirectory(cacheSubDirectory.absoluteFilePath(subDirectories.at(j)));
-			const QStringList files(cacheFilesDirectory.entryList(QDir::Files));
+	if (!iterator.value().path.isEmpty() && QFileInfo::exists(iterator.value().path))
+	{
+		return iterator.value().path;
+	}
 
-			for (int k = 0; k < files.count(); ++k)
-			{
-				const QString cacheFilePath(cacheFilesDirectory.absoluteFilePath(files.at(k)));
-				const QNetworkCacheMetaData metaData(fileMetaData(cacheFilePath));
+	if (!QNetworkDiskCache::metaData(url).isValid())
+	{
+		removeIndexEntry(url);
 
-				if (metaData.isValid() && url == metaData.url())
-				{
-					return cacheFilePath;
-				}
-			}
-		}
+		emit entryRemoved(url);
+
+		return {};
+	}
+
+	iterator.value().path = findPathForUrl(url);
+
+	if (!iterator.value().path.isEmpty())
+	{
+		const qint64 fileSize(QFileInfo(iterator.value().path).size());
+
+		m_indexSize += (fileSize - iterator.value().fileSize);
+
+		iterator.value().fileSize = fileSize;
 	}
 
-	return {};
+	return iterator.value().path;
 }
 
-QVector<QUrl> NetworkCache::getEntries() const
+QString NetworkCache::findPathForUrl(const QUrl &url) const
 {
-	QVector<QUrl> entries;
-	const QDir cacheMainDirectory(cacheDirectory());
-	const QStringList directories(cacheMainDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
+	QUrl cleanUrl(url);
+	cleanUrl.setPassword(QString());
+	cleanUrl.setFragment(QString());
+
+	const QByteArray hash(QCryptographicHash::hash(cleanUrl.toEncoded(), QCryptographicHash::Sha1));
+	qlonglong hashValue(0);
+
+	std::memcpy(&hashValue, hash.constData(), sizeof(hashValue));
+
+	const QByteArray identifier(QByteArray::number(hashValue, 36).left(8));
+	const QString path(QDir(cacheDirectory()).absoluteFilePath(QStringLiteral("data8/%1/%2.d").arg(QString::number((static_cast<uint>(identifier.at(identifier.length() - 1)) % 16), 16), QString::fromLatin1(identifier))));
+
+	return (QFileInfo::exists(path) ? path : QString());
+}
+
+NetworkCache::EntryInformation NetworkCache::getEntryInformation(const QUrl &url)
+{
+	ensureIndex();
+
+	return m_index.value(url);
+}
+
+QVector<QUrl> NetworkCache::getEntries()
+{
+	ensureIndex();
+	pruneIndex();
+
+	return m_index.keys().toVector();
+}
+
+void NetworkCache::evictEntries(qint64 targetSize)
+{
+	pruneIndex();
+
+	while (!m_evictionQueue.isEmpty() && m_indexSize > targetSize)
+	{
+		const QUrl url(m_evictionQueue.constBegin().value());
+		const qint64 previousSize(m_indexSize);
+
+		QNetworkDiskCache::remove(url);
+
+		removeIndexEntry(url);
+
+		m_evictedBytes += static_cast<quint64>(previousSize - m_indexSize);
+
+		++m_evictedEntries;
+
+		emit entryRemoved(url);
+	}
+}
+
+void NetworkCache::recordAccess(const QUrl &url, qint64 size, bool isHit)
+{
+	CacheStatistics &hostStatistics(m_hostStatistics[url.host()]);
+
+	if (!isHit)
+	{
+		++m_statistics.misses;
+		++hostStatistics.misses;
+
+		return;
+	}
+
+	++m_statistics.hits;
+	++hostStatistics.hits;
+
+	if (size > 0)
+	{
+		m_statistics.savedBytes += static_cast<quint64>(size);
+		hostStatistics.savedBytes += static_cast<quint64>(size);
+	}
+
+	QHash<QUrl, EntryInformation>::iterator iterator(m_index.find(url));
+
+	if (iterator != m_index.end())
+	{
+		m_evictionQueue.remove(getEvictionKey(iterator.value()), url);
+
+		iterator.value().lastAccessTime = QDateTime::currentDateTimeUtc();
+
+		++iterator.value().accessesAmount;
+
+		m_evictionQueue.insert(getEvictionKey(iterator.value()), url);
+	}
+}
+
+void NetworkCache::setEvictionPolicy(const QString &policy)
+{
+	const EvictionPolicy evictionPolicy(getEvictionPolicy(policy));
+
+	if (evictionPolicy == m_evictionPolicy)
+	{
+		return;
+	}
+
+	m_evictionPolicy = evictionPolicy;
+	m_evictionQueue.clear();
+
+	QHash<QUrl, EntryInformation>::const_iterator iterator;
+
+	for (iterator = m_index.constBegin(); iterator != m_index.constEnd(); ++iterator)
+	{
+		m_evictionQueue.insert(getEvictionKey(iterator.value()), iterator.key());
+	}
+}
+
+QPair<int, qint64> NetworkCache::getEvictionKey(const EntryInformation &information) const
+{
+	int rank(0);
+
+	switch (m_evictionPolicy)
+	{
+		case LeastFrequentlyUsedPolicy:
+			rank = information.accessesAmount;
+
+			break;
+		case SegmentedLeastRecentlyUsedPolicy:
+			rank = ((information.accessesAmount > 1) ? 1 : 0);
+
+			break;
+		default:
+			break;
+	}
+
+	return {rank, information.lastAccessTime.toMSecsSinceEpoch()};
+}
+
+NetworkCache::EvictionPolicy NetworkCache::getEvictionPolicy(const QString &policy)
+{
+	if (policy == QLatin1String("leastRecentlyUsed"))
+	{
+		return LeastRecentlyUsedPolicy;
+	}
+
+	if (policy == QLatin1String("leastFrequentlyUsed"))
+	{
+		return LeastFrequentlyUsedPolicy;
+	}
+
+	return SegmentedLeastRecentlyUsedPolicy;
+}
+
+QString NetworkCache::getEvictionPolicyName(EvictionPolicy policy)
+{
+	switch (policy)
+	{
+		case LeastRecentlyUsedPolicy:
+			return QLatin1String("LRU");
+		case LeastFrequentlyUsedPolicy:
+			return QLatin1String("LFU");
+		default:
+			break;
+	}
+
+	return QLatin1String("Segmented LRU");
+}
+
+QIODevice* NetworkCache::data(const QUrl &url)
+{
+	QIODevice *device(QNetworkDiskCache::data(url));
+
+	if (device && !m_isUpdatingMetaData)
+	{
+		recordAccess(url, device->size(), true);
+	}
+
+	return device;
+}
+
+QIODevice* NetworkCache::getEntryData(const QUrl &url)
+{
+	return QNetworkDiskCache::data(url);
+}
+
+QNetworkCacheMetaData NetworkCache::metaData(const QUrl &url)
+{
+	const QNetworkCacheMetaData metaData(QNetworkDiskCache::metaData(url));
+
+	if (!metaData.isValid())
+	{
+		recordAccess(url, 0, false);
+	}
+
+	return metaData;
+}
+
+NetworkCache::CacheStatistics NetworkCache::getStatistics() const
+{
+	return m_statistics;
+}
+
+NetworkCache::CacheStatistics NetworkCache::getStatistics(const QString &host) const
+{
+	return m_hostStatistics.value(host);
+}
+
+DiagnosticReport::Section NetworkCache::createReport()
+{
+	const quint64 requestsAmount(m_statistics.hits + m_statistics.misses);
+	DiagnosticReport::Section report;
+	report.title = QLatin1String("Disk Cache");
+	report.fieldWidths = {30, 0};
+	report.entries.reserve(8);
+	report.entries.append({QLatin1String("Eviction Policy"), getEvictionPolicyName(m_evictionPolicy)});
+	report.entries.append({QLatin1String("Entries"), (m_indexIterator ? QStringLiteral("%1 (indexing)").arg(m_index.count()) : QString::number(m_index.count()))});
+	report.entries.append({QLatin1String("Size"), QStringLiteral("%1 / %2").arg(Utils::formatUnit(m_indexSize, false, 1, true), Utils::formatUnit(maximumCacheSize(), false, 1, true))});
+	report.entries.append({QLatin1String("Hits"), QString::number(m_statistics.hits)});
+	report.entries.append({QLatin1String("Misses"), QString::number(m_statistics.misses)});
+	report.entries.append({QLatin1String("Hit Ratio"), ((requestsAmount > 0) ? QStringLiteral("%1%").arg(((m_statistics.hits * 100.0) / requestsAmount), 0, 'f', 1) : QString(QLatin1Char('-')))});
+	report.entries.append({QLatin1String("Saved Transfers"), Utils::formatUnit(static_cast<qint64>(m_statistics.savedBytes), false, 1, true)});
+	report.entries.append({QLatin1String("Evicted Entries"), QStringLiteral("%1 (%2)").arg(m_evictedEntries).arg(Utils::formatUnit(static_cast<qint64>(m_evictedBytes), false, 1, true))});
+
+	return report;
+}
+
+DiagnosticReport::Section NetworkCache::createReport(const QString &path)
+{
+	QFile file(QDir(path).filePath(QLatin1String("index.dat")));
+	qint64 size(0);
+	int amount(0);
+	bool isIndexValid(false);
 
-	for (int i = 0; i < directories.count(); ++i)
+	if (file.open(QIODevice::ReadOnly))
 	{
-		const QDir cacheSubDirectory(cacheMainDirectory.absoluteFilePath(directories.at(i)));
-		const QStringList subDirectories(cacheSubDirectory.entryList(QDir::AllDirs | QDir::NoDotAndDotDot));
+		QDataStream stream(&file);
+		stream.setVersion(QDataStream::Qt_5_15);
+
+		quint32 version(0);
+		quint32 entriesAmount(0);
+
+		stream >> version >> entriesAmount;
+
+		isIndexValid = (version == m_indexVersion && stream.status() == QDataStream::Ok);
 
-		for (int j = 0; j < subDirectories.count(); ++j)
+		for (quint32 i = 0; isIndexValid && i < entriesAmount; ++i)
 		{
-			const QDir cacheFilesDirectory(cacheSubDirectory.absoluteFilePath(subDirectories.at(j)));
-			const QStringList files(cacheFilesDirectory.entryList(QDir::Files));
+			QUrl url;
+			EntryInformation information;
 
-			entries.reserve(entries.count() + files.count());
+			stream >> url >> information.path >> information.type >> information.lastModified >> information.expirationDate >> information.storageTime >> information.lastAccessTime >> information.size >> information.fileSize >> information.accessesAmount;
 
-			for (int k = 0; k < files.count(); ++k)
-			{
-				const QNetworkCacheMetaData metaData(fileMetaData(cacheFilesDirectory.absoluteFilePath(files.at(k))));
+			isIndexValid = (stream.status() == QDataStream::Ok);
+			size += information.fileSize;
 
-				if (metaData.url().isValid())
-				{
-					entries.append(metaData.url());
-				}
-			}
+			++amount;
+		}
+
+		file.close();
+	}
+
+	if (!isIndexValid)
+	{
+		QDirIterator iterator(path, {QLatin1String("*.d")}, QDir::Files, QDirIterator::Subdirectories);
+
+		size = 0;
+		amount = 0;
+
+		while (iterator.hasNext())
+		{
+			iterator.next();
+
+			size += iterator.fileInfo().size();
+
+			++amount;
+		}
+	}
+
+	DiagnosticReport::Section report;
+	report.title = QLatin1String("Disk Cache");
+	report.fieldWidths = {30, 0};
+	report.entries.reserve(3);
+	report.entries.append({QLatin1String("Eviction Policy"), getEvictionPolicyName(getEvictionPolicy(SettingsManager::getOption(SettingsManager::Cache_EvictionPolicyOption).toString()))});
+	report.entries.append({QLatin1String("Entries"), QString::number(amount)});
+	report.entries.append({QLatin1String("Size"), QStringLiteral("%1 / %2").arg(Utils::formatUnit(size, false, 1, true), Utils::formatUnit((SettingsManager::getOption(SettingsManager::Cache_DiskCacheLimitOption).toInt() * 1024), false, 1, true))});
+
+	return report;
+}
+
+qint64 NetworkCache::expire()
+{
+	if (m_indexIterator || maximumCacheSize() <= 0)
+	{
+		const qint64 size(QNetworkDiskCache::expire());
+
+		if (size < m_indexSize && !m_index.isEmpty())
+		{
+			m_needsPruning = true;
 		}
+
+		return size;
 	}
 
-	entries.squeeze();
+	if (m_indexSize > maximumCacheSize())
+	{
+		evictEntries((maximumCacheSize() * 9) / 10);
+	}
 
-	return entries;
+	return m_indexSize;
 }
 
 bool NetworkCache::remove(const QUrl &url)
 {
+	QHash<QIODevice*, QNetworkCacheMetaData>::iterator iterator(m_devices.begin());
+
+	while (iterator != m_devices.end())
+	{
+		if (iterator.value().url() == url)
+		{
+			iterator = m_devices.erase(iterator);
+		}
+		else
+		{
+			++iterator;
+		}
+	}
+
 	const bool result(QNetworkDiskCache::remove(url));
 
+	removeIndexEntry(url);
+
 	if (result)
 	{
 		emit entryRemoved(url);
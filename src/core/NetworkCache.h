@@ -20,6 +20,11 @@
 #ifndef OTTER_NETWORKCACHE_H
 #define OTTER_NETWORKCACHE_H
 
+#include "Utils.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDirIterator>
+#include <QtCore/QMap>
 #include <QtNetwork/QNetworkDiskCache>
 
 namespace Otter
@@ -30,17 +35,88 @@ class NetworkCache final : public QNetworkDiskCache
 	Q_OBJECT
 
 public:
+	enum EvictionPolicy
+	{
+		LeastRecentlyUsedPolicy = 0,
+		LeastFrequentlyUsedPolicy,
+		SegmentedLeastRecentlyUsedPolicy
+	};
+
+	struct EntryInformation final
+	{
+		QString path;
+		QString type;
+		QDateTime lastModified;
+		QDateTime expirationDate;
+		QDateTime storageTime;
+		QDateTime lastAccessTime;
+		qint64 size = -1;
+		qint64 fileSize = 0;
+		int accessesAmount = 0;
+	};
+
+	struct CacheStatistics final
+	{
+		quint64 hits = 0;
+		quint64 misses = 0;
+		quint64 savedBytes = 0;
+	};
+
 	explicit NetworkCache(const QString &path, QObject *parent = nullptr);
+	~NetworkCache();
 
 	void clearCache(int period = 0);
+	void clear() override;
 	void insert(QIODevice *device) override;
+	void updateMetaData(const QNetworkCacheMetaData &metaData) override;
 	QIODevice* prepare(const QNetworkCacheMetaData &metaData) override;
+	QIODevice* data(const QUrl &url) override;
+	QIODevice* getEntryData(const QUrl &url);
+	QNetworkCacheMetaData metaData(const QUrl &url) override;
 	QString getPathForUrl(const QUrl &url);
-	QVector<QUrl> getEntries() const;
+	EntryInformation getEntryInformation(const QUrl &url);
+	CacheStatistics getStatistics() const;
+	CacheStatistics getStatistics(const QString &host) const;
+	DiagnosticReport::Section createReport();
+	static DiagnosticReport::Section createReport(const QString &path);
+	QVector<QUrl> getEntries();
 	bool remove(const QUrl &url) override;
 
+protected:
+	void timerEvent(QTimerEvent *event) override;
+	void loadIndex();
+	void saveIndex();
+	void ensureIndex();
+	void updateIndex(int limit);
+	void pruneIndex();
+	void evictEntries(qint64 targetSize);
+	void recordAccess(const QUrl &url, qint64 size, bool isHit);
+	void setEvictionPolicy(const QString &policy);
+	void addIndexEntry(const QUrl &url, const EntryInformation &information);
+	void removeIndexEntry(const QUrl &url);
+	QString findPathForUrl(const QUrl &url) const;
+	QPair<int, qint64> getEvictionKey(const EntryInformation &information) const;
+	qint64 expire() override;
+	static EntryInformation createEntryInformation(const QNetworkCacheMetaData &metaData);
+	static EvictionPolicy getEvictionPolicy(const QString &policy);
+	static QString getEvictionPolicyName(EvictionPolicy policy);
+
 private:
-	QHash<QIODevice*, QUrl> m_devices;
+	QDirIterator *m_indexIterator;
+	QHash<QIODevice*, QNetworkCacheMetaData> m_devices;
+	QHash<QUrl, EntryInformation> m_index;
+	QMultiMap<QPair<int, qint64>, QUrl> m_evictionQueue;
+	QHash<QString, CacheStatistics> m_hostStatistics;
+	CacheStatistics m_statistics;
+	EvictionPolicy m_evictionPolicy;
+	qint64 m_indexSize;
+	quint64 m_evictedBytes;
+	quint64 m_evictedEntries;
+	int m_indexTimer;
+	bool m_needsPruning;
+	bool m_isUpdatingMetaData;
+
+	static const quint32 m_indexVersion;
 
 signals:
 	void cleared();
@@ -279,7 +279,7 @@ void NetworkManagerFactory::clearCookies(int period)
 {
 	if (!m_cookieJar)
 	{
-		m_cookieJar = new CookieJar(SessionsManager::getWritableDataPath(QLatin1String("cookies.dat")), QCoreApplication::instance());
+		m_cookieJar = new CookieJar(SessionsManager::getWritableDataPath(QLatin1String("cookieJar.dat")), QCoreApplication::instance());
 	}
 
 	m_cookieJar->clearCookies(period);
@@ -655,7 +655,7 @@ CookieJar* NetworkManagerFactory::getCookieJar()
 {
 	if (!m_cookieJar)
 	{
-		m_cookieJar = new CookieJar(SessionsManager::getWritableDataPath(QLatin1String("cookies.dat")), QCoreApplication::instance());
+		m_cookieJar = new CookieJar(SessionsManager::getWritableDataPath(QLatin1String("cookieJar.dat")), QCoreApplication::instance());
 	}
 
 	return m_cookieJar;
@@ -767,6 +767,11 @@ bool NetworkManagerFactory::canSendReferrer()
 	return m_canSendReferrer;
 }
 
+bool NetworkManagerFactory::hasCache()
+{
+	return (m_cache != nullptr);
+}
+
 bool NetworkManagerFactory::isWorkingOffline()
 {
 	return m_isWorkingOffline;
@@ -207,6 +207,7 @@ public:
 	static UserAgentDefinition getUserAgent(const QString &identifier);
 	static DoNotTrackPolicy getDoNotTrackPolicy();
 	static bool canSendReferrer();
+	static bool hasCache();
 	static bool isWorkingOffline();
 	static bool usesSystemProxyAuthentication();
 	bool event(QEvent *event) override;
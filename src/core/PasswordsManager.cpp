@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2015 - 2022 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2015 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -19,7 +19,7 @@
 
 #include "PasswordsManager.h"
 #include "PasswordsStorageBackend.h"
-#include "../modules/backends/passwords/file/FilePasswordsStorageBackend.h"
+#include "../modules/backends/passwords/journal/JournalPasswordsStorageBackend.h"
 
 namespace Otter
 {
@@ -36,7 +36,7 @@ void PasswordsManager::createInstance()
 	if (!m_instance)
 	{
 		m_instance = new PasswordsManager(QCoreApplication::instance());
-		m_backend = new FilePasswordsStorageBackend(m_instance);
+		m_backend = new JournalPasswordsStorageBackend(m_instance);
 
 		connect(m_backend, &PasswordsStorageBackend::passwordsModified, m_instance, &PasswordsManager::passwordsModified);
 	}
@@ -27,7 +27,7 @@
 
 #include <QtCore/QDir>
 #include <QtCore/QJsonArray>
-#include <QtCore/QJsonObject>
+#include <QtCore/QJsonDocument>
 
 namespace Otter
 {
@@ -50,6 +50,8 @@ bool SessionsManager::m_isPrivate(false);
 bool SessionsManager::m_isReadOnly(false);
 
 SessionsManager::SessionsManager(QObject *parent) : QObject(parent),
+	m_journal(nullptr),
+	m_snapshotThread(nullptr),
 	m_saveTimer(0)
 {
 }
@@ -64,9 +66,9 @@ void SessionsManager::timerEvent(QTimerEvent *event)
 
 		m_saveTimer = 0;
 
-		if (!m_isPrivate)
+		if (!m_isPrivate && !Application::isAboutToQuit())
 		{
-			saveSession({}, {}, nullptr, false);
+			saveJournal();
 		}
 	}
 }
@@ -81,6 +83,7 @@ void SessionsManager::createInstance(const QString &profilePath, const QString &
 		m_profilePath = profilePath;
 		m_isPrivate = isPrivate;
 		m_isReadOnly = isReadOnly;
+		m_instance->m_journal = new JournalFile(QDir::toNativeSeparators(profilePath + QLatin1String("/sessions/default.journal")), m_instance);
 	}
 }
 
@@ -92,6 +95,466 @@ void SessionsManager::scheduleSave()
 	}
 }
 
+void SessionsManager::saveJournal()
+{
+	const QStringList excludedOptions(SettingsManager::getOption(SettingsManager::Sessions_OptionsExludedFromSavingOption).toStringList());
+	const QVector<MainWindow*> mainWindows(Application::getWindows());
+	const bool needsSnapshot(m_journaledSession.isEmpty());
+	QHash<quint64, QJsonObject> journaledMainWindows;
+	QHash<quint64, QJsonObject> journaledWindows;
+	QJsonArray mainWindowsArray;
+
+	for (int i = 0; i < mainWindows.count(); ++i)
+	{
+		const MainWindow *mainWindow(mainWindows.at(i));
+
+		if (mainWindow->isPrivate())
+		{
+			continue;
+		}
+
+		const Window *activeWindow(mainWindow->getActiveWindow());
+		const quint64 mainWindowIdentifier(mainWindow->getIdentifier());
+		Session::MainWindow mainWindowSession(mainWindow->getSession(false));
+		QJsonArray windowsArray;
+
+		for (int j = 0; j < mainWindow->getWindowCount(); ++j)
+		{
+			const Window *window(mainWindow->getWindowByIndex(j));
+
+			if (!window || window->isPrivate())
+			{
+				if (j <= mainWindowSession.index)
+				{
+					--mainWindowSession.index;
+				}
+
+				continue;
+			}
+
+			const quint64 identifier(window->getIdentifier());
+
+			if (window == activeWindow || m_modifiedWindows.contains(identifier) || !m_journaledWindows.contains(identifier))
+			{
+				const QJsonObject windowObject(createWindowObject(window->getSession(), excludedOptions));
+
+				if (!needsSnapshot && windowObject != m_journaledWindows.value(identifier))
+				{
+					m_journal->addRecord(WindowRecord, createRecord(windowObject, identifier));
+				}
+
+				journaledWindows[identifier] = windowObject;
+			}
+			else
+			{
+				journaledWindows[identifier] = m_journaledWindows.value(identifier);
+			}
+
+			windowsArray.append(static_cast<qint64>(identifier));
+		}
+
+		QJsonObject mainWindowObject(createMainWindowObject(mainWindowSession, excludedOptions));
+		mainWindowObject.insert(QLatin1String("windows"), windowsArray);
+
+		if (!needsSnapshot && mainWindowObject != m_journaledMainWindows.value(mainWindowIdentifier))
+		{
+			m_journal->addRecord(MainWindowRecord, createRecord(mainWindowObject, mainWindowIdentifier));
+		}
+
+		journaledMainWindows[mainWindowIdentifier] = mainWindowObject;
+
+		mainWindowsArray.append(static_cast<qint64>(mainWindowIdentifier));
+	}
+
+	m_modifiedWindows.clear();
+
+	if (mainWindowsArray.isEmpty())
+	{
+		return;
+	}
+
+	const QJsonObject sessionObject({{QLatin1String("windows"), mainWindowsArray}});
+
+	if (!needsSnapshot && sessionObject != m_journaledSession)
+	{
+		m_journal->addRecord(SessionRecord, createRecord(sessionObject, 0));
+	}
+
+	m_journaledSession = sessionObject;
+	m_journaledMainWindows = journaledMainWindows;
+	m_journaledWindows = journaledWindows;
+
+	if (needsSnapshot || m_journal->needsCompaction(m_journaledWindows.count() + m_journaledMainWindows.count() + 1))
+	{
+		compactJournal();
+	}
+	else
+	{
+		m_journal->flush();
+	}
+}
+
+void SessionsManager::compactJournal()
+{
+	if (m_journal->isCompacting() || m_snapshotThread)
+	{
+		m_journal->flush();
+
+		return;
+	}
+
+	Utils::ensureDirectoryExists(m_profilePath + QLatin1String("/sessions/"));
+
+	m_journal->compact(createJournalRecords());
+
+	QJsonObject sessionObject(m_journaledSession);
+	sessionObject.insert(QLatin1String("title"), (m_sessionTitle.isEmpty() ? tr("Default") : m_sessionTitle));
+	sessionObject.insert(QLatin1String("currentIndex"), 1);
+	sessionObject.insert(QLatin1String("isClean"), false);
+
+	const QJsonObject snapshotObject(createSessionObject(sessionObject, m_journaledMainWindows, m_journaledWindows));
+	const QString path(getSessionPath(QLatin1String("default")));
+
+	m_snapshotThread = QThread::create([=]()
+	{
+		JsonSettings settings;
+		settings.setObject(snapshotObject);
+		settings.save(path);
+	});
+
+	connect(m_snapshotThread, &QThread::finished, this, [=]()
+	{
+		m_snapshotThread->deleteLater();
+		m_snapshotThread = nullptr;
+	});
+
+	m_snapshotThread->start(QThread::LowPriority);
+}
+
+void SessionsManager::resetJournal()
+{
+	m_journal->clear();
+
+	m_journaledSession = {};
+	m_journaledMainWindows.clear();
+	m_journaledWindows.clear();
+	m_modifiedWindows.clear();
+}
+
+QVector<JournalFile::Record> SessionsManager::createJournalRecords() const
+{
+	QVector<JournalFile::Record> records;
+	records.reserve(m_journaledWindows.count() + m_journaledMainWindows.count() + 1);
+
+	QHash<quint64, QJsonObject>::const_iterator iterator;
+
+	for (iterator = m_journaledWindows.constBegin(); iterator != m_journaledWindows.constEnd(); ++iterator)
+	{
+		JournalFile::Record record;
+		record.type = WindowRecord;
+		record.data = createRecord(iterator.value(), iterator.key());
+
+		records.append(record);
+	}
+
+	for (iterator = m_journaledMainWindows.constBegin(); iterator != m_journaledMainWindows.constEnd(); ++iterator)
+	{
+		JournalFile::Record record;
+		record.type = MainWindowRecord;
+		record.data = createRecord(iterator.value(), iterator.key());
+
+		records.append(record);
+	}
+
+	JournalFile::Record record;
+	record.type = SessionRecord;
+	record.data = createRecord(m_journaledSession, 0);
+
+	records.append(record);
+
+	return records;
+}
+
+QJsonObject SessionsManager::loadJournal()
+{
+	if (!m_instance || !m_instance->m_journal->exists())
+	{
+		return {};
+	}
+
+	const QVector<JournalFile::Record> records(m_instance->m_journal->load());
+	QHash<quint64, QJsonObject> mainWindows;
+	QHash<quint64, QJsonObject> windows;
+	QJsonObject sessionObject;
+
+	for (int i = 0; i < records.count(); ++i)
+	{
+		const QJsonObject object(QJsonDocument::fromJson(records.at(i).data).object());
+		const quint64 identifier(object.value(QLatin1String("identifier")).toVariant().toULongLong());
+
+		switch (records.at(i).type)
+		{
+			case SessionRecord:
+				sessionObject = object;
+
+				break;
+			case MainWindowRecord:
+				mainWindows[identifier] = object;
+
+				break;
+			case WindowRecord:
+				windows[identifier] = object;
+
+				break;
+			default:
+				break;
+		}
+	}
+
+	if (sessionObject.value(QLatin1String("windows")).toArray().isEmpty())
+	{
+		return {};
+	}
+
+	return createSessionObject(sessionObject, mainWindows, windows);
+}
+
+QJsonObject SessionsManager::createSessionObject(const QJsonObject &sessionObject, const QHash<quint64, QJsonObject> &mainWindows, const QHash<quint64, QJsonObject> &windows)
+{
+	const QJsonArray mainWindowsIdentifiers(sessionObject.value(QLatin1String("windows")).toArray());
+	QJsonObject object(sessionObject);
+	QJsonArray mainWindowsArray;
+
+	for (int i = 0; i < mainWindowsIdentifiers.count(); ++i)
+	{
+		const quint64 mainWindowIdentifier(mainWindowsIdentifiers.at(i).toVariant().toULongLong());
+
+		if (!mainWindows.contains(mainWindowIdentifier))
+		{
+			continue;
+		}
+
+		QJsonObject mainWindowObject(mainWindows[mainWindowIdentifier]);
+		const QJsonArray windowsIdentifiers(mainWindowObject.value(QLatin1String("windows")).toArray());
+		QJsonArray windowsArray;
+
+		for (int j = 0; j < windowsIdentifiers.count(); ++j)
+		{
+			const quint64 windowIdentifier(windowsIdentifiers.at(j).toVariant().toULongLong());
+
+			if (windows.contains(windowIdentifier))
+			{
+				QJsonObject windowObject(windows[windowIdentifier]);
+				windowObject.remove(QLatin1String("identifier"));
+
+				windowsArray.append(windowObject);
+			}
+		}
+
+		mainWindowObject.remove(QLatin1String("identifier"));
+		mainWindowObject.insert(QLatin1String("windows"), windowsArray);
+
+		mainWindowsArray.append(mainWindowObject);
+	}
+
+	object.remove(QLatin1String("identifier"));
+	object.insert(QLatin1String("windows"), mainWindowsArray);
+
+	return object;
+}
+
+QJsonObject SessionsManager::createMainWindowObject(const Session::MainWindow &mainWindow, const QStringList &excludedOptions)
+{
+	QJsonObject mainWindowObject({{QLatin1String("currentIndex"), (mainWindow.index + 1)}, {QLatin1String("geometry"), QString::fromLatin1(mainWindow.geometry.toBase64())}});
+	QJsonArray windowsArray;
+
+	for (int i = 0; i < mainWindow.windows.count(); ++i)
+	{
+		windowsArray.append(createWindowObject(mainWindow.windows.at(i), excludedOptions));
+	}
+
+	mainWindowObject.insert(QLatin1String("windows"), windowsArray);
+
+	if (mainWindow.hasToolBarsState)
+	{
+		QJsonArray toolBarsArray;
+
+		for (int i = 0; i < mainWindow.toolBars.count(); ++i)
+		{
+			const QString identifier(ToolBarsManager::getToolBarName(mainWindow.toolBars.at(i).identifier));
+
+			if (identifier.isEmpty())
+			{
+				continue;
+			}
+
+			QJsonObject toolBarObject({{QLatin1String("identifier"), identifier}});
+			QString location;
+
+			switch (mainWindow.toolBars.at(i).location)
+			{
+				case Qt::LeftToolBarArea:
+					location = QLatin1String("left");
+
+					break;
+				case Qt::RightToolBarArea:
+					location = QLatin1String("right");
+
+					break;
+				case Qt::TopToolBarArea:
+					location = QLatin1String("top");
+
+					break;
+				case Qt::BottomToolBarArea:
+					location = QLatin1String("bottom");
+
+					break;
+				default:
+					break;
+			}
+
+			if (!location.isEmpty())
+			{
+				toolBarObject.insert(QLatin1String("location"), location);
+			}
+
+			if (mainWindow.toolBars.at(i).normalVisibility != Session::MainWindow::ToolBarState::UnspecifiedVisibilityToolBar)
+			{
+				toolBarObject.insert(QLatin1String("normalVisibility"), ((mainWindow.toolBars.at(i).normalVisibility == Session::MainWindow::ToolBarState::AlwaysHiddenToolBar) ? QLatin1String("hidden") : QLatin1String("visible")));
+			}
+
+			if (mainWindow.toolBars.at(i).fullScreenVisibility != Session::MainWindow::ToolBarState::UnspecifiedVisibilityToolBar)
+			{
+				toolBarObject.insert(QLatin1String("fullScreenVisibility"), ((mainWindow.toolBars.at(i).fullScreenVisibility == Session::MainWindow::ToolBarState::AlwaysHiddenToolBar) ? QLatin1String("hidden") : QLatin1String("visible")));
+			}
+
+			if (mainWindow.toolBars.at(i).row >= 0)
+			{
+				toolBarObject.insert(QLatin1String("row"), mainWindow.toolBars.at(i).row);
+			}
+
+			toolBarsArray.append(toolBarObject);
+		}
+
+		mainWindowObject.insert(QLatin1String("toolBars"), toolBarsArray);
+	}
+
+	if (!mainWindow.splitters.isEmpty())
+	{
+		QJsonArray splittersArray;
+		QMap<QString, QVector<int> >::const_iterator iterator;
+
+		for (iterator = mainWindow.splitters.begin(); iterator != mainWindow.splitters.end(); ++iterator)
+		{
+			QJsonArray sizesArray;
+			const QVector<int> &sizes(iterator.value());
+
+			for (int i = 0; i < sizes.count(); ++i)
+			{
+				sizesArray.append(sizes.at(i));
+			}
+
+			splittersArray.append(QJsonObject({{QLatin1String("identifier"), iterator.key()}, {QLatin1String("sizes"), sizesArray}}));
+		}
+
+		mainWindowObject.insert(QLatin1String("splitters"), splittersArray);
+	}
+
+	return mainWindowObject;
+}
+
+QJsonObject SessionsManager::createWindowObject(const Session::Window &window, const QStringList &excludedOptions)
+{
+	QJsonObject windowObject({{QLatin1String("currentIndex"), (window.history.index + 1)}});
+
+	if (!window.identity.isEmpty())
+	{
+		windowObject.insert(QLatin1String("identity"), window.identity);
+	}
+
+	if (!window.options.isEmpty())
+	{
+		const QHash<int, QVariant> windowOptions(window.options);
+		QHash<int, QVariant>::const_iterator optionsIterator;
+		QJsonObject optionsObject;
+
+		for (optionsIterator = windowOptions.constBegin(); optionsIterator != windowOptions.constEnd(); ++optionsIterator)
+		{
+			const QString optionName(SettingsManager::getOptionName(optionsIterator.key()));
+
+			if (!optionName.isEmpty() && !excludedOptions.contains(optionName))
+			{
+				optionsObject.insert(optionName, QJsonValue::fromVariant(optionsIterator.value()));
+			}
+		}
+
+		windowObject.insert(QLatin1String("options"), optionsObject);
+	}
+
+	switch (window.state.state)
+	{
+		case Qt::WindowMaximized:
+			windowObject.insert(QLatin1String("state"), QLatin1String("maximized"));
+
+			break;
+		case Qt::WindowMinimized:
+			windowObject.insert(QLatin1String("state"), QLatin1String("minimized"));
+
+			break;
+		default:
+			{
+				const QRect geometry(window.state.geometry);
+
+				windowObject.insert(QLatin1String("state"), QLatin1String("normal"));
+
+				if (geometry.isValid())
+				{
+					windowObject.insert(QLatin1String("geometry"), QStringLiteral("%1, %2, %3, %4").arg(geometry.x()).arg(geometry.y()).arg(geometry.width()).arg(geometry.height()));
+				}
+			}
+
+			break;
+	}
+
+	if (window.isAlwaysOnTop)
+	{
+		windowObject.insert(QLatin1String("isAlwaysOnTop"), true);
+	}
+
+	if (window.isPinned)
+	{
+		windowObject.insert(QLatin1String("isPinned"), true);
+	}
+
+	const Session::Window::History windowHistory(window.history);
+	QJsonArray windowHistoryArray;
+
+	for (int i = 0; i < windowHistory.entries.count(); ++i)
+	{
+		const QPoint position(windowHistory.entries.at(i).position);
+		QJsonObject historyEntryObject({{QLatin1String("url"), windowHistory.entries.at(i).url}, {QLatin1String("title"), windowHistory.entries.at(i).title}, {QLatin1String("zoom"), windowHistory.entries.at(i).zoom}});
+
+		if (!position.isNull())
+		{
+			historyEntryObject.insert(QLatin1String("position"), QStringLiteral("%1, %2").arg(position.x()).arg(position.y()));
+		}
+
+		windowHistoryArray.append(historyEntryObject);
+	}
+
+	windowObject.insert(QLatin1String("history"), windowHistoryArray);
+
+	return windowObject;
+}
+
+QByteArray SessionsManager::createRecord(const QJsonObject &object, quint64 identifier)
+{
+	QJsonObject recordObject(object);
+	recordObject.insert(QLatin1String("identifier"), static_cast<qint64>(identifier));
+
+	return QJsonDocument(recordObject).toJson(QJsonDocument::Compact);
+}
+
 void SessionsManager::clearClosedWindows()
 {
 	m_closedWindows.clear();
@@ -136,6 +599,16 @@ void SessionsManager::markSessionAsModified()
 	}
 }
 
+void SessionsManager::markWindowAsModified(quint64 identifier)
+{
+	if (!m_isPrivate && identifier > 0 && m_sessionPath == QLatin1String("default"))
+	{
+		m_instance->m_modifiedWindows.insert(identifier);
+
+		markSessionAsModified();
+	}
+}
+
 void SessionsManager::removeStoredUrl(const QString &url)
 {
 	emit m_instance->requestedRemoveStoredUrl(url);
@@ -220,8 +693,20 @@ SessionInformation SessionsManager::getSession(const QString &path)
 {
 	SessionInformation session;
 	const JsonSettings settings(getSessionPath(path));
+	QJsonObject sessionObject(settings.object());
 
-	if (settings.isNull())
+	if (path == QLatin1String("default"))
+	{
+		const QJsonObject journalObject(loadJournal());
+
+		if (!journalObject.isEmpty())
+		{
+			sessionObject.insert(QLatin1String("windows"), journalObject.value(QLatin1String("windows")));
+			sessionObject.insert(QLatin1String("isClean"), false);
+		}
+	}
+
+	if (sessionObject.isEmpty())
 	{
 		session.path = path;
 		session.title = ((path == QLatin1String("default")) ? tr("Default") : tr("(Untitled)"));
@@ -230,12 +715,12 @@ SessionInformation SessionsManager::getSession(const QString &path)
 	}
 
 	const int defaultZoom(SettingsManager::getOption(SettingsManager::Content_DefaultZoomOption).toInt());
-	const QJsonArray mainWindowsArray(settings.object().value(QLatin1String("windows")).toArray());
+	const QJsonArray mainWindowsArray(sessionObject.value(QLatin1String("windows")).toArray());
 
 	session.path = path;
-	session.title = settings.object().value(QLatin1String("title")).toString((path == QLatin1String("default")) ? tr("Default") : tr("(Untitled)"));
-	session.index = (settings.object().value(QLatin1String("currentIndex")).toInt(1) - 1);
-	session.isClean = settings.object().value(QLatin1String("isClean")).toBool(true);
+	session.title = sessionObject.value(QLatin1String("title")).toString((path == QLatin1String("default")) ? tr("Default") : tr("(Untitled)"));
+	session.index = (sessionObject.value(QLatin1String("currentIndex")).toInt(1) - 1);
+	session.isClean = sessionObject.value(QLatin1String("isClean")).toBool(true);
 
 	for (int i = 0; i < mainWindowsArray.count(); ++i)
 	{
@@ -658,196 +1143,48 @@ bool SessionsManager::saveSession(const SessionInformation &session)
 
 	for (int i = 0; i < session.windows.count(); ++i)
 	{
-		const Session::MainWindow sessionEntry(session.windows.at(i));
-		QJsonObject mainWindowObject({{QLatin1String("currentIndex"), (sessionEntry.index + 1)}, {QLatin1String("geometry"), QString::fromLatin1(sessionEntry.geometry.toBase64())}});
-		QJsonArray windowsArray;
-
-		for (int j = 0; j < sessionEntry.windows.count(); ++j)
-		{
-			QJsonObject windowObject({{QLatin1String("currentIndex"), (sessionEntry.windows.at(j).history.index + 1)}});
-
-			if (!sessionEntry.windows.at(j).identity.isEmpty())
-			{
-				windowObject.insert(QLatin1String("identity"), sessionEntry.windows.at(j).identity);
-			}
-
-			if (!sessionEntry.windows.at(j).options.isEmpty())
-			{
-				const QHash<int, QVariant> windowOptions(sessionEntry.windows.at(j).options);
-				QHash<int, QVariant>::const_iterator optionsIterator;
-				QJsonObject optionsObject;
-
-				for (optionsIterator = windowOptions.constBegin(); optionsIterator != windowOptions.constEnd(); ++optionsIterator)
-				{
-					const QString optionName(SettingsManager::getOptionName(optionsIterator.key()));
-
-					if (!optionName.isEmpty() && !excludedOptions.contains(optionName))
-					{
-						optionsObject.insert(optionName, QJsonValue::fromVariant(optionsIterator.value()));
-					}
-				}
-
-				windowObject.insert(QLatin1String("options"), optionsObject);
-			}
-
-			switch (sessionEntry.windows.at(j).state.state)
-			{
-				case Qt::WindowMaximized:
-					windowObject.insert(QLatin1String("state"), QLatin1String("maximized"));
-
-					break;
-				case Qt::WindowMinimized:
-					windowObject.insert(QLatin1String("state"), QLatin1String("minimized"));
-
-					break;
-				default:
-					{
-						const QRect geometry(sessionEntry.windows.at(j).state.geometry);
-
-						windowObject.insert(QLatin1String("state"), QLatin1String("normal"));
-
-						if (geometry.isValid())
-						{
-							windowObject.insert(QLatin1String("geometry"), QStringLiteral("%1, %2, %3, %4").arg(geometry.x()).arg(geometry.y()).arg(geometry.width()).arg(geometry.height()));
-						}
-					}
-
-					break;
-			}
-
-			if (sessionEntry.windows.at(j).isAlwaysOnTop)
-			{
-				windowObject.insert(QLatin1String("isAlwaysOnTop"), true);
-			}
-
-			if (sessionEntry.windows.at(j).isPinned)
-			{
-				windowObject.insert(QLatin1String("isPinned"), true);
-			}
-
-			const Session::Window::History windowHistory(sessionEntry.windows.at(j).history);
-			QJsonArray windowHistoryArray;
-
-			for (int k = 0; k < windowHistory.entries.count(); ++k)
-			{
-				const QPoint position(windowHistory.entries.at(k).position);
-				QJsonObject historyEntryObject({{QLatin1String("url"), windowHistory.entries.at(k).url}, {QLatin1String("title"), windowHistory.entries.at(k).title}, {QLatin1String("zoom"), windowHistory.entries.at(k).zoom}});
-
-				if (!position.isNull())
-				{
-					historyEntryObject.insert(QLatin1String("position"), QStringLiteral("%1, %2").arg(position.x()).arg(position.y()));
-				}
-
-				windowHistoryArray.append(historyEntryObject);
-			}
-
-			windowObject.insert(QLatin1String("history"), windowHistoryArray);
-
-			windowsArray.append(windowObject);
-		}
-
-		mainWindowObject.insert(QLatin1String("windows"), windowsArray);
-
-		if (sessionEntry.hasToolBarsState)
-		{
-			QJsonArray toolBarsArray;
-
-			for (int j = 0; j < sessionEntry.toolBars.count(); ++j)
-			{
-				const QString identifier(ToolBarsManager::getToolBarName(sessionEntry.toolBars.at(j).identifier));
-
-				if (identifier.isEmpty())
-				{
-					continue;
-				}
-
-				QJsonObject toolBarObject({{QLatin1String("identifier"), identifier}});
-				QString location;
-
-				switch (sessionEntry.toolBars.at(j).location)
-				{
-					case Qt::LeftToolBarArea:
-						location = QLatin1String("left");
-
-						break;
-					case Qt::RightToolBarArea:
-						location = QLatin1String("right");
-
-						break;
-					case Qt::TopToolBarArea:
-						location = QLatin1String("top");
-
-						break;
-					case Qt::BottomToolBarArea:
-						location = QLatin1String("bottom");
-
-						break;
-					default:
-						break;
-				}
-
-				if (!location.isEmpty())
-				{
-					toolBarObject.insert(QLatin1String("location"), location);
-				}
-
-				if (sessionEntry.toolBars.at(j).normalVisibility != Session::MainWindow::ToolBarState::UnspecifiedVisibilityToolBar)
-				{
-					toolBarObject.insert(QLatin1String("normalVisibility"), ((sessionEntry.toolBars.at(j).normalVisibility == Session::MainWindow::ToolBarState::AlwaysHiddenToolBar) ? QLatin1String("hidden") : QLatin1String("visible")));
-				}
-
-				if (sessionEntry.toolBars.at(j).fullScreenVisibility != Session::MainWindow::ToolBarState::UnspecifiedVisibilityToolBar)
-				{
-					toolBarObject.insert(QLatin1String("fullScreenVisibility"), ((sessionEntry.toolBars.at(j).fullScreenVisibility == Session::MainWindow::ToolBarState::AlwaysHiddenToolBar) ? QLatin1String("hidden") : QLatin1String("visible")));
-				}
-
-				if (sessionEntry.toolBars.at(j).row >= 0)
-				{
-					toolBarObject.insert(QLatin1String("row"), sessionEntry.toolBars.at(j).row);
-				}
+		mainWindowsArray.append(createMainWindowObject(session.windows.at(i), excludedOptions));
+	}
 
-				toolBarsArray.append(toolBarObject);
-			}
+	sessionObject.insert(QLatin1String("windows"), mainWindowsArray);
 
-			mainWindowObject.insert(QLatin1String("toolBars"), toolBarsArray);
-		}
+	const bool isDefault(m_instance && path == getSessionPath(QLatin1String("default")));
 
-		if (!sessionEntry.splitters.isEmpty())
+	if (isDefault)
+	{
+		if (m_instance->m_snapshotThread)
 		{
-			QJsonArray splittersArray;
-			QMap<QString, QVector<int> >::const_iterator iterator;
-
-			for (iterator = sessionEntry.splitters.begin(); iterator != sessionEntry.splitters.end(); ++iterator)
-			{
-				QJsonArray sizesArray;
-				const QVector<int> &sizes(iterator.value());
-
-				for (int j = 0; j < sizes.count(); ++j)
-				{
-					sizesArray.append(sizes.at(j));
-				}
-
-				splittersArray.append(QJsonObject({{QLatin1String("identifier"), iterator.key()}, {QLatin1String("sizes"), sizesArray}}));
-			}
-
-			mainWindowObject.insert(QLatin1String("splitters"), splittersArray);
+			m_instance->m_snapshotThread->wait();
 		}
 
-		mainWindowsArray.append(mainWindowObject);
+		m_instance->m_journal->waitForCompaction();
 	}
 
-	sessionObject.insert(QLatin1String("windows"), mainWindowsArray);
-
 	JsonSettings settings;
 	settings.setObject(sessionObject);
 
-	return settings.save(path);
+	if (!settings.save(path))
+	{
+		return false;
+	}
+
+	if (isDefault)
+	{
+		m_instance->resetJournal();
+	}
+
+	return true;
 }
 
 bool SessionsManager::deleteSession(const QString &path)
 {
 	const QString normalizedPath(getSessionPath(path, true));
 
+	if (m_instance && normalizedPath == getSessionPath(QLatin1String("default")))
+	{
+		m_instance->resetJournal();
+	}
+
 	if (QFile::exists(normalizedPath))
 	{
 		return QFile::remove(normalizedPath);
@@ -21,13 +21,16 @@
 #ifndef OTTER_SESSIONSMANAGER_H
 #define OTTER_SESSIONSMANAGER_H
 
+#include "JournalFile.h"
 #include "SettingsManager.h"
 #include "ToolBarsManager.h"
 #include "Utils.h"
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDateTime>
+#include <QtCore/QJsonObject>
 #include <QtCore/QRect>
+#include <QtCore/QSet>
 
 namespace Otter
 {
@@ -244,6 +247,7 @@ public:
 	static void clearClosedWindows();
 	static void storeClosedWindow(MainWindow *mainWindow);
 	static void markSessionAsModified();
+	static void markWindowAsModified(quint64 identifier);
 	static void removeStoredUrl(const QString &url);
 	static SessionsManager* getInstance();
 	static SessionModel* getModel();
@@ -271,12 +275,34 @@ public:
 	static bool hasUrl(const QUrl &url, bool activate = false);
 
 protected:
+	enum JournalRecordType : quint8
+	{
+		SessionRecord = 1,
+		MainWindowRecord,
+		WindowRecord
+	};
+
 	explicit SessionsManager(QObject *parent);
 
 	void timerEvent(QTimerEvent *event) override;
 	void scheduleSave();
+	void saveJournal();
+	void compactJournal();
+	void resetJournal();
+	QVector<JournalFile::Record> createJournalRecords() const;
+	static QJsonObject loadJournal();
+	static QJsonObject createSessionObject(const QJsonObject &sessionObject, const QHash<quint64, QJsonObject> &mainWindows, const QHash<quint64, QJsonObject> &windows);
+	static QJsonObject createMainWindowObject(const Session::MainWindow &mainWindow, const QStringList &excludedOptions);
+	static QJsonObject createWindowObject(const Session::Window &window, const QStringList &excludedOptions);
+	static QByteArray createRecord(const QJsonObject &object, quint64 identifier);
 
 private:
+	JournalFile *m_journal;
+	QThread *m_snapshotThread;
+	QJsonObject m_journaledSession;
+	QHash<quint64, QJsonObject> m_journaledMainWindows;
+	QHash<quint64, QJsonObject> m_journaledWindows;
+	QSet<quint64> m_modifiedWindows;
 	int m_saveTimer;
 
 	static SessionsManager *m_instance;
@@ -20,11 +20,13 @@
 **************************************************************************/
 
 #include "SettingsManager.h"
+#include "Application.h"
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
 #include <QtCore/QMetaEnum>
-#include <QtCore/QSettings>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QTimerEvent>
 #include <QtCore/QVector>
 
 namespace Otter
@@ -34,15 +36,27 @@ SettingsManager* SettingsManager::m_instance(nullptr);
 QString SettingsManager::m_globalPath;
 QString SettingsManager::m_overridePath;
 QVector<SettingsManager::OptionDefinition> SettingsManager::m_definitions;
+QVector<QVariant> SettingsManager::m_values;
+QVector<SettingsManager::OptionChange> SettingsManager::m_changes;
 QHash<QString, int> SettingsManager::m_customOptions;
+QHash<QString, QHash<int, QVariant> > SettingsManager::m_overrides;
+QHash<QString, QHash<int, QVariant> > SettingsManager::m_hostOverrides;
+QMutex SettingsManager::m_hostOverridesMutex;
+quint64 SettingsManager::m_hostOverridesGeneration(0);
 int SettingsManager::m_identifierCounter(-1);
 int SettingsManager::m_optionIdentifierEnumerator(0);
 bool SettingsManager::m_hasWildcardedOverrides(false);
 
-SettingsManager::SettingsManager(QObject *parent) : QObject(parent)
+SettingsManager::SettingsManager(QObject *parent) : QObject(parent),
+	m_saveTimer(0)
 {
 }
 
+SettingsManager::~SettingsManager()
+{
+	save();
+}
+
 void SettingsManager::createInstance(const QString &path)
 {
 	if (m_instance)
@@ -97,9 +111,13 @@ void SettingsManager::createInstance(const QString &path)
 	registerOption(Browser_SpellCheckDictionaryOption, StringType, QString());
 	registerOption(Browser_SpellCheckIgnoreDctionariesOption, StringType, QStringList());
 	registerOption(Browser_StartupBehaviorOption, EnumerationType, QLatin1String("continuePrevious"), {QLatin1String("continuePrevious"), QLatin1String("showDialog"), QLatin1String("startHomePage"), QLatin1String("startStartPage"), QLatin1String("startEmpty")});
+	registerOption(Browser_TransferBandwidthLimitOption, IntegerType, 0);
+	registerOption(Browser_TransferSegmentsAmountOption, IntegerType, 4);
 	registerOption(Browser_TransferStartingActionOption, EnumerationType, QLatin1String("doNothing"), {QLatin1String("openTab"), QLatin1String("openBackgroundTab"), QLatin1String("openPanel"), QLatin1String("doNothing")});
+	registerOption(Browser_TransfersLimitOption, IntegerType, 3);
 	registerOption(Browser_ValidatorsOrderOption, ListType, QStringList({QLatin1String("w3c-markup"), QLatin1String("w3c-css")}));
 	registerOption(Cache_DiskCacheLimitOption, IntegerType, 51200);
+	registerOption(Cache_EvictionPolicyOption, EnumerationType, QLatin1String("segmentedLeastRecentlyUsed"), {QLatin1String("leastRecentlyUsed"), QLatin1String("leastFrequentlyUsed"), QLatin1String("segmentedLeastRecentlyUsed")});
 	registerOption(Cache_PagesInMemoryLimitOption, IntegerType, 5);
 	registerOption(Choices_WarnFormResendOption, BooleanType, true);
 	registerOption(Choices_WarnLowDiskSpaceOption, EnumerationType, QLatin1String("warn"), {QLatin1String("warn"), QLatin1String("continueReadOnly"), QLatin1String("continueReadWrite")});
@@ -245,67 +263,133 @@ void SettingsManager::createInstance(const QString &path)
 	registerOption(Updates_LastCheckOption, StringType, QString());
 	registerOption(Updates_ServerUrlOption, StringType, QLatin1String("https://www.otter-browser.org/updates/update.json"));
 
-	const QStringList hosts(getOverrideHosts());
+	m_values.resize(m_definitions.count());
+
+	const QSettings settings(m_globalPath, QSettings::IniFormat);
+
+	for (int i = 0; i < m_definitions.count(); ++i)
+	{
+		const QString name(getOptionName(i));
+
+		if (settings.contains(name))
+		{
+			m_values[i] = settings.value(name);
+		}
+	}
+
+	QSettings overrides(m_overridePath, QSettings::IniFormat);
+	const QStringList hosts(overrides.childGroups());
 
 	for (int i = 0; i < hosts.count(); ++i)
 	{
-		if (hosts.at(i).startsWith(QLatin1Char('*')))
+		overrides.beginGroup(hosts.at(i));
+
+		const QStringList keys(overrides.allKeys());
+
+		for (int j = 0; j < keys.count(); ++j)
 		{
-			m_hasWildcardedOverrides = true;
+			const int identifier(getOptionIdentifier(keys.at(j)));
 
-			break;
+			if (identifier >= 0 && identifier < m_definitions.count())
+			{
+				m_overrides[hosts.at(i)][identifier] = overrides.value(keys.at(j));
+			}
 		}
+
+		overrides.endGroup();
 	}
+
+	updateOverrides();
 }
 
-void SettingsManager::removeOverride(const QString &host, int identifier)
+void SettingsManager::timerEvent(QTimerEvent *event)
 {
-	QSettings settings(m_overridePath, QSettings::IniFormat);
-
-	if (identifier >= 0)
+	if (event->timerId() == m_saveTimer)
 	{
-		settings.remove(host + QLatin1Char('/') + getOptionName(identifier));
-		settings.sync();
+		killTimer(m_saveTimer);
 
-		emit m_instance->hostOptionChanged(identifier, getOption(identifier), host);
+		m_saveTimer = 0;
 
-		return;
+		save();
 	}
+}
 
-	settings.beginGroup(host);
+void SettingsManager::scheduleSave()
+{
+	if (Application::isAboutToQuit())
+	{
+		if (m_saveTimer != 0)
+		{
+			killTimer(m_saveTimer);
+
+			m_saveTimer = 0;
+		}
 
-	const QStringList groups(settings.childGroups());
+		save();
+	}
+	else if (m_saveTimer == 0)
+	{
+		m_saveTimer = startTimer(1000);
+	}
+}
 
-	if (groups.isEmpty())
+void SettingsManager::save()
+{
+	if (m_changes.isEmpty())
 	{
 		return;
 	}
 
-	QVector<int> options;
-	options.reserve(groups.count());
+	QSettings settings(m_globalPath, QSettings::IniFormat);
+	QSettings overrides(m_overridePath, QSettings::IniFormat);
 
-	for (int i = 0; i < groups.count(); ++i)
+	for (int i = 0; i < m_changes.count(); ++i)
 	{
-		settings.beginGroup(groups.at(i));
+		const OptionChange &change(m_changes.at(i));
 
-		const QStringList rawOptions(settings.childKeys());
+		saveOption((change.isOverride ? &overrides : &settings), change.key, change.value, change.type);
+	}
 
-		for (int j = 0; j < rawOptions.count(); ++j)
+	m_changes.clear();
+
+	settings.sync();
+	overrides.sync();
+}
+
+void SettingsManager::removeOverride(const QString &host, int identifier)
+{
+	if (identifier >= 0)
+	{
+		if (m_overrides.contains(host))
 		{
-			const int option(getOptionIdentifier(groups.at(i) + QLatin1Char('/') + rawOptions.at(j)));
+			m_overrides[host].remove(identifier);
 
-			if (option >= 0)
+			if (m_overrides[host].isEmpty())
 			{
-				options.append(option);
+				m_overrides.remove(host);
 			}
+
+			updateOverrides();
 		}
 
-		settings.endGroup();
+		queueOptionChange(host + QLatin1Char('/') + getOptionName(identifier), {}, UnknownType, true);
+
+		emit m_instance->hostOptionChanged(identifier, getOption(identifier), host);
+
+		return;
 	}
 
-	settings.endGroup();
-	settings.remove(host);
-	settings.sync();
+	if (!m_overrides.contains(host))
+	{
+		return;
+	}
+
+	const QList<int> options(m_overrides.value(host).keys());
+
+	m_overrides.remove(host);
+
+	updateOverrides();
+	queueOptionChange(host, {}, UnknownType, true);
 
 	for (int i = 0; i < options.count(); ++i)
 	{
@@ -325,23 +409,141 @@ void SettingsManager::registerOption(int identifier, OptionType type, const QVar
 	m_definitions.append(definition);
 }
 
-void SettingsManager::saveOption(const QString &path, const QString &key, const QVariant &value, OptionType type)
+void SettingsManager::loadOption(int identifier)
 {
-	QSettings settings(path, QSettings::IniFormat);
+	const QString name(getOptionName(identifier));
+	const QSettings settings(m_globalPath, QSettings::IniFormat);
+
+	if (identifier >= m_values.count())
+	{
+		m_values.resize(identifier + 1);
+	}
+
+	m_values[identifier] = settings.value(name);
+
+	const QSettings overrides(m_overridePath, QSettings::IniFormat);
+	const QStringList hosts(overrides.childGroups());
+
+	for (int i = 0; i < hosts.count(); ++i)
+	{
+		const QString overrideName(hosts.at(i) + QLatin1Char('/') + name);
+
+		if (overrides.contains(overrideName))
+		{
+			m_overrides[hosts.at(i)][identifier] = overrides.value(overrideName);
+		}
+	}
+
+	for (int i = 0; i < m_changes.count(); ++i)
+	{
+		const OptionChange &change(m_changes.at(i));
+
+		if (!change.isOverride)
+		{
+			if (change.key == name)
+			{
+				m_values[identifier] = change.value;
+			}
 
+			continue;
+		}
+
+		QString host;
+
+		if (!change.key.contains(QLatin1Char('/')))
+		{
+			host = change.key;
+		}
+		else if (change.key.endsWith(QLatin1Char('/') + name))
+		{
+			host = change.key.left(change.key.length() - name.length() - 1);
+		}
+		else
+		{
+			continue;
+		}
+
+		if (change.value.isNull() || host == change.key)
+		{
+			if (m_overrides.contains(host))
+			{
+				m_overrides[host].remove(identifier);
+
+				if (m_overrides[host].isEmpty())
+				{
+					m_overrides.remove(host);
+				}
+			}
+		}
+		else
+		{
+			m_overrides[host][identifier] = change.value;
+		}
+	}
+
+	updateOverrides();
+}
+
+void SettingsManager::saveOption(QSettings *settings, const QString &key, const QVariant &value, OptionType type)
+{
 	if (value.isNull())
 	{
-		settings.remove(key);
+		settings->remove(key);
 	}
 	else if (type == ColorType)
 	{
 		const QColor color(value.value<QColor>());
 
-		settings.setValue(key, (color.isValid() ? color.name(QColor::HexArgb).toUpper() : QString()));
+		settings->setValue(key, (color.isValid() ? color.name(QColor::HexArgb).toUpper() : QString()));
 	}
 	else
 	{
-		settings.setValue(key, value);
+		settings->setValue(key, value);
+	}
+}
+
+void SettingsManager::queueOptionChange(const QString &key, const QVariant &value, OptionType type, bool isOverride)
+{
+	for (int i = (m_changes.count() - 1); i >= 0; --i)
+	{
+		if (m_changes.at(i).isOverride == isOverride && m_changes.at(i).key == key)
+		{
+			m_changes.remove(i);
+		}
+	}
+
+	OptionChange change;
+	change.key = key;
+	change.value = value;
+	change.type = type;
+	change.isOverride = isOverride;
+
+	m_changes.append(change);
+
+	m_instance->scheduleSave();
+}
+
+void SettingsManager::updateOverrides()
+{
+	m_hostOverridesMutex.lock();
+	m_hostOverrides.clear();
+
+	++m_hostOverridesGeneration;
+
+	m_hostOverridesMutex.unlock();
+
+	m_hasWildcardedOverrides = false;
+
+	QHash<QString, QHash<int, QVariant> >::const_iterator iterator;
+
+	for (iterator = m_overrides.constBegin(); iterator != m_overrides.constEnd(); ++iterator)
+	{
+		if (iterator.key().startsWith(QLatin1Char('*')))
+		{
+			m_hasWildcardedOverrides = true;
+
+			break;
+		}
 	}
 }
 
@@ -356,26 +558,35 @@ void SettingsManager::updateOptionDefinition(int identifier, const SettingsManag
 
 void SettingsManager::setOption(int identifier, const QVariant &value, const QString &host)
 {
+	if (identifier < 0 || identifier >= m_definitions.count())
+	{
+		return;
+	}
+
 	const QString name(getOptionName(identifier));
-	const OptionType type(getOptionDefinition(identifier).type);
+	const OptionType type(m_definitions.at(identifier).type);
 
 	if (!host.isEmpty())
 	{
-		const QString overrideName(host + QLatin1Char('/') + name);
-
 		if (value.isNull())
 		{
-			QSettings(m_overridePath, QSettings::IniFormat).remove(overrideName);
+			if (m_overrides.contains(host))
+			{
+				m_overrides[host].remove(identifier);
+
+				if (m_overrides[host].isEmpty())
+				{
+					m_overrides.remove(host);
+				}
+			}
 		}
 		else
 		{
-			saveOption(m_overridePath, overrideName, value, type);
+			m_overrides[host][identifier] = normalizeValue(value, type);
 		}
 
-		if (!m_hasWildcardedOverrides && overrideName.startsWith(QLatin1Char('*')))
-		{
-			m_hasWildcardedOverrides = true;
-		}
+		updateOverrides();
+		queueOptionChange(host + QLatin1Char('/') + name, value, type, true);
 
 		emit m_instance->hostOptionChanged(identifier, value, host);
 
@@ -384,7 +595,9 @@ void SettingsManager::setOption(int identifier, const QVariant &value, const QSt
 
 	if (getOption(identifier) != value)
 	{
-		saveOption(m_globalPath, name, value, type);
+		m_values[identifier] = (value.isNull() ? QVariant() : normalizeValue(value, type));
+
+		queueOptionChange(name, value, type, false);
 
 		emit m_instance->optionChanged(identifier, value);
 	}
@@ -474,32 +687,19 @@ QVariant SettingsManager::getOption(int identifier, const QString &host)
 		return {};
 	}
 
-	const QString name(getOptionName(identifier));
-
-	if (host.isEmpty())
+	if (!host.isEmpty() && !m_overrides.isEmpty())
 	{
-		return QSettings(m_globalPath, QSettings::IniFormat).value(name, m_definitions.at(identifier).defaultValue);
-	}
-
-	const QString overrideName(host + QLatin1Char('/') + name);
-	const QSettings overrides(m_overridePath, QSettings::IniFormat);
+		const QHash<int, QVariant> overrides(getHostOverrides(host));
 
-	if (m_hasWildcardedOverrides && !overrides.contains(overrideName))
-	{
-		const QStringList hostParts(host.split(QLatin1Char('.')));
-
-		for (int i = 1; i < hostParts.count(); ++i)
+		if (overrides.contains(identifier))
 		{
-			const QString wildcardedName(QLatin1String("*.") + hostParts.mid(i).join(QLatin1Char('.')) + QLatin1Char('/') + name);
-
-			if (overrides.contains(wildcardedName))
-			{
-				return QSettings(m_overridePath, QSettings::IniFormat).value(wildcardedName, getOption(identifier));
-			}
+			return overrides[identifier];
 		}
 	}
 
-	return QSettings(m_overridePath, QSettings::IniFormat).value(overrideName, getOption(identifier));
+	const QVariant value(m_values.value(identifier));
+
+	return (value.isValid() ? value : m_definitions.at(identifier).defaultValue);
 }
 
 QStringList SettingsManager::getOptions()
@@ -519,24 +719,19 @@ QStringList SettingsManager::getOptions()
 
 QStringList SettingsManager::getOverrideHosts(int identifier)
 {
-	if (identifier < 0)
-	{
-		return QSettings(m_overridePath, QSettings::IniFormat).childGroups();
-	}
-
-	const QSettings overrides(m_overridePath, QSettings::IniFormat);
-	const QStringList overridesGroups(overrides.childGroups());
 	QStringList hosts;
-	const QString optionName(getOptionName(identifier));
+	QHash<QString, QHash<int, QVariant> >::const_iterator iterator;
 
-	for (int i = 0; i < overridesGroups.count(); ++i)
+	for (iterator = m_overrides.constBegin(); iterator != m_overrides.constEnd(); ++iterator)
 	{
-		if (overrides.contains(overridesGroups.at(i) + QLatin1Char('/') + optionName))
+		if (identifier < 0 || iterator.value().contains(identifier))
 		{
-			hosts.append(overridesGroups.at(i));
+			hosts.append(iterator.key());
 		}
 	}
 
+	hosts.sort();
+
 	return hosts;
 }
 
@@ -549,7 +744,6 @@ QStringList SettingsManager::getOverridesHierarchy(const QString &host)
 		return hierarchy;
 	}
 
-	const QStringList groups(QSettings(m_overridePath, QSettings::IniFormat).childGroups());
 	const QStringList hostParts(host.split(QLatin1Char('.')));
 
 	for (int i = 0; i < hostParts.count(); ++i)
@@ -560,13 +754,13 @@ QStringList SettingsManager::getOverridesHierarchy(const QString &host)
 		{
 			const QString wildcardedHost(QLatin1String("*.") + explicitHost);
 
-			if (groups.contains(wildcardedHost))
+			if (m_overrides.contains(wildcardedHost))
 			{
 				hierarchy.append(wildcardedHost);
 			}
 		}
 
-		if (groups.contains(explicitHost))
+		if (m_overrides.contains(explicitHost))
 		{
 			hierarchy.append(explicitHost);
 		}
@@ -578,18 +772,15 @@ QStringList SettingsManager::getOverridesHierarchy(const QString &host)
 DiagnosticReport::Section SettingsManager::createReport()
 {
 	QHash<QString, int> overridenValues;
-	QSettings overrides(m_overridePath, QSettings::IniFormat);
-	const QStringList overridesGroups(overrides.childGroups());
+	QHash<QString, QHash<int, QVariant> >::const_iterator iterator;
 
-	for (int i = 0; i < overridesGroups.count(); ++i)
+	for (iterator = m_overrides.constBegin(); iterator != m_overrides.constEnd(); ++iterator)
 	{
-		overrides.beginGroup(overridesGroups.at(i));
-
-		const QStringList keys(overrides.allKeys());
+		const QList<int> identifiers(iterator.value().keys());
 
-		for (int j = 0; j < keys.count(); ++j)
+		for (int i = 0; i < identifiers.count(); ++i)
 		{
-			const QString key(keys.at(j));
+			const QString key(getOptionName(identifiers.at(i)));
 
 			if (overridenValues.contains(key))
 			{
@@ -600,8 +791,6 @@ DiagnosticReport::Section SettingsManager::createReport()
 				overridenValues[key] = 1;
 			}
 		}
-
-		overrides.endGroup();
 	}
 
 	const QStringList options(getOptions());
@@ -668,6 +857,8 @@ int SettingsManager::registerOption(const QString &name, OptionType type, const
 
 	m_definitions.append(definition);
 
+	loadOption(identifier);
+
 	return identifier;
 }
 
@@ -691,14 +882,12 @@ int SettingsManager::getOptionIdentifier(const QString &name)
 
 int SettingsManager::getOverridesCount(int identifier)
 {
-	const QSettings overrides(m_overridePath, QSettings::IniFormat);
-	const QStringList overridesGroups(overrides.childGroups());
-	const QString optionName(getOptionName(identifier));
 	int amount(0);
+	QHash<QString, QHash<int, QVariant> >::const_iterator iterator;
 
-	for (int i = 0; i < overridesGroups.count(); ++i)
+	for (iterator = m_overrides.constBegin(); iterator != m_overrides.constEnd(); ++iterator)
 	{
-		if (overrides.contains(overridesGroups.at(i) + QLatin1Char('/') + optionName))
+		if (iterator.value().contains(identifier))
 		{
 			++amount;
 		}
@@ -711,10 +900,79 @@ bool SettingsManager::hasOverride(const QString &host, int identifier)
 {
 	if (identifier < 0)
 	{
-		return QSettings(m_overridePath, QSettings::IniFormat).childGroups().contains(host);
+		return m_overrides.contains(host);
+	}
+
+	return m_overrides.value(host).contains(identifier);
+}
+
+QVariant SettingsManager::normalizeValue(const QVariant &value, OptionType type)
+{
+	if (type == ColorType && !value.isNull())
+	{
+		const QColor color(value.value<QColor>());
+
+		return (color.isValid() ? color.name(QColor::HexArgb).toUpper() : QString());
+	}
+
+	return value;
+}
+
+QHash<int, QVariant> SettingsManager::getHostOverrides(const QString &host)
+{
+	m_hostOverridesMutex.lock();
+
+	const QHash<QString, QHash<int, QVariant> >::const_iterator cachedOverrides(m_hostOverrides.constFind(host));
+
+	if (cachedOverrides != m_hostOverrides.constEnd())
+	{
+		const QHash<int, QVariant> overrides(cachedOverrides.value());
+
+		m_hostOverridesMutex.unlock();
+
+		return overrides;
 	}
 
-	return QSettings(m_overridePath, QSettings::IniFormat).contains(host + QLatin1Char('/') + getOptionName(identifier));
+	const quint64 generation(m_hostOverridesGeneration);
+
+	m_hostOverridesMutex.unlock();
+
+	QHash<int, QVariant> overrides(m_overrides.value(host));
+
+	if (m_hasWildcardedOverrides)
+	{
+		const QStringList hostParts(host.split(QLatin1Char('.')));
+
+		for (int i = 1; i < hostParts.count(); ++i)
+		{
+			const QHash<int, QVariant> wildcardedOverrides(m_overrides.value(QLatin1String("*.") + hostParts.mid(i).join(QLatin1Char('.'))));
+			QHash<int, QVariant>::const_iterator iterator;
+
+			for (iterator = wildcardedOverrides.constBegin(); iterator != wildcardedOverrides.constEnd(); ++iterator)
+			{
+				if (!overrides.contains(iterator.key()))
+				{
+					overrides.insert(iterator.key(), iterator.value());
+				}
+			}
+		}
+	}
+
+	QMutexLocker locker(&m_hostOverridesMutex);
+
+	if (generation != m_hostOverridesGeneration)
+	{
+		return overrides;
+	}
+
+	if (m_hostOverrides.count() > 1000)
+	{
+		m_hostOverrides.clear();
+	}
+
+	m_hostOverrides.insert(host, overrides);
+
+	return overrides;
 }
 
 bool SettingsManager::isDefault(int identifier)
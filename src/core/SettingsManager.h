@@ -24,6 +24,8 @@
 
 #include "Utils.h"
 
+#include <QtCore/QMutex>
+#include <QtCore/QSettings>
 #include <QtCore/QVariant>
 #include <QtGui/QIcon>
 
@@ -76,9 +78,13 @@ public:
 		Browser_SpellCheckDictionaryOption,
 		Browser_SpellCheckIgnoreDctionariesOption,
 		Browser_StartupBehaviorOption,
+		Browser_TransferBandwidthLimitOption,
+		Browser_TransferSegmentsAmountOption,
 		Browser_TransferStartingActionOption,
+		Browser_TransfersLimitOption,
 		Browser_ValidatorsOrderOption,
 		Cache_DiskCacheLimitOption,
+		Cache_EvictionPolicyOption,
 		Cache_PagesInMemoryLimitOption,
 		Choices_WarnFormResendOption,
 		Choices_WarnLowDiskSpaceOption,
@@ -326,17 +332,42 @@ public:
 	static bool isDefault(int identifier);
 
 protected:
+	struct OptionChange final
+	{
+		QString key;
+		QVariant value;
+		OptionType type = UnknownType;
+		bool isOverride = false;
+	};
+
 	explicit SettingsManager(QObject *parent);
+	~SettingsManager();
 
+	void timerEvent(QTimerEvent *event) override;
+	void scheduleSave();
 	static void registerOption(int identifier, OptionType type, const QVariant &defaultValue = {}, const QStringList &choices = {}, OptionDefinition::OptionFlags flags = static_cast<OptionDefinition::OptionFlags>(OptionDefinition::IsEnabledFlag | OptionDefinition::IsVisibleFlag | OptionDefinition::IsBuiltInFlag));
-	static void saveOption(const QString &path, const QString &key, const QVariant &value, OptionType type);
+	static void loadOption(int identifier);
+	static void saveOption(QSettings *settings, const QString &key, const QVariant &value, OptionType type);
+	static void queueOptionChange(const QString &key, const QVariant &value, OptionType type, bool isOverride);
+	static void updateOverrides();
+	static void save();
+	static QVariant normalizeValue(const QVariant &value, OptionType type);
+	static QHash<int, QVariant> getHostOverrides(const QString &host);
 
 private:
+	int m_saveTimer;
+
 	static SettingsManager *m_instance;
 	static QString m_globalPath;
 	static QString m_overridePath;
 	static QVector<OptionDefinition> m_definitions;
+	static QVector<QVariant> m_values;
+	static QVector<OptionChange> m_changes;
 	static QHash<QString, int> m_customOptions;
+	static QHash<QString, QHash<int, QVariant> > m_overrides;
+	static QHash<QString, QHash<int, QVariant> > m_hostOverrides;
+	static QMutex m_hostOverridesMutex;
+	static quint64 m_hostOverridesGeneration;
 	static int m_identifierCounter;
 	static int m_optionIdentifierEnumerator;
 	static bool m_hasWildcardedOverrides;
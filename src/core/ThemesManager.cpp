@@ -32,6 +32,7 @@
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
+#include <QtCore/QThreadPool>
 #include <QtGui/QIcon>
 #include <QtWidgets/QWidget>
 
@@ -121,6 +122,9 @@ ThemesManager* ThemesManager::m_instance(nullptr);
 ColorScheme* ThemesManager::m_colorScheme(nullptr);
 QWidget* ThemesManager::m_probeWidget(nullptr);
 QString ThemesManager::m_iconThemePath(QLatin1String(":/icons/theme/"));
+QHash<QString, QIcon> ThemesManager::m_icons;
+QHash<QString, QString> ThemesManager::m_iconPaths;
+bool ThemesManager::m_isIconThemeIndexed(false);
 bool ThemesManager::m_useSystemIconTheme(false);
 
 ThemesManager::ThemesManager(QObject *parent) : QObject(parent)
@@ -143,12 +147,50 @@ void ThemesManager::createInstance()
 		m_probeWidget->setAttribute(Qt::WA_DontShowOnScreen, true);
 		m_probeWidget->installEventFilter(m_instance);
 
+		indexIconTheme();
+
 #ifdef Q_OS_WIN32
 		QAbstractEventDispatcher::instance()->installNativeEventFilter(m_instance);
 #endif
 	}
 }
 
+void ThemesManager::indexIconTheme()
+{
+	const QString path(m_iconThemePath);
+
+	m_icons.clear();
+	m_iconPaths.clear();
+	m_isIconThemeIndexed = false;
+
+	QThreadPool::globalInstance()->start([=]()
+	{
+		const QFileInfoList entries(QDir(path).entryInfoList({QLatin1String("*.svg"), QLatin1String("*.png")}, QDir::Files));
+		QHash<QString, QString> iconPaths;
+		iconPaths.reserve(entries.count());
+
+		for (int i = 0; i < entries.count(); ++i)
+		{
+			const QFileInfo &entry(entries.at(i));
+			const QString name(entry.completeBaseName());
+
+			if (entry.suffix() == QLatin1String("svg") || !iconPaths.contains(name))
+			{
+				iconPaths[name] = entry.filePath();
+			}
+		}
+
+		QMetaObject::invokeMethod(m_instance, [=]()
+		{
+			if (path == m_iconThemePath)
+			{
+				m_iconPaths = iconPaths;
+				m_isIconThemeIndexed = true;
+			}
+		}, Qt::QueuedConnection);
+	});
+}
+
 void ThemesManager::handleOptionChanged(int identifier, const QVariant &value)
 {
 	switch (identifier)
@@ -170,6 +212,11 @@ void ThemesManager::handleOptionChanged(int identifier, const QVariant &value)
 				{
 					m_iconThemePath = path;
 
+					if (m_instance)
+					{
+						indexIconTheme();
+					}
+
 					emit iconThemeChanged();
 				}
 			}
@@ -180,6 +227,8 @@ void ThemesManager::handleOptionChanged(int identifier, const QVariant &value)
 			{
 				m_useSystemIconTheme = value.toBool();
 
+				m_icons.clear();
+
 				emit iconThemeChanged();
 			}
 
@@ -264,13 +313,28 @@ Animation* ThemesManager::createAnimation(const QString &name, QObject *parent)
 
 QIcon ThemesManager::createIcon(const QString &name, bool fromTheme, IconContext context)
 {
-	Q_UNUSED(context)
-
 	if (name.isEmpty())
 	{
 		return {};
 	}
 
+	const QString key(QString::number(context) + (fromTheme ? QLatin1Char('+') : QLatin1Char('-')) + name);
+	const QHash<QString, QIcon>::const_iterator iterator(m_icons.constFind(key));
+
+	if (iterator != m_icons.constEnd())
+	{
+		return iterator.value();
+	}
+
+	const QIcon icon(loadIcon(name, fromTheme));
+
+	m_icons[key] = icon;
+
+	return icon;
+}
+
+QIcon ThemesManager::loadIcon(const QString &name, bool fromTheme)
+{
 	if (name.startsWith(QLatin1String("data:image/")))
 	{
 		return QIcon(Utils::loadPixmapFromDataUri(name));
@@ -281,7 +345,16 @@ QIcon ThemesManager::createIcon(const QString &name, bool fromTheme, IconContext
 		return QIcon::fromTheme(name);
 	}
 
-	const QString iconPath((!fromTheme && name == QLatin1String("otter-browser")) ? QLatin1String(":/icons/otter-browser") : m_iconThemePath + name);
+	const bool isThemeIcon(fromTheme || name != QLatin1String("otter-browser"));
+
+	if (isThemeIcon && m_isIconThemeIndexed && !name.contains(QLatin1Char('/')))
+	{
+		const QString path(m_iconPaths.value(name));
+
+		return (path.isEmpty() ? QIcon() : QIcon(path));
+	}
+
+	const QString iconPath(isThemeIcon ? m_iconThemePath + name : QLatin1String(":/icons/otter-browser"));
 	const QString svgPath(iconPath + QLatin1String(".svg"));
 	const QString rasterPath(iconPath + QLatin1String(".png"));
 
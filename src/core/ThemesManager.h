@@ -25,6 +25,7 @@
 #ifdef Q_OS_WIN32
 #include <QtCore/QAbstractNativeEventFilter>
 #endif
+#include <QtCore/QHash>
 #include <QtCore/QMap>
 #include <QtWidgets/QStyle>
 
@@ -123,6 +124,8 @@ public:
 protected:
 	explicit ThemesManager(QObject *parent);
 
+	static void indexIconTheme();
+	static QIcon loadIcon(const QString &name, bool fromTheme);
 	bool eventFilter(QObject *object, QEvent *event) override;
 #ifdef Q_OS_WIN32
 	bool nativeEventFilter(const QByteArray &eventType, void *message, long *result) override;
@@ -136,6 +139,9 @@ private:
 	static ColorScheme *m_colorScheme;
 	static QWidget *m_probeWidget;
 	static QString m_iconThemePath;
+	static QHash<QString, QIcon> m_icons;
+	static QHash<QString, QString> m_iconPaths;
+	static bool m_isIconThemeIndexed;
 	static bool m_useSystemIconTheme;
 
 signals:
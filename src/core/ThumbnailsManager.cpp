@@ -0,0 +1,236 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "ThumbnailsManager.h"
+#include "../ui/Window.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QThreadPool>
+#include <QtCore/QtMath>
+
+namespace Otter
+{
+
+ThumbnailsManager* ThumbnailsManager::m_instance(nullptr);
+QElapsedTimer ThumbnailsManager::m_clock;
+QVector<QPointer<const Window> > ThumbnailsManager::m_captureQueue;
+QHash<quint64, ThumbnailsManager::ThumbnailInformation> ThumbnailsManager::m_thumbnails;
+quint64 ThumbnailsManager::m_generation(0);
+const QSize ThumbnailsManager::m_thumbnailSize(260, 170);
+const int ThumbnailsManager::m_captureInterval(16);
+const int ThumbnailsManager::m_frameBudget(8);
+const int ThumbnailsManager::m_refreshInterval(1000);
+
+ThumbnailsManager::ThumbnailsManager(QObject *parent) : QObject(parent),
+	m_captureTimer(0)
+{
+	m_clock.start();
+}
+
+void ThumbnailsManager::createInstance()
+{
+	if (!m_instance)
+	{
+		m_instance = new ThumbnailsManager(QCoreApplication::instance());
+	}
+}
+
+void ThumbnailsManager::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() != m_captureTimer)
+	{
+		return;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	int capturesAmount(0);
+
+	do
+	{
+		const QPointer<const Window> window(m_captureQueue.first());
+
+		if (window && capturesAmount > 0 && (timer.elapsed() + m_thumbnails.value(window->getIdentifier()).captureDuration) > m_frameBudget)
+		{
+			break;
+		}
+
+		m_captureQueue.removeFirst();
+
+		if (window && !window->isAboutToClose())
+		{
+			captureThumbnail(window);
+
+			++capturesAmount;
+		}
+	}
+	while (!m_captureQueue.isEmpty() && timer.elapsed() < m_frameBudget);
+
+	if (m_captureQueue.isEmpty())
+	{
+		killTimer(m_captureTimer);
+
+		m_captureTimer = 0;
+	}
+}
+
+void ThumbnailsManager::scheduleCapture(const Window *window)
+{
+	if (m_captureQueue.contains(window))
+	{
+		return;
+	}
+
+	m_captureQueue.append(window);
+
+	if (m_instance->m_captureTimer == 0)
+	{
+		m_instance->m_captureTimer = m_instance->startTimer(m_captureInterval);
+	}
+}
+
+void ThumbnailsManager::captureThumbnail(const Window *window)
+{
+	if (window->getLoadingState() == WebWidget::OngoingLoadingState)
+	{
+		return;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	const quint64 identifier(window->getIdentifier());
+	const quint64 generation(++m_generation);
+	const qreal devicePixelRatio(window->devicePixelRatioF());
+	const QImage snapshot(window->createSnapshot(m_thumbnailSize));
+	ThumbnailInformation &thumbnail(m_thumbnails[identifier]);
+	thumbnail.captureTime = m_clock.elapsed();
+	thumbnail.captureDuration = timer.elapsed();
+	thumbnail.generation = generation;
+	thumbnail.devicePixelRatio = qRound(devicePixelRatio * 100);
+	thumbnail.isModified = false;
+
+	if (snapshot.isNull())
+	{
+		thumbnail.pixmap = {};
+
+		return;
+	}
+
+	QThreadPool::globalInstance()->start([=]()
+	{
+		const QImage image(scaleSnapshot(snapshot, devicePixelRatio));
+
+		QMetaObject::invokeMethod(m_instance, [=]()
+		{
+			handleThumbnailScaled(identifier, generation, image);
+		}, Qt::QueuedConnection);
+	});
+}
+
+void ThumbnailsManager::handleThumbnailScaled(quint64 identifier, quint64 generation, const QImage &image)
+{
+	if (!m_thumbnails.contains(identifier) || m_thumbnails[identifier].generation != generation)
+	{
+		return;
+	}
+
+	m_thumbnails[identifier].pixmap = QPixmap::fromImage(image);
+
+	emit m_instance->thumbnailChanged(identifier);
+}
+
+void ThumbnailsManager::markAsModified(quint64 identifier)
+{
+	if (m_thumbnails.contains(identifier))
+	{
+		m_thumbnails[identifier].isModified = true;
+	}
+}
+
+ThumbnailsManager* ThumbnailsManager::getInstance()
+{
+	return m_instance;
+}
+
+QImage ThumbnailsManager::scaleSnapshot(const QImage &snapshot, qreal devicePixelRatio)
+{
+	const qreal thumbnailAspectRatio(static_cast<qreal>(m_thumbnailSize.width()) / m_thumbnailSize.height());
+	const qreal snapshotAspectRatio(static_cast<qreal>(snapshot.width()) / snapshot.height());
+	QImage image(snapshot);
+
+	if (!qFuzzyCompare(thumbnailAspectRatio, snapshotAspectRatio))
+	{
+		if (thumbnailAspectRatio > snapshotAspectRatio)
+		{
+			image = image.copy({{0, 0}, QSize(image.width(), qFloor(image.width() / thumbnailAspectRatio))});
+		}
+		else
+		{
+			const int offset((image.width() - qFloor(image.height() * thumbnailAspectRatio)) / 2);
+
+			image = image.copy({{offset, 0}, QSize((image.width() - (offset * 2)), image.height())});
+		}
+	}
+
+	image = image.scaled((m_thumbnailSize * devicePixelRatio), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+	image.setDevicePixelRatio(devicePixelRatio);
+
+	return image;
+}
+
+QPixmap ThumbnailsManager::getThumbnail(const Window *window)
+{
+	if (!m_instance || !window || window->isAboutToClose())
+	{
+		return {};
+	}
+
+	const quint64 identifier(window->getIdentifier());
+
+	if (!m_thumbnails.contains(identifier))
+	{
+		const auto markWindowAsModified([=]()
+		{
+			markAsModified(identifier);
+		});
+
+		m_thumbnails[identifier] = {};
+
+		connect(window, &Window::loadingStateChanged, m_instance, markWindowAsModified);
+		connect(window, &Window::urlChanged, m_instance, markWindowAsModified);
+		connect(window, &Window::zoomChanged, m_instance, markWindowAsModified);
+		connect(window, &Window::destroyed, m_instance, [=]()
+		{
+			m_thumbnails.remove(identifier);
+		});
+	}
+
+	const ThumbnailInformation thumbnail(m_thumbnails.value(identifier));
+
+	if (thumbnail.isModified || thumbnail.devicePixelRatio != qRound(window->devicePixelRatioF() * 100) || (window->isVisible() && (m_clock.elapsed() - thumbnail.captureTime) > qMax(static_cast<qint64>(m_refreshInterval), (thumbnail.captureDuration * 100))))
+	{
+		scheduleCapture(window);
+	}
+
+	return thumbnail.pixmap;
+}
+
+}
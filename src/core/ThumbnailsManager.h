@@ -0,0 +1,82 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_THUMBNAILSMANAGER_H
+#define OTTER_THUMBNAILSMANAGER_H
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
+#include <QtCore/QVector>
+#include <QtGui/QPixmap>
+
+namespace Otter
+{
+
+class Window;
+
+class ThumbnailsManager final : public QObject
+{
+	Q_OBJECT
+
+public:
+	static void createInstance();
+	static ThumbnailsManager* getInstance();
+	static QPixmap getThumbnail(const Window *window);
+
+protected:
+	struct ThumbnailInformation final
+	{
+		QPixmap pixmap;
+		qint64 captureTime = -1;
+		qint64 captureDuration = 0;
+		quint64 generation = 0;
+		int devicePixelRatio = 0;
+		bool isModified = true;
+	};
+
+	explicit ThumbnailsManager(QObject *parent);
+
+	void timerEvent(QTimerEvent *event) override;
+	static void scheduleCapture(const Window *window);
+	static void captureThumbnail(const Window *window);
+	static void handleThumbnailScaled(quint64 identifier, quint64 generation, const QImage &image);
+	static void markAsModified(quint64 identifier);
+	static QImage scaleSnapshot(const QImage &snapshot, qreal devicePixelRatio);
+
+private:
+	int m_captureTimer;
+
+	static ThumbnailsManager *m_instance;
+	static QElapsedTimer m_clock;
+	static QVector<QPointer<const Window> > m_captureQueue;
+	static QHash<quint64, ThumbnailInformation> m_thumbnails;
+	static quint64 m_generation;
+	static const QSize m_thumbnailSize;
+	static const int m_captureInterval;
+	static const int m_frameBudget;
+	static const int m_refreshInterval;
+
+signals:
+	void thumbnailChanged(quint64 identifier);
+};
+
+}
+
+#endif
@@ -37,6 +37,8 @@
 #include <QtWidgets/QFileIconProvider>
 #include <QtWidgets/QMessageBox>
 
+#include <algorithm>
+
 namespace Otter
 {
 
@@ -45,6 +47,9 @@ QVector<Transfer*> TransfersManager::m_transfers;
 QVector<Transfer*> TransfersManager::m_privateTransfers;
 bool TransfersManager::m_isInitilized(false);
 bool TransfersManager::m_hasRunningTransfers(false);
+const int TransfersManager::m_bandwidthInterval(100);
+const qint64 Transfer::m_minimumSegmentSize(1048576);
+const int Transfer::m_bufferSize(65536);
 
 Transfer::Transfer(TransferOptions options, QObject *parent) : QObject(parent ? parent : TransfersManager::getInstance()),
 	m_reply(nullptr),
@@ -54,13 +59,19 @@ Transfer::Transfer(TransferOptions options, QObject *parent) : QObject(parent ?
 	m_bytesReceivedDifference(0),
 	m_bytesReceived(0),
 	m_bytesTotal(0),
+	m_hashedBytes(0),
+	m_bytesAllowance(-1),
+	m_bandwidthLimit(0),
 	m_options(options),
 	m_state(UnknownState),
+	m_priority(NormalPriority),
 	m_updateTimer(0),
 	m_updateInterval(0),
 	m_remainingTime(-1),
 	m_isSelectingPath(false),
-	m_isArchived(false)
+	m_isArchived(false),
+	m_isQueued(false),
+	m_isFinishing(false)
 {
 }
 
@@ -77,20 +88,54 @@ Transfer::Transfer(const QSettings &settings, QObject *parent) : QObject(parent
 	m_bytesReceivedDifference(0),
 	m_bytesReceived(settings.value(QLatin1String("bytesReceived")).toLongLong()),
 	m_bytesTotal(settings.value(QLatin1String("bytesTotal")).toLongLong()),
+	m_hashedBytes(0),
+	m_bytesAllowance(-1),
+	m_bandwidthLimit(settings.value(QLatin1String("bandwidthLimit"), 0).toLongLong()),
 	m_options(NoOption),
 	m_state((m_bytesReceived > 0 && m_bytesTotal == m_bytesReceived && QFile::exists(settings.value(QLatin1String("target")).toString())) ? FinishedState : ErrorState),
+	m_priority(static_cast<TransferPriority>(settings.value(QLatin1String("priority"), NormalPriority).toInt())),
 	m_updateTimer(0),
 	m_updateInterval(0),
 	m_remainingTime(-1),
 	m_isSelectingPath(false),
-	m_isArchived(true)
+	m_isArchived(true),
+	m_isQueued(false),
+	m_isFinishing(false)
 {
 	m_timeStarted.setTimeSpec(Qt::UTC);
 	m_timeFinished.setTimeSpec(Qt::UTC);
+
+	if (m_state == FinishedState)
+	{
+		return;
+	}
+
+	const QStringList segments(settings.value(QLatin1String("segments")).toStringList());
+
+	for (int i = 0; i < segments.count(); ++i)
+	{
+		const QStringList range(segments.at(i).split(QLatin1Char('-')));
+
+		if (range.count() != 2)
+		{
+			continue;
+		}
+
+		Segment segment;
+		segment.position = range.at(0).toLongLong();
+		segment.end = range.at(1).toLongLong();
+
+		if (segment.position <= segment.end && segment.end < m_bytesTotal)
+		{
+			m_segments.append(segment);
+		}
+	}
 }
 
 Transfer::~Transfer()
 {
+	qDeleteAll(m_hashCalculators);
+
 	if (m_options.testFlag(HasToOpenAfterFinishOption) && QFile::exists(m_target))
 	{
 		QFile::remove(m_target);
@@ -324,268 +369,796 @@ void Transfer::start(QNetworkReply *reply, const QString &target)
 	}
 }
 
-void Transfer::openTarget() const
+void Transfer::setQueued(bool isQueued)
 {
-	Utils::runApplication(m_openCommand, QUrl::fromLocalFile(getTarget()));
-}
+	if (isQueued == m_isQueued)
+	{
+		return;
+	}
 
-void Transfer::cancel()
-{
-	m_state = CancelledState;
+	m_isQueued = isQueued;
 
-	if (m_reply)
+	if (m_state == RunningState)
 	{
-		m_reply->abort();
-
-		QTimer::singleShot(250, m_reply, &QNetworkReply::deleteLater);
+		if (!isQueued)
+		{
+			startRequest();
+		}
+		else if (canSuspendRequest())
+		{
+			suspendRequest();
+		}
+		else
+		{
+			setAllowance(0);
+		}
 	}
 
-	if (m_device)
+	emit changed();
+}
+
+void Transfer::setAllowance(qint64 allowance)
+{
+	if (allowance == m_bytesAllowance && allowance < 0)
 	{
-		m_device->remove();
+		return;
 	}
 
-	stop();
+	const bool needsUpdate((allowance < 0) != (m_bytesAllowance < 0));
 
-	if (m_options.testFlag(CanAutoDeleteOption) && !m_isSelectingPath)
+	m_bytesAllowance = allowance;
+
+	if (needsUpdate)
 	{
-		deleteLater();
+		updateReadBufferSize();
 	}
-}
 
-void Transfer::stop()
-{
-	if (m_updateTimer != 0)
+	if (allowance == 0 || m_state != RunningState)
 	{
-		killTimer(m_updateTimer);
-
-		m_updateTimer = 0;
+		return;
 	}
 
-	if (m_reply)
+	if (m_segments.isEmpty())
 	{
-		m_reply->abort();
+		if (m_reply && m_reply->bytesAvailable() > 0)
+		{
+			handleDataAvailable();
+		}
 
-		QTimer::singleShot(250, m_reply, &QNetworkReply::deleteLater);
+		return;
 	}
 
-	if (m_device && !m_device->inherits("QTemporaryFile"))
-	{
-		m_device->close();
-		m_device->deleteLater();
-		m_device = nullptr;
-	}
+	QVector<QNetworkReply*> replies;
+	replies.reserve(m_segments.count());
 
-	if (m_state == RunningState)
+	for (int i = 0; i < m_segments.count(); ++i)
 	{
-		m_state = ErrorState;
-
-		if (m_options.testFlag(CanAutoDeleteOption) && !m_isSelectingPath)
+		if (m_segments.at(i).reply)
 		{
-			deleteLater();
+			replies.append(m_segments.at(i).reply);
 		}
 	}
 
-	m_speeds.clear();
+	for (int i = 0; i < replies.count(); ++i)
+	{
+		const int index(findSegment(replies.at(i)));
 
-	emit stopped();
-	emit changed();
-}
+		if (index >= 0 && writeSegmentData(index))
+		{
+			completeSegment(index);
+		}
 
-void Transfer::markAsStarted()
-{
-	m_timeStarted = QDateTime::currentDateTimeUtc();
+		if (m_state != RunningState || m_bytesAllowance == 0)
+		{
+			break;
+		}
+	}
 }
 
-void Transfer::markAsFinished()
+void Transfer::updateReadBufferSize()
 {
-	m_timeFinished = QDateTime::currentDateTimeUtc();
-}
+	const qint64 size((m_bytesAllowance < 0) ? 0 : m_bufferSize);
 
-void Transfer::handleDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
-{
-	m_bytesReceivedDifference += (bytesReceived - (m_bytesReceived - m_bytesStart));
-	m_bytesReceived = (m_bytesStart + bytesReceived);
-	m_bytesTotal = (m_bytesStart + bytesTotal);
+	if (m_reply)
+	{
+		m_reply->setReadBufferSize(size);
+	}
 
-	emit progressChanged(bytesReceived, bytesTotal);
+	for (int i = 0; i < m_segments.count(); ++i)
+	{
+		if (m_segments.at(i).reply)
+		{
+			m_segments.at(i).reply->setReadBufferSize(size);
+		}
+	}
 }
 
-void Transfer::handleDataAvailable()
+void Transfer::startRequest()
 {
-	if (!m_reply || !m_device)
+	if (!m_segments.isEmpty())
 	{
+		for (int i = 0; i < m_segments.count(); ++i)
+		{
+			if (!m_segments.at(i).reply)
+			{
+				startSegment(i);
+			}
+		}
+
 		return;
 	}
 
-	if (m_state == ErrorState)
+	if (m_reply || !m_device)
 	{
-		m_state = RunningState;
-
-		if (m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid() && m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206)
-		{
-			m_device->reset();
-		}
+		return;
 	}
 
-	m_device->write(m_reply->readAll());
-	m_device->seek(m_device->size());
+	m_bytesStart = m_device->size();
 
-	if (m_state == RunningState && m_reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool() && m_bytesTotal >= 0 && m_device->size() == m_bytesTotal)
+	QNetworkRequest request;
+	request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+	request.setHeader(QNetworkRequest::UserAgentHeader, NetworkManagerFactory::getUserAgent());
+	request.setUrl(m_source);
+
+	if (m_bytesStart > 0)
 	{
-		handleDownloadFinished();
+		request.setRawHeader(QByteArrayLiteral("Range"), QStringLiteral("bytes=%1-").arg(m_bytesStart).toLatin1());
 	}
+
+	m_reply = NetworkManagerFactory::getNetworkManager(m_options.testFlag(IsPrivateOption))->get(request);
+
+	updateReadBufferSize();
+
+	connect(m_reply, &QNetworkReply::downloadProgress, this, &Transfer::handleDownloadProgress);
+	connect(m_reply, &QNetworkReply::readyRead, this, &Transfer::handleDataAvailable);
+	connect(m_reply, &QNetworkReply::finished, this, &Transfer::handleDownloadFinished);
+	connect(m_reply, &QNetworkReply::errorOccurred, this, &Transfer::handleDownloadError);
 }
 
-void Transfer::handleDownloadFinished()
+void Transfer::suspendRequest()
 {
-	if (!m_reply)
+	if (!m_segments.isEmpty())
 	{
-		if (m_device && !m_device->inherits("QTemporaryFile"))
-		{
-			m_device->close();
-			m_device->deleteLater();
-			m_device = nullptr;
-		}
+		stopSegments();
 
-		if (m_options.testFlag(CanAutoDeleteOption) && !m_isSelectingPath)
-		{
-			deleteLater();
-		}
+		m_reply = nullptr;
 
 		return;
 	}
 
-	if (!m_reply->attribute(QNetworkRequest::RedirectionTargetAttribute).isNull())
+	if (!m_reply || m_reply->isFinished())
 	{
-		const QUrl url(m_source.resolved(m_reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl()));
-
-		if (!url.isValid() || (m_source.scheme() == QLatin1String("https") && url.scheme() == QLatin1String("http")))
-		{
-			handleDownloadError(QNetworkReply::UnknownContentError);
-		}
-		else
-		{
-			m_source = url;
-
-			restart();
-		}
-
 		return;
 	}
 
-	if (m_updateTimer != 0)
-	{
-		killTimer(m_updateTimer);
+	disconnect(m_reply, nullptr, this, nullptr);
 
-		m_updateTimer = 0;
-	}
+	m_reply->abort();
 
-	if (m_reply->size() > 0)
+	QTimer::singleShot(250, m_reply, &QNetworkReply::deleteLater);
+
+	m_reply = nullptr;
+
+	if (m_device)
 	{
-		m_device->write(m_reply->readAll());
+		m_device->seek(m_device->size());
 	}
+}
+
+void Transfer::startSegments(int amount)
+{
+	const qint64 position(m_device->size());
+	const qint64 segmentSize(qMax(((m_bytesTotal - position) / amount), m_minimumSegmentSize));
 
 	disconnect(m_reply, &QNetworkReply::downloadProgress, this, &Transfer::handleDownloadProgress);
 	disconnect(m_reply, &QNetworkReply::readyRead, this, &Transfer::handleDataAvailable);
 	disconnect(m_reply, &QNetworkReply::finished, this, &Transfer::handleDownloadFinished);
+	disconnect(m_reply, &QNetworkReply::errorOccurred, this, &Transfer::handleDownloadError);
 
-	m_bytesReceived = (m_device ? m_device->size() : -1);
-
-	if (m_bytesTotal <= 0 && m_bytesReceived > 0)
+	if (!m_device->resize(m_bytesTotal))
 	{
-		m_bytesTotal = m_bytesReceived;
-	}
+		connect(m_reply, &QNetworkReply::downloadProgress, this, &Transfer::handleDownloadProgress);
+		connect(m_reply, &QNetworkReply::readyRead, this, &Transfer::handleDataAvailable);
+		connect(m_reply, &QNetworkReply::finished, this, &Transfer::handleDownloadFinished);
+		connect(m_reply, &QNetworkReply::errorOccurred, this, &Transfer::handleDownloadError);
 
-	if (m_bytesReceived == 0 || m_bytesReceived < m_bytesTotal)
-	{
-		m_state = ErrorState;
+		return;
 	}
-	else
-	{
-		markAsFinished();
 
-		m_state = FinishedState;
-		m_mimeType = QMimeDatabase().mimeTypeForFile(m_target);
-	}
+	m_bytesReceived = position;
 
-	emit finished();
-	emit changed();
+	Segment firstSegment;
+	firstSegment.reply = m_reply;
+	firstSegment.position = position;
+	firstSegment.end = qMin((position + segmentSize - 1), (m_bytesTotal - 1));
+	firstSegment.isRangeRequest = false;
 
-	if (m_device && (m_options.testFlag(HasToOpenAfterFinishOption) || !m_device->inherits("QTemporaryFile")))
+	m_segments.append(firstSegment);
+
+	connect(m_reply, &QNetworkReply::readyRead, this, &Transfer::handleSegmentDataAvailable);
+	connect(m_reply, &QNetworkReply::finished, this, &Transfer::handleSegmentFinished);
+
+	for (qint64 start = (firstSegment.end + 1); start < m_bytesTotal; start += segmentSize)
 	{
-		m_device->close();
-		m_device->deleteLater();
-		m_device = nullptr;
+		Segment segment;
+		segment.position = start;
+		segment.end = (((m_bytesTotal - start) < (segmentSize * 2)) ? (m_bytesTotal - 1) : (start + segmentSize - 1));
 
-		if (m_reply)
+		m_segments.append(segment);
+
+		startSegment(m_segments.count() - 1);
+
+		if (segment.end == (m_bytesTotal - 1))
 		{
-			QTimer::singleShot(250, m_reply, &QNetworkReply::deleteLater);
+			break;
 		}
 	}
 
-	if (m_state == FinishedState && m_options.testFlag(HasToOpenAfterFinishOption))
-	{
-		openTarget();
-	}
-
-	if (m_options.testFlag(CanAutoDeleteOption) && !m_isSelectingPath)
+	if (m_reply->bytesAvailable() > 0 && writeSegmentData(0))
 	{
-		deleteLater();
+		completeSegment(0);
 	}
 }
 
-void Transfer::handleDownloadError(QNetworkReply::NetworkError error)
+void Transfer::startSegment(int index)
 {
-	Q_UNUSED(error)
+	Segment &segment(m_segments[index]);
 
-	stop();
+	QNetworkRequest request;
+	request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+	request.setHeader(QNetworkRequest::UserAgentHeader, NetworkManagerFactory::getUserAgent());
+	request.setRawHeader(QByteArrayLiteral("Range"), QStringLiteral("bytes=%1-%2").arg(segment.position).arg(segment.end).toLatin1());
+	request.setUrl(m_source);
 
-	m_state = ErrorState;
+	segment.reply = NetworkManagerFactory::getNetworkManager(m_options.testFlag(IsPrivateOption))->get(request);
+	segment.reply->setReadBufferSize((m_bytesAllowance < 0) ? 0 : m_bufferSize);
+	segment.isRangeRequest = true;
 
-	if (m_options.testFlag(CanAutoDeleteOption) && !m_isSelectingPath)
-	{
-		deleteLater();
-	}
+	connect(segment.reply, &QNetworkReply::readyRead, this, &Transfer::handleSegmentDataAvailable);
+	connect(segment.reply, &QNetworkReply::finished, this, &Transfer::handleSegmentFinished);
 }
 
-void Transfer::setOpenCommand(const QString &command)
+void Transfer::stopSegments()
 {
-	m_openCommand = command;
-
-	m_options |= HasToOpenAfterFinishOption;
-
-	QTemporaryFile *file(qobject_cast<QTemporaryFile*>(m_device));
-
-	if (file)
+	for (int i = 0; i < m_segments.count(); ++i)
 	{
-		file->setAutoRemove(false);
-	}
+		QNetworkReply *reply(m_segments.at(i).reply);
 
-	if (m_state == FinishedState)
-	{
-		if (file)
+		if (!reply)
 		{
-			file->close();
-			file->deleteLater();
-
-			m_device = nullptr;
+			continue;
 		}
 
-		openTarget();
+		disconnect(reply, nullptr, this, nullptr);
+
+		reply->abort();
+
+		QTimer::singleShot(250, reply, &QNetworkReply::deleteLater);
+
+		m_segments[i].reply = nullptr;
 	}
 }
 
-void Transfer::setHash(QCryptographicHash::Algorithm algorithm, const QByteArray &hash)
+void Transfer::cancelSegments(int index)
 {
-	if (!hash.isEmpty())
-	{
-		m_hashes[algorithm] = hash;
-	}
-	else if (m_hashes.contains(algorithm))
-	{
-		m_hashes.remove(algorithm);
-	}
+	QNetworkReply *reply(m_segments.at(index).reply);
+
+	m_segments[index].reply = nullptr;
+
+	disconnect(reply, nullptr, this, nullptr);
+
+	stopSegments();
+
+	m_segments.clear();
+
+	m_reply = reply;
+	m_bytesStart = 0;
+	m_bytesReceived = 0;
+
+	m_device->resize(0);
+	m_device->reset();
+
+	resetHashes();
+	updateReadBufferSize();
+
+	connect(m_reply, &QNetworkReply::downloadProgress, this, &Transfer::handleDownloadProgress);
+	connect(m_reply, &QNetworkReply::readyRead, this, &Transfer::handleDataAvailable);
+	connect(m_reply, &QNetworkReply::finished, this, &Transfer::handleDownloadFinished);
+	connect(m_reply, &QNetworkReply::errorOccurred, this, &Transfer::handleDownloadError);
+
+	if (m_reply->isFinished())
+	{
+		handleDownloadFinished();
+	}
+	else if (m_reply->bytesAvailable() > 0)
+	{
+		handleDataAvailable();
+	}
+}
+
+void Transfer::completeSegment(int index)
+{
+	QNetworkReply *reply(m_segments.at(index).reply);
+
+	m_segments.removeAt(index);
+
+	if (reply)
+	{
+		disconnect(reply, nullptr, this, nullptr);
+
+		if (!reply->isFinished())
+		{
+			reply->abort();
+		}
+
+		QTimer::singleShot(250, reply, &QNetworkReply::deleteLater);
+	}
+
+	if (m_segments.isEmpty())
+	{
+		finishSegments();
+	}
+	else
+	{
+		rebalanceSegments();
+	}
+}
+
+void Transfer::finishSegments()
+{
+	if (m_updateTimer != 0)
+	{
+		killTimer(m_updateTimer);
+
+		m_updateTimer = 0;
+	}
+
+	m_reply = nullptr;
+	m_bytesReceived = m_bytesTotal;
+	m_state = FinishedState;
+	m_mimeType = QMimeDatabase().mimeTypeForFile(m_target);
+
+	markAsFinished();
+	finishHashes();
+
+	if (m_device)
+	{
+		m_device->close();
+		m_device->deleteLater();
+		m_device = nullptr;
+	}
+
+	emit progressChanged(m_bytesReceived, m_bytesTotal);
+	emit finished();
+	emit changed();
+
+	if (m_options.testFlag(HasToOpenAfterFinishOption))
+	{
+		openTarget();
+	}
+
+	if (m_options.testFlag(CanAutoDeleteOption) && !m_isSelectingPath)
+	{
+		deleteLater();
+	}
+}
+
+void Transfer::rebalanceSegments()
+{
+	int index(-1);
+	qint64 remainingBytes(0);
+
+	for (int i = 0; i < m_segments.count(); ++i)
+	{
+		const Segment &segment(m_segments.at(i));
+		const qint64 segmentRemainingBytes(segment.end - segment.position + 1);
+
+		if (segment.reply && segmentRemainingBytes > remainingBytes)
+		{
+			index = i;
+			remainingBytes = segmentRemainingBytes;
+		}
+	}
+
+	if (index < 0 || remainingBytes < (m_minimumSegmentSize * 2))
+	{
+		return;
+	}
+
+	Segment segment;
+	segment.position = (m_segments.at(index).position + (remainingBytes / 2));
+	segment.end = m_segments.at(index).end;
+
+	m_segments[index].end = (segment.position - 1);
+	m_segments.append(segment);
+
+	startSegment(m_segments.count() - 1);
+}
+
+void Transfer::openTarget() const
+{
+	Utils::runApplication(m_openCommand, QUrl::fromLocalFile(getTarget()));
+}
+
+void Transfer::cancel()
+{
+	m_state = CancelledState;
+
+	if (m_reply)
+	{
+		m_reply->abort();
+
+		QTimer::singleShot(250, m_reply, &QNetworkReply::deleteLater);
+	}
+
+	if (m_device)
+	{
+		m_device->remove();
+	}
+
+	stop();
+
+	m_segments.clear();
+
+	if (m_options.testFlag(CanAutoDeleteOption) && !m_isSelectingPath)
+	{
+		deleteLater();
+	}
+}
+
+void Transfer::stop()
+{
+	if (m_updateTimer != 0)
+	{
+		killTimer(m_updateTimer);
+
+		m_updateTimer = 0;
+	}
+
+	stopSegments();
+
+	m_bytesAllowance = -1;
+	m_isQueued = false;
+	m_isFinishing = false;
+
+	if (m_reply)
+	{
+		m_reply->abort();
+
+		QTimer::singleShot(250, m_reply, &QNetworkReply::deleteLater);
+	}
+
+	if (m_device && !m_device->inherits("QTemporaryFile"))
+	{
+		m_device->close();
+		m_device->deleteLater();
+		m_device = nullptr;
+	}
+
+	if (m_state == RunningState)
+	{
+		m_state = ErrorState;
+
+		if (m_options.testFlag(CanAutoDeleteOption) && !m_isSelectingPath)
+		{
+			deleteLater();
+		}
+	}
+
+	m_speeds.clear();
+
+	emit stopped();
+	emit changed();
+}
+
+void Transfer::markAsStarted()
+{
+	m_timeStarted = QDateTime::currentDateTimeUtc();
+}
+
+void Transfer::markAsFinished()
+{
+	m_timeFinished = QDateTime::currentDateTimeUtc();
+}
+
+void Transfer::handleDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+	m_bytesReceivedDifference += (bytesReceived - (m_bytesReceived - m_bytesStart));
+	m_bytesReceived = (m_bytesStart + bytesReceived);
+	m_bytesTotal = (m_bytesStart + bytesTotal);
+
+	emit progressChanged(bytesReceived, bytesTotal);
+}
+
+void Transfer::handleDataAvailable()
+{
+	if (!m_reply || !m_device || !m_segments.isEmpty())
+	{
+		return;
+	}
+
+	if (m_state == ErrorState)
+	{
+		m_state = RunningState;
+
+		if (m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid() && m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206)
+		{
+			m_device->reset();
+		}
+	}
+	else if (m_bytesStart > 0 && m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid() && m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206)
+	{
+		if (m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200)
+		{
+			return;
+		}
+
+		m_bytesStart = 0;
+		m_bytesReceived = 0;
+
+		m_device->resize(0);
+		m_device->reset();
+
+		resetHashes();
+	}
+
+	const qint64 bytesWritten(writeData(m_reply, m_bytesAllowance));
+
+	if (m_bytesAllowance > 0 && bytesWritten > 0)
+	{
+		m_bytesAllowance = qMax(static_cast<qint64>(0), (m_bytesAllowance - bytesWritten));
+	}
+
+	m_device->seek(m_device->size());
+
+	if (m_isFinishing)
+	{
+		if (m_reply->bytesAvailable() == 0)
+		{
+			handleDownloadFinished();
+		}
+
+		return;
+	}
+
+	if (m_state == RunningState && m_reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool() && m_bytesTotal >= 0 && m_device->size() == m_bytesTotal)
+	{
+		handleDownloadFinished();
+	}
+	else if (canStartSegments())
+	{
+		startSegments(SettingsManager::getOption(SettingsManager::Browser_TransferSegmentsAmountOption).toInt());
+	}
+}
+
+void Transfer::handleDownloadFinished()
+{
+	if (!m_reply)
+	{
+		if (m_device && !m_device->inherits("QTemporaryFile"))
+		{
+			m_device->close();
+			m_device->deleteLater();
+			m_device = nullptr;
+		}
+
+		if (m_options.testFlag(CanAutoDeleteOption) && !m_isSelectingPath)
+		{
+			deleteLater();
+		}
+
+		return;
+	}
+
+	if (!m_reply->attribute(QNetworkRequest::RedirectionTargetAttribute).isNull())
+	{
+		const QUrl url(m_source.resolved(m_reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl()));
+
+		if (!url.isValid() || (m_source.scheme() == QLatin1String("https") && url.scheme() == QLatin1String("http")))
+		{
+			handleDownloadError(QNetworkReply::UnknownContentError);
+		}
+		else
+		{
+			m_source = url;
+
+			restart();
+		}
+
+		return;
+	}
+
+	if (m_reply->bytesAvailable() > 0 && m_device)
+	{
+		const qint64 bytesWritten(writeData(m_reply, m_bytesAllowance));
+
+		if (m_bytesAllowance > 0 && bytesWritten > 0)
+		{
+			m_bytesAllowance = qMax(static_cast<qint64>(0), (m_bytesAllowance - bytesWritten));
+		}
+
+		if (bytesWritten >= 0 && m_bytesAllowance >= 0 && m_reply->bytesAvailable() > 0)
+		{
+			m_isFinishing = true;
+
+			return;
+		}
+	}
+
+	m_isFinishing = false;
+
+	if (m_updateTimer != 0)
+	{
+		killTimer(m_updateTimer);
+
+		m_updateTimer = 0;
+	}
+
+	disconnect(m_reply, &QNetworkReply::downloadProgress, this, &Transfer::handleDownloadProgress);
+	disconnect(m_reply, &QNetworkReply::readyRead, this, &Transfer::handleDataAvailable);
+	disconnect(m_reply, &QNetworkReply::finished, this, &Transfer::handleDownloadFinished);
+
+	m_bytesReceived = (m_device ? m_device->size() : -1);
+
+	if (m_bytesTotal <= 0 && m_bytesReceived > 0)
+	{
+		m_bytesTotal = m_bytesReceived;
+	}
+
+	if (m_bytesReceived == 0 || m_bytesReceived < m_bytesTotal)
+	{
+		m_state = ErrorState;
+	}
+	else
+	{
+		markAsFinished();
+		finishHashes();
+
+		m_state = FinishedState;
+		m_mimeType = QMimeDatabase().mimeTypeForFile(m_target);
+	}
+
+	emit finished();
+	emit changed();
+
+	if (m_device && (m_options.testFlag(HasToOpenAfterFinishOption) || !m_device->inherits("QTemporaryFile")))
+	{
+		m_device->close();
+		m_device->deleteLater();
+		m_device = nullptr;
+
+		if (m_reply)
+		{
+			QTimer::singleShot(250, m_reply, &QNetworkReply::deleteLater);
+		}
+	}
+
+	if (m_state == FinishedState && m_options.testFlag(HasToOpenAfterFinishOption))
+	{
+		openTarget();
+	}
+
+	if (m_options.testFlag(CanAutoDeleteOption) && !m_isSelectingPath)
+	{
+		deleteLater();
+	}
+}
+
+void Transfer::handleDownloadError(QNetworkReply::NetworkError error)
+{
+	Q_UNUSED(error)
+
+	stop();
+
+	m_state = ErrorState;
+
+	if (m_options.testFlag(CanAutoDeleteOption) && !m_isSelectingPath)
+	{
+		deleteLater();
+	}
+}
+
+void Transfer::handleSegmentDataAvailable()
+{
+	const int index(findSegment(qobject_cast<QNetworkReply*>(sender())));
+
+	if (index >= 0 && writeSegmentData(index))
+	{
+		completeSegment(index);
+	}
+}
+
+void Transfer::handleSegmentFinished()
+{
+	const int index(findSegment(qobject_cast<QNetworkReply*>(sender())));
+
+	if (index < 0)
+	{
+		return;
+	}
+
+	if (writeSegmentData(index))
+	{
+		completeSegment(index);
+	}
+	else if (m_state == RunningState && (m_segments.at(index).reply->error() != QNetworkReply::NoError || m_segments.at(index).reply->bytesAvailable() == 0))
+	{
+		handleDownloadError(m_segments.at(index).reply->error());
+	}
+}
+
+void Transfer::setOpenCommand(const QString &command)
+{
+	m_openCommand = command;
+
+	m_options |= HasToOpenAfterFinishOption;
+
+	QTemporaryFile *file(qobject_cast<QTemporaryFile*>(m_device));
+
+	if (file)
+	{
+		file->setAutoRemove(false);
+	}
+
+	if (m_state == FinishedState)
+	{
+		if (file)
+		{
+			file->close();
+			file->deleteLater();
+
+			m_device = nullptr;
+		}
+
+		openTarget();
+	}
+}
+
+void Transfer::setHash(QCryptographicHash::Algorithm algorithm, const QByteArray &hash)
+{
+	if (!hash.isEmpty())
+	{
+		m_hashes[algorithm] = hash;
+
+		if (!m_hashCalculators.contains(algorithm))
+		{
+			m_hashCalculators[algorithm] = new QCryptographicHash(algorithm);
+
+			if (m_hashedBytes > 0)
+			{
+				resetHashes();
+			}
+		}
+	}
+	else if (m_hashes.contains(algorithm))
+	{
+		m_hashes.remove(algorithm);
+		m_hashResults.remove(algorithm);
+
+		delete m_hashCalculators.take(algorithm);
+	}
+}
+
+void Transfer::setPriority(TransferPriority priority)
+{
+	if (priority != m_priority)
+	{
+		m_priority = priority;
+
+		emit limitsChanged();
+		emit changed();
+	}
+}
+
+void Transfer::setBandwidthLimit(qint64 limit)
+{
+	if (limit != m_bandwidthLimit)
+	{
+		m_bandwidthLimit = qMax(static_cast<qint64>(0), limit);
+
+		emit limitsChanged();
+		emit changed();
+	}
 }
 
 void Transfer::setUpdateInterval(int interval)
@@ -661,71 +1234,292 @@ QString Transfer::getSuggestedFileName()
 
 		if (!suffix.isEmpty())
 		{
-			fileName.append(QLatin1Char('.'));
-			fileName.append(suffix);
+			fileName.append(QLatin1Char('.'));
+			fileName.append(suffix);
+		}
+	}
+
+	m_suggestedFileName = fileName;
+
+	return fileName;
+}
+
+QString Transfer::getTarget() const
+{
+	return m_target;
+}
+
+QIcon Transfer::getIcon() const
+{
+	const QString iconName(getMimeType().iconName());
+
+	return QIcon::fromTheme(iconName, QFileIconProvider().icon(iconName));
+}
+
+QDateTime Transfer::getTimeStarted() const
+{
+	return m_timeStarted;
+}
+
+QDateTime Transfer::getTimeFinished() const
+{
+	return m_timeFinished;
+}
+
+QMimeType Transfer::getMimeType() const
+{
+	return m_mimeType;
+}
+
+qint64 Transfer::getSpeed() const
+{
+	return m_speed;
+}
+
+qint64 Transfer::getBytesReceived() const
+{
+	return m_bytesReceived;
+}
+
+qint64 Transfer::getBytesTotal() const
+{
+	return m_bytesTotal;
+}
+
+Transfer::TransferOptions Transfer::getOptions() const
+{
+	return m_options;
+}
+
+Transfer::TransferState Transfer::getState() const
+{
+	return m_state;
+}
+
+Transfer::TransferPriority Transfer::getPriority() const
+{
+	return m_priority;
+}
+
+qint64 Transfer::getBandwidthLimit() const
+{
+	return m_bandwidthLimit;
+}
+
+int Transfer::getRemainingTime() const
+{
+	return m_remainingTime;
+}
+
+int Transfer::findSegment(QNetworkReply *reply) const
+{
+	if (!reply)
+	{
+		return -1;
+	}
+
+	for (int i = 0; i < m_segments.count(); ++i)
+	{
+		if (m_segments.at(i).reply == reply)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+void Transfer::updateHashes(qint64 position, const char *data, qint64 size)
+{
+	if (m_hashCalculators.isEmpty())
+	{
+		return;
+	}
+
+	if (position == 0 && m_hashedBytes > 0)
+	{
+		resetHashes();
+	}
+
+	if (position != m_hashedBytes)
+	{
+		return;
+	}
+
+	QHash<QCryptographicHash::Algorithm, QCryptographicHash*>::iterator iterator;
+
+	for (iterator = m_hashCalculators.begin(); iterator != m_hashCalculators.end(); ++iterator)
+	{
+		iterator.value()->addData(data, static_cast<int>(size));
+	}
+
+	m_hashedBytes += size;
+}
+
+void Transfer::resetHashes()
+{
+	QHash<QCryptographicHash::Algorithm, QCryptographicHash*>::iterator iterator;
+
+	for (iterator = m_hashCalculators.begin(); iterator != m_hashCalculators.end(); ++iterator)
+	{
+		iterator.value()->reset();
+	}
+
+	m_hashResults.clear();
+	m_hashedBytes = 0;
+}
+
+void Transfer::finishHashes()
+{
+	if (m_hashCalculators.isEmpty())
+	{
+		return;
+	}
+
+	if (m_device)
+	{
+		m_device->flush();
+	}
+
+	QFile file(m_target);
+
+	if (file.open(QIODevice::ReadOnly) && m_hashedBytes < file.size() && file.seek(m_hashedBytes))
+	{
+		if (m_buffer.size() != m_bufferSize)
+		{
+			m_buffer.resize(m_bufferSize);
+		}
+
+		qint64 bytesRead(0);
+
+		while ((bytesRead = file.read(m_buffer.data(), m_bufferSize)) > 0)
+		{
+			updateHashes(m_hashedBytes, m_buffer.constData(), bytesRead);
+		}
+	}
+
+	QHash<QCryptographicHash::Algorithm, QCryptographicHash*>::iterator iterator;
+
+	for (iterator = m_hashCalculators.begin(); iterator != m_hashCalculators.end(); ++iterator)
+	{
+		m_hashResults[iterator.key()] = iterator.value()->result();
+	}
+}
+
+qint64 Transfer::writeData(QIODevice *source, qint64 limit)
+{
+	if (m_buffer.size() != m_bufferSize)
+	{
+		m_buffer.resize(m_bufferSize);
+	}
+
+	qint64 bytesWritten(0);
+
+	while (limit < 0 || bytesWritten < limit)
+	{
+		const qint64 position(m_device->pos());
+		const qint64 bytesRead(source->read(m_buffer.data(), ((limit < 0) ? m_bufferSize : qMin(static_cast<qint64>(m_bufferSize), (limit - bytesWritten)))));
+
+		if (bytesRead <= 0)
+		{
+			break;
+		}
+
+		if (m_device->write(m_buffer.constData(), bytesRead) != bytesRead)
+		{
+			return -1;
+		}
+
+		updateHashes(position, m_buffer.constData(), bytesRead);
+
+		bytesWritten += bytesRead;
+	}
+
+	return bytesWritten;
+}
+
+bool Transfer::writeSegmentData(int index)
+{
+	Segment &segment(m_segments[index]);
+
+	if (m_state != RunningState || !m_device || !segment.reply)
+	{
+		return false;
+	}
+
+	if (segment.isRangeRequest && segment.reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid() && segment.reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206)
+	{
+		if (segment.reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200)
+		{
+			cancelSegments(index);
+		}
+		else
+		{
+			handleDownloadError(QNetworkReply::ProtocolInvalidOperationError);
 		}
+
+		return false;
 	}
 
-	m_suggestedFileName = fileName;
+	const qint64 remainingBytes(segment.end - segment.position + 1);
 
-	return fileName;
-}
+	if (remainingBytes <= 0 || segment.reply->bytesAvailable() <= 0)
+	{
+		return (remainingBytes <= 0);
+	}
 
-QString Transfer::getTarget() const
-{
-	return m_target;
-}
+	const qint64 bytesWritten(m_device->seek(segment.position) ? writeData(segment.reply, ((m_bytesAllowance < 0) ? remainingBytes : qMin(remainingBytes, m_bytesAllowance))) : -1);
 
-QIcon Transfer::getIcon() const
-{
-	const QString iconName(getMimeType().iconName());
+	if (bytesWritten < 0)
+	{
+		handleDownloadError(QNetworkReply::UnknownContentError);
 
-	return QIcon::fromTheme(iconName, QFileIconProvider().icon(iconName));
-}
+		return false;
+	}
 
-QDateTime Transfer::getTimeStarted() const
-{
-	return m_timeStarted;
-}
+	if (m_bytesAllowance > 0)
+	{
+		m_bytesAllowance = qMax(static_cast<qint64>(0), (m_bytesAllowance - bytesWritten));
+	}
 
-QDateTime Transfer::getTimeFinished() const
-{
-	return m_timeFinished;
-}
+	segment.position += bytesWritten;
 
-QMimeType Transfer::getMimeType() const
-{
-	return m_mimeType;
-}
+	m_bytesReceived += bytesWritten;
+	m_bytesReceivedDifference += bytesWritten;
 
-qint64 Transfer::getSpeed() const
-{
-	return m_speed;
-}
+	emit progressChanged(m_bytesReceived, m_bytesTotal);
 
-qint64 Transfer::getBytesReceived() const
-{
-	return m_bytesReceived;
+	return (segment.position > segment.end);
 }
 
-qint64 Transfer::getBytesTotal() const
+bool Transfer::canSuspendRequest() const
 {
-	return m_bytesTotal;
-}
+	if (!m_segments.isEmpty())
+	{
+		return true;
+	}
 
-Transfer::TransferOptions Transfer::getOptions() const
-{
-	return m_options;
-}
+	if (!m_reply || m_reply->isFinished() || !m_device || m_reply->operation() != QNetworkAccessManager::GetOperation || m_reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool())
+	{
+		return false;
+	}
 
-Transfer::TransferState Transfer::getState() const
-{
-	return m_state;
+	return (m_reply->rawHeader(QByteArrayLiteral("Accept-Ranges")).trimmed().toLower() == QByteArrayLiteral("bytes") && (m_source.scheme() == QLatin1String("http") || m_source.scheme() == QLatin1String("https")));
 }
 
-int Transfer::getRemainingTime() const
+bool Transfer::canStartSegments() const
 {
-	return m_remainingTime;
+	if (!m_segments.isEmpty() || m_state != RunningState || m_isQueued || !m_reply || !m_device || m_device->inherits("QTemporaryFile") || m_bytesStart > 0 || m_bytesTotal < (m_minimumSegmentSize * 4) || SettingsManager::getOption(SettingsManager::Browser_TransferSegmentsAmountOption).toInt() < 2)
+	{
+		return false;
+	}
+
+	if (m_reply->operation() != QNetworkAccessManager::GetOperation || m_reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool() || m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200 || m_reply->hasRawHeader(QByteArrayLiteral("Content-Encoding")))
+	{
+		return false;
+	}
+
+	return (m_reply->rawHeader(QByteArrayLiteral("Accept-Ranges")).trimmed().toLower() == QByteArrayLiteral("bytes") && (m_source.scheme() == QLatin1String("http") || m_source.scheme() == QLatin1String("https")));
 }
 
 bool Transfer::verifyHashes() const
@@ -735,34 +1529,68 @@ bool Transfer::verifyHashes() const
 		return false;
 	}
 
-	QFile file(getTarget());
+	QHash<QCryptographicHash::Algorithm, QByteArray> results(m_hashResults);
 
-	if (!file.open(QIODevice::ReadOnly))
+	if (results.count() != m_hashes.count())
 	{
-		return false;
+		QFile file(getTarget());
+
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			return false;
+		}
+
+		QVector<QCryptographicHash*> calculators;
+		calculators.reserve(m_hashes.count());
+
+		QHash<QCryptographicHash::Algorithm, QByteArray>::const_iterator iterator;
+
+		for (iterator = m_hashes.constBegin(); iterator != m_hashes.constEnd(); ++iterator)
+		{
+			calculators.append(new QCryptographicHash(iterator.key()));
+		}
+
+		QByteArray buffer(m_bufferSize, Qt::Uninitialized);
+		qint64 bytesRead(0);
+
+		while ((bytesRead = file.read(buffer.data(), m_bufferSize)) > 0)
+		{
+			for (int i = 0; i < calculators.count(); ++i)
+			{
+				calculators.at(i)->addData(buffer.constData(), static_cast<int>(bytesRead));
+			}
+		}
+
+		file.close();
+
+		int i(0);
+
+		for (iterator = m_hashes.constBegin(); iterator != m_hashes.constEnd(); ++iterator)
+		{
+			results[iterator.key()] = calculators.at(i)->result();
+
+			++i;
+		}
+
+		qDeleteAll(calculators);
 	}
 
 	QHash<QCryptographicHash::Algorithm, QByteArray>::const_iterator iterator;
-	bool isValid(true);
 
 	for (iterator = m_hashes.constBegin(); iterator != m_hashes.constEnd(); ++iterator)
 	{
-		QCryptographicHash hash(iterator.key());
-		hash.addData(&file);
-
-		if (hash.result() != iterator.value())
+		if (results.value(iterator.key()) != iterator.value())
 		{
-			isValid = false;
-
-			break;
+			return false;
 		}
-
-		file.seek(0);
 	}
 
-	file.close();
+	return true;
+}
 
-	return isValid;
+bool Transfer::canBeScheduled() const
+{
+	return (m_state == RunningState && (m_isQueued || m_isFinishing || (m_reply && !m_reply->isFinished()) || !m_segments.isEmpty()));
 }
 
 bool Transfer::isArchived() const
@@ -770,6 +1598,11 @@ bool Transfer::isArchived() const
 	return m_isArchived;
 }
 
+bool Transfer::isQueued() const
+{
+	return m_isQueued;
+}
+
 bool Transfer::resume()
 {
 	if (m_state != ErrorState || !QFile::exists(m_target))
@@ -784,6 +1617,42 @@ bool Transfer::resume()
 		return restart();
 	}
 
+	resetHashes();
+
+	if (!m_segments.isEmpty())
+	{
+		QFile *file(new QFile(m_target));
+
+		if (!file->open(QIODevice::ReadWrite) || file->size() != m_bytesTotal)
+		{
+			file->deleteLater();
+
+			return restart();
+		}
+
+		m_state = RunningState;
+		m_device = file;
+		m_timeStarted = QDateTime::currentDateTimeUtc();
+		m_timeFinished = {};
+		m_bytesReceived = m_bytesTotal;
+
+		m_isQueued = true;
+
+		for (int i = 0; i < m_segments.count(); ++i)
+		{
+			m_bytesReceived -= (m_segments.at(i).end - m_segments.at(i).position + 1);
+		}
+
+		if (m_updateTimer == 0 && m_updateInterval > 0)
+		{
+			m_updateTimer = startTimer(m_updateInterval);
+		}
+
+		emit changed();
+
+		return true;
+	}
+
 	QFile *file(new QFile(m_target));
 
 	if (!file->open(QIODevice::WriteOnly | QIODevice::Append))
@@ -798,27 +1667,15 @@ bool Transfer::resume()
 	m_timeStarted = QDateTime::currentDateTimeUtc();
 	m_timeFinished = {};
 	m_bytesStart = file->size();
-
-	QNetworkRequest request;
-	request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
-	request.setHeader(QNetworkRequest::UserAgentHeader, NetworkManagerFactory::getUserAgent());
-	request.setRawHeader(QByteArrayLiteral("Range"), QStringLiteral("bytes=%1-").arg(file->size()).toLatin1());
-	request.setUrl(m_source);
-
-	m_reply = NetworkManagerFactory::getNetworkManager(m_options.testFlag(IsPrivateOption))->get(request);
-
-	handleDataAvailable();
-
-	connect(m_reply, &QNetworkReply::downloadProgress, this, &Transfer::handleDownloadProgress);
-	connect(m_reply, &QNetworkReply::readyRead, this, &Transfer::handleDataAvailable);
-	connect(m_reply, &QNetworkReply::finished, this, &Transfer::handleDownloadFinished);
-	connect(m_reply, &QNetworkReply::errorOccurred, this, &Transfer::handleDownloadError);
+	m_isQueued = true;
 
 	if (m_updateTimer == 0 && m_updateInterval > 0)
 	{
 		m_updateTimer = startTimer(m_updateInterval);
 	}
 
+	emit changed();
+
 	return true;
 }
 
@@ -827,6 +1684,9 @@ bool Transfer::restart()
 	stop();
 
 	m_isArchived = false;
+	m_segments.clear();
+
+	resetHashes();
 
 	QFile *file(new QFile(m_target));
 
@@ -842,26 +1702,15 @@ bool Transfer::restart()
 	m_timeStarted = QDateTime::currentDateTimeUtc();
 	m_timeFinished = {};
 	m_bytesStart = 0;
-
-	QNetworkRequest request;
-	request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
-	request.setHeader(QNetworkRequest::UserAgentHeader, NetworkManagerFactory::getUserAgent());
-	request.setUrl(m_source);
-
-	m_reply = NetworkManagerFactory::getNetworkManager(m_options.testFlag(IsPrivateOption))->get(request);
-
-	handleDataAvailable();
-
-	connect(m_reply, &QNetworkReply::downloadProgress, this, &Transfer::handleDownloadProgress);
-	connect(m_reply, &QNetworkReply::readyRead, this, &Transfer::handleDataAvailable);
-	connect(m_reply, &QNetworkReply::finished, this, &Transfer::handleDownloadFinished);
-	connect(m_reply, &QNetworkReply::errorOccurred, this, &Transfer::handleDownloadError);
+	m_isQueued = true;
 
 	if (m_updateTimer == 0 && m_updateInterval > 0)
 	{
 		m_updateTimer = startTimer(m_updateInterval);
 	}
 
+	emit changed();
+
 	return true;
 }
 
@@ -944,7 +1793,17 @@ bool Transfer::setTarget(const QString &target, bool canOverwriteExisting)
 
 		m_device->reset();
 
-		file->write(m_device->readAll());
+		if (m_buffer.size() != m_bufferSize)
+		{
+			m_buffer.resize(m_bufferSize);
+		}
+
+		qint64 bytesRead(0);
+
+		while ((bytesRead = m_device->read(m_buffer.data(), m_bufferSize)) > 0)
+		{
+			file->write(m_buffer.constData(), bytesRead);
+		}
 
 		m_device->close();
 		m_device->deleteLater();
@@ -967,8 +1826,11 @@ bool Transfer::setTarget(const QString &target, bool canOverwriteExisting)
 }
 
 TransfersManager::TransfersManager(QObject *parent) : QObject(parent),
-	m_saveTimer(0)
+	m_saveTimer(0),
+	m_bandwidthTimer(0),
+	m_isUpdatingQueue(false)
 {
+	connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, &TransfersManager::handleOptionChanged);
 }
 
 void TransfersManager::createInstance()
@@ -989,6 +1851,10 @@ void TransfersManager::timerEvent(QTimerEvent *event)
 
 		save();
 	}
+	else if (event->timerId() == m_bandwidthTimer)
+	{
+		distributeBandwidth();
+	}
 }
 
 void TransfersManager::scheduleSave()
@@ -1027,6 +1893,105 @@ void TransfersManager::updateRunningTransfersState()
 	m_hasRunningTransfers = hasRunningTransfers;
 }
 
+void TransfersManager::updateQueue()
+{
+	if (m_isUpdatingQueue)
+	{
+		return;
+	}
+
+	m_isUpdatingQueue = true;
+
+	const QVector<Transfer*> transfers(getScheduledTransfers());
+	const int transfersLimit(SettingsManager::getOption(SettingsManager::Browser_TransfersLimitOption).toInt());
+	const bool hasBandwidthLimit(SettingsManager::getOption(SettingsManager::Browser_TransferBandwidthLimitOption).toInt() > 0);
+	int activeTransfers(0);
+	bool needsBandwidthTimer(false);
+
+	for (int i = 0; i < transfers.count(); ++i)
+	{
+		Transfer *transfer(transfers.at(i));
+		const bool isQueued(transfersLimit > 0 && activeTransfers >= transfersLimit);
+
+		transfer->setQueued(isQueued);
+
+		if (isQueued)
+		{
+			continue;
+		}
+
+		++activeTransfers;
+
+		if (hasBandwidthLimit || transfer->getBandwidthLimit() > 0)
+		{
+			needsBandwidthTimer = true;
+
+			if (transfer->m_bytesAllowance < 0)
+			{
+				transfer->setAllowance(0);
+			}
+		}
+		else
+		{
+			transfer->setAllowance(-1);
+		}
+	}
+
+	if (needsBandwidthTimer && m_bandwidthTimer == 0)
+	{
+		m_bandwidthTimer = startTimer(m_bandwidthInterval);
+	}
+	else if (!needsBandwidthTimer && m_bandwidthTimer != 0)
+	{
+		killTimer(m_bandwidthTimer);
+
+		m_bandwidthTimer = 0;
+	}
+
+	m_isUpdatingQueue = false;
+}
+
+void TransfersManager::distributeBandwidth()
+{
+	const QVector<Transfer*> transfers(getScheduledTransfers());
+	const qint64 bandwidthLimit(SettingsManager::getOption(SettingsManager::Browser_TransferBandwidthLimitOption).toLongLong() * 1024);
+	int weightsSum(0);
+
+	for (int i = 0; i < transfers.count(); ++i)
+	{
+		if (!transfers.at(i)->isQueued())
+		{
+			weightsSum += (1 << transfers.at(i)->getPriority());
+		}
+	}
+
+	for (int i = 0; i < transfers.count(); ++i)
+	{
+		Transfer *transfer(transfers.at(i));
+
+		if (transfer->isQueued())
+		{
+			continue;
+		}
+
+		qint64 allowance(-1);
+
+		if (bandwidthLimit > 0)
+		{
+			allowance = qMax(static_cast<qint64>(1), (((bandwidthLimit * m_bandwidthInterval) / 1000) * (1 << transfer->getPriority()) / weightsSum));
+		}
+
+		if (transfer->getBandwidthLimit() > 0)
+		{
+			const qint64 transferAllowance(qMax(static_cast<qint64>(1), ((transfer->getBandwidthLimit() * m_bandwidthInterval) / 1000)));
+
+			allowance = ((allowance < 0) ? transferAllowance : qMin(allowance, transferAllowance));
+		}
+
+		transfer->setAllowance(allowance);
+	}
+}
+
 void TransfersManager::addTransfer(Transfer *transfer)
 {
 	if (!transfer)
@@ -1044,6 +2009,7 @@ void TransfersManager::addTransfer(Transfer *transfer)
 	connect(transfer, &Transfer::finished, m_instance, &TransfersManager::handleTransferFinished);
 	connect(transfer, &Transfer::changed, m_instance, &TransfersManager::handleTransferChanged);
 	connect(transfer, &Transfer::stopped, m_instance, &TransfersManager::handleTransferStopped);
+	connect(transfer, &Transfer::limitsChanged, m_instance, &TransfersManager::updateQueue);
 
 	if (options.testFlag(Transfer::CanNotifyOption) && transfer->getState() != Transfer::CancelledState)
 	{
@@ -1070,6 +2036,8 @@ void TransfersManager::addTransfer(Transfer *transfer)
 			HistoryManager::addEntry(source);
 		}
 	}
+
+	m_instance->updateQueue();
 }
 
 void TransfersManager::save()
@@ -1101,6 +2069,29 @@ void TransfersManager::save()
 		history.setValue(QStringLiteral("%1/bytesTotal").arg(entry), transfer->getBytesTotal());
 		history.setValue(QStringLiteral("%1/bytesReceived").arg(entry), transfer->getBytesReceived());
 
+		if (transfer->getPriority() != Transfer::NormalPriority)
+		{
+			history.setValue(QStringLiteral("%1/priority").arg(entry), transfer->getPriority());
+		}
+
+		if (transfer->getBandwidthLimit() > 0)
+		{
+			history.setValue(QStringLiteral("%1/bandwidthLimit").arg(entry), transfer->getBandwidthLimit());
+		}
+
+		if (!transfer->m_segments.isEmpty() && transfer->getState() != Transfer::FinishedState)
+		{
+			QStringList segments;
+			segments.reserve(transfer->m_segments.count());
+
+			for (int i = 0; i < transfer->m_segments.count(); ++i)
+			{
+				segments.append(QStringLiteral("%1-%2").arg(transfer->m_segments.at(i).position).arg(transfer->m_segments.at(i).end));
+			}
+
+			history.setValue(QStringLiteral("%1/segments").arg(entry), segments);
+		}
+
 		++entry;
 	}
 
@@ -1135,6 +2126,7 @@ void TransfersManager::handleTransferStarted()
 		emit transfersChanged();
 
 		scheduleSave();
+		updateQueue();
 	}
 }
 
@@ -1143,6 +2135,7 @@ void TransfersManager::handleTransferFinished()
 	Transfer *transfer(qobject_cast<Transfer*>(sender()));
 
 	updateRunningTransfersState();
+	updateQueue();
 
 	if (!transfer)
 	{
@@ -1181,6 +2174,7 @@ void TransfersManager::handleTransferChanged()
 	{
 		scheduleSave();
 		updateRunningTransfersState();
+		updateQueue();
 
 		emit transferChanged(transfer);
 		emit transfersChanged();
@@ -1192,6 +2186,7 @@ void TransfersManager::handleTransferStopped()
 	Transfer *transfer(qobject_cast<Transfer*>(sender()));
 
 	updateRunningTransfersState();
+	updateQueue();
 
 	if (transfer)
 	{
@@ -1202,6 +2197,20 @@ void TransfersManager::handleTransferStopped()
 	}
 }
 
+void TransfersManager::handleOptionChanged(int identifier)
+{
+	switch (identifier)
+	{
+		case SettingsManager::Browser_TransferBandwidthLimitOption:
+		case SettingsManager::Browser_TransfersLimitOption:
+			updateQueue();
+
+			break;
+		default:
+			break;
+	}
+}
+
 TransfersManager* TransfersManager::getInstance()
 {
 	return m_instance;
@@ -1293,6 +2302,26 @@ QVector<Transfer*> TransfersManager::getTransfers()
 	return m_transfers;
 }
 
+QVector<Transfer*> TransfersManager::getScheduledTransfers() const
+{
+	QVector<Transfer*> transfers;
+
+	for (int i = 0; i < m_transfers.count(); ++i)
+	{
+		if (m_transfers.at(i)->canBeScheduled())
+		{
+			transfers.append(m_transfers.at(i));
+		}
+	}
+
+	std::stable_sort(transfers.begin(), transfers.end(), [&](Transfer *first, Transfer *second)
+	{
+		return (first->getPriority() > second->getPriority());
+	});
+
+	return transfers;
+}
+
 TransfersManager::ActiveTransfersInformation TransfersManager::getActiveTransfersInformation()
 {
 	ActiveTransfersInformation information;
@@ -51,6 +51,13 @@ public:
 
 	Q_DECLARE_FLAGS(TransferOptions, TransferOption)
 
+	enum TransferPriority
+	{
+		LowPriority = 0,
+		NormalPriority,
+		HighPriority
+	};
+
 	enum TransferState
 	{
 		UnknownState = 0,
@@ -63,6 +70,8 @@ public:
 	~Transfer();
 
 	void setHash(QCryptographicHash::Algorithm algorithm, const QByteArray &hash);
+	void setPriority(TransferPriority priority);
+	void setBandwidthLimit(qint64 limit);
 	virtual void setUpdateInterval(int interval);
 	virtual QUrl getSource() const;
 	virtual QString getSuggestedFileName();
@@ -76,9 +85,12 @@ public:
 	virtual qint64 getBytesTotal() const;
 	TransferOptions getOptions() const;
 	virtual TransferState getState() const;
+	TransferPriority getPriority() const;
+	qint64 getBandwidthLimit() const;
 	virtual int getRemainingTime() const;
 	bool verifyHashes() const;
 	bool isArchived() const;
+	bool isQueued() const;
 
 public slots:
 	void openTarget() const;
@@ -90,11 +102,40 @@ public slots:
 	virtual bool setTarget(const QString &target, bool canOverwriteExisting = false);
 
 protected:
+	struct Segment final
+	{
+		QPointer<QNetworkReply> reply;
+		qint64 position = 0;
+		qint64 end = -1;
+		bool isRangeRequest = true;
+	};
+
 	explicit Transfer(TransferOptions options = CanAskForPathOption, QObject *parent = nullptr);
 	explicit Transfer(const QSettings &settings, QObject *parent = nullptr);
 
 	void timerEvent(QTimerEvent *event) override;
 	void start(QNetworkReply *reply, const QString &target);
+	void setQueued(bool isQueued);
+	void setAllowance(qint64 allowance);
+	void updateReadBufferSize();
+	void startRequest();
+	void suspendRequest();
+	void startSegments(int amount);
+	void startSegment(int index);
+	void stopSegments();
+	void cancelSegments(int index);
+	void completeSegment(int index);
+	void finishSegments();
+	void rebalanceSegments();
+	int findSegment(QNetworkReply *reply) const;
+	void updateHashes(qint64 position, const char *data, qint64 size);
+	void resetHashes();
+	void finishHashes();
+	qint64 writeData(QIODevice *source, qint64 limit = -1);
+	bool writeSegmentData(int index);
+	bool canSuspendRequest() const;
+	bool canStartSegments() const;
+	bool canBeScheduled() const;
 
 protected slots:
 	void markAsStarted();
@@ -103,6 +144,8 @@ protected slots:
 	void handleDataAvailable();
 	void handleDownloadFinished();
 	void handleDownloadError(QNetworkReply::NetworkError error);
+	void handleSegmentDataAvailable();
+	void handleSegmentFinished();
 
 private:
 	QPointer<QNetworkReply> m_reply;
@@ -115,19 +158,32 @@ private:
 	QDateTime m_timeFinished;
 	QMimeType m_mimeType;
 	QHash<QCryptographicHash::Algorithm, QByteArray> m_hashes;
+	QHash<QCryptographicHash::Algorithm, QByteArray> m_hashResults;
+	QHash<QCryptographicHash::Algorithm, QCryptographicHash*> m_hashCalculators;
+	QByteArray m_buffer;
 	QQueue<qint64> m_speeds;
+	QVector<Segment> m_segments;
 	qint64 m_speed;
 	qint64 m_bytesStart;
 	qint64 m_bytesReceivedDifference;
 	qint64 m_bytesReceived;
 	qint64 m_bytesTotal;
+	qint64 m_hashedBytes;
+	qint64 m_bytesAllowance;
+	qint64 m_bandwidthLimit;
 	TransferOptions m_options;
 	TransferState m_state;
+	TransferPriority m_priority;
 	int m_updateTimer;
 	int m_updateInterval;
 	int m_remainingTime;
 	bool m_isSelectingPath;
 	bool m_isArchived;
+	bool m_isQueued;
+	bool m_isFinishing;
+
+	static const qint64 m_minimumSegmentSize;
+	static const int m_bufferSize;
 
 signals:
 	void progressChanged(qint64 bytesReceived, qint64 bytesTotal);
@@ -135,6 +191,7 @@ signals:
 	void finished();
 	void changed();
 	void stopped();
+	void limitsChanged();
 
 friend class TransfersManager;
 };
@@ -172,9 +229,13 @@ protected:
 	void timerEvent(QTimerEvent *event) override;
 	void scheduleSave();
 	void updateRunningTransfersState();
+	void updateQueue();
+	void distributeBandwidth();
+	QVector<Transfer*> getScheduledTransfers() const;
 
 protected slots:
 	void save();
+	void handleOptionChanged(int identifier);
 	void handleTransferStarted();
 	void handleTransferFinished();
 	void handleTransferChanged();
@@ -182,12 +243,15 @@ protected slots:
 
 private:
 	int m_saveTimer;
+	int m_bandwidthTimer;
+	bool m_isUpdatingQueue;
 
 	static TransfersManager *m_instance;
 	static QVector<Transfer*> m_transfers;
 	static QVector<Transfer*> m_privateTransfers;
 	static bool m_isInitilized;
 	static bool m_hasRunningTransfers;
+	static const int m_bandwidthInterval;
 
 signals:
 	void transferStarted(Transfer *transfer);
@@ -32,6 +32,8 @@
 namespace Otter
 {
 
+UserScriptMatcher UserScript::m_matcher;
+
 UserScript::UserScript(const QString &path, const QUrl &url, QObject *parent) : QObject(parent),
 	m_iconFetchJob(nullptr),
 	m_path(path),
@@ -42,6 +44,11 @@ UserScript::UserScript(const QString &path, const QUrl &url, QObject *parent) :
 	reload();
 }
 
+UserScript::~UserScript()
+{
+	m_matcher.removeScript(this);
+}
+
 void UserScript::reload()
 {
 	m_source.clear();
@@ -64,6 +71,8 @@ void UserScript::reload()
 	{
 		Console::addMessage(QCoreApplication::translate("main", "Failed to open User Script file: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, m_path);
 
+		m_matcher.addScript(this);
+
 		return;
 	}
 
@@ -232,6 +241,8 @@ void UserScript::reload()
 		Console::addMessage(QCoreApplication::translate("main", "Failed to locate header of User Script file"), Console::OtherCategory, Console::WarningLevel, m_path);
 	}
 
+	m_matcher.addScript(this);
+
 	emit metaDataChanged();
 }
 
@@ -279,50 +290,6 @@ QString UserScript::getSource()
 	return m_source;
 }
 
-QString UserScript::checkUrlSubString(const QString &rule, const QString &urlSubString, QString generatedUrl, int position) const
-{
-	if (rule.isEmpty())
-	{
-		return urlSubString;
-	}
-
-	for (int i = 0; i < urlSubString.length(); ++i)
-	{
-		const QChar urlCharacter(urlSubString.at(i));
-		const QChar ruleCharacter(rule.at(position));
-
-		if (ruleCharacter == QLatin1Char('*'))
-		{
-			const QString wildcardString(urlSubString.mid(i));
-
-			for (int j = 1; j < wildcardString.length(); ++j)
-			{
-				const QString result(checkUrlSubString(rule, urlSubString.right(wildcardString.length() - j), generatedUrl + wildcardString.left(j), (position + 1)));
-
-				if (!result.isEmpty())
-				{
-					return result;
-				}
-			}
-		}
-		else if (ruleCharacter != urlCharacter)
-		{
-			return {};
-		}
-
-		++position;
-
-		generatedUrl += urlCharacter;
-
-		if (position == rule.length())
-		{
-			return generatedUrl;
-		}
-	}
-
-	return {};
-}
-
 QUrl UserScript::getHomePage() const
 {
 	return m_homePage;
@@ -356,13 +323,25 @@ QStringList UserScript::getMatchRules() const
 QVector<UserScript*> UserScript::getUserScriptsForUrl(const QUrl &url, UserScript::InjectionTime injectionTime, bool isSubFrame)
 {
 	const QStringList scriptNames(AddonsManager::getAddons(Addon::UserScriptType));
+
+	if (scriptNames.isEmpty() || !isUrlSupported(url))
+	{
+		return {};
+	}
+
+	const QSet<UserScript*> matchingScripts(m_matcher.getScripts(url));
 	QVector<UserScript*> scripts;
 
+	if (matchingScripts.isEmpty())
+	{
+		return scripts;
+	}
+
 	for (int i = 0; i < scriptNames.count(); ++i)
 	{
 		UserScript *script(AddonsManager::getUserScript(scriptNames.at(i)));
 
-		if (script->isEnabled() && (injectionTime == AnyTime || script->getInjectionTime() == injectionTime) && (!isSubFrame || script->shouldRunOnSubFrames()) && script->isEnabledForUrl(url))
+		if (matchingScripts.contains(script) && script->isEnabled() && (injectionTime == AnyTime || script->getInjectionTime() == injectionTime) && (!isSubFrame || script->shouldRunOnSubFrames()))
 		{
 			scripts.append(script);
 		}
@@ -383,29 +362,7 @@ Addon::AddonType UserScript::getType() const
 
 bool UserScript::isEnabledForUrl(const QUrl &url)
 {
-	if (url.scheme() != QLatin1String("http") && url.scheme() != QLatin1String("https") && url.scheme() != QLatin1String("file") && url.scheme() != QLatin1String("ftp") && url.scheme() != QLatin1String("about"))
-	{
-		return false;
-	}
-
-	bool isEnabled(!(m_includeRules.length() > 0 || m_matchRules.length() > 0));
-
-	if (checkUrl(url, m_matchRules))
-	{
-		isEnabled = true;
-	}
-
-	if (!isEnabled && checkUrl(url, m_includeRules))
-	{
-		isEnabled = true;
-	}
-
-	if (isEnabled && checkUrl(url, m_excludeRules))
-	{
-		isEnabled = false;
-	}
-
-	return isEnabled;
+	return (isUrlSupported(url) && m_matcher.isEnabledForUrl(this, url));
 }
 
 bool UserScript::canRemove() const
@@ -413,39 +370,11 @@ bool UserScript::canRemove() const
 	return true;
 }
 
-bool UserScript::checkUrl(const QUrl &url, const QStringList &rules) const
+bool UserScript::isUrlSupported(const QUrl &url)
 {
-	for (int i = 0; i < rules.count(); ++i)
-	{
-		QString rule(rules.at(i));
-
-		if (rule.startsWith(QLatin1Char('/')) && rule.endsWith(QLatin1Char('/')))
-		{
-			return QRegularExpression(rule.mid(1, rule.length() - 2)).match(url.url()).hasMatch();
-		}
-
-		if (rule.contains(QLatin1String(".tld"), Qt::CaseInsensitive))
-		{
-			rule.replace(QLatin1String(".tld"), url.topLevelDomain(), Qt::CaseInsensitive);
-		}
-
-		bool useExactMatch(true);
-
-		if (rule.endsWith(QLatin1Char('*')))
-		{
-			useExactMatch = false;
-			rule = rule.left(rule.length() - 1);
-		}
-
-		const QString result(checkUrlSubString(rule, url.url(), {}));
-
-		if (!result.isEmpty() && ((useExactMatch && url.url() == result) || (!useExactMatch && url.url().startsWith(result))))
-		{
-			return true;
-		}
-	}
+	const QString scheme(url.scheme());
 
-	return false;
+	return (scheme == QLatin1String("http") || scheme == QLatin1String("https") || scheme == QLatin1String("file") || scheme == QLatin1String("ftp") || scheme == QLatin1String("about"));
 }
 
 bool UserScript::shouldRunOnSubFrames() const
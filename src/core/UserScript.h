@@ -22,6 +22,7 @@
 #define OTTER_USERSCRIPT_H
 
 #include "AddonsManager.h"
+#include "UserScriptMatcher.h"
 
 namespace Otter
 {
@@ -42,6 +43,7 @@ public:
 	};
 
 	explicit UserScript(const QString &path, const QUrl &url = {}, QObject *parent = nullptr);
+	~UserScript();
 
 	QString getName() const override;
 	QString getTitle() const override;
@@ -61,15 +63,12 @@ public:
 	bool isEnabledForUrl(const QUrl &url);
 	bool canRemove() const override;
 	bool shouldRunOnSubFrames() const;
+	static bool isUrlSupported(const QUrl &url);
 	bool remove() override;
 
 public slots:
 	void reload();
 
-protected:
-	QString checkUrlSubString(const QString &rule, const QString &urlSubString, QString generatedUrl, int position = 0) const;
-	bool checkUrl(const QUrl &url, const QStringList &rules) const;
-
 private:
 	IconFetchJob *m_iconFetchJob;
 	QString m_path;
@@ -88,6 +87,8 @@ private:
 	InjectionTime m_injectionTime;
 	bool m_shouldRunOnSubFrames;
 
+	static UserScriptMatcher m_matcher;
+
 signals:
 	void metaDataChanged();
 };
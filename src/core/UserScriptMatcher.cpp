@@ -0,0 +1,287 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "UserScriptMatcher.h"
+#include "Console.h"
+#include "UserScript.h"
+
+#include <QtCore/QCoreApplication>
+
+namespace Otter
+{
+
+void UserScriptMatcher::addScript(UserScript *script)
+{
+	removeScript(script);
+
+	const QStringList includeRules(script->getIncludeRules());
+	const QStringList matchRules(script->getMatchRules());
+	ScriptRules rules;
+	rules.includeExpression = createExpression(includeRules, &rules.includeTemplates, script->getPath());
+	rules.excludeExpression = createExpression(script->getExcludeRules(), &rules.excludeTemplates, script->getPath());
+	rules.hasIncludeRules = !includeRules.isEmpty();
+	rules.hasMatchRules = !matchRules.isEmpty();
+
+	for (int i = 0; i < matchRules.count(); ++i)
+	{
+		const QString rule(matchRules.at(i));
+		const int schemeEnd(rule.indexOf(QLatin1String("://")));
+		const QString hostAndPath(rule.mid(schemeEnd + 3));
+		const int pathStart(hostAndPath.indexOf(QLatin1Char('/')));
+		QString host(hostAndPath.left(pathStart).toLower());
+		MatchRule matchRule;
+		matchRule.pathExpression = QRegularExpression(QLatin1Char('^') + createGlobPattern(hostAndPath.mid(pathStart)) + QLatin1Char('$'));
+		matchRule.pathExpression.optimize();
+		matchRule.scheme = rule.left(schemeEnd);
+		matchRule.script = script;
+
+		if (host.startsWith(QLatin1String("*.")))
+		{
+			host = host.mid(2);
+
+			matchRule.matchesSubdomains = true;
+		}
+
+		m_matchRules[host].append(matchRule);
+	}
+
+	m_scripts[script] = rules;
+}
+
+void UserScriptMatcher::removeScript(UserScript *script)
+{
+	if (!m_scripts.contains(script))
+	{
+		return;
+	}
+
+	m_scripts.remove(script);
+
+	QHash<QString, QVector<MatchRule> >::iterator iterator(m_matchRules.begin());
+
+	while (iterator != m_matchRules.end())
+	{
+		QVector<MatchRule> &rules(iterator.value());
+
+		for (int i = (rules.count() - 1); i >= 0; --i)
+		{
+			if (rules.at(i).script == script)
+			{
+				rules.removeAt(i);
+			}
+		}
+
+		if (rules.isEmpty())
+		{
+			iterator = m_matchRules.erase(iterator);
+		}
+		else
+		{
+			++iterator;
+		}
+	}
+}
+
+QSet<UserScript*> UserScriptMatcher::getScripts(const QUrl &url)
+{
+	QSet<UserScript*> candidates;
+	const QString host(url.host().toLower());
+	QString domain(host);
+	bool isExactHost(true);
+
+	while (true)
+	{
+		const QVector<MatchRule> rules(m_matchRules.value(domain));
+
+		for (int i = 0; i < rules.count(); ++i)
+		{
+			if ((isExactHost || rules.at(i).matchesSubdomains) && checkMatchRule(rules.at(i), url))
+			{
+				candidates.insert(rules.at(i).script);
+			}
+		}
+
+		const int separator(domain.indexOf(QLatin1Char('.')));
+
+		if (separator < 0)
+		{
+			break;
+		}
+
+		domain = domain.mid(separator + 1);
+		isExactHost = false;
+	}
+
+	const QVector<MatchRule> wildcardRules(m_matchRules.value(QLatin1String("*")));
+
+	for (int i = 0; i < wildcardRules.count(); ++i)
+	{
+		if (checkMatchRule(wildcardRules.at(i), url))
+		{
+			candidates.insert(wildcardRules.at(i).script);
+		}
+	}
+
+	QSet<UserScript*> scripts;
+	QHash<UserScript*, ScriptRules>::const_iterator iterator;
+
+	for (iterator = m_scripts.constBegin(); iterator != m_scripts.constEnd(); ++iterator)
+	{
+		const ScriptRules &rules(iterator.value());
+		bool isEnabled(candidates.contains(iterator.key()) || (!rules.hasIncludeRules && !rules.hasMatchRules));
+
+		if (!isEnabled && rules.hasIncludeRules)
+		{
+			isEnabled = checkRules(rules.includeExpression, rules.includeTemplates, url);
+		}
+
+		if (isEnabled && !checkRules(rules.excludeExpression, rules.excludeTemplates, url))
+		{
+			scripts.insert(iterator.key());
+		}
+	}
+
+	return scripts;
+}
+
+QRegularExpression UserScriptMatcher::createExpression(const QStringList &rules, QStringList *templates, const QString &path)
+{
+	QStringList patterns;
+	patterns.reserve(rules.count());
+
+	for (int i = 0; i < rules.count(); ++i)
+	{
+		const QString rule(rules.at(i));
+
+		if (rule.length() > 1 && rule.startsWith(QLatin1Char('/')) && rule.endsWith(QLatin1Char('/')))
+		{
+			const QString pattern(rule.mid(1, (rule.length() - 2)));
+
+			if (QRegularExpression(pattern).isValid())
+			{
+				patterns.append(QLatin1String("(?:") + pattern + QLatin1Char(')'));
+			}
+			else
+			{
+				Console::addMessage(QCoreApplication::translate("main", "Invalid rule for User Script: %1").arg(rule), Console::OtherCategory, Console::ErrorLevel, path);
+			}
+		}
+		else if (rule.contains(QLatin1String(".tld"), Qt::CaseInsensitive))
+		{
+			templates->append(rule);
+		}
+		else
+		{
+			patterns.append(QLatin1String("(?:^") + createGlobPattern(rule) + QLatin1String("$)"));
+		}
+	}
+
+	if (patterns.isEmpty())
+	{
+		return {};
+	}
+
+	QRegularExpression expression(patterns.join(QLatin1Char('|')));
+	expression.optimize();
+
+	return expression;
+}
+
+QString UserScriptMatcher::createGlobPattern(const QString &rule)
+{
+	const QStringList parts(rule.split(QLatin1Char('*')));
+	QStringList escapedParts;
+	escapedParts.reserve(parts.count());
+
+	for (int i = 0; i < parts.count(); ++i)
+	{
+		escapedParts.append(QRegularExpression::escape(parts.at(i)));
+	}
+
+	return escapedParts.join(QLatin1String(".*"));
+}
+
+bool UserScriptMatcher::isEnabledForUrl(UserScript *script, const QUrl &url)
+{
+	if (!m_scripts.contains(script))
+	{
+		addScript(script);
+	}
+
+	return getScripts(url).contains(script);
+}
+
+bool UserScriptMatcher::checkRules(const QRegularExpression &expression, const QStringList &templates, const QUrl &url)
+{
+	const QString urlString(url.url());
+
+	if (!expression.pattern().isEmpty() && expression.match(urlString).hasMatch())
+	{
+		return true;
+	}
+
+	if (templates.isEmpty())
+	{
+		return false;
+	}
+
+	const QString topLevelDomain(url.topLevelDomain());
+
+	for (int i = 0; i < templates.count(); ++i)
+	{
+		QString rule(templates.at(i));
+		rule.replace(QLatin1String(".tld"), topLevelDomain, Qt::CaseInsensitive);
+
+		if (!m_templateExpressions.contains(rule))
+		{
+			QRegularExpression templateExpression(QLatin1Char('^') + createGlobPattern(rule) + QLatin1Char('$'));
+			templateExpression.optimize();
+
+			m_templateExpressions[rule] = templateExpression;
+		}
+
+		if (m_templateExpressions[rule].match(urlString).hasMatch())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool UserScriptMatcher::checkMatchRule(const MatchRule &rule, const QUrl &url) const
+{
+	const QString scheme(url.scheme());
+
+	if (rule.scheme == QLatin1String("*"))
+	{
+		if (scheme != QLatin1String("http") && scheme != QLatin1String("https"))
+		{
+			return false;
+		}
+	}
+	else if (rule.scheme != scheme)
+	{
+		return false;
+	}
+
+	return rule.pathExpression.match(url.toString(QUrl::RemoveScheme | QUrl::RemoveAuthority | QUrl::RemoveFragment)).hasMatch();
+}
+
+}
@@ -0,0 +1,73 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_USERSCRIPTMATCHER_H
+#define OTTER_USERSCRIPTMATCHER_H
+
+#include <QtCore/QHash>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QSet>
+#include <QtCore/QUrl>
+
+namespace Otter
+{
+
+class UserScript;
+
+class UserScriptMatcher final
+{
+public:
+	void addScript(UserScript *script);
+	void removeScript(UserScript *script);
+	QSet<UserScript*> getScripts(const QUrl &url);
+	bool isEnabledForUrl(UserScript *script, const QUrl &url);
+
+protected:
+	struct MatchRule final
+	{
+		QRegularExpression pathExpression;
+		QString scheme;
+		UserScript *script = nullptr;
+		bool matchesSubdomains = false;
+	};
+
+	struct ScriptRules final
+	{
+		QRegularExpression includeExpression;
+		QRegularExpression excludeExpression;
+		QStringList includeTemplates;
+		QStringList excludeTemplates;
+		bool hasIncludeRules = false;
+		bool hasMatchRules = false;
+	};
+
+	bool checkRules(const QRegularExpression &expression, const QStringList &templates, const QUrl &url);
+	bool checkMatchRule(const MatchRule &rule, const QUrl &url) const;
+	static QRegularExpression createExpression(const QStringList &rules, QStringList *templates, const QString &path);
+	static QString createGlobPattern(const QString &rule);
+
+private:
+	QHash<UserScript*, ScriptRules> m_scripts;
+	QHash<QString, QVector<MatchRule> > m_matchRules;
+	QHash<QString, QRegularExpression> m_templateExpressions;
+};
+
+}
+
+#endif
@@ -0,0 +1,601 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "JournalPasswordsStorageBackend.h"
+#include "../file/FilePasswordsStorageBackend.h"
+#include "../../../../core/SessionsManager.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QTimerEvent>
+
+namespace Otter
+{
+
+JournalPasswordsStorageBackend::JournalPasswordsStorageBackend(QObject *parent) : PasswordsStorageBackend(parent),
+	m_journal(new JournalFile(SessionsManager::getWritableDataPath(QLatin1String("passwords.dat")), this)),
+	m_saveTimer(0),
+	m_isInitialized(false)
+{
+}
+
+JournalPasswordsStorageBackend::~JournalPasswordsStorageBackend()
+{
+	if (m_saveTimer != 0)
+	{
+		killTimer(m_saveTimer);
+
+		m_saveTimer = 0;
+
+		save();
+	}
+}
+
+void JournalPasswordsStorageBackend::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_saveTimer)
+	{
+		killTimer(m_saveTimer);
+
+		m_saveTimer = 0;
+
+		save();
+	}
+}
+
+void JournalPasswordsStorageBackend::ensureInitialized()
+{
+	if (m_isInitialized)
+	{
+		return;
+	}
+
+	m_isInitialized = true;
+
+	if (!m_journal->exists())
+	{
+		importLegacyPasswords();
+
+		return;
+	}
+
+	const QVector<JournalFile::Record> records(m_journal->load());
+
+	for (int i = 0; i < records.count(); ++i)
+	{
+		const JournalFile::Record record(records.at(i));
+		QDataStream stream(record.data);
+		stream.setVersion(QDataStream::Qt_5_15);
+
+		QString host;
+
+		stream >> host;
+
+		switch (record.type)
+		{
+			case HostRecord:
+				{
+					QByteArray data;
+
+					stream >> data;
+
+					if (stream.status() == QDataStream::Ok)
+					{
+						m_rawPasswords[host] = data;
+					}
+				}
+
+				break;
+			case RemoveHostRecord:
+				m_rawPasswords.remove(host);
+
+				break;
+			default:
+				break;
+		}
+	}
+
+	if (m_journal->needsCompaction(m_rawPasswords.count()))
+	{
+		compactJournal();
+	}
+}
+
+void JournalPasswordsStorageBackend::importLegacyPasswords()
+{
+	const QString path(SessionsManager::getWritableDataPath(QLatin1String("passwords.json")));
+
+	if (!QFile::exists(path))
+	{
+		return;
+	}
+
+	FilePasswordsStorageBackend legacyBackend;
+	const QStringList hosts(legacyBackend.getHosts());
+
+	for (int i = 0; i < hosts.count(); ++i)
+	{
+		const QVector<PasswordsManager::PasswordInformation> passwords(legacyBackend.getPasswords(QUrl(QLatin1String("http://") + hosts.at(i))));
+
+		if (!passwords.isEmpty())
+		{
+			m_passwords[hosts.at(i)] = passwords;
+		}
+	}
+
+	connect(m_journal, &JournalFile::compacted, this, [=](bool isSuccess)
+	{
+		if (isSuccess)
+		{
+			QFile::remove(path);
+		}
+	});
+
+	compactJournal();
+}
+
+void JournalPasswordsStorageBackend::compactJournal()
+{
+	QVector<JournalFile::Record> records;
+	records.reserve(m_passwords.count() + m_rawPasswords.count());
+
+	QHash<QString, QVector<PasswordsManager::PasswordInformation> >::const_iterator passwordsIterator;
+
+	for (passwordsIterator = m_passwords.constBegin(); passwordsIterator != m_passwords.constEnd(); ++passwordsIterator)
+	{
+		QByteArray data;
+		QDataStream stream(&data, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_15);
+		stream << passwordsIterator.key() << serializePasswords(passwordsIterator.value());
+
+		JournalFile::Record record;
+		record.type = HostRecord;
+		record.data = data;
+
+		records.append(record);
+	}
+
+	QHash<QString, QByteArray>::const_iterator rawPasswordsIterator;
+
+	for (rawPasswordsIterator = m_rawPasswords.constBegin(); rawPasswordsIterator != m_rawPasswords.constEnd(); ++rawPasswordsIterator)
+	{
+		QByteArray data;
+		QDataStream stream(&data, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_15);
+		stream << rawPasswordsIterator.key() << rawPasswordsIterator.value();
+
+		JournalFile::Record record;
+		record.type = HostRecord;
+		record.data = data;
+
+		records.append(record);
+	}
+
+	m_modifiedHosts.clear();
+
+	m_journal->compact(records);
+}
+
+void JournalPasswordsStorageBackend::markModified(const QString &host)
+{
+	m_modifiedHosts.insert(host);
+
+	if (m_saveTimer == 0)
+	{
+		m_saveTimer = startTimer(500);
+	}
+
+	emit passwordsModified();
+}
+
+void JournalPasswordsStorageBackend::save()
+{
+	QSet<QString>::const_iterator iterator;
+
+	for (iterator = m_modifiedHosts.constBegin(); iterator != m_modifiedHosts.constEnd(); ++iterator)
+	{
+		QByteArray data;
+		QDataStream stream(&data, QIODevice::WriteOnly);
+		stream.setVersion(QDataStream::Qt_5_15);
+		stream << *iterator;
+
+		if (m_passwords.value(*iterator).isEmpty())
+		{
+			m_journal->addRecord(RemoveHostRecord, data);
+		}
+		else
+		{
+			stream << serializePasswords(m_passwords.value(*iterator));
+
+			m_journal->addRecord(HostRecord, data);
+		}
+	}
+
+	m_modifiedHosts.clear();
+
+	if (m_journal->needsCompaction(m_passwords.count() + m_rawPasswords.count()))
+	{
+		compactJournal();
+	}
+	else
+	{
+		m_journal->flush();
+	}
+}
+
+void JournalPasswordsStorageBackend::clearPasswords(const QString &host)
+{
+	if (host.isEmpty())
+	{
+		return;
+	}
+
+	ensureInitialized();
+
+	if (m_passwords.remove(host) > 0 || m_rawPasswords.remove(host) > 0)
+	{
+		markModified(host);
+	}
+}
+
+void JournalPasswordsStorageBackend::clearPasswords(int period)
+{
+	ensureInitialized();
+
+	if (period <= 0)
+	{
+		const bool hadPasswords(!m_passwords.isEmpty() || !m_rawPasswords.isEmpty());
+
+		if (m_saveTimer != 0)
+		{
+			killTimer(m_saveTimer);
+
+			m_saveTimer = 0;
+		}
+
+		m_passwords.clear();
+		m_rawPasswords.clear();
+		m_modifiedHosts.clear();
+		m_journal->clear();
+
+		QFile::remove(SessionsManager::getWritableDataPath(QLatin1String("passwords.json")));
+
+		if (hadPasswords)
+		{
+			emit passwordsModified();
+		}
+
+		return;
+	}
+
+	const QStringList hosts(getHosts());
+
+	for (int i = 0; i < hosts.count(); ++i)
+	{
+		QVector<PasswordsManager::PasswordInformation> *passwords(getBucket(hosts.at(i)));
+		bool wasModified(false);
+
+		for (int j = (passwords->count() - 1); j >= 0; --j)
+		{
+			if (passwords->at(j).timeAdded.secsTo(QDateTime::currentDateTimeUtc()) < (period * 3600))
+			{
+				passwords->removeAt(j);
+
+				wasModified = true;
+			}
+		}
+
+		if (passwords->isEmpty())
+		{
+			m_passwords.remove(hosts.at(i));
+		}
+
+		if (wasModified)
+		{
+			markModified(hosts.at(i));
+		}
+	}
+}
+
+void JournalPasswordsStorageBackend::addPassword(const PasswordsManager::PasswordInformation &password)
+{
+	ensureInitialized();
+
+	const QString host(Utils::extractHost(password.url));
+	QVector<PasswordsManager::PasswordInformation> *passwords(getBucket(host));
+
+	if (!passwords)
+	{
+		m_passwords[host] = {password};
+
+		markModified(host);
+
+		return;
+	}
+
+	for (int i = 0; i < passwords->count(); ++i)
+	{
+		const PasswordsManager::PasswordMatch match(comparePasswords(password, passwords->at(i)));
+
+		if (match == PasswordsManager::FullMatch)
+		{
+			return;
+		}
+
+		if (match == PasswordsManager::PartialMatch)
+		{
+			passwords->replace(i, password);
+
+			markModified(host);
+
+			return;
+		}
+	}
+
+	passwords->append(password);
+
+	markModified(host);
+}
+
+void JournalPasswordsStorageBackend::removePassword(const PasswordsManager::PasswordInformation &password)
+{
+	ensureInitialized();
+
+	const QString host(Utils::extractHost(password.url));
+	QVector<PasswordsManager::PasswordInformation> *passwords(getBucket(host));
+
+	if (!passwords)
+	{
+		return;
+	}
+
+	for (int i = 0; i < passwords->count(); ++i)
+	{
+		if (comparePasswords(password, passwords->at(i)) != PasswordsManager::NoMatch)
+		{
+			passwords->removeAt(i);
+
+			if (passwords->isEmpty())
+			{
+				m_passwords.remove(host);
+			}
+
+			markModified(host);
+
+			return;
+		}
+	}
+}
+
+QString JournalPasswordsStorageBackend::getName() const
+{
+	return QLatin1String("journal");
+}
+
+QString JournalPasswordsStorageBackend::getTitle() const
+{
+	return tr("Journaled File");
+}
+
+QString JournalPasswordsStorageBackend::getDescription() const
+{
+	return tr("Stores passwords in file updated incrementally.");
+}
+
+QString JournalPasswordsStorageBackend::getVersion() const
+{
+	return QLatin1String("1.0");
+}
+
+QUrl JournalPasswordsStorageBackend::getHomePage() const
+{
+	return QUrl(QLatin1String("https://otter-browser.org/"));
+}
+
+QStringList JournalPasswordsStorageBackend::getHosts()
+{
+	ensureInitialized();
+
+	return (m_passwords.keys() + m_rawPasswords.keys());
+}
+
+QVector<PasswordsManager::PasswordInformation> JournalPasswordsStorageBackend::getPasswords(const QUrl &url, PasswordsManager::PasswordTypes types)
+{
+	ensureInitialized();
+
+	const QVector<PasswordsManager::PasswordInformation> *passwords(getBucket(Utils::extractHost(url)));
+
+	if (!passwords)
+	{
+		return {};
+	}
+
+	if (types == PasswordsManager::AnyPassword)
+	{
+		return *passwords;
+	}
+
+	QVector<PasswordsManager::PasswordInformation> matchingPasswords;
+
+	for (int i = 0; i < passwords->count(); ++i)
+	{
+		if (types.testFlag(passwords->at(i).type))
+		{
+			matchingPasswords.append(passwords->at(i));
+		}
+	}
+
+	return matchingPasswords;
+}
+
+QVector<PasswordsManager::PasswordInformation>* JournalPasswordsStorageBackend::getBucket(const QString &host)
+{
+	if (m_rawPasswords.contains(host))
+	{
+		m_passwords[host] = deserializePasswords(m_rawPasswords.take(host));
+	}
+
+	if (!m_passwords.contains(host))
+	{
+		return nullptr;
+	}
+
+	return &m_passwords[host];
+}
+
+QByteArray JournalPasswordsStorageBackend::serializePasswords(const QVector<PasswordsManager::PasswordInformation> &passwords)
+{
+	QByteArray data;
+	QDataStream stream(&data, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_5_15);
+	stream << static_cast<quint32>(passwords.count());
+
+	for (int i = 0; i < passwords.count(); ++i)
+	{
+		const PasswordsManager::PasswordInformation &password(passwords.at(i));
+
+		stream << password.url.toString() << (password.timeAdded.isValid() ? password.timeAdded.toMSecsSinceEpoch() : static_cast<qint64>(-1)) << (password.timeUsed.isValid() ? password.timeUsed.toMSecsSinceEpoch() : static_cast<qint64>(-1)) << static_cast<qint32>(password.type) << static_cast<quint32>(password.fields.count());
+
+		for (int j = 0; j < password.fields.count(); ++j)
+		{
+			const PasswordsManager::PasswordInformation::Field &field(password.fields.at(j));
+
+			stream << field.name << field.value << static_cast<qint32>(field.type);
+		}
+	}
+
+	return data;
+}
+
+QVector<PasswordsManager::PasswordInformation> JournalPasswordsStorageBackend::deserializePasswords(const QByteArray &data)
+{
+	QDataStream stream(data);
+	stream.setVersion(QDataStream::Qt_5_15);
+
+	quint32 amount(0);
+
+	stream >> amount;
+
+	QVector<PasswordsManager::PasswordInformation> passwords;
+	passwords.reserve(static_cast<int>(qMin(amount, static_cast<quint32>(1000))));
+
+	for (quint32 i = 0; i < amount; ++i)
+	{
+		QString url;
+		qint64 timeAdded(-1);
+		qint64 timeUsed(-1);
+		qint32 type(0);
+		quint32 fieldsAmount(0);
+
+		stream >> url >> timeAdded >> timeUsed >> type >> fieldsAmount;
+
+		if (stream.status() != QDataStream::Ok)
+		{
+			break;
+		}
+
+		PasswordsManager::PasswordInformation password;
+		password.url = QUrl(url);
+		password.type = static_cast<PasswordsManager::PasswordType>(type);
+
+		if (timeAdded >= 0)
+		{
+			password.timeAdded = QDateTime::fromMSecsSinceEpoch(timeAdded, Qt::UTC);
+		}
+
+		if (timeUsed >= 0)
+		{
+			password.timeUsed = QDateTime::fromMSecsSinceEpoch(timeUsed, Qt::UTC);
+		}
+
+		for (quint32 j = 0; j < fieldsAmount; ++j)
+		{
+			qint32 fieldType(0);
+			PasswordsManager::PasswordInformation::Field field;
+
+			stream >> field.name >> field.value >> fieldType;
+
+			field.type = static_cast<PasswordsManager::FieldType>(fieldType);
+
+			password.fields.append(field);
+		}
+
+		if (stream.status() != QDataStream::Ok)
+		{
+			break;
+		}
+
+		passwords.append(password);
+	}
+
+	return passwords;
+}
+
+PasswordsManager::PasswordMatch JournalPasswordsStorageBackend::hasPassword(const PasswordsManager::PasswordInformation &password)
+{
+	ensureInitialized();
+
+	const QVector<PasswordsManager::PasswordInformation> *passwords(getBucket(Utils::extractHost(password.url)));
+
+	if (!passwords)
+	{
+		return PasswordsManager::NoMatch;
+	}
+
+	for (int i = 0; i < passwords->count(); ++i)
+	{
+		const PasswordsManager::PasswordMatch match(comparePasswords(password, passwords->at(i)));
+
+		if (match != PasswordsManager::NoMatch)
+		{
+			return match;
+		}
+	}
+
+	return PasswordsManager::NoMatch;
+}
+
+bool JournalPasswordsStorageBackend::hasPasswords(const QUrl &url, PasswordsManager::PasswordTypes types)
+{
+	ensureInitialized();
+
+	const QString host(Utils::extractHost(url));
+
+	if (types == PasswordsManager::AnyPassword)
+	{
+		return (m_passwords.contains(host) || m_rawPasswords.contains(host));
+	}
+
+	const QVector<PasswordsManager::PasswordInformation> *passwords(getBucket(host));
+
+	if (passwords)
+	{
+		for (int i = 0; i < passwords->count(); ++i)
+		{
+			if (types.testFlag(passwords->at(i).type))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+}
@@ -0,0 +1,81 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_JOURNALPASSWORDSSTORAGEBACKEND_H
+#define OTTER_JOURNALPASSWORDSSTORAGEBACKEND_H
+
+#include "../../../../core/JournalFile.h"
+#include "../../../../core/PasswordsStorageBackend.h"
+
+#include <QtCore/QSet>
+
+namespace Otter
+{
+
+class JournalPasswordsStorageBackend final : public PasswordsStorageBackend
+{
+	Q_OBJECT
+
+public:
+	explicit JournalPasswordsStorageBackend(QObject *parent = nullptr);
+	~JournalPasswordsStorageBackend();
+
+	void clearPasswords(const QString &host) override;
+	void clearPasswords(int period = 0) override;
+	void addPassword(const PasswordsManager::PasswordInformation &password) override;
+	void removePassword(const PasswordsManager::PasswordInformation &password) override;
+	QString getName() const override;
+	QString getTitle() const override;
+	QString getDescription() const override;
+	QString getVersion() const override;
+	QUrl getHomePage() const override;
+	QStringList getHosts() override;
+	QVector<PasswordsManager::PasswordInformation> getPasswords(const QUrl &url, PasswordsManager::PasswordTypes types = PasswordsManager::AnyPassword) override;
+	PasswordsManager::PasswordMatch hasPassword(const PasswordsManager::PasswordInformation &password) override;
+	bool hasPasswords(const QUrl &url, PasswordsManager::PasswordTypes types = PasswordsManager::AnyPassword) override;
+
+protected:
+	enum RecordType : quint8
+	{
+		HostRecord = 1,
+		RemoveHostRecord
+	};
+
+	void timerEvent(QTimerEvent *event) override;
+	void ensureInitialized();
+	void importLegacyPasswords();
+	void compactJournal();
+	void markModified(const QString &host);
+	void save();
+	QVector<PasswordsManager::PasswordInformation>* getBucket(const QString &host);
+	static QByteArray serializePasswords(const QVector<PasswordsManager::PasswordInformation> &passwords);
+	static QVector<PasswordsManager::PasswordInformation> deserializePasswords(const QByteArray &data);
+
+private:
+	JournalFile *m_journal;
+	QHash<QString, QVector<PasswordsManager::PasswordInformation> > m_passwords;
+	QHash<QString, QByteArray> m_rawPasswords;
+	QSet<QString> m_modifiedHosts;
+	int m_saveTimer;
+	bool m_isInitialized;
+};
+
+}
+
+#endif
@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2016 - 2022 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2016 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 * Copyright (C) 2016 Jan Bajer aka bajasoft <jbajer@gmail.com>
 *
 * This program is free software: you can redistribute it and/or modify
@@ -26,6 +26,7 @@
 #include "../../../../core/WebBackend.h"
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QMutexLocker>
 
 namespace Otter
 {
@@ -34,23 +35,25 @@ WebBackend* QtWebEngineUrlRequestInterceptor::m_backend(nullptr);
 
 QtWebEngineUrlRequestInterceptor::QtWebEngineUrlRequestInterceptor(QtWebEngineWebWidget *parent) : QWebEngineUrlRequestInterceptor(parent),
 	m_widget(parent),
-	m_doNotTrackPolicy(NetworkManagerFactory::SkipTrackPolicy),
-	m_areImagesEnabled(true),
-	m_canSendReferrer(true),
-	m_isWorkingOffline(false)
+	m_requestOptions(new RequestOptions()),
+	m_startedRequestsAmount(0),
+	m_pendingStartedRequestsAmount(0),
+	m_isStatisticsUpdateScheduled(false)
 {
 }
 
 void QtWebEngineUrlRequestInterceptor::interceptRequest(QWebEngineUrlRequestInfo &request)
 {
-	if (m_isWorkingOffline || (!m_areImagesEnabled && request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeImage))
+	const QSharedPointer<RequestOptions> options(getRequestOptions());
+
+	if (options->isWorkingOffline || (!options->areImagesEnabled && request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeImage))
 	{
 		request.block(true);
 
 		return;
 	}
 
-	if (!m_contentBlockingProfiles.isEmpty() && (m_unblockedHosts.isEmpty() || !m_unblockedHosts.contains(Utils::extractHost(request.firstPartyUrl()))))
+	if (!options->contentBlockingProfiles.isEmpty() && (options->unblockedHosts.isEmpty() || !options->unblockedHosts.contains(Utils::extractHost(request.firstPartyUrl()))))
 	{
 		NetworkManager::ResourceType resourceType(NetworkManager::OtherType);
 		bool storeBlockedUrl(true);
@@ -97,29 +100,26 @@ void QtWebEngineUrlRequestInterceptor::interceptRequest(QWebEngineUrlRequestInfo
 				break;
 		}
 
-		const ContentFiltersManager::CheckResult result(ContentFiltersManager::checkUrl(m_contentBlockingProfiles, request.firstPartyUrl(), request.requestUrl(), resourceType));
+		const ContentFiltersManager::CheckResult result(ContentFiltersManager::getRulesSnapshot()->checkUrl(options->contentBlockingProfiles, request.firstPartyUrl(), request.requestUrl(), resourceType));
 
 		if (result.isBlocked)
 		{
-			const ContentFiltersProfile *profile(ContentFiltersManager::getProfile(result.profile));
-
-			Console::addMessage(QCoreApplication::translate("main", "Request blocked by rule from profile %1:\n%2").arg(profile ? profile->getTitle() : QCoreApplication::translate("main", "(Unknown)"), result.rule), Console::NetworkCategory, Console::LogLevel, request.requestUrl().toString(), -1);
-
-			if (storeBlockedUrl && !m_blockedElements.contains(request.requestUrl().url()))
-			{
-				m_blockedElements.append(request.requestUrl().url());
-			}
-
 			NetworkManager::ResourceInformation resource;
 			resource.url = request.requestUrl();
 			resource.resourceType = resourceType;
 			resource.metaData[NetworkManager::ContentBlockingProfileMetaData] = result.profile;
 			resource.metaData[NetworkManager::ContentBlockingRuleMetaData] = result.rule;
 
-			m_blockedRequests.append(resource);
+			QMutexLocker locker(&m_statisticsMutex);
+
+			if (storeBlockedUrl)
+			{
+				m_pendingBlockedElements.append(request.requestUrl().url());
+			}
 
-			emit pageInformationChanged(WebWidget::RequestsBlockedInformation, m_blockedRequests.count());
-			emit requestBlocked(resource);
+			m_pendingBlockedRequests.append(resource);
+
+			scheduleStatisticsUpdate();
 
 			request.block(true);
 
@@ -127,29 +127,93 @@ void QtWebEngineUrlRequestInterceptor::interceptRequest(QWebEngineUrlRequestInfo
 		}
 	}
 
-	++m_startedRequestsAmount;
-
-	request.setHttpHeader(QByteArrayLiteral("Accept-Language"), (m_acceptLanguage.isEmpty() ? NetworkManagerFactory::getAcceptLanguage().toLatin1() : m_acceptLanguage.toLatin1()));
-	request.setHttpHeader(QByteArrayLiteral("User-Agent"), m_userAgent.toUtf8());
+	request.setHttpHeader(QByteArrayLiteral("Accept-Language"), (options->acceptLanguage.isEmpty() ? NetworkManagerFactory::getAcceptLanguage().toLatin1() : options->acceptLanguage.toLatin1()));
+	request.setHttpHeader(QByteArrayLiteral("User-Agent"), options->userAgent.toUtf8());
 
-	if (m_doNotTrackPolicy != NetworkManagerFactory::SkipTrackPolicy)
+	if (options->doNotTrackPolicy != NetworkManagerFactory::SkipTrackPolicy)
 	{
-		request.setHttpHeader(QByteArrayLiteral("DNT"), ((m_doNotTrackPolicy == NetworkManagerFactory::DoNotAllowToTrackPolicy) ? QByteArrayLiteral("1") : QByteArrayLiteral("0")));
+		request.setHttpHeader(QByteArrayLiteral("DNT"), ((options->doNotTrackPolicy == NetworkManagerFactory::DoNotAllowToTrackPolicy) ? QByteArrayLiteral("1") : QByteArrayLiteral("0")));
 	}
 
-	if (!m_canSendReferrer)
+	if (!options->canSendReferrer)
 	{
 		request.setHttpHeader(QByteArrayLiteral("Referer"), {});
 	}
 
-	emit pageInformationChanged(WebWidget::RequestsStartedInformation, m_startedRequestsAmount);
+	QMutexLocker locker(&m_statisticsMutex);
+
+	++m_pendingStartedRequestsAmount;
+
+	scheduleStatisticsUpdate();
+}
+
+void QtWebEngineUrlRequestInterceptor::scheduleStatisticsUpdate()
+{
+	if (!m_isStatisticsUpdateScheduled)
+	{
+		m_isStatisticsUpdateScheduled = true;
+
+		QMetaObject::invokeMethod(this, &QtWebEngineUrlRequestInterceptor::updateStatistics, Qt::QueuedConnection);
+	}
 }
 
 void QtWebEngineUrlRequestInterceptor::resetStatistics()
 {
+	QMutexLocker locker(&m_statisticsMutex);
+
 	m_blockedRequests.clear();
 	m_blockedElements.clear();
+	m_pendingBlockedRequests.clear();
+	m_pendingBlockedElements.clear();
 	m_startedRequestsAmount = 0;
+	m_pendingStartedRequestsAmount = 0;
+}
+
+void QtWebEngineUrlRequestInterceptor::updateStatistics()
+{
+	QMutexLocker locker(&m_statisticsMutex);
+	const QStringList blockedElements(m_pendingBlockedElements);
+	const QVector<NetworkManager::ResourceInformation> blockedRequests(m_pendingBlockedRequests);
+	const quint64 startedRequestsAmount(m_pendingStartedRequestsAmount);
+
+	m_pendingBlockedElements.clear();
+	m_pendingBlockedRequests.clear();
+	m_pendingStartedRequestsAmount = 0;
+	m_isStatisticsUpdateScheduled = false;
+
+	locker.unlock();
+
+	for (int i = 0; i < blockedElements.count(); ++i)
+	{
+		if (!m_blockedElements.contains(blockedElements.at(i)))
+		{
+			m_blockedElements.append(blockedElements.at(i));
+		}
+	}
+
+	for (int i = 0; i < blockedRequests.count(); ++i)
+	{
+		const NetworkManager::ResourceInformation &resource(blockedRequests.at(i));
+		const ContentFiltersProfile *profile(ContentFiltersManager::getProfile(resource.metaData.value(NetworkManager::ContentBlockingProfileMetaData).toInt()));
+
+		Console::addMessage(QT_TRANSLATE_NOOP("main", "Request blocked by rule from profile %1:\n%2"), {(profile ? profile->getTitle() : QCoreApplication::translate("main", "(Unknown)")), resource.metaData.value(NetworkManager::ContentBlockingRuleMetaData).toString()}, Console::NetworkCategory, Console::LogLevel, resource.url.toString(), -1);
+
+		m_blockedRequests.append(resource);
+
+		emit requestBlocked(resource);
+	}
+
+	if (!blockedRequests.isEmpty())
+	{
+		emit pageInformationChanged(WebWidget::RequestsBlockedInformation, m_blockedRequests.count());
+	}
+
+	if (startedRequestsAmount > 0)
+	{
+		m_startedRequestsAmount += startedRequestsAmount;
+
+		emit pageInformationChanged(WebWidget::RequestsStartedInformation, m_startedRequestsAmount);
+	}
 }
 
 void QtWebEngineUrlRequestInterceptor::updateOptions(const QUrl &url)
@@ -159,40 +223,47 @@ void QtWebEngineUrlRequestInterceptor::updateOptions(const QUrl &url)
 		m_backend = AddonsManager::getWebBackend(QLatin1String("qtwebengine"));
 	}
 
+	QSharedPointer<RequestOptions> options(new RequestOptions());
+
 	if (getOption(SettingsManager::ContentBlocking_EnableContentBlockingOption, url).toBool())
 	{
-		m_contentBlockingProfiles = ContentFiltersManager::getProfileIdentifiers(getOption(SettingsManager::ContentBlocking_ProfilesOption, url).toStringList());
-	}
-	else
-	{
-		m_contentBlockingProfiles.clear();
+		options->contentBlockingProfiles = ContentFiltersManager::getProfileIdentifiers(getOption(SettingsManager::ContentBlocking_ProfilesOption, url).toStringList());
 	}
 
+	ContentFiltersManager::preloadProfiles(options->contentBlockingProfiles, this);
+
 	QString acceptLanguage(getOption(SettingsManager::Network_AcceptLanguageOption, url).toString());
 	acceptLanguage = ((acceptLanguage.isEmpty()) ? QLatin1String(" ") : acceptLanguage.replace(QLatin1String("system"), QLocale::system().bcp47Name()));
 
-	m_acceptLanguage = ((acceptLanguage == NetworkManagerFactory::getAcceptLanguage()) ? QString() : acceptLanguage);
-	m_userAgent = m_backend->getUserAgent(NetworkManagerFactory::getUserAgent(getOption(SettingsManager::Network_UserAgentOption, url).toString()).value);
-	m_unblockedHosts = getOption(SettingsManager::ContentBlocking_IgnoreHostsOption, url).toStringList();
+	options->acceptLanguage = ((acceptLanguage == NetworkManagerFactory::getAcceptLanguage()) ? QString() : acceptLanguage);
+	options->userAgent = m_backend->getUserAgent(NetworkManagerFactory::getUserAgent(getOption(SettingsManager::Network_UserAgentOption, url).toString()).value);
+	options->unblockedHosts = getOption(SettingsManager::ContentBlocking_IgnoreHostsOption, url).toStringList();
 
 	const QString doNotTrackPolicyValue(getOption(SettingsManager::Network_DoNotTrackPolicyOption, url).toString());
 
 	if (doNotTrackPolicyValue == QLatin1String("allow"))
 	{
-		m_doNotTrackPolicy = NetworkManagerFactory::AllowToTrackPolicy;
+		options->doNotTrackPolicy = NetworkManagerFactory::AllowToTrackPolicy;
 	}
 	else if (doNotTrackPolicyValue == QLatin1String("doNotAllow"))
 	{
-		m_doNotTrackPolicy = NetworkManagerFactory::DoNotAllowToTrackPolicy;
-	}
-	else
-	{
-		m_doNotTrackPolicy = NetworkManagerFactory::SkipTrackPolicy;
+		options->doNotTrackPolicy = NetworkManagerFactory::DoNotAllowToTrackPolicy;
 	}
 
-	m_areImagesEnabled = (getOption(SettingsManager::Permissions_EnableImagesOption, url).toString() != QLatin1String("disabled"));
-	m_canSendReferrer = getOption(SettingsManager::Network_EnableReferrerOption, url).toBool();
-	m_isWorkingOffline = getOption(SettingsManager::Network_WorkOfflineOption, url).toBool();
+	options->areImagesEnabled = (getOption(SettingsManager::Permissions_EnableImagesOption, url).toString() != QLatin1String("disabled"));
+	options->canSendReferrer = getOption(SettingsManager::Network_EnableReferrerOption, url).toBool();
+	options->isWorkingOffline = getOption(SettingsManager::Network_WorkOfflineOption, url).toBool();
+
+	QMutexLocker locker(&m_requestOptionsMutex);
+
+	m_requestOptions.swap(options);
+}
+
+QSharedPointer<QtWebEngineUrlRequestInterceptor::RequestOptions> QtWebEngineUrlRequestInterceptor::getRequestOptions()
+{
+	QMutexLocker locker(&m_requestOptionsMutex);
+
+	return m_requestOptions;
 }
 
 QVariant QtWebEngineUrlRequestInterceptor::getOption(int identifier, const QUrl &url) const
@@ -25,6 +25,8 @@
 #include "../../../../core/NetworkManager.h"
 #include "../../../../core/NetworkManagerFactory.h"
 
+#include <QtCore/QMutex>
+#include <QtCore/QSharedPointer>
 #include <QtWebEngineCore/QWebEngineUrlRequestInterceptor>
 
 namespace Otter
@@ -35,6 +37,18 @@ class QtWebEngineUrlRequestInterceptor final : public QWebEngineUrlRequestInterc
 	Q_OBJECT
 
 public:
+	struct RequestOptions final
+	{
+		QString acceptLanguage;
+		QString userAgent;
+		QStringList unblockedHosts;
+		QVector<int> contentBlockingProfiles;
+		NetworkManagerFactory::DoNotTrackPolicy doNotTrackPolicy = NetworkManagerFactory::SkipTrackPolicy;
+		bool areImagesEnabled = true;
+		bool canSendReferrer = true;
+		bool isWorkingOffline = false;
+	};
+
 	explicit QtWebEngineUrlRequestInterceptor(QtWebEngineWebWidget *parent);
 
 	void interceptRequest(QWebEngineUrlRequestInfo &request) override;
@@ -43,25 +57,27 @@ public:
 
 protected:
 	void updateOptions(const QUrl &url);
+	void scheduleStatisticsUpdate();
+	QSharedPointer<RequestOptions> getRequestOptions();
 	QVariant getOption(int identifier, const QUrl &url) const;
 	QVariant getPageInformation(WebWidget::PageInformation key) const;
 
 protected slots:
 	void resetStatistics();
+	void updateStatistics();
 
 private:
 	QtWebEngineWebWidget *m_widget;
-	QString m_acceptLanguage;
-	QString m_userAgent;
+	QSharedPointer<RequestOptions> m_requestOptions;
 	QStringList m_blockedElements;
-	QStringList m_unblockedHosts;
+	QStringList m_pendingBlockedElements;
 	QVector<NetworkManager::ResourceInformation> m_blockedRequests;
-	QVector<int> m_contentBlockingProfiles;
-	NetworkManagerFactory::DoNotTrackPolicy m_doNotTrackPolicy;
+	QVector<NetworkManager::ResourceInformation> m_pendingBlockedRequests;
+	QMutex m_requestOptionsMutex;
+	QMutex m_statisticsMutex;
 	quint64 m_startedRequestsAmount;
-	bool m_areImagesEnabled;
-	bool m_canSendReferrer;
-	bool m_isWorkingOffline;
+	quint64 m_pendingStartedRequestsAmount;
+	bool m_isStatisticsUpdateScheduled;
 
 	static WebBackend *m_backend;
 
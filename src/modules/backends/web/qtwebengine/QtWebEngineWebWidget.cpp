@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2015 - 2022 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2015 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -24,6 +24,7 @@
 #include "../../../../core/BookmarksManager.h"
 #include "../../../../core/Console.h"
 #include "../../../../core/GesturesManager.h"
+#include "../../../../core/HistoryManager.h"
 #include "../../../../core/NetworkManager.h"
 #include "../../../../core/NetworkManagerFactory.h"
 #include "../../../../core/NotesManager.h"
@@ -46,7 +47,6 @@
 #include <QtCore/QFileInfo>
 #include <QtCore/QMimeData>
 #include <QtCore/QTimer>
-#include <QtCore/QtMath>
 #include <QtGui/QClipboard>
 #include <QtGui/QContextMenuEvent>
 #include <QtGui/QImageWriter>
@@ -1112,11 +1112,16 @@ void QtWebEngineWebWidget::notifyUrlChanged()
 	emit urlChanged((url.toString() == QLatin1String("about:blank")) ? m_page->requestedUrl() : url);
 	emit categorizedActionsStateChanged({ActionsManager::ActionDefinition::PageCategory});
 
-	SessionsManager::markSessionAsModified();
+	SessionsManager::markWindowAsModified(getWindowIdentifier());
 }
 
 void QtWebEngineWebWidget::notifyIconChanged()
 {
+	if (!isPrivate())
+	{
+		HistoryManager::setIcon(getUrl(), m_page->icon());
+	}
+
 	emit iconChanged(getIcon());
 }
 
@@ -1347,7 +1352,7 @@ void QtWebEngineWebWidget::setZoom(int zoom)
 	{
 		m_page->setZoomFactor(qBound(0.1, (static_cast<qreal>(zoom) / 100), static_cast<qreal>(100)));
 
-		SessionsManager::markSessionAsModified();
+		SessionsManager::markWindowAsModified(getWindowIdentifier());
 
 		emit zoomChanged(zoom);
 		emit geometryChanged();
@@ -1589,47 +1594,16 @@ QIcon QtWebEngineWebWidget::getIcon() const
 	return (icon.isNull() ? ThemesManager::createIcon(QLatin1String("tab")) : icon);
 }
 
-QPixmap QtWebEngineWebWidget::createThumbnail(const QSize &size)
+QImage QtWebEngineWebWidget::createSnapshot(const QSize &size)
 {
+	Q_UNUSED(size)
+
 	if (!m_webView)
 	{
 		return {};
 	}
 
-	if ((size.isNull() || size == m_thumbnail.size()) && ((!m_thumbnail.isNull() && qFuzzyCompare(m_thumbnail.devicePixelRatio(), devicePixelRatio())) || m_loadingState == OngoingLoadingState))
-	{
-		return m_thumbnail;
-	}
-
-	const QSize thumbnailSize(size.isValid() ? size : QSize(260, 170));
-	const qreal thumbnailAspectRatio(static_cast<qreal>(thumbnailSize.width()) / thumbnailSize.height());
-	const QSize contentsSize(m_webView->size());
-	const qreal contentsAspectRatio(static_cast<qreal>(contentsSize.width()) / contentsSize.height());
-	QPixmap pixmap(m_webView->grab(QRect({0, 0}, contentsSize)));
-
-	if (!qFuzzyCompare(thumbnailAspectRatio, contentsAspectRatio))
-	{
-		if (thumbnailAspectRatio > contentsAspectRatio)
-		{
-			pixmap = pixmap.copy({{0, 0}, QSize(pixmap.width(), qFloor(pixmap.width() / thumbnailAspectRatio))});
-		}
-		else
-		{
-			const int offset((pixmap.width() - qFloor(pixmap.height() * thumbnailAspectRatio)) / 2);
-
-			pixmap = pixmap.copy({{offset, 0}, QSize((pixmap.width() - (offset * 2)), pixmap.height())});
-		}
-	}
-
-	pixmap = pixmap.scaled((thumbnailSize * devicePixelRatio()), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-	pixmap.setDevicePixelRatio(devicePixelRatio());
-
-	if (size.isNull())
-	{
-		m_thumbnail = pixmap;
-	}
-
-	return pixmap;
+	return m_webView->grab().toImage();
 }
 
 QDateTime QtWebEngineWebWidget::getLastUrlClickTime() const
@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2015 - 2022 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2015 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -64,7 +64,7 @@ public:
 	QVariant getPageInformation(PageInformation key) const override;
 	QUrl getUrl() const override;
 	QIcon getIcon() const override;
-	QPixmap createThumbnail(const QSize &size = {}) override;
+	QImage createSnapshot(const QSize &size) override;
 	QPoint getScrollPosition() const override;
 	LinkUrl getActiveFrame() const override;
 	LinkUrl getActiveImage() const override;
@@ -154,7 +154,6 @@ private:
 	QtWebEngineUrlRequestInterceptor *m_requestInterceptor;
 	QString m_findInPageText;
 	QDateTime m_lastUrlClickTime;
-	QPixmap m_thumbnail;
 	HitTestResult m_hitResult;
 	QHash<QNetworkReply*, QPointer<SourceViewerWebWidget> > m_viewSourceReplies;
 	QMultiMap<QString, QString> m_metaData;
@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2013 - 2017 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2013 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -23,34 +23,179 @@
 namespace Otter
 {
 
+const int QtWebKitHistoryInterface::m_recentHashesLimit(100);
+
 QtWebKitHistoryInterface::QtWebKitHistoryInterface(QObject *parent) : QWebHistoryInterface(parent)
 {
-	connect(HistoryManager::getBrowsingHistoryModel(), &HistoryModel::cleared, this, &QtWebKitHistoryInterface::clear);
+	const HistoryModel *model(HistoryManager::getBrowsingHistoryModel());
+
+	m_entryHashes.reserve(model->rowCount());
+	m_hashes.reserve(model->rowCount());
+
+	for (int i = 0; i < model->rowCount(); ++i)
+	{
+		handleEntryAdded(static_cast<HistoryModel::Entry*>(model->item(i, 0)));
+	}
+
+	connect(model, &HistoryModel::cleared, this, &QtWebKitHistoryInterface::clear);
+	connect(model, &HistoryModel::entryAdded, this, &QtWebKitHistoryInterface::handleEntryAdded);
+	connect(model, &HistoryModel::entryModified, this, &QtWebKitHistoryInterface::handleEntryModified);
+	connect(model, &HistoryModel::entryRemoved, this, &QtWebKitHistoryInterface::handleEntryRemoved);
 }
 
 void QtWebKitHistoryInterface::clear()
 {
-	m_urls.clear();
+	m_recentHashes.clear();
+	m_entryHashes.clear();
+	m_hashes.clear();
 }
 
 void QtWebKitHistoryInterface::addHistoryEntry(const QString &url)
 {
-	if (m_urls.contains(url))
+	const quint64 hash(createHash(url));
+
+	if (m_recentHashes.contains(hash))
+	{
+		return;
+	}
+
+	m_recentHashes.append(hash);
+
+	if (m_recentHashes.count() > m_recentHashesLimit)
+	{
+		m_recentHashes.removeFirst();
+	}
+}
+
+void QtWebKitHistoryInterface::addHash(quint64 hash)
+{
+	++m_hashes[hash];
+}
+
+void QtWebKitHistoryInterface::removeHash(quint64 hash)
+{
+	QHash<quint64, int>::iterator iterator(m_hashes.find(hash));
+
+	if (iterator == m_hashes.end())
 	{
 		return;
 	}
 
-	m_urls.append(url);
+	--iterator.value();
+
+	if (iterator.value() <= 0)
+	{
+		m_hashes.erase(iterator);
+	}
+}
 
-	if (m_urls.length() > 100)
+void QtWebKitHistoryInterface::handleEntryAdded(HistoryModel::Entry *entry)
+{
+	if (!entry || !entry->isValid())
 	{
-		m_urls.removeAt(0);
+		return;
 	}
+
+	const quint64 hash(createHash(entry->getUrl().toString(QUrl::FullyEncoded)));
+
+	m_entryHashes[entry->getIdentifier()] = hash;
+
+	addHash(hash);
+}
+
+void QtWebKitHistoryInterface::handleEntryModified(HistoryModel::Entry *entry)
+{
+	if (!entry || !entry->isValid())
+	{
+		return;
+	}
+
+	const quint64 identifier(entry->getIdentifier());
+
+	if (!m_entryHashes.contains(identifier))
+	{
+		handleEntryAdded(entry);
+
+		return;
+	}
+
+	const quint64 hash(createHash(entry->getUrl().toString(QUrl::FullyEncoded)));
+	const quint64 oldHash(m_entryHashes.value(identifier));
+
+	if (hash != oldHash)
+	{
+		m_entryHashes[identifier] = hash;
+
+		addHash(hash);
+		removeHash(oldHash);
+	}
+}
+
+void QtWebKitHistoryInterface::handleEntryRemoved(HistoryModel::Entry *entry)
+{
+	if (!entry)
+	{
+		return;
+	}
+
+	const quint64 identifier(entry->getIdentifier());
+
+	if (m_entryHashes.contains(identifier))
+	{
+		removeHash(m_entryHashes.take(identifier));
+	}
+}
+
+quint64 QtWebKitHistoryInterface::createHash(QStringView url)
+{
+	int end(url.indexOf(QLatin1Char('#')));
+
+	if (end < 0)
+	{
+		end = url.length();
+	}
+
+	int pathEnd(url.left(end).indexOf(QLatin1Char('?')));
+
+	if (pathEnd < 0)
+	{
+		pathEnd = end;
+	}
+
+	int trimmedPathEnd(pathEnd);
+
+	while (trimmedPathEnd > 0 && url.at(trimmedPathEnd - 1) == QLatin1Char('/'))
+	{
+		--trimmedPathEnd;
+	}
+
+	const QChar *data(url.data());
+	quint64 hash(Q_UINT64_C(14695981039346656037));
+
+	for (int i = 0; i < end; ++i)
+	{
+		if (i == trimmedPathEnd)
+		{
+			i = pathEnd;
+
+			if (i == end)
+			{
+				break;
+			}
+		}
+
+		hash ^= data[i].unicode();
+		hash *= Q_UINT64_C(1099511628211);
+	}
+
+	return hash;
 }
 
 bool QtWebKitHistoryInterface::historyContains(const QString &url) const
 {
-	return (m_urls.contains(url) || HistoryManager::hasEntry(url));
+	const quint64 hash(createHash(url));
+
+	return (m_recentHashes.contains(hash) || (HistoryManager::isEnabled() && m_hashes.contains(hash)));
 }
 
 }
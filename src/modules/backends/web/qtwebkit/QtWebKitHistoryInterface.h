@@ -20,7 +20,8 @@
 #ifndef OTTER_QTWEBKITHISTORYINTERFACE_H
 #define OTTER_QTWEBKITHISTORYINTERFACE_H
 
-#include <QtCore/QStringList>
+#include "../../../../core/HistoryModel.h"
+
 #include <QtWebKit/QWebHistoryInterface>
 
 namespace Otter
@@ -36,11 +37,23 @@ public:
 	void addHistoryEntry(const QString &url) override;
 	bool historyContains(const QString &url) const override;
 
+protected:
+	void addHash(quint64 hash);
+	void removeHash(quint64 hash);
+	static quint64 createHash(QStringView url);
+
 protected slots:
 	void clear();
+	void handleEntryAdded(HistoryModel::Entry *entry);
+	void handleEntryModified(HistoryModel::Entry *entry);
+	void handleEntryRemoved(HistoryModel::Entry *entry);
 
 private:
-	QStringList m_urls;
+	QVector<quint64> m_recentHashes;
+	QHash<quint64, quint64> m_entryHashes;
+	QHash<quint64, int> m_hashes;
+
+	static const int m_recentHashesLimit;
 };
 
 }
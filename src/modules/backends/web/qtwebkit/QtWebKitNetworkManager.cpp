@@ -455,6 +455,8 @@ void QtWebKitNetworkManager::updateOptions(const QUrl &url)
 		m_contentBlockingProfiles.clear();
 	}
 
+	ContentFiltersManager::preloadProfiles(m_contentBlockingProfiles, this);
+
 	QString acceptLanguage(getOption(SettingsManager::Network_AcceptLanguageOption, url).toString());
 	acceptLanguage = ((acceptLanguage.isEmpty()) ? QLatin1String(" ") : acceptLanguage.replace(QLatin1String("system"), QLocale::system().bcp47Name()));
 
@@ -677,7 +679,7 @@ QNetworkReply* QtWebKitNetworkManager::createRequest(Operation operation, const
 			{
 				const ContentFiltersProfile *profile(ContentFiltersManager::getProfile(result.profile));
 
-				Console::addMessage(QCoreApplication::translate("main", "Request blocked by rule from profile %1:\n%2").arg((profile ? profile->getTitle() : QCoreApplication::translate("main", "(Unknown)")), result.rule), Console::NetworkCategory, Console::LogLevel, request.url().toString(), -1, (m_widget ? m_widget->getWindowIdentifier() : 0));
+				Console::addMessage(QT_TRANSLATE_NOOP("main", "Request blocked by rule from profile %1:\n%2"), {(profile ? profile->getTitle() : QCoreApplication::translate("main", "(Unknown)")), result.rule}, Console::NetworkCategory, Console::LogLevel, request.url().toString(), -1, (m_widget ? m_widget->getWindowIdentifier() : 0));
 
 				if (resourceType != NetworkManager::ScriptType && resourceType != NetworkManager::StyleSheetType)
 				{
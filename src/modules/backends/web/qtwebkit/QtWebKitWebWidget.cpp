@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2013 - 2022 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2013 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 * Copyright (C) 2015 - 2016 Jan Bajer aka bajasoft <jbajer@gmail.com>
 *
 * This program is free software: you can redistribute it and/or modify
@@ -1399,7 +1399,6 @@ void QtWebKitWebWidget::handleLoadStarted()
 		return;
 	}
 
-	m_thumbnail = {};
 	m_messageToken = QUuid::createUuid().toString();
 #ifdef OTTER_QTWEBKIT_PLUGINS_AVAILABLE
 	m_canLoadPlugins = (getOption(SettingsManager::Permissions_EnablePluginsOption, getUrl()).toString() == QLatin1String("enabled"));
@@ -1433,7 +1432,6 @@ void QtWebKitWebWidget::handleLoadFinished(bool result)
 
 	m_networkManager->handleLoadFinished(result);
 
-	m_thumbnail = {};
 	m_loadingState = FinishedLoadingState;
 
 #ifdef OTTER_QTWEBKIT_PLUGINS_AVAILABLE
@@ -1513,7 +1511,7 @@ void QtWebKitWebWidget::handleHistory()
 			m_isTypedIn = false;
 		}
 
-		SessionsManager::markSessionAsModified();
+		SessionsManager::markWindowAsModified(getWindowIdentifier());
 		BookmarksManager::updateVisits(url.toString());
 	}
 }
@@ -1601,11 +1599,16 @@ void QtWebKitWebWidget::notifyUrlChanged(const QUrl &url)
 	emit arbitraryActionsStateChanged({ActionsManager::InspectPageAction, ActionsManager::InspectElementAction});
 	emit categorizedActionsStateChanged({ActionsManager::ActionDefinition::NavigationCategory, ActionsManager::ActionDefinition::PageCategory});
 
-	SessionsManager::markSessionAsModified();
+	SessionsManager::markWindowAsModified(getWindowIdentifier());
 }
 
 void QtWebKitWebWidget::notifyIconChanged()
 {
+	if (!isPrivate())
+	{
+		HistoryManager::setIcon(getUrl(), m_page->mainFrame()->icon());
+	}
+
 	emit iconChanged(getIcon());
 }
 
@@ -1853,7 +1856,7 @@ void QtWebKitWebWidget::setZoom(int zoom)
 	{
 		m_page->mainFrame()->setZoomFactor(qBound(0.1, (static_cast<qreal>(zoom) / 100), static_cast<qreal>(100)));
 
-		SessionsManager::markSessionAsModified();
+		SessionsManager::markWindowAsModified(getWindowIdentifier());
 
 		emit zoomChanged(zoom);
 		emit geometryChanged();
@@ -2109,58 +2112,58 @@ QIcon QtWebKitWebWidget::getIcon() const
 	return (icon.isNull() ? ThemesManager::createIcon(QLatin1String("tab")) : icon);
 }
 
-QPixmap QtWebKitWebWidget::createThumbnail(const QSize &size)
+QImage QtWebKitWebWidget::createSnapshot(const QSize &size)
 {
-	if ((size.isNull() || size == m_thumbnail.size()) && ((!m_thumbnail.isNull() && qFuzzyCompare(m_thumbnail.devicePixelRatio(), devicePixelRatio())) || m_loadingState == OngoingLoadingState))
+	if (size.isEmpty())
 	{
-		return m_thumbnail;
+		return {};
 	}
 
-	const QSize thumbnailSize(size.isValid() ? size : QSize(260, 170));
 	const QSize oldViewportSize(m_page->viewportSize());
 	const QPoint position(m_page->mainFrame()->scrollPosition());
 	const qreal zoom(m_page->mainFrame()->zoomFactor());
-	QSize contentsSize(m_page->mainFrame()->contentsSize());
+	QSize contentsSize(qMin(((oldViewportSize.width() > 0) ? oldViewportSize.width() : m_page->mainFrame()->contentsSize().width()), 1024), 0);
+
+	if (contentsSize.width() <= 0)
+	{
+		return {};
+	}
+
+	contentsSize.setHeight(qRound(size.height() * (static_cast<qreal>(contentsSize.width()) / size.width())));
+
 	QWidget *newView(new QWidget());
 	QWidget *oldView(m_page->view());
 
 	m_page->setView(newView);
-	m_page->setViewportSize(contentsSize);
-	m_page->mainFrame()->setZoomFactor(1);
 
-	if (contentsSize.width() > 2000)
+	if (!qFuzzyCompare(zoom, 1))
 	{
-		contentsSize.setWidth(2000);
+		m_page->mainFrame()->setZoomFactor(1);
 	}
 
-	contentsSize.setHeight(qRound(thumbnailSize.height() * (static_cast<qreal>(contentsSize.width()) / thumbnailSize.width())));
-
 	m_page->setViewportSize(contentsSize);
 
-	QPixmap pixmap(contentsSize);
-	pixmap.fill(Qt::white);
+	QImage image(contentsSize, QImage::Format_RGB32);
+	image.fill(Qt::white);
 
-	QPainter painter(&pixmap);
+	QPainter painter(&image);
 
 	m_page->mainFrame()->render(&painter, QWebFrame::ContentsLayer, QRegion({{0, 0}, contentsSize}));
-	m_page->mainFrame()->setZoomFactor(zoom);
+
+	if (!qFuzzyCompare(zoom, 1))
+	{
+		m_page->mainFrame()->setZoomFactor(zoom);
+	}
+
 	m_page->setView(oldView);
 	m_page->setViewportSize(oldViewportSize);
 	m_page->mainFrame()->setScrollPosition(position);
 
 	painter.end();
 
-	pixmap = pixmap.scaled((thumbnailSize * devicePixelRatio()), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-	pixmap.setDevicePixelRatio(devicePixelRatio());
-
 	newView->deleteLater();
 
-	if (size.isNull())
-	{
-		m_thumbnail = pixmap;
-	}
-
-	return pixmap;
+	return image;
 }
 
 QPoint QtWebKitWebWidget::getScrollPosition() const
@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2013 - 2022 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2013 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 * Copyright (C) 2015 - 2016 Jan Bajer aka bajasoft <jbajer@gmail.com>
 *
 * This program is free software: you can redistribute it and/or modify
@@ -68,7 +68,7 @@ public:
 	QStringList getBlockedElements() const;
 	QUrl getUrl() const override;
 	QIcon getIcon() const override;
-	QPixmap createThumbnail(const QSize &size = {}) override;
+	QImage createSnapshot(const QSize &size) override;
 	QPoint getScrollPosition() const override;
 	QRect getGeometry(bool excludeScrollBars = false) const override;
 	LinkUrl getActiveFrame() const override;
@@ -185,7 +185,6 @@ private:
 #ifdef OTTER_QTWEBKIT_PLUGINS_AVAILABLE
 	QString m_pluginToken;
 #endif
-	QPixmap m_thumbnail;
 	QNetworkRequest m_formRequest;
 	QByteArray m_formRequestBody;
 	QQueue<Transfer*> m_transfers;
@@ -116,28 +116,49 @@ void ErrorConsoleWidget::showEvent(QShowEvent *event)
 		m_model = new QStandardItemModel(this);
 		m_model->setSortRole(TimeRole);
 
-		const QVector<Console::Message> messages(Console::getMessages());
-
-		for (int i = 0; i < messages.count(); ++i)
-		{
-			addMessage(messages.at(i));
-		}
+		addMessages(Console::getMessages());
 
 		m_ui->consoleView->setModel(m_model);
 
-		connect(Console::getInstance(), &Console::messageAdded, this, &ErrorConsoleWidget::addMessage);
+		connect(Console::getInstance(), &Console::messagesAdded, this, &ErrorConsoleWidget::addMessages);
 	}
 
 	QWidget::showEvent(event);
 }
 
-void ErrorConsoleWidget::addMessage(const Console::Message &message)
+void ErrorConsoleWidget::addMessages(const QVector<Console::Message> &messages)
 {
-	if (!m_model)
+	if (!m_model || messages.isEmpty())
 	{
 		return;
 	}
 
+	QVector<QStandardItem*> items;
+	items.reserve(messages.count());
+
+	for (int i = 0; i < messages.count(); ++i)
+	{
+		QStandardItem *item(createItem(messages.at(i)));
+
+		m_model->appendRow(item);
+
+		items.append(item);
+	}
+
+	m_model->sort(0, Qt::DescendingOrder);
+
+	const QString filter(m_ui->filterLineEditWidget->text());
+	const QVector<Console::MessageCategory> categories(getCategories());
+	const quint64 activeWindow(getActiveWindow());
+
+	for (int i = 0; i < items.count(); ++i)
+	{
+		applyFilters(items.at(i)->index(), filter, categories, activeWindow);
+	}
+}
+
+QStandardItem* ErrorConsoleWidget::createItem(const Console::Message &message) const
+{
 	QIcon icon;
 	QString category;
 
@@ -178,7 +199,8 @@ void ErrorConsoleWidget::addMessage(const Console::Message &message)
 	}
 
 	const QString source(message.source + ((message.line > 0) ? QStringLiteral(":%1").arg(message.line) : QString()));
-	const QString description(message.note.isEmpty() ? tr("<empty>") : message.note);
+	const QString note(message.getNote());
+	const QString description(note.isEmpty() ? tr("<empty>") : note);
 	QString entry(QStringLiteral("[%1] %2").arg(message.time.toLocalTime().toString(QLatin1String("yyyy-dd-MM hh:mm:ss")), category));
 
 	if (!message.source.isEmpty())
@@ -199,10 +221,7 @@ void ErrorConsoleWidget::addMessage(const Console::Message &message)
 
 	messageItem->appendRow(descriptionItem);
 
-	m_model->appendRow(messageItem);
-	m_model->sort(0, Qt::DescendingOrder);
-
-	applyFilters(messageItem->index(), m_ui->filterLineEditWidget->text(), getCategories(), getActiveWindow());
+	return messageItem;
 }
 
 void ErrorConsoleWidget::filterCategories()
@@ -62,11 +62,12 @@ protected:
 
 	void showEvent(QShowEvent *event) override;
 	void applyFilters(const QModelIndex &index, const QString &filter, const QVector<Console::MessageCategory> &categories, quint64 activeWindow);
+	QStandardItem* createItem(const Console::Message &message) const;
 	QVector<Console::MessageCategory> getCategories() const;
 	quint64 getActiveWindow();
 
 protected slots:
-	void addMessage(const Console::Message &message);
+	void addMessages(const QVector<Console::Message> &messages);
 	void filterCategories();
 	void filterMessages(const QString &filter);
 	void showContextMenu(const QPoint &position);
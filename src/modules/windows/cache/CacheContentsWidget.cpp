@@ -116,7 +116,7 @@ void CacheContentsWidget::populateCache()
 	m_model->setHeaderData(2, Qt::Horizontal, 150, HeaderViewWidget::WidthRole);
 	m_model->setSortRole(Qt::DisplayRole);
 
-	const NetworkCache *cache(NetworkManagerFactory::getCache());
+	NetworkCache *cache(NetworkManagerFactory::getCache());
 	const QVector<QUrl> entries(cache->getEntries());
 
 	for (int i = 0; i < entries.count(); ++i)
@@ -240,42 +240,43 @@ void CacheContentsWidget::handleEntryAdded(const QUrl &url)
 	}
 
 	NetworkCache *cache(NetworkManagerFactory::getCache());
-	QIODevice *device(cache->data(url));
-	const QNetworkCacheMetaData metaData(cache->metaData(url));
-	const QList<QPair<QByteArray, QByteArray> > headers(metaData.rawHeaders());
-	QString type;
+	const NetworkCache::EntryInformation information(cache->getEntryInformation(url));
+	QMimeType mimeType;
 
-	for (int i = 0; i < headers.count(); ++i)
+	if (information.type.isEmpty())
 	{
-		if (headers.at(i).first == QByteArrayLiteral("Content-Type"))
+		QIODevice *device(cache->getEntryData(url));
+
+		if (device)
 		{
-			type = QString::fromLatin1(headers.at(i).second);
+			mimeType = QMimeDatabase().mimeTypeForData(device);
 
-			break;
+			device->deleteLater();
 		}
 	}
+	else
+	{
+		mimeType = QMimeDatabase().mimeTypeForName(information.type);
+	}
 
-	const QMimeType mimeType((device && type.isEmpty()) ? QMimeDatabase().mimeTypeForData(device) : QMimeDatabase().mimeTypeForName(type));
-	QList<QStandardItem*> entryItems({new QStandardItem(url.path()), new QStandardItem(mimeType.name()), new QStandardItem(device ? Utils::formatUnit(device->size()) : QString()), new QStandardItem(Utils::formatDateTime(metaData.lastModified())), new QStandardItem(Utils::formatDateTime(metaData.expirationDate()))});
+	QList<QStandardItem*> entryItems({new QStandardItem(url.path()), new QStandardItem(mimeType.name()), new QStandardItem((information.size >= 0) ? Utils::formatUnit(information.size) : QString()), new QStandardItem(Utils::formatDateTime(information.lastModified)), new QStandardItem(Utils::formatDateTime(information.expirationDate))});
 	entryItems[0]->setData(url, UrlRole);
 	entryItems[0]->setFlags(entryItems[0]->flags() | Qt::ItemNeverHasChildren);
 	entryItems[1]->setFlags(entryItems[1]->flags() | Qt::ItemNeverHasChildren);
-	entryItems[2]->setData((device ? device->size() : 0), SizeRole);
+	entryItems[2]->setData(((information.size > 0) ? information.size : 0), SizeRole);
 	entryItems[2]->setFlags(entryItems[2]->flags() | Qt::ItemNeverHasChildren);
 	entryItems[3]->setFlags(entryItems[3]->flags() | Qt::ItemNeverHasChildren);
 	entryItems[4]->setFlags(entryItems[4]->flags() | Qt::ItemNeverHasChildren);
 
-	if (device)
+	if (information.size > 0)
 	{
 		QStandardItem *sizeItem(m_model->item(domainItem->row(), 2));
 
 		if (sizeItem)
 		{
-			sizeItem->setData((sizeItem->data(SizeRole).toLongLong() + device->size()), SizeRole);
+			sizeItem->setData((sizeItem->data(SizeRole).toLongLong() + information.size), SizeRole);
 			sizeItem->setText(Utils::formatUnit(sizeItem->data(SizeRole).toLongLong()));
 		}
-
-		device->deleteLater();
 	}
 
 	domainItem->appendRow(entryItems);
@@ -389,6 +390,11 @@ void CacheContentsWidget::updateActions()
 	m_ui->previewLabel->setPixmap({});
 	m_ui->deleteButton->setEnabled(!domain.isEmpty());
 
+	NetworkCache *cache(NetworkManagerFactory::getCache());
+	const NetworkCache::CacheStatistics statistics(domain.isEmpty() ? cache->getStatistics() : cache->getStatistics(domain));
+
+	m_ui->statisticsLabelWidget->setText(tr("Hits: %1, misses: %2, saved: %3").arg(statistics.hits).arg(statistics.misses).arg(Utils::formatUnit(static_cast<qint64>(statistics.savedBytes))));
+
 	if (!url.isValid())
 	{
 		m_ui->addressLabelWidget->setText({});
@@ -407,8 +413,7 @@ void CacheContentsWidget::updateActions()
 		return;
 	}
 
-	NetworkCache *cache(NetworkManagerFactory::getCache());
-	QIODevice *device(cache->data(url));
+	QIODevice *device(cache->getEntryData(url));
 	const QNetworkCacheMetaData metaData(cache->metaData(url));
 	const QMimeDatabase mimeDatabase;
 	QMimeType mimeType;
@@ -31,7 +31,9 @@
 #include <QtCore/QtMath>
 #include <QtGui/QClipboard>
 #include <QtGui/QKeyEvent>
+#include <QtWidgets/QActionGroup>
 #include <QtWidgets/QApplication>
+#include <QtWidgets/QInputDialog>
 #include <QtWidgets/QMessageBox>
 
 namespace Otter
@@ -314,7 +316,22 @@ void TransfersContentsWidget::handleTransferChanged(Transfer *transfer)
 
 				break;
 			case SpeedColumn:
-				m_model->setData(index, ((transfer->getState() == Transfer::RunningState) ? Utils::formatUnit(transfer->getSpeed(), true, 1) : QString()), Qt::DisplayRole);
+				if (transfer->getState() != Transfer::RunningState)
+				{
+					m_model->setData(index, QString(), Qt::DisplayRole);
+				}
+				else if (transfer->isQueued())
+				{
+					m_model->setData(index, tr("Queued"), Qt::DisplayRole);
+				}
+				else if (transfer->getBandwidthLimit() > 0)
+				{
+					m_model->setData(index, tr("%1 (limited to %2)").arg(Utils::formatUnit(transfer->getSpeed(), true, 1), Utils::formatUnit(transfer->getBandwidthLimit(), true, 1)), Qt::DisplayRole);
+				}
+				else
+				{
+					m_model->setData(index, Utils::formatUnit(transfer->getSpeed(), true, 1), Qt::DisplayRole);
+				}
 
 				break;
 			case TimeStartedColumn:
@@ -389,6 +406,53 @@ void TransfersContentsWidget::showContextMenu(const QPoint &position)
 		menu.addAction(((transfer->getState() == Transfer::ErrorState) ? tr("Resume") : tr("Stop")), this, &TransfersContentsWidget::stopResumeTransfer)->setEnabled(transfer->getState() == Transfer::RunningState || transfer->getState() == Transfer::ErrorState);
 		menu.addAction(tr("Redownload"), this, &TransfersContentsWidget::redownloadTransfer);
 		menu.addSeparator();
+
+		const bool canSchedule(transfer->getState() == Transfer::RunningState || transfer->getState() == Transfer::ErrorState);
+		const QVector<QPair<Transfer::TransferPriority, QString> > priorities({{Transfer::HighPriority, tr("High")}, {Transfer::NormalPriority, tr("Normal")}, {Transfer::LowPriority, tr("Low")}});
+		QMenu *priorityMenu(menu.addMenu(tr("Priority")));
+		priorityMenu->setEnabled(canSchedule);
+
+		QActionGroup *priorityGroup(new QActionGroup(priorityMenu));
+		priorityGroup->setExclusive(true);
+
+		for (int i = 0; i < priorities.count(); ++i)
+		{
+			QAction *action(priorityMenu->addAction(priorities.at(i).second));
+			action->setCheckable(true);
+			action->setChecked(transfer->getPriority() == priorities.at(i).first);
+			action->setData(priorities.at(i).first);
+
+			priorityGroup->addAction(action);
+		}
+
+		connect(priorityGroup, &QActionGroup::triggered, this, [&](QAction *action)
+		{
+			Transfer *transfer(getTransfer(m_ui->transfersViewWidget->currentIndex()));
+
+			if (transfer)
+			{
+				transfer->setPriority(static_cast<Transfer::TransferPriority>(action->data().toInt()));
+			}
+		});
+
+		menu.addAction(tr("Limit Speed…"), this, [&]()
+		{
+			Transfer *transfer(getTransfer(m_ui->transfersViewWidget->currentIndex()));
+
+			if (!transfer)
+			{
+				return;
+			}
+
+			bool isConfirmed(false);
+			const int limit(QInputDialog::getInt(this, tr("Limit Speed"), tr("Maximum speed in KiB/s (0 for unlimited):"), static_cast<int>(transfer->getBandwidthLimit() / 1024), 0, 1048576, 1, &isConfirmed));
+
+			if (isConfirmed)
+			{
+				transfer->setBandwidthLimit(static_cast<qint64>(limit) * 1024);
+			}
+		})->setEnabled(canSchedule);
+		menu.addSeparator();
 		menu.addAction(tr("Copy Transfer Information"), this, &TransfersContentsWidget::copyTransferInformation);
 		menu.addSeparator();
 		menu.addAction(ThemesManager::createIcon(QLatin1String("edit-delete")), tr("Remove"), this, &TransfersContentsWidget::removeTransfer);
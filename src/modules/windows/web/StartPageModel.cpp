@@ -25,6 +25,7 @@
 #include "../../../core/WebBackend.h"
 
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <QtCore/QMimeData>
 #include <QtCore/QTimer>
 #include <QtGui/QPainter>
@@ -32,6 +33,10 @@
 namespace Otter
 {
 
+QCache<quint64, StartPageModel::ThumbnailCacheEntry> StartPageModel::m_thumbnailsCache(20480);
+const int StartPageModel::m_maximumThumbnailJobs(3);
+const int StartPageModel::m_thumbnailJobTimeout(30000);
+
 StartPageModel::StartPageModel(QObject *parent) : QStandardItemModel(parent),
 	m_bookmark(nullptr)
 {
@@ -83,7 +88,7 @@ void StartPageModel::reloadModel()
 				item->setData(true, IsEmptyRole);
 			}
 
-			if (url.isValid() && !QFile::exists(getThumbnailPath(identifier)))
+			if (url.isValid() && !m_tileReloads.contains(identifier) && !QFile::exists(getThumbnailPath(identifier)))
 			{
 				requestThumbnail(url, identifier);
 			}
@@ -106,6 +111,83 @@ void StartPageModel::reloadModel()
 	emit modelModified();
 }
 
+void StartPageModel::startThumbnailJobs()
+{
+	while (m_thumbnailJobs.count() < m_maximumThumbnailJobs && !m_thumbnailRequests.isEmpty())
+	{
+		int index(0);
+
+		for (int i = 0; i < m_thumbnailRequests.count(); ++i)
+		{
+			if (m_visibleTiles.contains(m_thumbnailRequests.at(i).identifier))
+			{
+				index = i;
+
+				break;
+			}
+		}
+
+		const ThumbnailRequest request(m_thumbnailRequests.takeAt(index));
+		const quint64 identifier(request.identifier);
+		WebPageThumbnailJob *job(request.job);
+
+		m_thumbnailJobs[identifier] = job;
+
+		connect(job, &WebPageThumbnailJob::jobFinished, this, [=]()
+		{
+			handleThumbnailJobFinished(identifier, job, false);
+		});
+
+		QTimer::singleShot(m_thumbnailJobTimeout, job, [=]()
+		{
+			handleThumbnailJobFinished(identifier, job, true);
+		});
+
+		job->start();
+	}
+}
+
+void StartPageModel::cancelThumbnailJob(quint64 identifier)
+{
+	for (int i = 0; i < m_thumbnailRequests.count(); ++i)
+	{
+		if (m_thumbnailRequests.at(i).identifier == identifier)
+		{
+			m_thumbnailRequests.takeAt(i).job->deleteLater();
+
+			break;
+		}
+	}
+
+	if (m_thumbnailJobs.contains(identifier))
+	{
+		m_thumbnailJobs.take(identifier)->cancel();
+	}
+}
+
+void StartPageModel::handleThumbnailJobFinished(quint64 identifier, WebPageThumbnailJob *job, bool isTimedOut)
+{
+	if (m_thumbnailJobs.value(identifier) != job)
+	{
+		return;
+	}
+
+	m_thumbnailJobs.remove(identifier);
+
+	if (isTimedOut)
+	{
+		job->cancel();
+
+		handleThumbnailCreated(identifier, {}, {});
+	}
+	else
+	{
+		handleThumbnailCreated(identifier, job->getThumbnail(), job->getTitle());
+	}
+
+	startThumbnailJobs();
+}
+
 void StartPageModel::handleOptionChanged(int identifier)
 {
 	switch (identifier)
@@ -205,16 +287,23 @@ void StartPageModel::handleThumbnailCreated(quint64 identifier, const QPixmap &t
 
 	m_tileReloads.remove(identifier);
 
-	if (!bookmark && SessionsManager::isReadOnly() && !thumbnail.isNull())
+	if (bookmark && !SessionsManager::isReadOnly() && !thumbnail.isNull())
 	{
 		Utils::ensureDirectoryExists(SessionsManager::getWritableDataPath(QLatin1String("thumbnails/")));
 
-		thumbnail.save(getThumbnailPath(identifier), "png");
+		if (thumbnail.save(getThumbnailPath(identifier), "png"))
+		{
+			ThumbnailCacheEntry *entry(new ThumbnailCacheEntry());
+			entry->pixmap = thumbnail;
+			entry->modificationTime = QFileInfo(getThumbnailPath(identifier)).lastModified();
+
+			m_thumbnailsCache.insert(identifier, entry, qMax(1, ((thumbnail.width() * thumbnail.height() * thumbnail.depth()) / 8192)));
+		}
 	}
 
 	if (bookmark)
 	{
-		if (needsTitleUpdate)
+		if (needsTitleUpdate && !title.isEmpty())
 		{
 			bookmark->setData(title, BookmarksModel::TitleRole);
 		}
@@ -225,6 +314,11 @@ void StartPageModel::handleThumbnailCreated(quint64 identifier, const QPixmap &t
 	}
 }
 
+void StartPageModel::setVisibleTiles(const QSet<quint64> &identifiers)
+{
+	m_visibleTiles = identifiers;
+}
+
 QMimeData* StartPageModel::mimeData(const QModelIndexList &indexes) const
 {
 	QMimeData *mimeData(new QMimeData());
@@ -279,6 +373,43 @@ QString StartPageModel::getThumbnailPath(quint64 identifier)
 	return SessionsManager::getWritableDataPath(QLatin1String("thumbnails/")) + QString::number(identifier) + QLatin1String(".png");
 }
 
+QPixmap StartPageModel::getThumbnail(quint64 identifier)
+{
+	const QFileInfo fileInformation(getThumbnailPath(identifier));
+
+	if (!fileInformation.exists())
+	{
+		m_thumbnailsCache.remove(identifier);
+
+		return {};
+	}
+
+	const QDateTime modificationTime(fileInformation.lastModified());
+	const ThumbnailCacheEntry *cachedEntry(m_thumbnailsCache.object(identifier));
+
+	if (cachedEntry && cachedEntry->modificationTime == modificationTime)
+	{
+		return cachedEntry->pixmap;
+	}
+
+	const QPixmap pixmap(fileInformation.filePath());
+
+	if (pixmap.isNull())
+	{
+		m_thumbnailsCache.remove(identifier);
+
+		return {};
+	}
+
+	ThumbnailCacheEntry *entry(new ThumbnailCacheEntry());
+	entry->pixmap = pixmap;
+	entry->modificationTime = modificationTime;
+
+	m_thumbnailsCache.insert(identifier, entry, qMax(1, ((pixmap.width() * pixmap.height() * pixmap.depth()) / 8192)));
+
+	return pixmap;
+}
+
 QVariant StartPageModel::data(const QModelIndex &index, int role) const
 {
 	if (role == IsReloadingRole)
@@ -348,14 +479,16 @@ bool StartPageModel::requestThumbnail(const QUrl &url, quint64 identifier, bool
 		return false;
 	}
 
-	connect(job, &WebPageThumbnailJob::jobFinished, this, [=]()
-	{
-		handleThumbnailCreated(identifier, job->getThumbnail(), job->getTitle());
-	});
+	ThumbnailRequest request;
+	request.job = job;
+	request.identifier = identifier;
 
-	m_tileReloads[identifier] = needsTitleUpdate;
+	cancelThumbnailJob(identifier);
+
+	m_thumbnailRequests.append(request);
+	m_tileReloads[identifier] = (needsTitleUpdate || m_tileReloads.value(identifier));
 
-	job->start();
+	startThumbnailJobs();
 
 	return true;
 }
@@ -22,9 +22,15 @@
 
 #include "../../../core/BookmarksModel.h"
 
+#include <QtCore/QCache>
+#include <QtCore/QDateTime>
+#include <QtCore/QSet>
+
 namespace Otter
 {
 
+class WebPageThumbnailJob;
+
 class StartPageModel final : public QStandardItemModel
 {
 	Q_OBJECT
@@ -39,9 +45,11 @@ public:
 
 	explicit StartPageModel(QObject *parent = nullptr);
 
+	void setVisibleTiles(const QSet<quint64> &identifiers);
 	QMimeData* mimeData(const QModelIndexList &indexes) const override;
 	static BookmarksModel::Bookmark* getBookmark(const QModelIndex &index);
 	static QString getThumbnailPath(quint64 identifier);
+	static QPixmap getThumbnail(quint64 identifier);
 	QVariant data(const QModelIndex &index, int role) const override;
 	QStringList mimeTypes() const override;
 	bool reloadTile(const QModelIndex &index, bool needsTitleUpdate = false);
@@ -53,6 +61,21 @@ public slots:
 	QModelIndex addTile(const QUrl &url);
 
 protected:
+	struct ThumbnailRequest final
+	{
+		WebPageThumbnailJob *job = nullptr;
+		quint64 identifier = 0;
+	};
+
+	struct ThumbnailCacheEntry final
+	{
+		QPixmap pixmap;
+		QDateTime modificationTime;
+	};
+
+	void startThumbnailJobs();
+	void cancelThumbnailJob(quint64 identifier);
+	void handleThumbnailJobFinished(quint64 identifier, WebPageThumbnailJob *job, bool isTimedOut);
 	BookmarksModel::Bookmark* getRootBookmark() const;
 	bool requestThumbnail(const QUrl &url, quint64 identifier, bool needsTitleUpdate = false);
 
@@ -66,7 +89,14 @@ protected slots:
 
 private:
 	BookmarksModel::Bookmark *m_bookmark;
+	QVector<ThumbnailRequest> m_thumbnailRequests;
+	QHash<quint64, WebPageThumbnailJob*> m_thumbnailJobs;
 	QHash<quint64, bool> m_tileReloads;
+	QSet<quint64> m_visibleTiles;
+
+	static QCache<quint64, ThumbnailCacheEntry> m_thumbnailsCache;
+	static const int m_maximumThumbnailJobs;
+	static const int m_thumbnailJobTimeout;
 
 signals:
 	void modelModified();
@@ -186,7 +186,7 @@ void TileDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
 				pixmapPainter.setBrush(Qt::white);
 				pixmapPainter.setPen(Qt::transparent);
 				pixmapPainter.drawRect(rectangle);
-				pixmapPainter.drawPixmap(rectangle, QPixmap(StartPageModel::getThumbnailPath(identifier)), rectangle.translated(-rectangle.topLeft()));
+				pixmapPainter.drawPixmap(rectangle, StartPageModel::getThumbnail(identifier), rectangle.translated(-rectangle.topLeft()));
 				pixmapPainter.restore();
 
 				break;
@@ -543,6 +543,7 @@ StartPageWidget::StartPageWidget(Window *parent) : QScrollArea(parent),
 	connect(m_model, &StartPageModel::modelModified, this, &StartPageWidget::updateSize);
 	connect(m_model, &StartPageModel::isReloadingTileChanged, this, &StartPageWidget::handleIsReloadingTileChanged);
 	connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, &StartPageWidget::handleOptionChanged);
+	connect(verticalScrollBar(), &QScrollBar::valueChanged, this, &StartPageWidget::updateVisibleTiles);
 }
 
 StartPageWidget::~StartPageWidget()
@@ -1013,8 +1014,6 @@ void StartPageWidget::handleIsReloadingTileChanged(const QModelIndex &index)
 
 	m_listView->update(index);
 
-	m_thumbnail = {};
-
 	if (m_spinnerAnimation && m_model->match(m_model->index(0, 0), StartPageModel::IsReloadingRole, true, 1, Qt::MatchExactly).isEmpty())
 	{
 		m_spinnerAnimation->deleteLater();
@@ -1038,7 +1037,32 @@ void StartPageWidget::updateSize()
 	m_tileDelegate->setPixmapCachePrefix(m_contentsWidget->getPixmapCachePrefix());
 
 	m_currentIndex = {};
-	m_thumbnail = {};
+
+	updateVisibleTiles();
+}
+
+void StartPageWidget::updateVisibleTiles()
+{
+	if (!isVisible())
+	{
+		return;
+	}
+
+	const QRect viewportRectangle(viewport()->rect());
+	QSet<quint64> identifiers;
+
+	for (int i = 0; i < m_model->rowCount(); ++i)
+	{
+		const QModelIndex index(m_model->index(i, 0));
+		const QRect rectangle(m_listView->visualRect(index));
+
+		if (viewportRectangle.intersects(QRect(m_listView->viewport()->mapTo(viewport(), rectangle.topLeft()), rectangle.size())))
+		{
+			identifiers.insert(index.data(BookmarksModel::IdentifierRole).toULongLong());
+		}
+	}
+
+	m_model->setVisibleTiles(identifiers);
 }
 
 void StartPageWidget::showContextMenu(const QPoint &position)
@@ -1082,23 +1106,19 @@ Animation* StartPageWidget::getLoadingAnimation()
 	return m_spinnerAnimation;
 }
 
-QPixmap StartPageWidget::createThumbnail()
+QImage StartPageWidget::createSnapshot()
 {
-	if (m_thumbnail.isNull())
-	{
-		QPixmap pixmap(widget()->size());
-		pixmap.setDevicePixelRatio(devicePixelRatio());
+	QImage image(widget()->size() * devicePixelRatioF(), QImage::Format_ARGB32_Premultiplied);
+	image.setDevicePixelRatio(devicePixelRatioF());
+	image.fill(Qt::white);
 
-		QPainter painter(&pixmap);
+	QPainter painter(&image);
 
-		widget()->render(&painter);
+	widget()->render(&painter);
 
-		painter.end();
-
-		m_thumbnail = pixmap.scaledToWidth(260, Qt::SmoothTransformation).copy(0, 0, 260, 170);
-	}
+	painter.end();
 
-	return m_thumbnail;
+	return image;
 }
 
 bool StartPageWidget::event(QEvent *event)
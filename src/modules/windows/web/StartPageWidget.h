@@ -119,7 +119,7 @@ public:
 	void scrollContents(const QPoint &delta);
 	void markForDeletion();
 	static Animation* getLoadingAnimation();
-	QPixmap createThumbnail();
+	QImage createSnapshot();
 	bool event(QEvent *event) override;
 	bool eventFilter(QObject *object, QEvent *event) override;
 
@@ -142,6 +142,7 @@ protected slots:
 	void handleOptionChanged(int identifier, const QVariant &value);
 	void handleIsReloadingTileChanged(const QModelIndex &index);
 	void updateSize();
+	void updateVisibleTiles();
 	void showContextMenu(const QPoint &position = {});
 
 private:
@@ -150,7 +151,6 @@ private:
 	QListView *m_listView;
 	SearchWidget *m_searchWidget;
 	TileDelegate *m_tileDelegate;
-	QPixmap m_thumbnail;
 	QTime m_urlOpenTime;
 	QModelIndex m_currentIndex;
 	int m_deleteTimer;
@@ -1422,14 +1422,14 @@ QIcon WebContentsWidget::getIcon() const
 	return m_webWidget->getIcon();
 }
 
-QPixmap WebContentsWidget::createThumbnail()
+QImage WebContentsWidget::createSnapshot(const QSize &size)
 {
 	if (m_startPageWidget && m_startPageWidget->isVisibleTo(this))
 	{
-		return m_startPageWidget->createThumbnail();
+		return m_startPageWidget->createSnapshot();
 	}
 
-	return m_webWidget->createThumbnail();
+	return m_webWidget->createSnapshot(size);
 }
 
 ActionsManager::ActionDefinition::State WebContentsWidget::getActionState(int identifier, const QVariantMap &parameters) const
@@ -58,7 +58,7 @@ public:
 	QVariant getOption(int identifier) const override;
 	QUrl getUrl() const override;
 	QIcon getIcon() const override;
-	QPixmap createThumbnail() override;
+	QImage createSnapshot(const QSize &size) override;
 	ActionsManager::ActionDefinition::State getActionState(int identifier, const QVariantMap &parameters = {}) const override;
 	Session::Window::History getHistory() const override;
 	QHash<int, QVariant> getOptions() const;
@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2013 - 2022 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2013 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -419,8 +419,10 @@ QVariant ContentsWidget::getOption(int identifier) const
 	return {};
 }
 
-QPixmap ContentsWidget::createThumbnail()
+QImage ContentsWidget::createSnapshot(const QSize &size)
 {
+	Q_UNUSED(size)
+
 	return {};
 }
 
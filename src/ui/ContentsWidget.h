@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2013 - 2022 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2013 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -50,7 +50,7 @@ public:
 	virtual QVariant getOption(int identifier) const;
 	virtual QUrl getUrl() const = 0;
 	virtual QIcon getIcon() const = 0;
-	virtual QPixmap createThumbnail();
+	virtual QImage createSnapshot(const QSize &size);
 	ActionsManager::ActionDefinition::State getActionState(int identifier, const QVariantMap &parameters = {}) const override;
 	virtual Session::Window::History getHistory() const;
 	virtual WebWidget::ContentStates getContentState() const;
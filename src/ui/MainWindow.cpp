@@ -2497,7 +2497,7 @@ ActionsManager::ActionDefinition::State MainWindow::getActionState(int identifie
 	return state;
 }
 
-Session::MainWindow MainWindow::getSession() const
+Session::MainWindow MainWindow::getSession(bool includeWindows) const
 {
 	const QVector<Qt::ToolBarArea> areas({Qt::LeftToolBarArea, Qt::RightToolBarArea, Qt::TopToolBarArea, Qt::BottomToolBarArea});
 	Session::MainWindow session;
@@ -2532,6 +2532,11 @@ Session::MainWindow MainWindow::getSession() const
 		return session;
 	}
 
+	if (!includeWindows)
+	{
+		return session;
+	}
+
 	session.windows.reserve(m_windows.count());
 
 	for (int i = 0; i < m_windows.count(); ++i)
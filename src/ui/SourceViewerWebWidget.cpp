@@ -1,6 +1,6 @@
 /**************************************************************************
 * Otter Browser: Web browser controlled by the user, not vice-versa.
-* Copyright (C) 2015 - 2023 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+* Copyright (C) 2015 - 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
 *
 * This program is free software: you can redistribute it and/or modify
 * it under the terms of the GNU General Public License as published by
@@ -290,7 +290,7 @@ void SourceViewerWebWidget::handleViewSourceReplyFinished()
 
 void SourceViewerWebWidget::handleZoomChanged()
 {
-	SessionsManager::markSessionAsModified();
+	SessionsManager::markWindowAsModified(getWindowIdentifier());
 }
 
 void SourceViewerWebWidget::notifyEditingActionsStateChanged()
@@ -348,7 +348,7 @@ void SourceViewerWebWidget::setZoom(int zoom)
 	{
 		m_sourceEditWidget->setZoom(zoom);
 
-		SessionsManager::markSessionAsModified();
+		SessionsManager::markWindowAsModified(getWindowIdentifier());
 
 		emit zoomChanged(zoom);
 	}
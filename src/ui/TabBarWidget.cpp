@@ -31,6 +31,7 @@
 #include "../core/InputInterpreter.h"
 #include "../core/SettingsManager.h"
 #include "../core/ThemesManager.h"
+#include "../core/ThumbnailsManager.h"
 
 #include <QtCore/QMimeData>
 #include <QtCore/QtMath>
@@ -82,6 +83,13 @@ TabHandleWidget::TabHandleWidget(Window *window, TabBarWidget *parent) : QWidget
 	connect(window, &Window::titleChanged, this, &TabHandleWidget::updateTitle);
 	connect(window, &Window::iconChanged, this, static_cast<void(TabHandleWidget::*)()>(&TabHandleWidget::update));
 	connect(window, &Window::loadingStateChanged, this, &TabHandleWidget::handleLoadingStateChanged);
+	connect(ThumbnailsManager::getInstance(), &ThumbnailsManager::thumbnailChanged, this, [&](quint64 identifier)
+	{
+		if (m_thumbnailRectangle.isValid() && m_window && m_window->getIdentifier() == identifier)
+		{
+			update();
+		}
+	});
 	connect(parent, &TabBarWidget::currentChanged, this, &TabHandleWidget::updateGeometries);
 	connect(parent, &TabBarWidget::tabsAmountChanged, this, &TabHandleWidget::updateGeometries);
 	connect(parent, &TabBarWidget::needsGeometriesUpdate, this, &TabHandleWidget::updateGeometries);
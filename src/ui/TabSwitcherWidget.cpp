@@ -24,6 +24,7 @@
 #include "../core/Application.h"
 #include "../core/SessionModel.h"
 #include "../core/ThemesManager.h"
+#include "../core/ThumbnailsManager.h"
 
 #include <QtGui/QKeyEvent>
 #include <QtWidgets/QFrame>
@@ -116,6 +117,7 @@ void TabSwitcherWidget::showEvent(QShowEvent *event)
 
 	connect(m_mainWindow, &MainWindow::windowAdded, this, &TabSwitcherWidget::handleWindowAdded);
 	connect(m_mainWindow, &MainWindow::windowRemoved, this, &TabSwitcherWidget::handleWindowRemoved);
+	connect(ThumbnailsManager::getInstance(), &ThumbnailsManager::thumbnailChanged, this, &TabSwitcherWidget::handleThumbnailChanged);
 }
 
 void TabSwitcherWidget::hideEvent(QHideEvent *event)
@@ -124,6 +126,7 @@ void TabSwitcherWidget::hideEvent(QHideEvent *event)
 
 	disconnect(m_mainWindow, &MainWindow::windowAdded, this, &TabSwitcherWidget::handleWindowAdded);
 	disconnect(m_mainWindow, &MainWindow::windowRemoved, this, &TabSwitcherWidget::handleWindowRemoved);
+	disconnect(ThumbnailsManager::getInstance(), &ThumbnailsManager::thumbnailChanged, this, &TabSwitcherWidget::handleThumbnailChanged);
 
 	m_model->clear();
 }
@@ -226,6 +229,16 @@ void TabSwitcherWidget::handleCurrentTabChanged(const QModelIndex &index)
 	}
 }
 
+void TabSwitcherWidget::handleThumbnailChanged(quint64 identifier)
+{
+	const QModelIndex index(m_tabsView->currentIndex());
+
+	if (index.data(IdentifierRole).toULongLong() == identifier)
+	{
+		handleCurrentTabChanged(index);
+	}
+}
+
 void TabSwitcherWidget::handleWindowAdded(quint64 identifier)
 {
 	Window *window(m_mainWindow->getWindowByIdentifier(identifier));
@@ -67,6 +67,7 @@ protected:
 
 protected slots:
 	void handleCurrentTabChanged(const QModelIndex &index);
+	void handleThumbnailChanged(quint64 identifier);
 	void handleWindowAdded(quint64 identifier);
 	void handleWindowRemoved(quint64 identifier);
 
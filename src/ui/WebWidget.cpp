@@ -684,7 +684,7 @@ void WebWidget::setOption(int identifier, const QVariant &value)
 		m_options[identifier] = value;
 	}
 
-	SessionsManager::markSessionAsModified();
+	SessionsManager::markWindowAsModified(m_windowIdentifier);
 
 	switch (identifier)
 	{
@@ -1031,12 +1031,12 @@ QUrl WebWidget::getRequestedUrl() const
 	return ((getUrl().isEmpty() || getLoadingState() == OngoingLoadingState) ? m_requestedUrl : getUrl());
 }
 
-QPixmap WebWidget::createThumbnail(const QSize &size)
+QImage WebWidget::createSnapshot(const QSize &size)
 {
-	QPixmap pixmap(size);
-	pixmap.fill(Qt::white);
+	QImage image(size, QImage::Format_RGB32);
+	image.fill(Qt::white);
 
-	return pixmap;
+	return image;
 }
 
 QPoint WebWidget::getClickPosition() const
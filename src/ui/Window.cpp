@@ -26,6 +26,7 @@
 #include "../core/HandlersManager.h"
 #include "../core/HistoryManager.h"
 #include "../core/SettingsManager.h"
+#include "../core/ThumbnailsManager.h"
 #include "../core/Utils.h"
 #include "../modules/widgets/address/AddressWidget.h"
 #include "../modules/widgets/search/SearchWidget.h"
@@ -313,7 +314,7 @@ void Window::setOption(int identifier, const QVariant &value)
 			m_session.options[identifier] = value;
 		}
 
-		SessionsManager::markSessionAsModified();
+		SessionsManager::markWindowAsModified(m_identifier);
 
 		emit optionChanged(identifier, value);
 	}
@@ -579,7 +580,12 @@ QIcon Window::getIcon() const
 
 QPixmap Window::createThumbnail() const
 {
-	return ((m_contentsWidget && !m_isAboutToClose) ? m_contentsWidget->createThumbnail() : QPixmap());
+	return ThumbnailsManager::getThumbnail(this);
+}
+
+QImage Window::createSnapshot(const QSize &size) const
+{
+	return ((m_contentsWidget && !m_isAboutToClose) ? m_contentsWidget->createSnapshot(size) : QImage());
 }
 
 QDateTime Window::getLastActivity() const
@@ -82,7 +82,7 @@ void MdiWindow::restoreState()
 		showNormal();
 	}
 
-	SessionsManager::markSessionAsModified();
+	SessionsManager::markWindowAsModified(m_window->getIdentifier());
 }
 
 void MdiWindow::changeEvent(QEvent *event)
@@ -91,7 +91,7 @@ void MdiWindow::changeEvent(QEvent *event)
 
 	if (event->type() == QEvent::WindowStateChange)
 	{
-		SessionsManager::markSessionAsModified();
+		SessionsManager::markWindowAsModified(m_window->getIdentifier());
 	}
 }
 
@@ -106,14 +106,14 @@ void MdiWindow::moveEvent(QMoveEvent *event)
 {
 	QMdiSubWindow::moveEvent(event);
 
-	SessionsManager::markSessionAsModified();
+	SessionsManager::markWindowAsModified(m_window->getIdentifier());
 }
 
 void MdiWindow::resizeEvent(QResizeEvent *event)
 {
 	QMdiSubWindow::resizeEvent(event);
 
-	SessionsManager::markSessionAsModified();
+	SessionsManager::markWindowAsModified(m_window->getIdentifier());
 }
 
 void MdiWindow::focusInEvent(QFocusEvent *event)
@@ -142,7 +142,7 @@ void MdiWindow::mouseReleaseEvent(QMouseEvent *event)
 		setWindowFlags(Qt::SubWindow | Qt::CustomizeWindowHint | Qt::FramelessWindowHint);
 		showMaximized();
 
-		SessionsManager::markSessionAsModified();
+		SessionsManager::markWindowAsModified(m_window->getIdentifier());
 	}
 	else if (!isMinimized() && style()->subControlRect(QStyle::CC_TitleBar, &option, QStyle::SC_TitleBarMinButton, this).contains(event->pos()))
 	{
@@ -179,7 +179,7 @@ void MdiWindow::mouseReleaseEvent(QMouseEvent *event)
 			Application::triggerAction(ActionsManager::ActivatePreviouslyUsedTabAction, {}, mdiArea());
 		}
 
-		SessionsManager::markSessionAsModified();
+		SessionsManager::markWindowAsModified(m_window->getIdentifier());
 	}
 	else if (isMinimized())
 	{
@@ -0,0 +1,582 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2024 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "../../src/core/AdblockContentFiltersRuleSet.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QTextStream>
+
+// Differential harness comparing the compiled rule set against the trie based matcher it replaced.
+// Usage: otter-adblock-harness <rules.txt> <requests.tsv> [iterations]
+// Each request line has the form: baseUrl<TAB>requestUrl<TAB>type[<TAB>trie-order]
+// Requests marked with trie-order are expected to differ from the old trie, any other difference is a failure.
+
+namespace Otter
+{
+
+typedef AdblockContentFiltersRuleSet::RuleDefinition RuleDefinition;
+typedef AdblockContentFiltersRuleSet::Request Request;
+
+class ReferenceMatcher final
+{
+public:
+	explicit ReferenceMatcher(bool canExploreAllBranches) :
+		m_root(new Node()),
+		m_canExploreAllBranches(canExploreAllBranches)
+	{
+	}
+
+	~ReferenceMatcher()
+	{
+		deleteNode(m_root);
+	}
+
+	void addRule(const RuleDefinition &definition)
+	{
+		Node *node(m_root);
+
+		for (int i = 0; i < definition.pattern.length(); ++i)
+		{
+			const QChar value(definition.pattern.at(i));
+			bool hasChildren(false);
+
+			for (int j = 0; j < node->children.count(); ++j)
+			{
+				Node *nextNode(node->children.at(j));
+
+				if (nextNode->value == value)
+				{
+					node = nextNode;
+
+					hasChildren = true;
+
+					break;
+				}
+			}
+
+			if (!hasChildren)
+			{
+				Node *newNode(new Node());
+				newNode->value = value;
+
+				if (value == QLatin1Char('^'))
+				{
+					node->children.insert(0, newNode);
+				}
+				else
+				{
+					node->children.append(newNode);
+				}
+
+				node = newNode;
+			}
+		}
+
+		node->rules.append(definition);
+	}
+
+	ContentFiltersManager::CheckResult checkUrl(const Request &request) const
+	{
+		ContentFiltersManager::CheckResult result;
+
+		for (int i = 0; i < request.requestUrl.length(); ++i)
+		{
+			const ContentFiltersManager::CheckResult currentResult(checkUrlSubstring(m_root, request.requestUrl.mid(i), {}, request));
+
+			if (currentResult.isBlocked)
+			{
+				result = currentResult;
+			}
+			else if (currentResult.isException)
+			{
+				return currentResult;
+			}
+		}
+
+		return result;
+	}
+
+protected:
+	struct Node final
+	{
+		QChar value;
+		QVector<Node*> children;
+		QVector<RuleDefinition> rules;
+	};
+
+	void deleteNode(Node *node) const
+	{
+		for (int i = 0; i < node->children.count(); ++i)
+		{
+			deleteNode(node->children.at(i));
+		}
+
+		delete node;
+	}
+
+	ContentFiltersManager::CheckResult checkUrlSubstring(const Node *node, const QString &subString, QString currentRule, const Request &request) const
+	{
+		ContentFiltersManager::CheckResult result;
+		ContentFiltersManager::CheckResult currentResult;
+
+		for (int i = 0; i < subString.length(); ++i)
+		{
+			const QChar treeChar(subString.at(i));
+			const Node *nextLiteralNode(nullptr);
+
+			currentResult = evaluateNodeRules(node, currentRule, request);
+
+			if (currentResult.isBlocked)
+			{
+				result = currentResult;
+			}
+			else if (currentResult.isException)
+			{
+				return currentResult;
+			}
+
+			for (int j = 0; j < node->children.count(); ++j)
+			{
+				const Node *nextNode(node->children.at(j));
+
+				if (nextNode->value == QLatin1Char('*'))
+				{
+					const QString wildcardSubString(subString.mid(i));
+
+					for (int k = 0; k < wildcardSubString.length(); ++k)
+					{
+						currentResult = checkUrlSubstring(nextNode, wildcardSubString.mid(k), (currentRule + wildcardSubString.left(k)), request);
+
+						if (currentResult.isBlocked)
+						{
+							result = currentResult;
+						}
+						else if (currentResult.isException)
+						{
+							return currentResult;
+						}
+					}
+				}
+
+				if (nextNode->value == QLatin1Char('^') && !treeChar.isDigit() && !treeChar.isLetter() && treeChar != QLatin1Char('_') && treeChar != QLatin1Char('-') && treeChar != QLatin1Char('.') && treeChar != QLatin1Char('%'))
+				{
+					currentResult = checkUrlSubstring(nextNode, subString.mid(i), currentRule, request);
+
+					if (currentResult.isBlocked)
+					{
+						result = currentResult;
+					}
+					else if (currentResult.isException)
+					{
+						return currentResult;
+					}
+				}
+
+				if (nextNode->value == treeChar)
+				{
+					nextLiteralNode = nextNode;
+
+					if (!m_canExploreAllBranches)
+					{
+						break;
+					}
+				}
+			}
+
+			if (!nextLiteralNode)
+			{
+				return result;
+			}
+
+			node = nextLiteralNode;
+
+			currentRule += treeChar;
+		}
+
+		currentResult = evaluateNodeRules(node, currentRule, request);
+
+		if (currentResult.isBlocked)
+		{
+			result = currentResult;
+		}
+		else if (currentResult.isException)
+		{
+			return currentResult;
+		}
+
+		return result;
+	}
+
+	ContentFiltersManager::CheckResult evaluateNodeRules(const Node *node, const QString &currentRule, const Request &request) const
+	{
+		ContentFiltersManager::CheckResult result;
+
+		for (int i = 0; i < node->rules.count(); ++i)
+		{
+			const ContentFiltersManager::CheckResult currentResult(checkRuleMatch(node->rules.at(i), currentRule, request));
+
+			if (currentResult.isBlocked)
+			{
+				result = currentResult;
+			}
+			else if (currentResult.isException)
+			{
+				return currentResult;
+			}
+		}
+
+		return result;
+	}
+
+	ContentFiltersManager::CheckResult checkRuleMatch(const RuleDefinition &rule, const QString &currentRule, const Request &request) const
+	{
+		switch (rule.ruleMatch)
+		{
+			case AdblockContentFiltersRuleSet::StartMatch:
+				if (!request.requestUrl.startsWith(currentRule))
+				{
+					return {};
+				}
+
+				break;
+			case AdblockContentFiltersRuleSet::EndMatch:
+				if (!request.requestUrl.endsWith(currentRule))
+				{
+					return {};
+				}
+
+				break;
+			case AdblockContentFiltersRuleSet::ExactMatch:
+				if (request.requestUrl != currentRule)
+				{
+					return {};
+				}
+
+				break;
+			default:
+				if (!request.requestUrl.contains(currentRule))
+				{
+					return {};
+				}
+
+				break;
+		}
+
+		if (rule.needsDomainCheck && !request.requestSubdomainList.contains(currentRule.left(currentRule.indexOf(m_domainExpression))))
+		{
+			return {};
+		}
+
+		const bool hasBlockedDomains(!rule.blockedDomains.isEmpty());
+		const bool hasAllowedDomains(!rule.allowedDomains.isEmpty());
+		bool isBlocked(true);
+
+		if (hasBlockedDomains)
+		{
+			isBlocked = resolveDomainExceptions(request.baseHost, rule.blockedDomains);
+
+			if (!isBlocked)
+			{
+				return {};
+			}
+		}
+
+		isBlocked = (hasAllowedDomains ? !resolveDomainExceptions(request.baseHost, rule.allowedDomains) : isBlocked);
+
+		if (rule.ruleOptions.testFlag(AdblockContentFiltersRuleSet::ThirdPartyOption) || rule.ruleExceptions.testFlag(AdblockContentFiltersRuleSet::ThirdPartyOption))
+		{
+			if (request.baseHost.isEmpty() || request.requestSubdomainList.contains(request.baseHost))
+			{
+				isBlocked = rule.ruleExceptions.testFlag(AdblockContentFiltersRuleSet::ThirdPartyOption);
+			}
+			else if (!hasBlockedDomains && !hasAllowedDomains)
+			{
+				isBlocked = rule.ruleOptions.testFlag(AdblockContentFiltersRuleSet::ThirdPartyOption);
+			}
+		}
+
+		if (rule.ruleOptions != AdblockContentFiltersRuleSet::NoOption || rule.ruleExceptions != AdblockContentFiltersRuleSet::NoOption)
+		{
+			QHash<NetworkManager::ResourceType, AdblockContentFiltersRuleSet::RuleOption>::const_iterator iterator;
+
+			for (iterator = m_resourceTypes.constBegin(); iterator != m_resourceTypes.constEnd(); ++iterator)
+			{
+				const bool supportsException(iterator.value() != AdblockContentFiltersRuleSet::WebSocketOption && iterator.value() != AdblockContentFiltersRuleSet::PopupOption);
+
+				if (!rule.ruleOptions.testFlag(iterator.value()) && !(supportsException && rule.ruleExceptions.testFlag(iterator.value())))
+				{
+					continue;
+				}
+
+				if (request.resourceType == iterator.key())
+				{
+					isBlocked = (isBlocked ? rule.ruleOptions.testFlag(iterator.value()) : isBlocked);
+				}
+				else if (supportsException)
+				{
+					isBlocked = (isBlocked ? rule.ruleExceptions.testFlag(iterator.value()) : isBlocked);
+				}
+				else
+				{
+					isBlocked = false;
+				}
+			}
+		}
+		else if (request.resourceType == NetworkManager::PopupType)
+		{
+			isBlocked = false;
+		}
+
+		if (!isBlocked)
+		{
+			return {};
+		}
+
+		ContentFiltersManager::CheckResult result;
+		result.rule = rule.rule;
+
+		if (rule.isException)
+		{
+			result.isBlocked = false;
+			result.isException = true;
+
+			if (rule.ruleOptions.testFlag(AdblockContentFiltersRuleSet::ElementHideOption))
+			{
+				result.comesticFiltersMode = ContentFiltersManager::NoFilters;
+			}
+			else if (rule.ruleOptions.testFlag(AdblockContentFiltersRuleSet::GenericHideOption))
+			{
+				result.comesticFiltersMode = ContentFiltersManager::DomainOnlyFilters;
+			}
+
+			return result;
+		}
+
+		result.isBlocked = true;
+
+		return result;
+	}
+
+	bool resolveDomainExceptions(const QString &url, const QStringList &ruleList) const
+	{
+		for (int i = 0; i < ruleList.count(); ++i)
+		{
+			if (url.contains(ruleList.at(i)))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+private:
+	Node *m_root;
+	bool m_canExploreAllBranches;
+
+	static QRegularExpression m_domainExpression;
+	static QHash<NetworkManager::ResourceType, AdblockContentFiltersRuleSet::RuleOption> m_resourceTypes;
+};
+
+QRegularExpression ReferenceMatcher::m_domainExpression(QLatin1String("[:\?&/=]"));
+QHash<NetworkManager::ResourceType, AdblockContentFiltersRuleSet::RuleOption> ReferenceMatcher::m_resourceTypes({{NetworkManager::ImageType, AdblockContentFiltersRuleSet::ImageOption}, {NetworkManager::ScriptType, AdblockContentFiltersRuleSet::ScriptOption}, {NetworkManager::StyleSheetType, AdblockContentFiltersRuleSet::StyleSheetOption}, {NetworkManager::ObjectType, AdblockContentFiltersRuleSet::ObjectOption}, {NetworkManager::XmlHttpRequestType, AdblockContentFiltersRuleSet::XmlHttpRequestOption}, {NetworkManager::SubFrameType, AdblockContentFiltersRuleSet::SubDocumentOption},{NetworkManager::PopupType, AdblockContentFiltersRuleSet::PopupOption}, {NetworkManager::ObjectSubrequestType, AdblockContentFiltersRuleSet::ObjectSubRequestOption}, {NetworkManager::WebSocketType, AdblockContentFiltersRuleSet::WebSocketOption}});
+
+NetworkManager::ResourceType getResourceType(const QString &name)
+{
+	static const QHash<QString, NetworkManager::ResourceType> types({{QLatin1String("image"), NetworkManager::ImageType}, {QLatin1String("script"), NetworkManager::ScriptType}, {QLatin1String("stylesheet"), NetworkManager::StyleSheetType}, {QLatin1String("object"), NetworkManager::ObjectType}, {QLatin1String("xmlhttprequest"), NetworkManager::XmlHttpRequestType}, {QLatin1String("subdocument"), NetworkManager::SubFrameType}, {QLatin1String("popup"), NetworkManager::PopupType}, {QLatin1String("object-subrequest"), NetworkManager::ObjectSubrequestType}, {QLatin1String("websocket"), NetworkManager::WebSocketType}});
+
+	return types.value(name, NetworkManager::OtherType);
+}
+
+QString describeResult(const ContentFiltersManager::CheckResult &result)
+{
+	if (result.isException)
+	{
+		return QStringLiteral("exception (%1)").arg(result.rule);
+	}
+
+	if (result.isBlocked)
+	{
+		return QStringLiteral("blocked (%1)").arg(result.rule);
+	}
+
+	return QLatin1String("allowed");
+}
+
+bool isSameDecision(const ContentFiltersManager::CheckResult &first, const ContentFiltersManager::CheckResult &second)
+{
+	return (first.isBlocked == second.isBlocked && first.isException == second.isException);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	using namespace Otter;
+
+	QCoreApplication application(argc, argv);
+	QTextStream output(stdout);
+	const QStringList arguments(application.arguments());
+
+	if (arguments.count() < 3)
+	{
+		output << "Usage: " << arguments.value(0) << " <rules.txt> <requests.tsv> [iterations]\n";
+
+		return 2;
+	}
+
+	QFile rulesFile(arguments.at(1));
+	QFile requestsFile(arguments.at(2));
+
+	if (!rulesFile.open(QIODevice::ReadOnly | QIODevice::Text) || !requestsFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		output << "Failed to open input files\n";
+
+		return 2;
+	}
+
+	const int iterations(qMax(1, arguments.value(3, QLatin1String("1")).toInt()));
+	ReferenceMatcher baselineMatcher(false);
+	ReferenceMatcher exhaustiveMatcher(true);
+	AdblockContentFiltersRuleSet::Builder builder({});
+	QTextStream rulesStream(&rulesFile);
+	int rulesAmount(0);
+
+	while (!rulesStream.atEnd())
+	{
+		const QString line(rulesStream.readLine().trimmed());
+		RuleDefinition definition;
+
+		if (!line.startsWith(QLatin1Char('[')) && AdblockContentFiltersRuleSet::parseRule(line, true, &definition))
+		{
+			baselineMatcher.addRule(definition);
+			exhaustiveMatcher.addRule(definition);
+			builder.addRule(definition);
+
+			++rulesAmount;
+		}
+	}
+
+	const QSharedPointer<AdblockContentFiltersRuleSet> ruleSet(AdblockContentFiltersRuleSet::fromData(builder.build()));
+
+	if (!ruleSet)
+	{
+		output << "Failed to load compiled rule set\n";
+
+		return 2;
+	}
+
+	QVector<Request> requests;
+	QVector<bool> trieOrderRequests;
+	QTextStream requestsStream(&requestsFile);
+
+	while (!requestsStream.atEnd())
+	{
+		const QString line(requestsStream.readLine());
+
+		if (line.trimmed().isEmpty() || line.startsWith(QLatin1Char('#')))
+		{
+			continue;
+		}
+
+		const QStringList fields(line.split(QLatin1Char('\t')));
+
+		requests.append(Request(QUrl(fields.value(0)), QUrl(fields.value(1)), getResourceType(fields.value(2).trimmed())));
+		trieOrderRequests.append(fields.value(3).trimmed() == QLatin1String("trie-order"));
+	}
+
+	int baselineMismatches(0);
+	int unexpectedBaselineMismatches(0);
+	int exhaustiveMismatches(0);
+	int ruleDifferences(0);
+
+	for (int i = 0; i < requests.count(); ++i)
+	{
+		const Request &request(requests.at(i));
+		const ContentFiltersManager::CheckResult baselineResult(baselineMatcher.checkUrl(request));
+		const ContentFiltersManager::CheckResult exhaustiveResult(exhaustiveMatcher.checkUrl(request));
+		const ContentFiltersManager::CheckResult result(ruleSet->checkUrl(request));
+
+		if (!isSameDecision(result, exhaustiveResult))
+		{
+			++exhaustiveMismatches;
+
+			output << "MISMATCH " << request.requestUrl << ": compiled " << describeResult(result) << ", reference " << describeResult(exhaustiveResult) << "\n";
+		}
+		else if (result.rule != exhaustiveResult.rule || result.comesticFiltersMode != exhaustiveResult.comesticFiltersMode)
+		{
+			++ruleDifferences;
+		}
+
+		if (!isSameDecision(result, baselineResult))
+		{
+			++baselineMismatches;
+
+			if (!trieOrderRequests.at(i))
+			{
+				++unexpectedBaselineMismatches;
+
+				output << "BASELINE MISMATCH " << request.requestUrl << ": compiled " << describeResult(result) << ", baseline " << describeResult(baselineResult) << "\n";
+			}
+		}
+		else if (trieOrderRequests.at(i))
+		{
+			++unexpectedBaselineMismatches;
+
+			output << "STALE TRIE ORDER " << request.requestUrl << ": compiled and baseline both " << describeResult(result) << "\n";
+		}
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		for (int j = 0; j < requests.count(); ++j)
+		{
+			baselineMatcher.checkUrl(requests.at(j));
+		}
+	}
+
+	const qint64 baselineTime(timer.nsecsElapsed());
+
+	timer.restart();
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		for (int j = 0; j < requests.count(); ++j)
+		{
+			ruleSet->checkUrl(requests.at(j));
+		}
+	}
+
+	const qint64 compiledTime(timer.nsecsElapsed());
+	const qint64 checksAmount(qMax(1, (requests.count() * iterations)));
+
+	output << "Rules: " << rulesAmount << ", requests: " << requests.count() << "\n";
+	output << "Decisions differing from reference matcher: " << exhaustiveMismatches << "\n";
+	output << "Decisions differing from baseline trie: " << baselineMismatches << " (unexpected: " << unexpectedBaselineMismatches << ")\n";
+	output << "Same decision, different reported rule: " << ruleDifferences << "\n";
+	output << "Baseline: " << (baselineTime / checksAmount) << " ns/request, compiled: " << (compiledTime / checksAmount) << " ns/request\n";
+
+	return ((exhaustiveMismatches > 0 || unexpectedBaselineMismatches > 0) ? 1 : 0);
+}